@@ -42,14 +42,6 @@ static int maximum_traverse_depth = 2000;
 static FILE *error_msgout = NULL;
 static FILE *sbom_out = NULL;
 
-#define OUTPUT_OR_RET(client, f, fmt, ...) \
-	do { \
-		if (!pkgconf_output_file_fmt((f), (fmt), ##__VA_ARGS__)) { \
-			pkgconf_error((client), "bomtool: Could not output to file: %s", strerror(errno)); \
-			return; \
-		} \
-	} while (0)
-
 #define OUTPUT_OR_RET_FALSE(client, f, fmt, ...) \
 	do { \
 		if (!pkgconf_output_file_fmt((f), (fmt), ##__VA_ARGS__)) { \
@@ -58,6 +50,26 @@ static FILE *sbom_out = NULL;
 		} \
 	} while (0)
 
+/* The SBOM is formatted into a buffer, which is written out whenever this much is pending. */
+#define SBOM_WRITER_FLUSH_SIZE	65536
+
+#define SBOM_SPDX_REF_PREFIX	"SPDXRef-Package-"
+#define SBOM_SPDX_AT			"C40"	/* 0x40 is the at sign (@) */
+
+typedef struct {
+	pkgconf_client_t *client;
+
+	/* text which has not been written to sbom_out yet */
+	pkgconf_buffer_t out;
+
+	/* the packages written so far, whose relationships go after all of the package records */
+	pkgconf_pkg_t **packages;
+	size_t package_count;
+	size_t package_alloc;
+
+	bool failed;
+} sbom_writer_t;
+
 static const char *
 environ_lookup_handler(const pkgconf_client_t *client, const char *key)
 {
@@ -75,88 +87,175 @@ error_handler(const char *msg, const pkgconf_client_t *client, void *data)
 	return true;
 }
 
-static const char *
-sbom_spdx_identity(pkgconf_pkg_t *pkg)
+/*
+ * Records are formatted straight into the output buffer: the size of each
+ * piece is worked out first, so that the buffer is grown once and the text
+ * is then copied into place.
+ */
+static inline char *
+sbom_put(char *p, const char *text, size_t len)
 {
-	static char buf[PKGCONF_ITEM_SIZE];
-	size_t i, o;
+	memcpy(p, text, len);
+	return p + len;
+}
 
-	/* Sanitize the package ID: only letters, numbers, dot (.) and dash (-)
-	 * are allowed.
-	 */
-	for (i = 0, o = 0; i < strlen(pkg->id) && o < sizeof(buf); i++, o++) {
-		char c = pkg->id[i];
-		if (c == '-' || c == '.' || isalnum(c))
-			buf[o] = c;
-		else {
-			snprintf(buf + o, sizeof(buf) - o, "C%02x", c);
-			o += 2;
-		}
-	}
-	snprintf(buf + o, sizeof(buf) - o, "C40%s", pkg->version);
-	/*                                  ^^^ 0x40 is the at sign (@) */
-	return buf;
+/* append a NULL-terminated list of strings */
+static bool
+sbom_append(pkgconf_buffer_t *buf, ...)
+{
+	va_list va;
+	const char *arg;
+	size_t len = 0;
+	char *p;
+
+	va_start(va, buf);
+	while ((arg = va_arg(va, const char *)) != NULL)
+		len += strlen(arg);
+	va_end(va);
+
+	p = pkgconf_buffer_extend(buf, len);
+	if (p == NULL)
+		return false;
+
+	va_start(va, buf);
+	while ((arg = va_arg(va, const char *)) != NULL)
+		p = sbom_put(p, arg, strlen(arg));
+	va_end(va);
+
+	return true;
 }
 
-static char *
-sbom_name(pkgconf_pkg_t *world)
+/* Sanitize the package ID: only letters, numbers, dot (.) and dash (-)
+ * are allowed, any other byte is written as C followed by its value in
+ * hex.
+ */
+static inline bool
+sbom_spdx_safe(char c)
 {
-	pkgconf_buffer_t name = PKGCONF_BUFFER_INITIALIZER;
-	pkgconf_node_t *node;
+	return c == '-' || c == '.' || isalnum((unsigned char) c);
+}
 
-	pkgconf_buffer_append(&name, "SBOM-SPDX");
+/* the length of a package's SPDX identity, as written by sbom_put_spdx_identity() */
+static size_t
+sbom_spdx_identity_len(const pkgconf_pkg_t *pkg)
+{
+	size_t len = strlen(SBOM_SPDX_AT) + strlen(pkg->version);
 
-	PKGCONF_FOREACH_LIST_ENTRY(world->required.head, node)
-	{
-		pkgconf_dependency_t *dep = node->data;
-		pkgconf_pkg_t *match = dep->match;
+	for (const char *p = pkg->id; *p != '\0'; p++)
+		len += sbom_spdx_safe(*p) ? 1 : 3;
 
-		if ((dep->flags & PKGCONF_PKG_DEPF_QUERY) != PKGCONF_PKG_DEPF_QUERY)
-			continue;
+	return len;
+}
 
-		if (!dep->match)
+static char *
+sbom_put_spdx_identity(char *p, const pkgconf_pkg_t *pkg)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	for (const char *s = pkg->id; *s != '\0'; s++)
+	{
+		unsigned char c = (unsigned char) *s;
+
+		if (sbom_spdx_safe(*s))
+		{
+			*p++ = *s;
 			continue;
+		}
 
-		pkgconf_buffer_append_fmt(&name, "-%s", sbom_spdx_identity(match));
+		*p++ = 'C';
+		*p++ = hex[c >> 4];
+		*p++ = hex[c & 0xf];
 	}
 
-	return pkgconf_buffer_freeze(&name);
+	p = sbom_put(p, SBOM_SPDX_AT, strlen(SBOM_SPDX_AT));
+	return sbom_put(p, pkg->version, strlen(pkg->version));
 }
 
+/* append prefix, followed by the package's SPDX identity */
 static bool
-write_sbom_header(pkgconf_client_t *client, pkgconf_pkg_t *world)
+sbom_append_spdx_identity(pkgconf_buffer_t *buf, const char *prefix, const pkgconf_pkg_t *pkg)
 {
-	time_t t;
-	struct tm *tm;
-	char buf[21];
+	size_t prefix_len = strlen(prefix);
+	char *p = pkgconf_buffer_extend(buf, prefix_len + sbom_spdx_identity_len(pkg));
 
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "SPDXVersion: %s\n", spdx_version);
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "DataLicense: %s\n", bom_license);
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "SPDXID: %s\n", document_ref);
-
-	char *docname = sbom_name(world);
-	if (!docname)
-	{
-		pkgconf_error(client, "write_sbom_header: out of memory");
+	if (p == NULL)
 		return false;
-	}
 
-	if (!pkgconf_output_file_fmt(sbom_out, "DocumentName: %s\n", docname))
+	sbom_put_spdx_identity(sbom_put(p, prefix, prefix_len), pkg);
+	return true;
+}
+
+static bool
+sbom_writer_flush(sbom_writer_t *writer)
+{
+	size_t len = pkgconf_buffer_len(&writer->out);
+
+	if (len > 0 && fwrite(pkgconf_buffer_str(&writer->out), 1, len, sbom_out) != len)
 	{
-		free(docname);
+		pkgconf_error(writer->client, "bomtool: Could not output to file: %s", strerror(errno));
+		writer->failed = true;
 		return false;
 	}
 
-	free(docname);
+	pkgconf_buffer_rewind(&writer->out);
+	return true;
+}
+
+/* write out the buffered text once enough of it has gathered */
+static bool
+sbom_writer_record_done(sbom_writer_t *writer)
+{
+	if (pkgconf_buffer_len(&writer->out) < SBOM_WRITER_FLUSH_SIZE)
+		return true;
+
+	return sbom_writer_flush(writer);
+}
+
+static bool
+sbom_writer_out_of_memory(sbom_writer_t *writer)
+{
+	pkgconf_error(writer->client, "bomtool: out of memory");
+	writer->failed = true;
+	return false;
+}
+
+static bool
+write_sbom_header(sbom_writer_t *writer, pkgconf_pkg_t *world)
+{
+	pkgconf_buffer_t *out = &writer->out;
+	pkgconf_node_t *node;
+	time_t t;
+	struct tm *tm;
+	char buf[21];
 
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "DocumentNamespace: https://spdx.org/spdxdocs/bomtool\n");
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "Creator: Tool: bomtool\n");
+	if (!sbom_append(out,
+			"SPDXVersion: ", spdx_version, "\n",
+			"DataLicense: ", bom_license, "\n",
+			"SPDXID: ", document_ref, "\n",
+			"DocumentName: SBOM-SPDX", NULL))
+		return sbom_writer_out_of_memory(writer);
 
-	if (creation_time != NULL)
+	PKGCONF_FOREACH_LIST_ENTRY(world->required.head, node)
 	{
-		OUTPUT_OR_RET_FALSE(client, sbom_out, "Created: %s\n", creation_time);
+		pkgconf_dependency_t *dep = node->data;
+
+		if ((dep->flags & PKGCONF_PKG_DEPF_QUERY) != PKGCONF_PKG_DEPF_QUERY)
+			continue;
+
+		if (!dep->match)
+			continue;
+
+		if (!sbom_append_spdx_identity(out, "-", dep->match))
+			return sbom_writer_out_of_memory(writer);
 	}
-	else
+
+	if (!sbom_append(out,
+			"\n",
+			"DocumentNamespace: https://spdx.org/spdxdocs/bomtool\n",
+			"Creator: Tool: bomtool\n", NULL))
+		return sbom_writer_out_of_memory(writer);
+
+	if (creation_time == NULL)
 	{
 		const char *source_date_epoch = getenv("SOURCE_DATE_EPOCH");
 
@@ -167,190 +266,262 @@ write_sbom_header(pkgconf_client_t *client, pkgconf_pkg_t *world)
 
 		tm = gmtime(&t);
 		strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", tm);
-		OUTPUT_OR_RET_FALSE(client, sbom_out, "Created: %s\n", buf);
 	}
 
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "\n\n");
+	if (!sbom_append(out, "Created: ", creation_time != NULL ? creation_time : buf, "\n\n\n", NULL))
+		return sbom_writer_out_of_memory(writer);
 
 	return true;
 }
 
-static const char *
-sbom_identity(pkgconf_pkg_t *pkg)
-{
-	static char buf[PKGCONF_ITEM_SIZE];
-
-	snprintf(buf, sizeof buf, "%s@%s", pkg->id, pkg->version);
-
-	return buf;
-}
-
 static bool
-write_copyright_lines(pkgconf_client_t *client, const pkgconf_list_t *copyright_lines)
+write_copyright_lines(pkgconf_buffer_t *out, const pkgconf_list_t *copyright_lines)
 {
 	const pkgconf_node_t *node;
 
-	if (copyright_lines->head == NULL) {
-		OUTPUT_OR_RET_FALSE(client, sbom_out, "PackageCopyrightText: NOASSERTION\n");
-		return true;
-	}
+	if (copyright_lines->head == NULL)
+		return pkgconf_buffer_append(out, "PackageCopyrightText: NOASSERTION\n");
 
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "PackageCopyrightText: <text>");
+	if (!pkgconf_buffer_append(out, "PackageCopyrightText: <text>"))
+		return false;
 
 	PKGCONF_FOREACH_LIST_ENTRY(copyright_lines->head, node)
 	{
 		const pkgconf_bufferset_t *set = node->data;
-		OUTPUT_OR_RET_FALSE(client, sbom_out, "%s%s", pkgconf_buffer_str_or_empty(&set->buffer), node->prev != NULL ? "\n" : "");
-	}
 
-	OUTPUT_OR_RET_FALSE(client, sbom_out, "</text>\n");
+		if (!sbom_append(out, pkgconf_buffer_str_or_empty(&set->buffer), node->prev != NULL ? "\n" : "", NULL))
+			return false;
+	}
 
-	return true;
+	return pkgconf_buffer_append(out, "</text>\n");
 }
 
-static void
-write_sbom_package(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *unused, unsigned int iter_flags)
+static bool
+write_sbom_package(sbom_writer_t *writer, pkgconf_pkg_t *pkg)
 {
-	(void) iter_flags;
-
-	pkgconf_buffer_t license_buf = PKGCONF_BUFFER_INITIALIZER;
-	(void) client;
-	(void) unused;
+	pkgconf_buffer_t *out = &writer->out;
 
-	if (pkg->flags & PKGCONF_PKG_PROPF_VIRTUAL)
-		return;
-
-	OUTPUT_OR_RET(client, sbom_out, "##### Package: %s\n\n", sbom_identity(pkg));
-	OUTPUT_OR_RET(client, sbom_out, "PackageName: %s\n", sbom_identity(pkg));
-	OUTPUT_OR_RET(client, sbom_out, "SPDXID: SPDXRef-Package-%s\n", sbom_spdx_identity(pkg));
-	OUTPUT_OR_RET(client, sbom_out, "PackageVersion: %s\n", pkg->version);
-	OUTPUT_OR_RET(client, sbom_out, "PackageDownloadLocation: NOASSERTION\n");
+	if (!sbom_append(out,
+			"##### Package: ", pkg->id, "@", pkg->version, "\n\n",
+			"PackageName: ", pkg->id, "@", pkg->version, "\n", NULL) ||
+		!sbom_append_spdx_identity(out, "SPDXID: " SBOM_SPDX_REF_PREFIX, pkg) ||
+		!sbom_append(out,
+			"\nPackageVersion: ", pkg->version, "\n",
+			"PackageDownloadLocation: NOASSERTION\n", NULL))
+		return sbom_writer_out_of_memory(writer);
 
 	/* NOASSERTION is not a valid value for PackageVerificationCode. It
 	 * expect 40 lowercase hexadecimal digits.
 	 */
 #if 0
-	OUTPUT_OR_RET(client, sbom_out, "PackageVerificationCode: NOASSERTION\n");
+	if (!pkgconf_buffer_append(out, "PackageVerificationCode: NOASSERTION\n"))
+		return sbom_writer_out_of_memory(writer);
 #endif
 
 	/* XXX: What about projects? */
-	if (pkg->maintainer != NULL)
-		OUTPUT_OR_RET(client, sbom_out, "PackageSupplier: Person: %s\n", pkg->maintainer);
+	if (pkg->maintainer != NULL &&
+		!sbom_append(out, "PackageSupplier: Person: ", pkg->maintainer, "\n", NULL))
+		return sbom_writer_out_of_memory(writer);
+
+	if (pkg->url != NULL &&
+		!sbom_append(out, "PackageHomePage: ", pkg->url, "\n", NULL))
+		return sbom_writer_out_of_memory(writer);
 
-	if (pkg->url != NULL)
-		OUTPUT_OR_RET(client, sbom_out, "PackageHomePage: %s\n", pkg->url);
+	if (!pkgconf_buffer_append(out, "PackageLicenseDeclared: "))
+		return sbom_writer_out_of_memory(writer);
 
 	if (pkg->license.head != NULL)
 	{
-		if (!pkgconf_license_render(client, &pkg->license, &license_buf))
-		{
-			pkgconf_buffer_finalize(&license_buf);
-			pkgconf_error(client, "bomtool: could not render package license");
-			return;
-		}
-
-		bool ret = pkgconf_output_file_fmt(sbom_out, "PackageLicenseDeclared: %s\n", pkgconf_buffer_str_or_empty(&license_buf));
-		int errno_save = errno;
-		pkgconf_buffer_finalize(&license_buf);
-		if (!ret)
+		if (!pkgconf_license_render(writer->client, &pkg->license, out))
 		{
-			pkgconf_error(client, "bomtool: could not output to file: %s", strerror(errno_save));
-			return;
+			pkgconf_error(writer->client, "bomtool: could not render package license");
+			writer->failed = true;
+			return false;
 		}
 	}
-	else
-		OUTPUT_OR_RET(client, sbom_out, "PackageLicenseDeclared: NOASSERTION\n");
-	OUTPUT_OR_RET(client, sbom_out, "PackageLicenseConcluded: NOASSERTION\n");
+	else if (!pkgconf_buffer_append(out, "NOASSERTION"))
+		return sbom_writer_out_of_memory(writer);
 
-	if (!write_copyright_lines(client, &pkg->copyright))
-		return;
+	if (!pkgconf_buffer_append(out, "\nPackageLicenseConcluded: NOASSERTION\n") ||
+		!write_copyright_lines(out, &pkg->copyright))
+		return sbom_writer_out_of_memory(writer);
 
-	if (pkg->description != NULL)
-		OUTPUT_OR_RET(client, sbom_out, "PackageSummary: <text>%s</text>\n", pkg->description);
+	if (pkg->description != NULL &&
+		!sbom_append(out, "PackageSummary: <text>", pkg->description, "</text>\n", NULL))
+		return sbom_writer_out_of_memory(writer);
 
-	if (pkg->source != NULL)
-		OUTPUT_OR_RET(client, sbom_out, "PackageDownloadLocation: %s\n", pkg->source);
-	else
-		OUTPUT_OR_RET(client, sbom_out, "PackageDownloadLocation: NOASSERTION\n");
+	if (!sbom_append(out, "PackageDownloadLocation: ", pkg->source != NULL ? pkg->source : "NOASSERTION", "\n\n\n", NULL))
+		return sbom_writer_out_of_memory(writer);
 
-	OUTPUT_OR_RET(client, sbom_out, "\n\n");
+	return sbom_writer_record_done(writer);
 }
 
-static void
-write_sbom_relationships(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *unused, unsigned int iter_flags)
+/* Each dependency gets a pair of relationships, which are written in one go. */
+static bool
+write_sbom_dependency_relationships(pkgconf_buffer_t *out, pkgconf_pkg_t *pkg, size_t pkg_len, const pkgconf_list_t *deps, const char *kind)
 {
-	(void) iter_flags;
-
-	(void) client;
-	(void) unused;
-
-	char baseref[PKGCONF_ITEM_SIZE];
+	static const char relationship[] = "Relationship: " SBOM_SPDX_REF_PREFIX;
+	static const char depends_on[] = " DEPENDS_ON " SBOM_SPDX_REF_PREFIX;
+	size_t kind_len = strlen(kind);
 	pkgconf_node_t *node;
 
-	if (pkg->flags & PKGCONF_PKG_PROPF_VIRTUAL)
-		return;
-
-	snprintf(baseref, sizeof baseref, "SPDXRef-Package-%s", sbom_spdx_identity(pkg));
-
-	PKGCONF_FOREACH_LIST_ENTRY(pkg->required.head, node)
+	PKGCONF_FOREACH_LIST_ENTRY(deps->head, node)
 	{
 		pkgconf_dependency_t *dep = node->data;
 		pkgconf_pkg_t *match = dep->match;
+		size_t match_len;
+		char *p;
 
 		if (!dep->match)
 			continue;
 
-		OUTPUT_OR_RET(client, sbom_out, "Relationship: %s DEPENDS_ON SPDXRef-Package-%s\n", baseref, sbom_spdx_identity(match));
-		OUTPUT_OR_RET(client, sbom_out, "Relationship: SPDXRef-Package-%s DEPENDENCY_OF %s\n", sbom_spdx_identity(match), baseref);
+		match_len = sbom_spdx_identity_len(match);
+
+		/* Relationship: <pkg> DEPENDS_ON <match>\nRelationship: <match> <kind> <pkg>\n */
+		p = pkgconf_buffer_extend(out, 2 * (sizeof(relationship) - 1) + sizeof(depends_on) - 1 +
+			2 * pkg_len + 2 * match_len + kind_len + strlen(SBOM_SPDX_REF_PREFIX) + 4);
+		if (p == NULL)
+			return false;
+
+		p = sbom_put(p, relationship, sizeof(relationship) - 1);
+		p = sbom_put_spdx_identity(p, pkg);
+		p = sbom_put(p, depends_on, sizeof(depends_on) - 1);
+		p = sbom_put_spdx_identity(p, match);
+		*p++ = '\n';
+
+		p = sbom_put(p, relationship, sizeof(relationship) - 1);
+		p = sbom_put_spdx_identity(p, match);
+		*p++ = ' ';
+		p = sbom_put(p, kind, kind_len);
+		*p++ = ' ';
+		p = sbom_put(p, SBOM_SPDX_REF_PREFIX, strlen(SBOM_SPDX_REF_PREFIX));
+		p = sbom_put_spdx_identity(p, pkg);
+		*p++ = '\n';
 	}
 
-	PKGCONF_FOREACH_LIST_ENTRY(pkg->requires_private.head, node)
+	return true;
+}
+
+static bool
+write_sbom_relationships(sbom_writer_t *writer, pkgconf_pkg_t *pkg)
+{
+	pkgconf_buffer_t *out = &writer->out;
+	size_t pkg_len = sbom_spdx_identity_len(pkg);
+
+	if (!write_sbom_dependency_relationships(out, pkg, pkg_len, &pkg->required, "DEPENDENCY_OF") ||
+		!write_sbom_dependency_relationships(out, pkg, pkg_len, &pkg->requires_private, "DEV_DEPENDENCY_OF"))
+		return sbom_writer_out_of_memory(writer);
+
+	if ((pkg->required.head != NULL || pkg->requires_private.head != NULL) &&
+		!pkgconf_buffer_append(out, "\n\n"))
+		return sbom_writer_out_of_memory(writer);
+
+	return sbom_writer_record_done(writer);
+}
+
+/*
+ * The package records are written as the packages are visited.  Their
+ * relationships go after all of the package records, and the walk may only
+ * resolve a package's dependencies after visiting it, so the packages are
+ * kept until then.
+ */
+static void
+write_sbom_entry(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
+{
+	sbom_writer_t *writer = data;
+
+	(void) iter_flags;
+
+	if (writer->failed)
+		return;
+
+	if (pkg->flags & PKGCONF_PKG_PROPF_VIRTUAL)
+		return;
+
+	if (writer->package_count == writer->package_alloc)
 	{
-		pkgconf_dependency_t *dep = node->data;
-		pkgconf_pkg_t *match = dep->match;
+		size_t alloc = writer->package_alloc ? writer->package_alloc * 2 : 64;
+		pkgconf_pkg_t **packages = pkgconf_reallocarray(writer->packages, alloc, sizeof(*packages));
 
-		if (!dep->match)
-			continue;
+		if (packages == NULL)
+		{
+			sbom_writer_out_of_memory(writer);
+			return;
+		}
 
-		OUTPUT_OR_RET(client, sbom_out, "Relationship: %s DEPENDS_ON SPDXRef-Package-%s\n", baseref, sbom_spdx_identity(match));
-		OUTPUT_OR_RET(client, sbom_out, "Relationship: SPDXRef-Package-%s DEV_DEPENDENCY_OF %s\n", sbom_spdx_identity(match), baseref);
+		writer->packages = packages;
+		writer->package_alloc = alloc;
 	}
 
-	if (pkg->required.head != NULL || pkg->requires_private.head != NULL)
-		OUTPUT_OR_RET(client, sbom_out, "\n\n");
+	if (!write_sbom_package(writer, pkg))
+		return;
+
+	writer->packages[writer->package_count++] = pkgconf_pkg_ref(client, pkg);
 }
 
 static bool
-generate_sbom_from_world(pkgconf_client_t *client, pkgconf_pkg_t *world)
+write_sbom(sbom_writer_t *writer, pkgconf_pkg_t *world)
 {
-	int eflag;
 	pkgconf_node_t *node;
 
-	if (!write_sbom_header(client, world))
+	if (!write_sbom_header(writer, world))
 		return false;
 
-	eflag = pkgconf_pkg_traverse(client, world, write_sbom_package, NULL, maximum_traverse_depth, 0);
-	if (eflag != PKGCONF_PKG_ERRF_OK)
+	if (pkgconf_pkg_traverse(writer->client, world, write_sbom_entry, writer, maximum_traverse_depth, 0) != PKGCONF_PKG_ERRF_OK)
 		return false;
 
-	eflag = pkgconf_pkg_traverse(client, world, write_sbom_relationships, NULL, maximum_traverse_depth, 0);
-	if (eflag != PKGCONF_PKG_ERRF_OK)
+	if (writer->failed)
 		return false;
 
+	for (size_t i = 0; i < writer->package_count; i++)
+	{
+		if (!write_sbom_relationships(writer, writer->packages[i]))
+			return false;
+	}
+
 	PKGCONF_FOREACH_LIST_ENTRY(world->required.head, node)
 	{
 		pkgconf_dependency_t *dep = node->data;
-		pkgconf_pkg_t *match = dep->match;
 
 		if (!dep->match)
 			continue;
 
-		OUTPUT_OR_RET_FALSE(client, sbom_out, "Relationship: %s DESCRIBES SPDXRef-Package-%s\n", document_ref, sbom_spdx_identity(match));
+		if (!sbom_append(&writer->out, "Relationship: ", document_ref, " DESCRIBES ", NULL) ||
+			!sbom_append_spdx_identity(&writer->out, SBOM_SPDX_REF_PREFIX, dep->match) ||
+			!pkgconf_buffer_push_byte(&writer->out, '\n'))
+			return sbom_writer_out_of_memory(writer);
+	}
+
+	if (!sbom_writer_flush(writer))
+		return false;
+
+	if (fflush(sbom_out) != 0)
+	{
+		pkgconf_error(writer->client, "bomtool: Could not output to file: %s", strerror(errno));
+		return false;
 	}
 
 	return true;
 }
 
+static bool
+generate_sbom_from_world(pkgconf_client_t *client, pkgconf_pkg_t *world)
+{
+	sbom_writer_t writer = {
+		.client = client,
+		.out = PKGCONF_BUFFER_INITIALIZER,
+	};
+	bool ret = write_sbom(&writer, world);
+
+	for (size_t i = 0; i < writer.package_count; i++)
+		pkgconf_pkg_unref(client, writer.packages[i]);
+
+	free(writer.packages);
+	pkgconf_buffer_finalize(&writer.out);
+
+	return ret;
+}
+
 static int
 version(void)
 {
@@ -450,6 +621,9 @@ main(int argc, char *argv[])
 	};
 	pkgconf_client_init_with_options(&pkg_client, &client_options);
 
+	/* the document is written by traversing the solved graph, so freeze it */
+	want_client_flags |= PKGCONF_PKG_PKGF_FREEZE_GRAPH;
+
 	/* we have determined what features we want most likely.  in some cases, we override later. */
 	pkgconf_client_set_flags(&pkg_client, want_client_flags);
 
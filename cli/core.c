@@ -570,52 +570,34 @@ apply_env(pkgconf_client_t *client, pkgconf_pkg_t *world, const void *env_prefix
 }
 
 static bool
-apply_cflags(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_list_t *target_list, int maxdepth)
+apply_cflags_libs(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_list_t *target_list, int maxdepth, bool want_cflags, bool want_libs, unsigned int collect_flags)
 {
-	pkgconf_list_t unfiltered_list = PKGCONF_LIST_INITIALIZER;
-	pkgconf_list_t filtered_list = PKGCONF_LIST_INITIALIZER;
-	int eflag;
-
-	eflag = pkgconf_pkg_cflags(client, world, &unfiltered_list, maxdepth);
-	if (eflag != PKGCONF_PKG_ERRF_OK)
-		return false;
-
-	pkgconf_fragment_filter_splice(client, &filtered_list, &unfiltered_list, filter_cflags, NULL);
-	maybe_add_module_definitions(client, world, &filtered_list);
-
-	if (filtered_list.head == NULL)
-		goto out;
-
-	pkgconf_list_splice(target_list, &filtered_list);
-
-out:
-	pkgconf_fragment_free(&unfiltered_list);
-	pkgconf_fragment_free(&filtered_list);
-
-	return true;
-}
-
-static bool
-apply_libs(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_list_t *target_list, int maxdepth)
-{
-	pkgconf_list_t unfiltered_list = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t unfiltered_cflags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t unfiltered_libs = PKGCONF_LIST_INITIALIZER;
 	pkgconf_list_t filtered_list = PKGCONF_LIST_INITIALIZER;
 	int eflag;
 
-	eflag = pkgconf_pkg_libs(client, world, &unfiltered_list, maxdepth);
+	/* collect both fragment lists with a single walk of the graph */
+	eflag = pkgconf_pkg_collect(client, world,
+		want_cflags ? &unfiltered_cflags : NULL,
+		want_libs ? &unfiltered_libs : NULL,
+		NULL, maxdepth, collect_flags);
 	if (eflag != PKGCONF_PKG_ERRF_OK)
 		return false;
 
-	pkgconf_fragment_filter_splice(client, &filtered_list, &unfiltered_list, filter_libs, NULL);
+	if (want_cflags)
+	{
+		pkgconf_fragment_filter_splice(client, &filtered_list, &unfiltered_cflags, filter_cflags, NULL);
+		maybe_add_module_definitions(client, world, &filtered_list);
+	}
 
-	if (filtered_list.head == NULL)
-		goto out;
+	if (want_libs)
+		pkgconf_fragment_filter_splice(client, &filtered_list, &unfiltered_libs, filter_libs, NULL);
 
 	pkgconf_list_splice(target_list, &filtered_list);
 
-out:
-	pkgconf_fragment_free(&unfiltered_list);
-	pkgconf_fragment_free(&filtered_list);
+	pkgconf_fragment_free(&unfiltered_cflags);
+	pkgconf_fragment_free(&unfiltered_libs);
 
 	return true;
 }
@@ -1066,6 +1048,12 @@ pkgconf_cli_run(pkgconf_cli_state_t *state, int argc, char *argv[], int last_arg
 		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
 	};
 
+	if (pkgconf_client_getenv(&state->pkg_client, "PKG_CONFIG_STATS") != NULL)
+		state->want_flags |= PKG_STATS;
+
+	if ((state->want_flags & PKG_STATS) == PKG_STATS)
+		pkgconf_stats_set_timing(&state->pkg_client, true);
+
 #ifndef PKGCONF_LITE
 	if ((state->want_flags & PKG_DUMP_PERSONALITY) == PKG_DUMP_PERSONALITY)
 	{
@@ -1161,6 +1149,18 @@ pkgconf_cli_run(pkgconf_cli_state_t *state, int argc, char *argv[], int last_arg
 	if (querying_flattened_metadata)
 		state->maximum_traverse_depth = 1;
 
+	/* a bare --exists produces no output, so it does not need a flattened world.
+	 * unless the errors are printed, it can also stop at the first unsatisfiable
+	 * dependency.
+	 */
+	const bool existence_only =
+		(state->want_flags & PKG_EXISTS) == PKG_EXISTS &&
+		!querying_flattened_metadata &&
+		(state->want_flags & (PKG_CFLAGS|PKG_LIBS|PKG_DIGRAPH|PKG_SOLUTION|PKG_SIMULATE|PKG_VALIDATE|
+			PKG_UNINSTALLED|PKG_DUMP_LICENSE|PKG_DUMP_LICENSE_FILE|PKG_DUMP_SOURCE|PKG_FRAGMENT_TREE|
+			PKG_LINK_ABI|PKG_EXISTS_CFLAGS)) == 0 &&
+		state->want_env_prefix == NULL;
+
 	/* metadata queries only report properties of the modules the user asked about, they
 	 * never combine those modules into a build, so 'Conflicts' rules between them are not
 	 * relevant.  see <https://github.com/pkgconf/pkgconf/issues/580>.
@@ -1204,6 +1204,9 @@ pkgconf_cli_run(pkgconf_cli_state_t *state, int argc, char *argv[], int last_arg
 		}
 	}
 
+	/* the solved graph is walked once for every requested output, so freeze it */
+	want_client_flags |= PKGCONF_PKG_PKGF_FREEZE_GRAPH;
+
 	/* we have determined what features we want most likely.  in some cases, we override later. */
 	pkgconf_client_set_flags(&state->pkg_client, want_client_flags);
 
@@ -1325,6 +1328,18 @@ pkgconf_cli_run(pkgconf_cli_state_t *state, int argc, char *argv[], int last_arg
 
 	ret = EXIT_SUCCESS;
 
+	if (existence_only)
+	{
+		if ((state->want_flags & PKG_SILENCE_ERRORS) == PKG_SILENCE_ERRORS &&
+			(state->want_flags & (PKG_PRINT_ERRORS|PKG_ERRORS_ON_STDOUT)) == 0)
+			pkgconf_client_set_flags(&state->pkg_client, want_client_flags | PKGCONF_PKG_PKGF_SKIP_ERRORS);
+
+		if (!pkgconf_queue_exists(&state->pkg_client, &pkgq, state->maximum_traverse_depth))
+			ret = EXIT_FAILURE;
+
+		goto out;
+	}
+
 	if (!pkgconf_queue_solve(&state->pkg_client, &pkgq, &world, state->maximum_traverse_depth))
 	{
 		ret = EXIT_FAILURE;
@@ -1462,14 +1477,12 @@ pkgconf_cli_run(pkgconf_cli_state_t *state, int argc, char *argv[], int last_arg
 		pkgconf_list_t target_list = PKGCONF_LIST_INITIALIZER;
 		pkgconf_buffer_t render_buf = PKGCONF_BUFFER_INITIALIZER;
 
-		if ((state->want_flags & PKG_CFLAGS))
-			apply_cflags(&state->pkg_client, &world, &target_list, 2);
-
-		if ((state->want_flags & PKG_LIBS) && !(state->want_flags & PKG_STATIC))
-			pkgconf_client_set_flags(&state->pkg_client, state->pkg_client.flags & ~PKGCONF_PKG_PKGF_SEARCH_PRIVATE);
+		/* private dependencies are only linked when statically linking */
+		apply_cflags_libs(&state->pkg_client, &world, &target_list, 2,
+			(state->want_flags & PKG_CFLAGS) != 0, (state->want_flags & PKG_LIBS) != 0,
+			(state->want_flags & PKG_STATIC) ? PKGCONF_PKG_COLLECTF_NONE : PKGCONF_PKG_COLLECTF_LINK_SHARED);
 
-		if ((state->want_flags & PKG_LIBS))
-			apply_libs(&state->pkg_client, &world, &target_list, 2);
+		pkgconf_phase_t phase = pkgconf_phase_begin(&state->pkg_client, PKGCONF_STATS_PHASE_RENDER, "render", NULL, NULL, NULL);
 
 		if (!pkgconf_fragment_render_buf(&target_list, &render_buf, true, state->want_render_ops,
 			(state->want_flags & PKG_NEWLINES) ? '\n' : ' ') ||
@@ -1477,12 +1490,24 @@ pkgconf_cli_run(pkgconf_cli_state_t *state, int argc, char *argv[], int last_arg
 			ret = EXIT_FAILURE;
 		pkgconf_buffer_finalize(&render_buf);
 
+		pkgconf_phase_end(&state->pkg_client, &phase, NULL);
+
 		pkgconf_fragment_free(&target_list);
 	}
 
 out:
 	pkgconf_solution_free(&state->pkg_client, &world);
 	pkgconf_queue_free(&pkgq);
+
+	if ((state->want_flags & PKG_STATS) == PKG_STATS)
+	{
+		pkgconf_buffer_t statsbuf = PKGCONF_BUFFER_INITIALIZER;
+
+		if (pkgconf_stats_render(&state->pkg_client, &statsbuf))
+			pkgconf_output_putbuf(state->pkg_client.output, PKGCONF_OUTPUT_STDERR, &statsbuf, true);
+		pkgconf_buffer_finalize(&statsbuf);
+	}
+
 	pkgconf_cli_state_reset(state);
 
 	return ret;
@@ -1491,11 +1516,22 @@ out:
 void
 pkgconf_cli_state_reset(pkgconf_cli_state_t *state)
 {
+#ifndef PKGCONF_LITE
+	/* terminates the trace event array, so must happen while the client is still live */
+	if (state->trace_events_out != NULL)
+		pkgconf_client_set_trace_events(&state->pkg_client, NULL);
+#endif
+
+	if (state->stats_out != NULL)
+		*state->stats_out = state->pkg_client.stats;
+
 	pkgconf_cross_personality_deinit((void *) state->pkg_client.personality);
 	pkgconf_client_deinit(&state->pkg_client);
 
 	if (state->logfile_out != NULL)
 		fclose(state->logfile_out);
+	if (state->trace_events_out != NULL)
+		fclose(state->trace_events_out);
 	if (state->opened_error_msgout)
 		fclose(state->error_msgout);
 }
@@ -71,6 +71,7 @@
 #define PKG_NEWLINES			(((uint64_t) 1) << 51)
 #define PKG_PRINT_DIGRAPH_QUERY_NODES	(((uint64_t) 1) << 52)
 #define PKG_LINK_ABI			(((uint64_t) 1) << 53)
+#define PKG_STATS			(((uint64_t) 1) << 54)
 
 typedef struct {
 	pkgconf_client_t pkg_client;
@@ -92,6 +93,10 @@ typedef struct {
 
 	FILE *error_msgout;
 	FILE *logfile_out;
+	FILE *trace_events_out;
+
+	/* if set, receives the client's statistics before the client is torn down */
+	pkgconf_stats_t *stats_out;
 
 	bool opened_error_msgout;
 } pkgconf_cli_state_t;
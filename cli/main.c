@@ -54,6 +54,10 @@ error_handler(const char *msg, const pkgconf_client_t *client, void *data)
 	if (state->error_msgout == NULL)
 		return true;
 
+	/* the default output leaves stdout buffered; keep errors behind what was printed before them */
+	if (state->error_msgout != stdout)
+		fflush(stdout);
+
 	pkgconf_output_file_fmt(state->error_msgout, "%s", msg);
 	return true;
 }
@@ -155,6 +159,8 @@ usage(void)
 	printf("  --list-package-names              list all known package names\n");
 #ifndef PKGCONF_LITE
 	printf("  --simulate                        simulate walking the calculated dependency graph\n");
+	printf("  --trace-events=filename           write the phases of the query to a specified file\n");
+	printf("                                    in Chrome trace event format\n");
 #endif
 	printf("  --no-cache                        do not cache already seen packages when\n");
 	printf("                                    walking the dependency graph\n");
@@ -166,6 +172,8 @@ usage(void)
 	printf("  --prefix-variable=varname         sets the name of the variable that pkgconf considers\n");
 	printf("                                    to be the package prefix\n");
 	printf("  --dont-relocate-paths             disables path relocation support\n");
+	printf("  --stats                           print performance counters and phase timings\n");
+	printf("                                    as JSON to stderr\n");
 
 #ifndef PKGCONF_LITE
 	printf("\ncross-compilation personality support:\n\n");
@@ -261,6 +269,9 @@ main(int argc, char *argv[])
 	pkgconf_list_t dir_list = PKGCONF_LIST_INITIALIZER;
 	char *env_traverse_depth;
 	char *logfile_arg = NULL;
+#ifndef PKGCONF_LITE
+	char *trace_events_arg = NULL;
+#endif
 	pkgconf_cross_personality_t *personality = NULL;
 
 	if (pkgconf_pledge("stdio rpath wpath cpath unveil", NULL) == -1)
@@ -354,8 +365,10 @@ main(int argc, char *argv[])
 		{ "fragment-tree", no_argument, &state.want_flags, PKG_FRAGMENT_TREE },
 		{ "source", no_argument, &state.want_flags, PKG_DUMP_SOURCE },
 		{ "newlines", no_argument, &state.want_flags, PKG_NEWLINES },
+		{ "stats", no_argument, &state.want_flags, PKG_STATS },
 #ifndef PKGCONF_LITE
 		{ "print-digraph-query-nodes", no_argument, &state.want_flags, PKG_PRINT_DIGRAPH_QUERY_NODES },
+		{ "trace-events", required_argument, NULL, 56 },
 #endif
 		{ NULL, 0, NULL, 0 }
 	};
@@ -421,6 +434,11 @@ main(int argc, char *argv[])
 		case 55:
 			state.verbosity++;
 			break;
+#ifndef PKGCONF_LITE
+		case 56:
+			trace_events_arg = pkg_optarg;
+			break;
+#endif
 		case '?':
 		case ':':
 			ret = EXIT_FAILURE;
@@ -523,6 +541,26 @@ main(int argc, char *argv[])
 		pkgconf_audit_set_log(&state.pkg_client, state.logfile_out);
 	}
 
+#ifndef PKGCONF_LITE
+	if (trace_events_arg != NULL)
+	{
+		if (pkgconf_unveil(trace_events_arg, "rwc") == -1)
+		{
+			pkgconf_output_file_fmt(stderr, "pkgconf: unveil failed: %s\n", strerror(errno));
+			return EXIT_FAILURE;
+		}
+
+		state.trace_events_out = fopen(trace_events_arg, "w");
+		if (state.trace_events_out == NULL)
+		{
+			pkgconf_output_file_fmt(stderr, "pkgconf: unable to open %s: %s\n", trace_events_arg, strerror(errno));
+			return EXIT_FAILURE;
+		}
+
+		pkgconf_client_set_trace_events(&state.pkg_client, state.trace_events_out);
+	}
+#endif
+
 	if (getenv("PKG_CONFIG_ALLOW_SYSTEM_CFLAGS") != NULL)
 		state.want_flags |= PKG_KEEP_SYSTEM_CFLAGS;
 
@@ -96,8 +96,85 @@ fail:
 	return false;
 }
 
+/* the ".lib" suffix never needs quoting, so only the data decides */
+static size_t
+msvc_renderer_size(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag)
+{
+	size_t size;
+
+	(void) ctx;
+
+	if (!allowed_fragment(frag))
+		return 0;
+
+	size = strlen(frag->data);
+
+	switch(frag->type) {
+	case 'D':
+	case 'I':
+		size += 2;
+		break;
+	case 'L':
+		size += sizeof("/libpath:") - 1;
+		break;
+	case 'l':
+		size += sizeof(".lib") - 1;
+		break;
+	}
+
+	if (should_quote(PKGCONF_BUFFER_FROM_STR(frag->data)))
+		size += 2;
+
+	return size;
+}
+
+static char *
+msvc_renderer_fill(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag, char *out)
+{
+	size_t len;
+	bool quote;
+
+	(void) ctx;
+
+	if (!allowed_fragment(frag))
+		return out;
+
+	switch(frag->type) {
+	case 'D':
+	case 'I':
+		*out++ = '/';
+		*out++ = frag->type;
+		break;
+	case 'L':
+		memcpy(out, "/libpath:", sizeof("/libpath:") - 1);
+		out += sizeof("/libpath:") - 1;
+		break;
+	}
+
+	quote = should_quote(PKGCONF_BUFFER_FROM_STR(frag->data));
+	if (quote)
+		*out++ = '"';
+
+	len = strlen(frag->data);
+	memcpy(out, frag->data, len);
+	out += len;
+
+	if (frag->type == 'l')
+	{
+		memcpy(out, ".lib", sizeof(".lib") - 1);
+		out += sizeof(".lib") - 1;
+	}
+
+	if (quote)
+		*out++ = '"';
+
+	return out;
+}
+
 static pkgconf_fragment_render_ops_t msvc_renderer_ops = {
-	.render = msvc_renderer_render
+	.render = msvc_renderer_render,
+	.size = msvc_renderer_size,
+	.fill = msvc_renderer_fill,
 };
 
 pkgconf_fragment_render_ops_t *
@@ -381,6 +381,20 @@ err:
 	return ret;
 }
 
+static const char *
+spdx_document_license_key(const void *entry)
+{
+	const spdxtool_simplelicensing_license_expression_t *expression = entry;
+	return expression->license_expression;
+}
+
+static const char *
+spdx_document_maintainer_key(const void *entry)
+{
+	const spdxtool_core_agent_t *maintainer = entry;
+	return maintainer->spdx_id;
+}
+
 /*
  * !doc
  *
@@ -406,6 +420,8 @@ spdxtool_core_spdx_document_new(pkgconf_client_t *client, const char *spdx_id, c
 		goto err;
 
 	spdx->type = "SpdxDocument";
+	spdx->license_index.key_of = spdx_document_license_key;
+	spdx->maintainer_index.key_of = spdx_document_maintainer_key;
 	spdx->spdx_id = strdup(spdx_id);
 	spdx->agent = strdup(agent_id);
 	spdx->creation_info = strdup(creation_id);
@@ -443,6 +459,9 @@ spdxtool_core_spdx_document_free(spdxtool_core_spdx_document_t *spdx)
 	free(spdx->creation_info);
 	free(spdx->agent);
 
+	spdxtool_util_index_free(&spdx->license_index);
+	spdxtool_util_index_free(&spdx->maintainer_index);
+
 	PKGCONF_FOREACH_LIST_ENTRY_SAFE(spdx->rootElement.head, iter_next, iter)
 	{
 		spdxtool_software_sbom_t *sbom = iter->data;
@@ -590,7 +609,8 @@ err:
  *
  * .. c:function:: bool spdxtool_core_spdx_document_is_license(pkgconf_client_t *client, spdxtool_core_spdx_document_t *spdx, const char *license)
  *
- *    Find out if specific license is already there.
+ *    Find out if specific license is already there.  The document keeps its
+ *    licenses in a hash index, so this does not depend on how many there are.
  *
  *    :param pkgconf_client_t *client: The pkgconf client being accessed.
  *    :param spdxtool_core_spdx_document_t *spdx: SpdxDocument struct being used.
@@ -600,9 +620,6 @@ err:
 bool
 spdxtool_core_spdx_document_is_license(pkgconf_client_t *client, const spdxtool_core_spdx_document_t *spdx, const char *license)
 {
-	pkgconf_node_t *iter = NULL;
-	spdxtool_simplelicensing_license_expression_t *expression = NULL;
-
 	(void) client;
 
 	if (!license || !spdx)
@@ -610,16 +627,7 @@ spdxtool_core_spdx_document_is_license(pkgconf_client_t *client, const spdxtool_
 		return false;
 	}
 
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->licenses.head, iter)
-	{
-		expression = iter->data;
-		if (!strcmp(expression->license_expression, license))
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return spdxtool_util_index_lookup(&spdx->license_index, license) != NULL;
 }
 
 /*
@@ -644,9 +652,10 @@ spdxtool_core_spdx_document_add_license(pkgconf_client_t *client, spdxtool_core_
 		return true;
 
 	pkgconf_node_t *node = calloc(1, sizeof(pkgconf_node_t));
-	if (!node)
+	if (!node || !spdxtool_util_index_reserve(&spdx->license_index))
 	{
 		pkgconf_error(client, "spdxtool_core_spdx_document_add_license: out of memory");
+		free(node);
 		return false;
 	}
 
@@ -664,6 +673,8 @@ spdxtool_core_spdx_document_add_license(pkgconf_client_t *client, spdxtool_core_
 		return false;
 	}
 
+	/* room was reserved above, so this cannot fail */
+	spdxtool_util_index_insert(&spdx->license_index, expression);
 	pkgconf_node_insert_tail(node, expression, &spdx->licenses);
 	return true;
 }
@@ -712,9 +723,9 @@ spdxtool_core_spdx_document_add_element(pkgconf_client_t *client, spdxtool_core_
  *
  *    Register a package maintainer as an Agent and add it to the SpdxDocument so that
  *    packages may reference it via their ``suppliedBy`` field.  Maintainers are
- *    deduplicated by their spdxId, so a maintainer shared between packages is only
- *    emitted once.  The first time a maintainer is seen, its spdxId is also added to
- *    the document element list.
+ *    deduplicated by their spdxId through a hash index, so a maintainer shared
+ *    between packages is only emitted once.  The first time a maintainer is seen,
+ *    its spdxId is also added to the document element list.
  *
  *    :param pkgconf_client_t *client: The pkgconf client being accessed.
  *    :param spdxtool_core_spdx_document_t *spdx: SpdxDocument struct being used.
@@ -724,8 +735,6 @@ spdxtool_core_spdx_document_add_element(pkgconf_client_t *client, spdxtool_core_
 const char *
 spdxtool_core_spdx_document_add_maintainer(pkgconf_client_t *client, spdxtool_core_spdx_document_t *spdx, const char *name)
 {
-	pkgconf_node_t *iter = NULL;
-
 	if (!client || !spdx || !name)
 		return NULL;
 
@@ -733,20 +742,18 @@ spdxtool_core_spdx_document_add_maintainer(pkgconf_client_t *client, spdxtool_co
 	if (!agent)
 		return NULL;
 
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->maintainers.head, iter)
+	spdxtool_core_agent_t *existing = spdxtool_util_index_lookup(&spdx->maintainer_index, agent->spdx_id);
+	if (existing)
 	{
-		spdxtool_core_agent_t *existing = iter->data;
-		if (!strcmp(existing->spdx_id, agent->spdx_id))
-		{
-			spdxtool_core_agent_free(agent);
-			return existing->spdx_id;
-		}
+		spdxtool_core_agent_free(agent);
+		return existing->spdx_id;
 	}
 
 	pkgconf_node_t *node = calloc(1, sizeof(pkgconf_node_t));
-	if (!node)
+	if (!node || !spdxtool_util_index_reserve(&spdx->maintainer_index))
 	{
 		pkgconf_error(client, "spdxtool_core_spdx_document_add_maintainer: out of memory");
+		free(node);
 		spdxtool_core_agent_free(agent);
 		return NULL;
 	}
@@ -758,6 +765,8 @@ spdxtool_core_spdx_document_add_maintainer(pkgconf_client_t *client, spdxtool_co
 		return NULL;
 	}
 
+	/* room was reserved above, so this cannot fail */
+	spdxtool_util_index_insert(&spdx->maintainer_index, agent);
 	pkgconf_node_insert_tail(node, agent, &spdx->maintainers);
 	return agent->spdx_id;
 }
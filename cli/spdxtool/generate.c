@@ -17,60 +17,42 @@
 #include "simplelicensing.h"
 #include "generate.h"
 
+/*
+ * The document is streamed out as packages are visited.  Every kind of element
+ * has its own section of the graph, so each section is written by a traversal
+ * of its own, which keeps the output in the same order as before while only
+ * the elements of one package are held in memory at a time.
+ */
+typedef enum {
+	GENERATE_SPDX_PASS_REGISTER,
+	GENERATE_SPDX_PASS_SBOM,
+	GENERATE_SPDX_PASS_PACKAGE,
+	GENERATE_SPDX_PASS_RELATIONSHIP,
+	GENERATE_SPDX_PASS_ROOT_ELEMENT,
+	GENERATE_SPDX_PASS_ELEMENT,
+	GENERATE_SPDX_PASS_PACKAGE_ELEMENT,
+} generate_spdx_pass_t;
+
 typedef struct {
 	spdxtool_core_spdx_document_t *document;
+	spdxtool_serialize_writer_t *writer;
+	generate_spdx_pass_t pass;
 	bool failed;
 } generate_spdx_ctx_t;
 
+/*
+ * Set the variables the serializers look up on the package, and register its
+ * maintainer and licenses, which are written out ahead of every package.
+ */
 static bool
-generate_spdx_document_add_sbom(pkgconf_client_t *client, spdxtool_core_spdx_document_t *document, spdxtool_software_sbom_t *sbom)
-{
-	pkgconf_node_t *node = calloc(1, sizeof(pkgconf_node_t));
-	if (!node)
-	{
-		pkgconf_error(client, "generate_spdx_document_add_sbom: out of memory");
-		return false;
-	}
-
-	pkgconf_node_insert_tail(node, sbom, &document->rootElement);
-	return true;
-}
-
-// NOTE: this function is passed to pkgconf_pkg_traverse
-static void
-generate_spdx_package(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *ptr, unsigned int iter_flags)
+generate_spdx_register_package(pkgconf_client_t *client, spdxtool_core_spdx_document_t *document, pkgconf_pkg_t *pkg)
 {
-	(void) iter_flags;
-
-	generate_spdx_ctx_t *ctx = ptr;
-	spdxtool_core_spdx_document_t *document = ctx->document;
 	pkgconf_node_t *iter = NULL;
-	spdxtool_software_sbom_t *sbom = NULL;
 	char *package_spdx = NULL;
-	char *spdx_id_string = NULL;
 	pkgconf_buffer_t spdx_id_buf = PKGCONF_BUFFER_INITIALIZER;
 	pkgconf_buffer_t concluded_buf = PKGCONF_BUFFER_INITIALIZER;
 	char sep = spdxtool_util_get_uri_separator(client);
 
-	if (pkg->flags & PKGCONF_PKG_PROPF_VIRTUAL)
-		return;
-
-	if (ctx->failed)
-		return;
-
-	spdx_id_string = spdxtool_util_get_spdx_id_string(client, "software_Sbom", pkg->id);
-	if (!spdx_id_string)
-		goto err;
-
-	sbom = spdxtool_software_sbom_new(client, spdx_id_string, document->creation_info, "build");
-	free(spdx_id_string);
-	spdx_id_string = NULL;
-	if (!sbom)
-		goto err;
-
-	sbom->spdx_document = document;
-	sbom->rootElement = pkg;
-
 	package_spdx = spdxtool_util_get_spdx_id_string(client, "Package", pkg->id);
 	if (!package_spdx)
 		goto err;
@@ -143,20 +125,225 @@ generate_spdx_package(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *ptr, u
 		}
 	}
 
-	if (!generate_spdx_document_add_sbom(client, document, sbom))
-		goto err;
-
-	sbom = NULL;
-	return;
+	return true;
 
 err:
-	ctx->failed = true;
-	pkgconf_error(client, "generate_spdx_package: failed for %s", pkg->id);
 	free(package_spdx);
-	free(spdx_id_string);
 	pkgconf_buffer_finalize(&spdx_id_buf);
 	pkgconf_buffer_finalize(&concluded_buf);
+	return false;
+}
+
+static bool
+generate_spdx_write_sbom(pkgconf_client_t *client, generate_spdx_ctx_t *ctx, pkgconf_pkg_t *pkg)
+{
+	char *spdx_id_string = spdxtool_util_get_spdx_id_string(client, "software_Sbom", pkg->id);
+	if (!spdx_id_string)
+		return false;
+
+	spdxtool_software_sbom_t *sbom = spdxtool_software_sbom_new(client, spdx_id_string, ctx->document->creation_info, "build");
+	free(spdx_id_string);
+	if (!sbom)
+		return false;
+
+	/* the Sbom is not part of the document, so serializing it registers nothing */
+	sbom->rootElement = pkg;
+
+	bool ret = spdxtool_serialize_writer_add_take(ctx->writer, NULL, spdxtool_software_sbom_to_object(client, sbom));
 	spdxtool_software_sbom_free(sbom);
+	return ret;
+}
+
+static bool
+generate_spdx_write_relationships(pkgconf_client_t *client, generate_spdx_ctx_t *ctx, pkgconf_pkg_t *pkg)
+{
+	pkgconf_list_t *relationships = &ctx->document->relationships;
+	pkgconf_node_t *iter = NULL, *iter_next = NULL;
+	bool ret = spdxtool_software_package_add_relationships(client, pkg, ctx->document);
+
+	PKGCONF_FOREACH_LIST_ENTRY_SAFE(relationships->head, iter_next, iter)
+	{
+		spdxtool_core_relationship_t *relationship = iter->data;
+
+		if (ret)
+			ret = spdxtool_serialize_writer_add_take(ctx->writer, NULL, spdxtool_core_relationship_to_object(client, relationship));
+
+		pkgconf_node_delete(iter, relationships);
+		spdxtool_core_relationship_free(relationship);
+		free(iter);
+	}
+
+	return ret;
+}
+
+static bool
+generate_spdx_write_sbom_id(pkgconf_client_t *client, generate_spdx_ctx_t *ctx, pkgconf_pkg_t *pkg)
+{
+	char *spdx_id_string = spdxtool_util_get_spdx_id_string(client, "software_Sbom", pkg->id);
+	if (!spdx_id_string)
+		return false;
+
+	bool ret = spdxtool_serialize_writer_add_string(ctx->writer, NULL, spdx_id_string);
+	free(spdx_id_string);
+	return ret;
+}
+
+static bool
+generate_spdx_write_elements(pkgconf_client_t *client, generate_spdx_ctx_t *ctx, pkgconf_pkg_t *pkg)
+{
+	pkgconf_node_t *iter = NULL;
+	spdxtool_serialize_array_t *elements = spdxtool_software_sbom_elements(client, pkg);
+	if (!elements)
+		return false;
+
+	PKGCONF_FOREACH_LIST_ENTRY(elements->items.head, iter)
+	{
+		if (!spdxtool_serialize_writer_add_value(ctx->writer, NULL, iter->data))
+		{
+			spdxtool_serialize_array_free(elements);
+			return false;
+		}
+	}
+
+	spdxtool_serialize_array_free(elements);
+	return true;
+}
+
+static bool
+generate_spdx_write_package_elements(pkgconf_client_t *client, generate_spdx_ctx_t *ctx, pkgconf_pkg_t *pkg)
+{
+	if (!generate_spdx_write_sbom_id(client, ctx, pkg))
+		return false;
+
+	char *pkg_spdx_id = spdxtool_util_tuple_lookup(client, &pkg->vars, "spdxId");
+	if (!pkg_spdx_id)
+		return false;
+
+	bool ret = spdxtool_serialize_writer_add_string(ctx->writer, NULL, pkg_spdx_id);
+	free(pkg_spdx_id);
+	return ret;
+}
+
+// NOTE: this function is passed to pkgconf_pkg_traverse
+static void
+generate_spdx_package(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *ptr, unsigned int iter_flags)
+{
+	(void) iter_flags;
+
+	generate_spdx_ctx_t *ctx = ptr;
+	bool ok = false;
+
+	if (pkg->flags & PKGCONF_PKG_PROPF_VIRTUAL)
+		return;
+
+	if (ctx->failed)
+		return;
+
+	switch (ctx->pass)
+	{
+	case GENERATE_SPDX_PASS_REGISTER:
+		ok = generate_spdx_register_package(client, ctx->document, pkg);
+		break;
+	case GENERATE_SPDX_PASS_SBOM:
+		ok = generate_spdx_write_sbom(client, ctx, pkg);
+		break;
+	case GENERATE_SPDX_PASS_PACKAGE:
+		ok = spdxtool_serialize_writer_add_take(ctx->writer, NULL, spdxtool_software_package_to_object(client, pkg, NULL));
+		break;
+	case GENERATE_SPDX_PASS_RELATIONSHIP:
+		ok = generate_spdx_write_relationships(client, ctx, pkg);
+		break;
+	case GENERATE_SPDX_PASS_ROOT_ELEMENT:
+		ok = generate_spdx_write_sbom_id(client, ctx, pkg);
+		break;
+	case GENERATE_SPDX_PASS_ELEMENT:
+		ok = generate_spdx_write_elements(client, ctx, pkg);
+		break;
+	case GENERATE_SPDX_PASS_PACKAGE_ELEMENT:
+		ok = generate_spdx_write_package_elements(client, ctx, pkg);
+		break;
+	}
+
+	if (!ok)
+	{
+		ctx->failed = true;
+		pkgconf_error(client, "generate_spdx_package: failed for %s", pkg->id);
+	}
+}
+
+static bool
+generate_spdx_run_pass(pkgconf_client_t *client, pkgconf_pkg_t *world, int maxdepth, generate_spdx_ctx_t *ctx, generate_spdx_pass_t pass)
+{
+	ctx->pass = pass;
+
+	int eflag = pkgconf_pkg_traverse(client, world, generate_spdx_package, ctx, maxdepth, 0);
+	return eflag == PKGCONF_PKG_ERRF_OK && !ctx->failed;
+}
+
+/*
+ * Write the graph in the order spdxtool has always used: the agent, tool and
+ * creation info, the maintainers, the licenses, then the Sbom, Package and
+ * Relationship elements of every package, and the SpdxDocument last.
+ */
+static bool
+generate_spdx_write_graph(pkgconf_client_t *client, pkgconf_pkg_t *world, int maxdepth, generate_spdx_ctx_t *ctx,
+	spdxtool_core_agent_t *agent, spdxtool_core_tool_t *tool, spdxtool_core_creation_info_t *creation)
+{
+	spdxtool_serialize_writer_t *writer = ctx->writer;
+	spdxtool_core_spdx_document_t *document = ctx->document;
+	pkgconf_node_t *iter = NULL;
+
+	if (!spdxtool_serialize_writer_begin_object(writer, NULL) ||
+		!spdxtool_serialize_writer_add_string(writer, "@context", "https://spdx.org/rdf/3.0.1/spdx-context.jsonld") ||
+		!spdxtool_serialize_writer_begin_array(writer, "@graph"))
+		return false;
+
+	if (!spdxtool_serialize_writer_add_take(writer, NULL, spdxtool_core_agent_to_object(client, agent)) ||
+		!spdxtool_serialize_writer_add_take(writer, NULL, spdxtool_core_tool_to_object(client, tool)) ||
+		!spdxtool_serialize_writer_add_take(writer, NULL, spdxtool_core_creation_info_to_object(client, creation)))
+		return false;
+
+	PKGCONF_FOREACH_LIST_ENTRY(document->maintainers.head, iter)
+	{
+		if (!spdxtool_serialize_writer_add_take(writer, NULL, spdxtool_core_agent_to_object(client, iter->data)))
+			return false;
+	}
+
+	PKGCONF_FOREACH_LIST_ENTRY(document->licenses.head, iter)
+	{
+		if (!spdxtool_serialize_writer_add_take(writer, NULL, spdxtool_simplelicensing_licenseExpression_to_object(client, document->creation_info, iter->data)))
+			return false;
+	}
+
+	if (!generate_spdx_run_pass(client, world, maxdepth, ctx, GENERATE_SPDX_PASS_SBOM) ||
+		!generate_spdx_run_pass(client, world, maxdepth, ctx, GENERATE_SPDX_PASS_PACKAGE) ||
+		!generate_spdx_run_pass(client, world, maxdepth, ctx, GENERATE_SPDX_PASS_RELATIONSHIP))
+		return false;
+
+	if (!spdxtool_serialize_writer_begin_object(writer, NULL) ||
+		!spdxtool_serialize_writer_add_string(writer, "type", document->type) ||
+		!spdxtool_serialize_writer_add_string(writer, "creationInfo", document->creation_info) ||
+		!spdxtool_serialize_writer_add_string(writer, "spdxId", document->spdx_id) ||
+		!spdxtool_serialize_writer_begin_array(writer, "rootElement") ||
+		!generate_spdx_run_pass(client, world, maxdepth, ctx, GENERATE_SPDX_PASS_ROOT_ELEMENT) ||
+		!spdxtool_serialize_writer_end_array(writer) ||
+		!spdxtool_serialize_writer_begin_array(writer, "element") ||
+		!spdxtool_serialize_writer_add_string(writer, NULL, document->agent))
+		return false;
+
+	/* the maintainers and licenses registered while visiting the packages */
+	PKGCONF_FOREACH_LIST_ENTRY(document->element.head, iter)
+	{
+		if (!spdxtool_serialize_writer_add_string(writer, NULL, iter->data))
+			return false;
+	}
+
+	return generate_spdx_run_pass(client, world, maxdepth, ctx, GENERATE_SPDX_PASS_ELEMENT) &&
+		generate_spdx_run_pass(client, world, maxdepth, ctx, GENERATE_SPDX_PASS_PACKAGE_ELEMENT) &&
+		spdxtool_serialize_writer_end_array(writer) &&
+		spdxtool_serialize_writer_end_object(writer) &&
+		spdxtool_serialize_writer_end_array(writer) &&
+		spdxtool_serialize_writer_end_object(writer);
 }
 
 bool
@@ -203,42 +390,25 @@ spdxtool_generate(pkgconf_client_t *client, pkgconf_pkg_t *world, FILE *out, int
 		return false;
 	}
 
+	spdxtool_serialize_writer_t writer;
+	spdxtool_serialize_writer_init(&writer, out);
+
 	generate_spdx_ctx_t ctx = {
 		.document = document,
+		.writer = &writer,
 	};
-	int eflag = pkgconf_pkg_traverse(client, world, generate_spdx_package, &ctx, maxdepth, 0);
-	if (eflag != PKGCONF_PKG_ERRF_OK || ctx.failed)
-	{
-		spdxtool_core_spdx_document_free(document);
-		spdxtool_core_creation_info_free(creation);
-		spdxtool_core_agent_free(agent);
-		return false;
-	}
-
-	spdxtool_serialize_value_t *root = spdxtool_serialize_sbom(client, agent, tool, creation, document);
-	if (!root)
-	{
-		spdxtool_core_spdx_document_free(document);
-		spdxtool_core_creation_info_free(creation);
-		spdxtool_core_agent_free(agent);
-		return false;
-	}
 
-	pkgconf_buffer_t buffer = PKGCONF_BUFFER_INITIALIZER;
-	bool ret = spdxtool_serialize_value_to_buf(&buffer, root, 0);
-	spdxtool_serialize_value_free(root);
+	bool ret = generate_spdx_run_pass(client, world, maxdepth, &ctx, GENERATE_SPDX_PASS_REGISTER) &&
+		generate_spdx_write_graph(client, world, maxdepth, &ctx, agent, tool, creation);
 
-	if (ret)
+	if (!spdxtool_serialize_writer_finish(&writer) && ret)
 	{
-		ret = pkgconf_output_file_fmt(out, "%s\n", pkgconf_buffer_str(&buffer));
-		if (!ret)
-			pkgconf_error(client, "spdxtool: Could not output to file: %s", strerror(errno));
+		pkgconf_error(client, "spdxtool: Could not output to file: %s", strerror(errno));
+		ret = false;
 	}
-	else
+	else if (!ret && !ctx.failed)
 		pkgconf_error(client, "spdxtool: Could not serialize SPDX document");
 
-	pkgconf_buffer_finalize(&buffer);
-
 	spdxtool_core_spdx_document_free(document);
 	spdxtool_core_creation_info_free(creation);
 	spdxtool_core_tool_free(tool);
@@ -184,6 +184,9 @@ main(int argc, char *argv[])
 	};
 	pkgconf_client_init_with_options(&pkg_client, &client_options);
 
+	/* the document is written by traversing the solved graph, so freeze it */
+	want_client_flags |= PKGCONF_PKG_PKGF_FREEZE_GRAPH;
+
 	/* we have determined what features we want most likely.  in some cases, we override later. */
 	pkgconf_client_set_flags(&pkg_client, want_client_flags);
 
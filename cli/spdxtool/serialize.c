@@ -18,13 +18,35 @@
 #include "simplelicensing.h"
 #include "serialize.h"
 
+/* the bytes a JSON string may not contain as they are */
+#define JSON_ESCAPE_RANGES(X) \
+	X(0x00, 0x1f) \
+	X('"', '"') \
+	X('\\', '\\')
+
+static const pkgconf_charset_t json_escape_charset = PKGCONF_CHARSET_FROM_RANGES(JSON_ESCAPE_RANGES);
+
 static bool
 serialize_escape_string(pkgconf_buffer_t *buffer, const char *s)
 {
-	for (const char *p = s; *p; p++)
+	const pkgconf_charset_t *charset = &json_escape_charset;
+	size_t len = strlen(s);
+
+	for (const char *p = s; len > 0; p++, len--)
 	{
+		size_t run = pkgconf_charset_scan(charset, p, len);
 		bool ret;
 
+		/* copy the bytes which need no escaping in one go */
+		if (run > 0 && !pkgconf_buffer_append_slice(buffer, p, run))
+			return false;
+
+		if (run == len)
+			break;
+
+		p += run;
+		len -= run;
+
 		switch (*p)
 		{
 		case '\"':
@@ -49,10 +71,8 @@ serialize_escape_string(pkgconf_buffer_t *buffer, const char *s)
 			ret = pkgconf_buffer_append(buffer, "\\t");
 			break;
 		default:
-			if ((unsigned char) *p < 0x20)
-				ret = pkgconf_buffer_append_fmt(buffer, "\\u%04x", (unsigned int)(unsigned char) *p);
-			else
-				ret = pkgconf_buffer_push_byte(buffer, *p);
+			/* the remaining control characters */
+			ret = pkgconf_buffer_append_fmt(buffer, "\\u%04x", (unsigned int)(unsigned char) *p);
 		}
 
 		if (!ret)
@@ -376,125 +396,262 @@ spdxtool_serialize_array_free(spdxtool_serialize_array_t *array)
 /*
  * !doc
  *
- * .. c:function:: spdxtool_serialize_value_t *spdxtool_serialize_sbom(pkgconf_client_t *client, spdxtool_core_agent_t *agent, spdxtool_core_creation_info_t *creation, spdxtool_core_spdx_document_t *spdx)
+ * .. c:function:: void spdxtool_serialize_writer_init(spdxtool_serialize_writer_t *writer, FILE *out)
  *
- *    Serialize a complete SPDX SBOM document to a JSON-LD value tree. Iterates
- *    all SBOMs, packages, relationships, and license expressions registered on
- *    the document. The SpdxDocument object is emitted last to ensure all element
- *    IDs have been populated by prior iteration. This function must be called
- *    after pkgconf_pkg_traverse has completed so that all packages and their
- *    dependencies are registered on spdx.
+ *    Initialize a JSON writer which streams to the given file.  The writer
+ *    produces the same layout as spdxtool_serialize_value_to_buf(), with a
+ *    newline after each top-level value, but only holds the output which has
+ *    not been written yet.  It must be released with
+ *    spdxtool_serialize_writer_finish().
  *
- *    :param pkgconf_client_t *client: The pkgconf client being accessed.
- *    :param spdxtool_core_agent_t *agent: Agent struct to include in the document.
- *    :param spdxtool_core_creation_info_t *creation: CreationInfo struct to include in the document.
- *    :param spdxtool_core_spdx_document_t *spdx: SpdxDocument struct containing all registered SBOMs, packages, relationships, and licenses.
- *    :return: spdxtool_serialize_value_t * representing the complete JSON-LD document, or a null string value on allocation failure.
+ *    :param spdxtool_serialize_writer_t *writer: Writer to initialize.
+ *    :param FILE *out: File to write to.
+ *    :return: nothing
  */
-spdxtool_serialize_value_t *
-spdxtool_serialize_sbom(pkgconf_client_t *client, spdxtool_core_agent_t *agent, spdxtool_core_tool_t *tool, spdxtool_core_creation_info_t *creation, spdxtool_core_spdx_document_t *spdx)
+void
+spdxtool_serialize_writer_init(spdxtool_serialize_writer_t *writer, FILE *out)
 {
-	const char *errstr = "out of memory";
-	spdxtool_serialize_value_t *ret = NULL;
-	spdxtool_serialize_array_t *graph = NULL;
-	spdxtool_serialize_object_list_t *root = spdxtool_serialize_object_list_new();
-	if (!root)
-		goto err;
-
-	if (!spdxtool_serialize_object_add_string(root, "@context", "https://spdx.org/rdf/3.0.1/spdx-context.jsonld"))
-		goto err;
+	*writer = (spdxtool_serialize_writer_t) {
+		.out = out,
+		.buffer = PKGCONF_BUFFER_INITIALIZER,
+	};
+}
 
-	graph = spdxtool_serialize_array_new();
-	if (!graph)
-		goto err;
+static bool
+serialize_writer_flush(spdxtool_serialize_writer_t *writer)
+{
+	size_t len = pkgconf_buffer_len(&writer->buffer);
 
-	if (!spdxtool_serialize_array_add_take(graph, spdxtool_core_agent_to_object(client, agent)))
-		goto err;
+	if (len > 0 && fwrite(pkgconf_buffer_str(&writer->buffer), 1, len, writer->out) != len)
+		return false;
 
-	if (!spdxtool_serialize_array_add_take(graph, spdxtool_core_tool_to_object(client, tool)))
-		goto err;
+	pkgconf_buffer_rewind(&writer->buffer);
+	return true;
+}
 
-	if (!spdxtool_serialize_array_add_take(graph, spdxtool_core_creation_info_to_object(client, creation)))
-		goto err;
+/* start an entry of the innermost container, or the top-level value */
+static bool
+serialize_writer_entry(spdxtool_serialize_writer_t *writer, const char *key)
+{
+	pkgconf_buffer_t *buffer = &writer->buffer;
 
-	pkgconf_node_t *iter = NULL;
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->maintainers.head, iter)
+	if (writer->depth > 0)
 	{
-		spdxtool_core_agent_t *maintainer = iter->data;
-		if (!maintainer)
-		{
-			errstr = "maintainers list corrupted";
-			goto err;
-		}
-		if (!spdxtool_serialize_array_add_take(graph, spdxtool_core_agent_to_object(client, maintainer)))
-			goto err;
-	}
+		uint64_t bit = UINT64_C(1) << (writer->depth - 1);
 
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->licenses.head, iter)
-	{
-		spdxtool_simplelicensing_license_expression_t *expression = iter->data;
-		if (!expression)
-		{
-			errstr = "licenses list corrupted";
-			goto err;
-		}
-		if (!spdxtool_serialize_array_add_take(graph, spdxtool_simplelicensing_licenseExpression_to_object(client, spdx->creation_info, expression)))
-			goto err;
-	}
+		if (!pkgconf_buffer_append(buffer, (writer->nonempty & bit) ? ",\n" : "\n") ||
+			!serialize_add_indent(buffer, writer->depth))
+			return false;
 
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->rootElement.head, iter)
-	{
-		spdxtool_software_sbom_t *current_sbom = iter->data;
-		if (!current_sbom)
-		{
-			errstr = "sbom list corrupted";
-			goto err;
-		}
-		if (!spdxtool_serialize_array_add_take(graph, spdxtool_software_sbom_to_object(client, current_sbom)))
-			goto err;
+		writer->nonempty |= bit;
 	}
 
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->packages.head, iter)
-	{
-		pkgconf_pkg_t *pkg = iter->data;
-		if (!pkg)
-		{
-			errstr = "pkg list corrupted";
-			goto err;
-		}
-		if (!spdxtool_serialize_array_add_take(graph, spdxtool_software_package_to_object(client, pkg, spdx)))
-			goto err;
-	}
+	if (key == NULL)
+		return true;
 
-	PKGCONF_FOREACH_LIST_ENTRY(spdx->relationships.head, iter)
-	{
-		spdxtool_core_relationship_t *relationship = iter->data;
-		if (!relationship)
-		{
-			errstr = "relationship list corrupted";
-			goto err;
-		}
-		if (!spdxtool_serialize_array_add_take(graph, spdxtool_core_relationship_to_object(client, relationship)))
-			goto err;
-	}
+	return pkgconf_buffer_push_byte(buffer, '"') &&
+		serialize_escape_string(buffer, key) &&
+		pkgconf_buffer_append(buffer, "\": ");
+}
+
+/* an entry is complete, so write out the buffer once enough has gathered */
+static bool
+serialize_writer_entry_done(spdxtool_serialize_writer_t *writer)
+{
+	/* a top-level value is terminated by a newline */
+	if (writer->depth == 0 && !pkgconf_buffer_push_byte(&writer->buffer, '\n'))
+		return false;
+
+	if (pkgconf_buffer_len(&writer->buffer) < SPDXTOOL_SERIALIZE_WRITER_FLUSH_SIZE)
+		return true;
+
+	return serialize_writer_flush(writer);
+}
+
+static bool
+serialize_writer_begin(spdxtool_serialize_writer_t *writer, const char *key, char open)
+{
+	if (writer->depth >= SPDXTOOL_SERIALIZE_WRITER_MAX_DEPTH)
+		return false;
+
+	if (!serialize_writer_entry(writer, key) ||
+		!pkgconf_buffer_push_byte(&writer->buffer, open))
+		return false;
+
+	writer->depth++;
+	writer->nonempty &= ~(UINT64_C(1) << (writer->depth - 1));
+	return true;
+}
+
+static bool
+serialize_writer_end(spdxtool_serialize_writer_t *writer, char close)
+{
+	if (writer->depth == 0)
+		return false;
+
+	writer->depth--;
+
+	return pkgconf_buffer_push_byte(&writer->buffer, '\n') &&
+		serialize_add_indent(&writer->buffer, writer->depth) &&
+		pkgconf_buffer_push_byte(&writer->buffer, close) &&
+		serialize_writer_entry_done(writer);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_begin_object(spdxtool_serialize_writer_t *writer, const char *key)
+ *
+ *    Open a JSON object.  Its entries are written by the following calls,
+ *    up to the matching spdxtool_serialize_writer_end_object().
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :param const char *key: Key of the object within the enclosing object, or NULL within an array or at the top level.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_begin_object(spdxtool_serialize_writer_t *writer, const char *key)
+{
+	return serialize_writer_begin(writer, key, '{');
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_end_object(spdxtool_serialize_writer_t *writer)
+ *
+ *    Close the innermost JSON object.
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_end_object(spdxtool_serialize_writer_t *writer)
+{
+	return serialize_writer_end(writer, '}');
+}
 
-	// SpdxDocument last — spdx->element must be fully populated first
-	if (!spdxtool_serialize_array_add_take(graph, spdxtool_core_spdx_document_to_object(client, spdx)))
-		goto err;
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_begin_array(spdxtool_serialize_writer_t *writer, const char *key)
+ *
+ *    Open a JSON array.  Its items are written by the following calls,
+ *    up to the matching spdxtool_serialize_writer_end_array().
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :param const char *key: Key of the array within the enclosing object, or NULL within an array or at the top level.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_begin_array(spdxtool_serialize_writer_t *writer, const char *key)
+{
+	return serialize_writer_begin(writer, key, '[');
+}
 
-	bool ok = spdxtool_serialize_object_add_array(root, "@graph", graph);
-	graph = NULL;
-	if (!ok)
-		goto err;
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_end_array(spdxtool_serialize_writer_t *writer)
+ *
+ *    Close the innermost JSON array.
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_end_array(spdxtool_serialize_writer_t *writer)
+{
+	return serialize_writer_end(writer, ']');
+}
 
-	ret = spdxtool_serialize_value_object(root);
-	root = NULL;
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_add_string(spdxtool_serialize_writer_t *writer, const char *key, const char *s)
+ *
+ *    Write a JSON string.
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :param const char *key: Key of the string within the enclosing object, or NULL within an array.
+ *    :param const char *s: String to write, NULL is written as an empty string.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_add_string(spdxtool_serialize_writer_t *writer, const char *key, const char *s)
+{
+	return serialize_writer_entry(writer, key) &&
+		pkgconf_buffer_push_byte(&writer->buffer, '"') &&
+		serialize_escape_string(&writer->buffer, s ? s : "") &&
+		pkgconf_buffer_push_byte(&writer->buffer, '"') &&
+		serialize_writer_entry_done(writer);
+}
 
-err:
-	if (!ret)
-		pkgconf_error(client, "spdxtool_serialize_sbom: %s", errstr);
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_add_value(spdxtool_serialize_writer_t *writer, const char *key, spdxtool_serialize_value_t *value)
+ *
+ *    Write a JSON value tree at the current position.
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :param const char *key: Key of the value within the enclosing object, or NULL within an array or at the top level.
+ *    :param spdxtool_serialize_value_t *value: Value to write.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_add_value(spdxtool_serialize_writer_t *writer, const char *key, spdxtool_serialize_value_t *value)
+{
+	if (!value)
+		return false;
+
+	return serialize_writer_entry(writer, key) &&
+		spdxtool_serialize_value_to_buf(&writer->buffer, value, writer->depth) &&
+		serialize_writer_entry_done(writer);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_add_take(spdxtool_serialize_writer_t *writer, const char *key, spdxtool_serialize_value_t *value)
+ *
+ *    Write a JSON value tree at the current position and free it.
+ *    This takes ownership of the value unconditionally, so the result of
+ *    a *_to_object function can be passed in as it is.
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to use.
+ *    :param const char *key: Key of the value within the enclosing object, or NULL within an array or at the top level.
+ *    :param spdxtool_serialize_value_t *value: Value to write.  May be NULL, which fails.
+ *    :return: true on success, false on failure
+ */
+bool
+spdxtool_serialize_writer_add_take(spdxtool_serialize_writer_t *writer, const char *key, spdxtool_serialize_value_t *value)
+{
+	bool ret = spdxtool_serialize_writer_add_value(writer, key, value);
+
+	spdxtool_serialize_value_free(value);
+	return ret;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_serialize_writer_finish(spdxtool_serialize_writer_t *writer)
+ *
+ *    Write out whatever is still buffered and release the writer.  If an
+ *    object or array is still open, the document is incomplete, so nothing
+ *    more is written.
+ *
+ *    :param spdxtool_serialize_writer_t *writer: Writer to finish.
+ *    :return: true if the whole document was written, false on failure
+ */
+bool
+spdxtool_serialize_writer_finish(spdxtool_serialize_writer_t *writer)
+{
+	bool ret = writer->depth == 0 &&
+		serialize_writer_flush(writer) &&
+		fflush(writer->out) == 0;
 
-	spdxtool_serialize_object_list_free(root);
-	spdxtool_serialize_array_free(graph);
+	pkgconf_buffer_finalize(&writer->buffer);
 	return ret;
 }
@@ -535,8 +535,46 @@ spdxtool_serialize_array_add_array(spdxtool_serialize_array_t *array, spdxtool_s
 	return spdxtool_serialize_array_add_take(array, ret);
 }
 
-spdxtool_serialize_value_t *
-spdxtool_serialize_sbom(pkgconf_client_t *client, spdxtool_core_agent_t *agent, spdxtool_core_tool_t *tool, spdxtool_core_creation_info_t *creation, spdxtool_core_spdx_document_t *spdx);
+#define SPDXTOOL_SERIALIZE_WRITER_MAX_DEPTH	64
+#define SPDXTOOL_SERIALIZE_WRITER_FLUSH_SIZE	65536
+
+/*
+ * A writer which streams JSON to a file in the layout spdxtool_serialize_value_to_buf()
+ * produces, so that a document never has to be held in memory as a whole.
+ */
+typedef struct spdxtool_serialize_writer_ {
+	FILE *out;
+	pkgconf_buffer_t buffer; // output not yet written to out
+	unsigned int depth; // number of open objects and arrays
+	uint64_t nonempty; // bit n is set once the container at depth n + 1 has an entry
+} spdxtool_serialize_writer_t;
+
+void
+spdxtool_serialize_writer_init(spdxtool_serialize_writer_t *writer, FILE *out);
+
+bool
+spdxtool_serialize_writer_begin_object(spdxtool_serialize_writer_t *writer, const char *key);
+
+bool
+spdxtool_serialize_writer_end_object(spdxtool_serialize_writer_t *writer);
+
+bool
+spdxtool_serialize_writer_begin_array(spdxtool_serialize_writer_t *writer, const char *key);
+
+bool
+spdxtool_serialize_writer_end_array(spdxtool_serialize_writer_t *writer);
+
+bool
+spdxtool_serialize_writer_add_string(spdxtool_serialize_writer_t *writer, const char *key, const char *s);
+
+bool
+spdxtool_serialize_writer_add_value(spdxtool_serialize_writer_t *writer, const char *key, spdxtool_serialize_value_t *value);
+
+bool
+spdxtool_serialize_writer_add_take(spdxtool_serialize_writer_t *writer, const char *key, spdxtool_serialize_value_t *value);
+
+bool
+spdxtool_serialize_writer_finish(spdxtool_serialize_writer_t *writer);
 
 #ifdef __cplusplus
 }
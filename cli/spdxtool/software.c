@@ -97,15 +97,89 @@ spdxtool_software_sbom_free(spdxtool_software_sbom_t *sbom)
 	free(sbom);
 }
 
+static bool
+sbom_add_dependency_elements(pkgconf_client_t *client, spdxtool_serialize_array_t *element_array, const pkgconf_pkg_t *pkg, const pkgconf_list_t *deps, char sep)
+{
+	pkgconf_node_t *node = NULL;
+
+	PKGCONF_FOREACH_LIST_ENTRY(deps->head, node)
+	{
+		pkgconf_dependency_t *dep = node->data;
+		pkgconf_pkg_t *match = dep->match;
+
+		/* an unresolved (but tolerated) dependency has no match */
+		if (match == NULL)
+			continue;
+
+		char *spdx_id_relation = relationship_spdx_id(client, pkg->id, match->id, sep);
+		if (!spdx_id_relation)
+			return false;
+
+		bool ok = spdxtool_serialize_array_add_string(element_array, spdx_id_relation) != NULL;
+		free(spdx_id_relation);
+
+		if (!ok)
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+sbom_add_tuple_element(pkgconf_client_t *client, spdxtool_serialize_array_t *element_array, pkgconf_pkg_t *pkg, const char *key)
+{
+	char *value = spdxtool_util_tuple_lookup(client, &pkg->vars, key);
+	if (!value)
+		return true;
+
+	bool ok = spdxtool_serialize_array_add_string(element_array, value) != NULL;
+	free(value);
+	return ok;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: spdxtool_serialize_array_t *spdxtool_software_sbom_elements(pkgconf_client_t *client, pkgconf_pkg_t *pkg)
+ *
+ *    Collect the spdxIds of the relationships which the Sbom of a package
+ *    lists as its elements: one for every resolved dependency, public and
+ *    private, followed by the package's license relationships.
+ *
+ *    :param pkgconf_client_t *client: The pkgconf client being accessed.
+ *    :param pkgconf_pkg_t *pkg: Package which is the root element of the Sbom.
+ *    :return: an array of strings, owned by the caller, or NULL on allocation failure.
+ */
+spdxtool_serialize_array_t *
+spdxtool_software_sbom_elements(pkgconf_client_t *client, pkgconf_pkg_t *pkg)
+{
+	char sep = spdxtool_util_get_uri_separator(client);
+	spdxtool_serialize_array_t *element_array = spdxtool_serialize_array_new();
+	if (!element_array)
+		return NULL;
+
+	if (!sbom_add_dependency_elements(client, element_array, pkg, &pkg->required, sep) ||
+		!sbom_add_dependency_elements(client, element_array, pkg, &pkg->requires_private, sep) ||
+		!sbom_add_tuple_element(client, element_array, pkg, "hasDeclaredLicense") ||
+		!sbom_add_tuple_element(client, element_array, pkg, "hasConcludedLicense"))
+	{
+		spdxtool_serialize_array_free(element_array);
+		return NULL;
+	}
+
+	return element_array;
+}
+
 /*
  * !doc
  *
  * .. c:function:: spdxtool_serialize_value_t *spdxtool_software_sbom_to_object(pkgconf_client_t *client, spdxtool_software_sbom_t *sbom)
  *
  *    Serialize /Software/Sbom struct to a JSON value tree. As a side effect,
- *    the package associated with the SBOM's rootElement is registered on the
- *    document via spdxtool_core_spdx_document_add_package, and relationship
- *    element IDs are registered via spdxtool_core_spdx_document_add_element.
+ *    if the SBOM belongs to a document, the package associated with the SBOM's
+ *    rootElement is registered on it via spdxtool_core_spdx_document_add_package,
+ *    and relationship element IDs are registered via
+ *    spdxtool_core_spdx_document_add_element.
  *
  *    :param pkgconf_client_t *client: The pkgconf client being accessed.
  *    :param spdxtool_software_sbom_t *sbom: Sbom struct to be serialized.
@@ -121,8 +195,6 @@ spdxtool_software_sbom_to_object(pkgconf_client_t *client, spdxtool_software_sbo
 	spdxtool_serialize_array_t *element_array = NULL;
 	char *spdx_id = NULL;
 
-	char sep = spdxtool_util_get_uri_separator(client);
-
 	spdx_id = spdxtool_util_tuple_lookup(client, &sbom->rootElement->vars, "spdxId");
 	if (!spdx_id)
 		goto err;
@@ -145,101 +217,19 @@ spdxtool_software_sbom_to_object(pkgconf_client_t *client, spdxtool_software_sbo
 	if (!spdxtool_serialize_array_add_string(root_element_array, spdx_id))
 		goto err;
 
-	element_array = spdxtool_serialize_array_new();
+	element_array = spdxtool_software_sbom_elements(client, sbom->rootElement);
 	if (!element_array)
 		goto err;
 
-	pkgconf_node_t *node = NULL;
-	PKGCONF_FOREACH_LIST_ENTRY(sbom->rootElement->required.head, node)
+	if (sbom->spdx_document != NULL)
 	{
-		pkgconf_dependency_t *dep = node->data;
-		pkgconf_pkg_t *match = dep->match;
-
-		/* an unresolved (but tolerated) dependency has no match */
-		if (match == NULL)
-			continue;
-
-		char *spdx_id_relation = relationship_spdx_id(client, sbom->rootElement->id, match->id, sep);
-		if (!spdx_id_relation)
-			goto err;
-
-		if (!spdxtool_serialize_array_add_string(element_array, spdx_id_relation))
-		{
-			free(spdx_id_relation);
-			goto err;
-		}
-
-		if (!spdxtool_core_spdx_document_add_element(client, sbom->spdx_document, spdx_id_relation))
+		pkgconf_node_t *node = NULL;
+		PKGCONF_FOREACH_LIST_ENTRY(element_array->items.head, node)
 		{
-			free(spdx_id_relation);
-			goto err;
-		}
-
-		free(spdx_id_relation);
-	}
-
-	PKGCONF_FOREACH_LIST_ENTRY(sbom->rootElement->requires_private.head, node)
-	{
-		pkgconf_dependency_t *dep = node->data;
-		pkgconf_pkg_t *match = dep->match;
-
-		/* an unresolved (but tolerated) dependency has no match */
-		if (match == NULL)
-			continue;
-
-		char *spdx_id_relation = relationship_spdx_id(client, sbom->rootElement->id, match->id, sep);
-		if (!spdx_id_relation)
-			goto err;
-
-		if (!spdxtool_serialize_array_add_string(element_array, spdx_id_relation))
-		{
-			free(spdx_id_relation);
-			goto err;
-		}
-
-		if (!spdxtool_core_spdx_document_add_element(client, sbom->spdx_document, spdx_id_relation))
-		{
-			free(spdx_id_relation);
-			goto err;
-		}
-
-		free(spdx_id_relation);
-	}
-
-	char *value = spdxtool_util_tuple_lookup(client, &sbom->rootElement->vars, "hasDeclaredLicense");
-	if (value)
-	{
-		if (!spdxtool_serialize_array_add_string(element_array, value))
-		{
-			free(value);
-			goto err;
-		}
-
-		if (!spdxtool_core_spdx_document_add_element(client, sbom->spdx_document, value))
-		{
-			free(value);
-			goto err;
-		}
-
-		free(value);
-	}
-
-	value = spdxtool_util_tuple_lookup(client, &sbom->rootElement->vars, "hasConcludedLicense");
-	if (value)
-	{
-		if (!spdxtool_serialize_array_add_string(element_array, value))
-		{
-			free(value);
-			goto err;
-		}
-
-		if (!spdxtool_core_spdx_document_add_element(client, sbom->spdx_document, value))
-		{
-			free(value);
-			goto err;
+			const spdxtool_serialize_value_t *element = node->data;
+			if (!spdxtool_core_spdx_document_add_element(client, sbom->spdx_document, element->value.s))
+				goto err;
 		}
-
-		free(value);
 	}
 
 	if (!(spdxtool_serialize_object_add_string(object_list, "type", sbom->type) &&
@@ -268,7 +258,8 @@ spdxtool_software_sbom_to_object(pkgconf_client_t *client, spdxtool_software_sbo
 	if (!ok)
 		goto err;
 
-	if (!spdxtool_core_spdx_document_add_package(client, sbom->spdx_document, sbom->rootElement))
+	if (sbom->spdx_document != NULL &&
+		!spdxtool_core_spdx_document_add_package(client, sbom->spdx_document, sbom->rootElement))
 		goto err;
 
 	ret = spdxtool_serialize_value_object(object_list);
@@ -313,28 +304,23 @@ serialize_copyright_lines_to_object(spdxtool_serialize_object_list_t *object_lis
 /*
  * !doc
  *
- * .. c:function:: spdxtool_serialize_value_t *spdxtool_software_package_to_object(pkgconf_client_t *client, pkgconf_pkg_t *pkg, spdxtool_core_spdx_document_t *spdx)
+ * .. c:function:: bool spdxtool_software_package_add_relationships(pkgconf_client_t *client, pkgconf_pkg_t *pkg, spdxtool_core_spdx_document_t *spdx)
  *
- *    Serialize /Software/Package struct to a JSON value tree. As a side effect,
- *    any license and dependency relationships generated during serialization are
- *    added to the document via spdxtool_core_spdx_document_add_relationship.
+ *    Add the relationships of a package to the document via
+ *    spdxtool_core_spdx_document_add_relationship: its declared and concluded
+ *    licenses, followed by one for every resolved dependency, public and private.
  *
  *    :param pkgconf_client_t *client: The pkgconf client being accessed.
- *    :param pkgconf_pkg_t *pkg: Package struct to be serialized.
- *    :param spdxtool_core_spdx_document_t *spdx: SpdxDocument to which generated relationships are added.
- *    :return: spdxtool_serialize_value_t * representing the Package object.
+ *    :param pkgconf_pkg_t *pkg: Package whose relationships are added.
+ *    :param spdxtool_core_spdx_document_t *spdx: SpdxDocument to which the relationships are added.
+ *    :return: true on success, false on failure
  */
-spdxtool_serialize_value_t *
-spdxtool_software_package_to_object(pkgconf_client_t *client, pkgconf_pkg_t *pkg, spdxtool_core_spdx_document_t *spdx)
+bool
+spdxtool_software_package_add_relationships(pkgconf_client_t *client, pkgconf_pkg_t *pkg, spdxtool_core_spdx_document_t *spdx)
 {
-	spdxtool_serialize_value_t *ret = NULL;
-	spdxtool_serialize_object_list_t *object_list = NULL;
-	spdxtool_serialize_array_t *originated_by = NULL;
-	spdxtool_serialize_array_t *supplied_by = NULL;
+	bool ret = false;
 	char *creation_info = NULL;
 	char *spdx_id = NULL;
-	char *agent = NULL;
-	char *supplier = NULL;
 	char *spdx_id_license = NULL;
 	pkgconf_list_t relations = PKGCONF_LIST_INITIALIZER;
 	pkgconf_list_t *cpy_relations = NULL;
@@ -343,71 +329,8 @@ spdxtool_software_package_to_object(pkgconf_client_t *client, pkgconf_pkg_t *pkg
 
 	creation_info = spdxtool_util_tuple_lookup(client, &pkg->vars, "creationInfo");
 	spdx_id = spdxtool_util_tuple_lookup(client, &pkg->vars, "spdxId");
-	agent = spdxtool_util_tuple_lookup(client, &pkg->vars, "agent");
-
-	if (!creation_info || !spdx_id || !agent)
-		goto err;
-
-	object_list = spdxtool_serialize_object_list_new();
-	if (!object_list)
-		goto err;
-
-	originated_by = spdxtool_serialize_array_new();
-	if (!originated_by)
-		goto err;
-
-	if (!spdxtool_serialize_array_add_string(originated_by, agent))
-		goto err;
-
-	if (!(spdxtool_serialize_object_add_string(object_list, "type", "software_Package") &&
-		spdxtool_serialize_object_add_string(object_list, "creationInfo", creation_info) &&
-		spdxtool_serialize_object_add_string(object_list, "spdxId", spdx_id) &&
-		spdxtool_serialize_object_add_string(object_list, "name", pkg->realname)))
-	{
-		goto err;
-	}
-
-	/* object_add_array always takes ownership of the array (it is freed even on
-	 * failure), so clear our reference before checking the result to avoid a
-	 * double free at the error label.
-	 */
-	bool ok = spdxtool_serialize_object_add_array(object_list, "originatedBy", originated_by);
-	originated_by = NULL;
-	if (!ok)
-		goto err;
-
-	supplier = spdxtool_util_tuple_lookup(client, &pkg->vars, "suppliedBy");
-	if (supplier)
-	{
-		supplied_by = spdxtool_serialize_array_new();
-		if (!supplied_by)
-			goto err;
 
-		if (!spdxtool_serialize_array_add_string(supplied_by, supplier))
-			goto err;
-
-		ok = spdxtool_serialize_object_add_array(object_list, "suppliedBy", supplied_by);
-		supplied_by = NULL;
-		if (!ok)
-			goto err;
-	}
-
-	if (!serialize_copyright_lines_to_object(object_list, &pkg->copyright))
-		goto err;
-
-	if (!spdxtool_serialize_object_add_string(object_list, "software_homePage",
-		pkg->url ? pkg->url : ""))
-	{
-		goto err;
-	}
-
-	if (!spdxtool_serialize_object_add_string(object_list, "software_downloadLocation",
-		pkg->source ? pkg->source : ""))
-	{
-		goto err;
-	}
-
-	if (!spdxtool_serialize_object_add_string(object_list, "software_packageVersion", pkg->version))
+	if (!creation_info || !spdx_id)
 		goto err;
 
 	PKGCONF_FOREACH_LIST_ENTRY(pkg->license.head, node)
@@ -580,17 +503,14 @@ spdxtool_software_package_to_object(pkgconf_client_t *client, pkgconf_pkg_t *pkg
 		}
 	}
 
-	ret = spdxtool_serialize_value_object(object_list);
-	object_list = NULL;
+	ret = true;
 
 err:
 	if (!ret)
-		pkgconf_error(client, "spdxtool_software_package_to_object: out of memory");
+		pkgconf_error(client, "spdxtool_software_package_add_relationships: out of memory");
 
 	free(creation_info);
 	free(spdx_id);
-	free(agent);
-	free(supplier);
 	free(spdx_id_license);
 	pkgconf_license_free(&relations);
 	if (cpy_relations != NULL)
@@ -598,6 +518,118 @@ err:
 		pkgconf_license_free(cpy_relations);
 		free(cpy_relations);
 	}
+	return ret;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: spdxtool_serialize_value_t *spdxtool_software_package_to_object(pkgconf_client_t *client, pkgconf_pkg_t *pkg, spdxtool_core_spdx_document_t *spdx)
+ *
+ *    Serialize /Software/Package struct to a JSON value tree. As a side effect,
+ *    if a document is given, the license and dependency relationships of the
+ *    package are added to it via spdxtool_software_package_add_relationships.
+ *
+ *    :param pkgconf_client_t *client: The pkgconf client being accessed.
+ *    :param pkgconf_pkg_t *pkg: Package struct to be serialized.
+ *    :param spdxtool_core_spdx_document_t *spdx: SpdxDocument to which generated relationships are added, or NULL.
+ *    :return: spdxtool_serialize_value_t * representing the Package object.
+ */
+spdxtool_serialize_value_t *
+spdxtool_software_package_to_object(pkgconf_client_t *client, pkgconf_pkg_t *pkg, spdxtool_core_spdx_document_t *spdx)
+{
+	spdxtool_serialize_value_t *ret = NULL;
+	spdxtool_serialize_object_list_t *object_list = NULL;
+	spdxtool_serialize_array_t *originated_by = NULL;
+	spdxtool_serialize_array_t *supplied_by = NULL;
+	char *creation_info = NULL;
+	char *spdx_id = NULL;
+	char *agent = NULL;
+	char *supplier = NULL;
+
+	creation_info = spdxtool_util_tuple_lookup(client, &pkg->vars, "creationInfo");
+	spdx_id = spdxtool_util_tuple_lookup(client, &pkg->vars, "spdxId");
+	agent = spdxtool_util_tuple_lookup(client, &pkg->vars, "agent");
+
+	if (!creation_info || !spdx_id || !agent)
+		goto err;
+
+	object_list = spdxtool_serialize_object_list_new();
+	if (!object_list)
+		goto err;
+
+	originated_by = spdxtool_serialize_array_new();
+	if (!originated_by)
+		goto err;
+
+	if (!spdxtool_serialize_array_add_string(originated_by, agent))
+		goto err;
+
+	if (!(spdxtool_serialize_object_add_string(object_list, "type", "software_Package") &&
+		spdxtool_serialize_object_add_string(object_list, "creationInfo", creation_info) &&
+		spdxtool_serialize_object_add_string(object_list, "spdxId", spdx_id) &&
+		spdxtool_serialize_object_add_string(object_list, "name", pkg->realname)))
+	{
+		goto err;
+	}
+
+	/* object_add_array always takes ownership of the array (it is freed even on
+	 * failure), so clear our reference before checking the result to avoid a
+	 * double free at the error label.
+	 */
+	bool ok = spdxtool_serialize_object_add_array(object_list, "originatedBy", originated_by);
+	originated_by = NULL;
+	if (!ok)
+		goto err;
+
+	supplier = spdxtool_util_tuple_lookup(client, &pkg->vars, "suppliedBy");
+	if (supplier)
+	{
+		supplied_by = spdxtool_serialize_array_new();
+		if (!supplied_by)
+			goto err;
+
+		if (!spdxtool_serialize_array_add_string(supplied_by, supplier))
+			goto err;
+
+		ok = spdxtool_serialize_object_add_array(object_list, "suppliedBy", supplied_by);
+		supplied_by = NULL;
+		if (!ok)
+			goto err;
+	}
+
+	if (!serialize_copyright_lines_to_object(object_list, &pkg->copyright))
+		goto err;
+
+	if (!spdxtool_serialize_object_add_string(object_list, "software_homePage",
+		pkg->url ? pkg->url : ""))
+	{
+		goto err;
+	}
+
+	if (!spdxtool_serialize_object_add_string(object_list, "software_downloadLocation",
+		pkg->source ? pkg->source : ""))
+	{
+		goto err;
+	}
+
+	if (!spdxtool_serialize_object_add_string(object_list, "software_packageVersion", pkg->version))
+		goto err;
+
+	if (spdx != NULL && !spdxtool_software_package_add_relationships(client, pkg, spdx))
+		goto err;
+
+	ret = spdxtool_serialize_value_object(object_list);
+	object_list = NULL;
+
+err:
+	if (!ret)
+		pkgconf_error(client, "spdxtool_software_package_to_object: out of memory");
+
+	free(creation_info);
+	free(spdx_id);
+	free(agent);
+	free(supplier);
 	spdxtool_serialize_object_list_free(object_list);
 	spdxtool_serialize_array_free(originated_by);
 	spdxtool_serialize_array_free(supplied_by);
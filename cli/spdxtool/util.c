@@ -332,3 +332,142 @@ spdxtool_util_tuple_lookup(pkgconf_client_t *client, pkgconf_list_t *vars, const
 
 	return pkgconf_buffer_freeze(&buf);
 }
+
+/* FNV-1a */
+static size_t
+util_index_hash(const char *key)
+{
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+	for (const char *p = key; *p != '\0'; p++)
+		hash = (hash ^ (unsigned char) *p) * UINT64_C(0x100000001b3);
+
+	return (size_t) hash;
+}
+
+/* the slot holding the entry with the given key, or the empty slot where it belongs */
+static void **
+util_index_slot(const spdxtool_util_index_t *index, const char *key)
+{
+	size_t mask = index->alloc - 1;
+	size_t i = util_index_hash(key) & mask;
+
+	while (index->slots[i] != NULL && strcmp(index->key_of(index->slots[i]), key))
+		i = (i + 1) & mask;
+
+	return &index->slots[i];
+}
+
+static bool
+util_index_grow(spdxtool_util_index_t *index)
+{
+	void **oldslots = index->slots;
+	size_t oldalloc = index->alloc;
+	size_t alloc = oldalloc != 0 ? oldalloc * 2 : 64;
+	void **slots = calloc(alloc, sizeof(*slots));
+
+	if (slots == NULL)
+		return false;
+
+	index->slots = slots;
+	index->alloc = alloc;
+
+	for (size_t i = 0; i < oldalloc; i++)
+	{
+		if (oldslots[i] != NULL)
+			*util_index_slot(index, index->key_of(oldslots[i])) = oldslots[i];
+	}
+
+	free(oldslots);
+	return true;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void *spdxtool_util_index_lookup(const spdxtool_util_index_t *index, const char *key)
+ *
+ *    Find the entry with the given key in a hash index.
+ *
+ *    :param const spdxtool_util_index_t *index: index to search
+ *    :param const char *key: key to look for
+ *    :return: the entry, or NULL if there is none
+ */
+void *
+spdxtool_util_index_lookup(const spdxtool_util_index_t *index, const char *key)
+{
+	if (index->alloc == 0)
+		return NULL;
+
+	return *util_index_slot(index, key);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_util_index_reserve(spdxtool_util_index_t *index)
+ *
+ *    Make room in a hash index for one more entry, so that the next
+ *    spdxtool_util_index_insert() cannot fail.
+ *
+ *    :param spdxtool_util_index_t *index: index to grow
+ *    :return: true on success, false on allocation failure
+ */
+bool
+spdxtool_util_index_reserve(spdxtool_util_index_t *index)
+{
+	/* keep the table at most half full, so probe sequences stay short */
+	if ((index->count + 1) * 2 > index->alloc)
+		return util_index_grow(index);
+
+	return true;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool spdxtool_util_index_insert(spdxtool_util_index_t *index, void *entry)
+ *
+ *    Add an entry to a hash index, unless an entry with the same key is
+ *    already there, which is then kept.
+ *
+ *    :param spdxtool_util_index_t *index: index to add to
+ *    :param void *entry: entry to add, not owned by the index
+ *    :return: true on success, false on allocation failure
+ */
+bool
+spdxtool_util_index_insert(spdxtool_util_index_t *index, void *entry)
+{
+	void **slot;
+
+	if (!spdxtool_util_index_reserve(index))
+		return false;
+
+	slot = util_index_slot(index, index->key_of(entry));
+	if (*slot == NULL)
+	{
+		*slot = entry;
+		index->count++;
+	}
+
+	return true;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void spdxtool_util_index_free(spdxtool_util_index_t *index)
+ *
+ *    Release the table of a hash index.  The entries are not freed.
+ *
+ *    :param spdxtool_util_index_t *index: index to release
+ *    :return: nothing
+ */
+void
+spdxtool_util_index_free(spdxtool_util_index_t *index)
+{
+	free(index->slots);
+	index->slots = NULL;
+	index->count = 0;
+	index->alloc = 0;
+}
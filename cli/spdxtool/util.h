@@ -47,6 +47,20 @@ typedef struct spdxtool_core_creation_info_
 	char *spec_version;
 } spdxtool_core_creation_info_t;
 
+typedef const char *(*spdxtool_util_index_key_func_t)(const void *entry);
+
+/*
+ * An open-addressed hash table of entries, each found by the string key
+ * which key_of returns for it.  The table does not own the entries.
+ */
+typedef struct spdxtool_util_index_
+{
+	void **slots;
+	size_t count;
+	size_t alloc;
+	spdxtool_util_index_key_func_t key_of;
+} spdxtool_util_index_t;
+
 typedef struct spdxtool_core_spdx_document
 {
 	const char *type;
@@ -59,6 +73,8 @@ typedef struct spdxtool_core_spdx_document
 	pkgconf_list_t relationships;
 	pkgconf_list_t packages;
 	pkgconf_list_t maintainers;
+	spdxtool_util_index_t license_index; // licenses by expression
+	spdxtool_util_index_t maintainer_index; // maintainers by spdxId
 } spdxtool_core_spdx_document_t;
 
 typedef struct spdxtool_software_sbom_
@@ -131,6 +147,18 @@ spdxtool_util_string_correction(char *str);
 char *
 spdxtool_util_tuple_lookup(pkgconf_client_t *client, pkgconf_list_t *vars, const char *key);
 
+void *
+spdxtool_util_index_lookup(const spdxtool_util_index_t *index, const char *key);
+
+bool
+spdxtool_util_index_reserve(spdxtool_util_index_t *index);
+
+bool
+spdxtool_util_index_insert(spdxtool_util_index_t *index, void *entry);
+
+void
+spdxtool_util_index_free(spdxtool_util_index_t *index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,6 @@
 /*
  * alloc-inject.c
- * allocator fault injection for fuzzing harnesses
+ * allocator fault injection and allocation counting for fuzzing harnesses and tests
  *
  * SPDX-License-Identifier: pkgconf
  *
@@ -16,6 +16,7 @@
  */
 
 #include <stddef.h>
+#include <string.h>
 #include "alloc-inject.h"
 
 /* the library's allocator calls are redirected here via -Wl,--wrap, so __real_*
@@ -27,6 +28,11 @@ static unsigned long alloc_seen = 0;
 static unsigned long alloc_fail_at = 0;
 static bool alloc_fired = false;
 
+/* counting is independent of injection, so a test can measure an operation that succeeds */
+static bool alloc_counting = false;
+static unsigned long alloc_count = 0;
+static size_t alloc_bytes = 0;
+
 void *__real_malloc(size_t size);
 void *__real_calloc(size_t nmemb, size_t size);
 void *__real_realloc(void *ptr, size_t size);
@@ -62,9 +68,33 @@ alloc_inject_fired(void)
 	return alloc_fired;
 }
 
+void
+alloc_inject_count_begin(void)
+{
+	alloc_count = 0;
+	alloc_bytes = 0;
+	alloc_counting = true;
+}
+
+void
+alloc_inject_count_end(unsigned long *count, size_t *bytes)
+{
+	alloc_counting = false;
+
+	*count = alloc_count;
+	*bytes = alloc_bytes;
+}
+
+/* `bytes` is what the caller asked for, not what the allocator hands out */
 static bool
-alloc_should_fail(void)
+alloc_should_fail(size_t bytes)
 {
+	if (alloc_counting)
+	{
+		alloc_count++;
+		alloc_bytes += bytes;
+	}
+
 	if (!alloc_armed)
 		return false;
 
@@ -78,7 +108,7 @@ alloc_should_fail(void)
 void *
 __wrap_malloc(size_t size)
 {
-	if (alloc_should_fail())
+	if (alloc_should_fail(size))
 		return NULL;
 
 	return __real_malloc(size);
@@ -87,7 +117,7 @@ __wrap_malloc(size_t size)
 void *
 __wrap_calloc(size_t nmemb, size_t size)
 {
-	if (alloc_should_fail())
+	if (alloc_should_fail(nmemb * size))
 		return NULL;
 
 	return __real_calloc(nmemb, size);
@@ -96,7 +126,7 @@ __wrap_calloc(size_t nmemb, size_t size)
 void *
 __wrap_realloc(void *ptr, size_t size)
 {
-	if (alloc_should_fail())
+	if (alloc_should_fail(size))
 		return NULL;
 
 	return __real_realloc(ptr, size);
@@ -105,7 +135,7 @@ __wrap_realloc(void *ptr, size_t size)
 void *
 __wrap_reallocarray(void *ptr, size_t nmemb, size_t size)
 {
-	if (alloc_should_fail())
+	if (alloc_should_fail(nmemb * size))
 		return NULL;
 
 	return __real_reallocarray(ptr, nmemb, size);
@@ -114,7 +144,7 @@ __wrap_reallocarray(void *ptr, size_t nmemb, size_t size)
 char *
 __wrap_strdup(const char *s)
 {
-	if (alloc_should_fail())
+	if (alloc_should_fail(strlen(s) + 1))
 		return NULL;
 
 	return __real_strdup(s);
@@ -123,7 +153,7 @@ __wrap_strdup(const char *s)
 char *
 __wrap_strndup(const char *s, size_t n)
 {
-	if (alloc_should_fail())
+	if (alloc_should_fail(strnlen(s, n) + 1))
 		return NULL;
 
 	return __real_strndup(s, n);
@@ -1,6 +1,6 @@
 /*
  * alloc-inject.h
- * allocator fault injection for fuzzing harnesses
+ * allocator fault injection and allocation counting for fuzzing harnesses and tests
  *
  * SPDX-License-Identifier: pkgconf
  *
@@ -19,6 +19,7 @@
 #define PKGCONF_FUZZER_ALLOC_INJECT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /* arm injection so that the fail_at-th allocation made while armed fails */
 void alloc_inject_arm(unsigned long fail_at);
@@ -29,4 +30,10 @@ void alloc_inject_disarm(void);
 /* whether the armed failure point was actually reached since the last arm */
 bool alloc_inject_fired(void);
 
+/* start counting allocations and the bytes they request */
+void alloc_inject_count_begin(void);
+
+/* stop counting, reporting the allocations and bytes seen since alloc_inject_count_begin() */
+void alloc_inject_count_end(unsigned long *count, size_t *bytes);
+
 #endif
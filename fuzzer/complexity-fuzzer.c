@@ -0,0 +1,249 @@
+/*
+ * complexity-fuzzer.c
+ * complexity-regression harness: solves a generated universe at growing sizes
+ * and checks that the work done grows no faster than n log n
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+#include <tests/universe.h>
+#include <inttypes.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/*
+ * The input does not describe packages directly: it is decoded into the
+ * parameters of a synthetic universe (see tests/universe.c), which is then
+ * generated at each of the sizes below.  The solver's operation counters for
+ * the smallest size fix the constant c of a c * n log n budget, and every
+ * larger size must stay within COMPLEXITY_SLACK times that budget.  Work that
+ * grows quadratically -- a list scan or an index memmove per element --
+ * overshoots the budget by a factor of n / log n, which is already larger than
+ * the slack at the largest size.
+ *
+ * An input which blows the budget aborts, so libFuzzer saves it (the
+ * fuzz-complexity target points -artifact_prefix at fuzz/complexity-regressions);
+ * once the regression is fixed it belongs in fuzzer/complexity-corpus, which
+ * the test suite replays.
+ */
+static const unsigned long complexity_sizes[] = { 64, 128, 256, 512, 1024 };
+
+#define COMPLEXITY_SIZE_COUNT	(sizeof(complexity_sizes) / sizeof(*complexity_sizes))
+#define COMPLEXITY_SLACK	4.0
+#define COMPLEXITY_MAXDEPTH	-1
+
+/* counters which measure work; files and bytes only measure the input */
+static const pkgconf_stats_counter_t complexity_counters[] = {
+	PKGCONF_STATS_CACHE_HITS,
+	PKGCONF_STATS_CACHE_MISSES,
+	PKGCONF_STATS_PROVIDER_SCANS,
+	PKGCONF_STATS_TRAVERSAL_NODES,
+	PKGCONF_STATS_TRAVERSAL_EDGES,
+	PKGCONF_STATS_FRAGMENTS_COPIED,
+	PKGCONF_STATS_FRAGMENTS_MERGED,
+	PKGCONF_STATS_BYTECODE_OPS,
+	PKGCONF_STATS_DEPENDENCY_PROBES,
+	PKGCONF_STATS_INDEX_SHIFTS,
+};
+
+#define COMPLEXITY_COUNTER_COUNT	(sizeof(complexity_counters) / sizeof(*complexity_counters))
+
+typedef struct {
+	double n;
+	uint64_t ops;
+	uint64_t counters[COMPLEXITY_COUNTER_COUNT];
+} complexity_sample_t;
+
+static const char *
+environ_lookup_handler(const pkgconf_client_t *client, const char *key)
+{
+	(void) client;
+	(void) key;
+
+	return NULL;
+}
+
+static void
+decode_params(universe_params_t *params, const uint8_t *data, size_t size)
+{
+	uint8_t bytes[17] = { 0 };
+
+	memcpy(bytes, data, size < sizeof bytes ? size : sizeof bytes);
+
+	for (size_t i = 0; i < 8; i++)
+		params->seed |= (uint64_t) bytes[i] << (8 * i);
+
+	params->degree = 1 + bytes[8] % 6;
+	params->degree_dist = (universe_degree_dist_t) (bytes[9] % 3);
+	params->private_percent = bytes[10] % 101;
+	params->shared_percent = bytes[16] % (101 - params->private_percent);
+	params->provides = bytes[11] % 3;
+	params->cflags = 1 + bytes[12] % 4;
+	params->libs = 1 + bytes[13] % 4;
+	params->variable_depth = bytes[14] % 4;
+
+	/* cycles are given per hundred packages, so their density is the same at every size */
+	params->cycles = bytes[15] % 4;
+	params->spine = true;
+}
+
+static void
+cleanup_universe(const char *dir, unsigned long packages)
+{
+	char name[64];
+	char path[PKGCONF_ITEM_SIZE];
+
+	for (unsigned long i = 0; i < packages; i++)
+	{
+		universe_package_name(name, sizeof name, i);
+		snprintf(path, sizeof path, "%s/%s.pc", dir, name);
+		unlink(path);
+	}
+
+	rmdir(dir);
+}
+
+static bool
+run_solve(const pkgconf_cross_personality_t *pers, const universe_params_t *base, unsigned long packages, complexity_sample_t *sample)
+{
+	universe_params_t params = *base;
+	universe_stats_t ustats;
+	char dir[] = "/tmp/pkgconf-fuzz-complexity-XXXXXX";
+	char root[64];
+	unsigned long roots = 0;
+	bool ok = false;
+
+	params.packages = packages;
+	params.cycles = base->cycles * packages / 100;
+
+	if (mkdtemp(dir) == NULL)
+		return false;
+
+	if (!universe_generate(&params, dir, &ustats))
+		goto out;
+
+	pkgconf_client_t *client = pkgconf_client_new(NULL, NULL, pers, NULL, environ_lookup_handler);
+	if (client == NULL)
+		goto out;
+
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_NO_UNINSTALLED | PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS);
+	pkgconf_path_add(dir, &client->dir_list, false);
+
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+	pkgconf_list_t pkgq = PKGCONF_LIST_INITIALIZER;
+
+	/* every package is queried, so the number of roots grows with n and building the
+	 * world's own dependency list is measured as well as the solve below it */
+	for (unsigned long i = 0; i < packages; i++, roots++)
+	{
+		universe_package_name(root, sizeof root, i);
+		pkgconf_queue_push(&pkgq, root);
+	}
+
+	if (pkgconf_queue_solve(client, &pkgq, &world, COMPLEXITY_MAXDEPTH))
+	{
+		pkgconf_list_t cflags = PKGCONF_LIST_INITIALIZER;
+		pkgconf_list_t libs = PKGCONF_LIST_INITIALIZER;
+
+		pkgconf_pkg_cflags(client, &world, &cflags, COMPLEXITY_MAXDEPTH);
+		pkgconf_pkg_libs(client, &world, &libs, COMPLEXITY_MAXDEPTH);
+
+		pkgconf_fragment_free(&cflags);
+		pkgconf_fragment_free(&libs);
+		ok = true;
+	}
+
+	pkgconf_solution_free(client, &world);
+	pkgconf_queue_free(&pkgq);
+
+	/* tearing the cache down is part of the work, so count it before the client goes */
+	pkgconf_cache_free(client);
+
+	sample->n = (double) (roots + ustats.packages + ustats.requires + ustats.requires_shared + ustats.requires_private + ustats.cycles +
+		ustats.packages * (params.cflags + params.libs + params.provides));
+	sample->ops = 0;
+
+	for (size_t i = 0; i < COMPLEXITY_COUNTER_COUNT; i++)
+	{
+		sample->counters[i] = client->stats.counters[complexity_counters[i]];
+		sample->ops += sample->counters[i];
+	}
+
+	pkgconf_client_free(client);
+
+out:
+	cleanup_universe(dir, packages);
+	return ok;
+}
+
+/* n * floor(log2 n), which is close enough given the slack and needs no libm */
+static double
+nlogn(double n)
+{
+	double log = 0.0;
+
+	for (double m = n; m >= 2.0; m /= 2.0)
+		log += 1.0;
+
+	return n * log;
+}
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	universe_params_t params = UNIVERSE_PARAMS_DEFAULT;
+	complexity_sample_t samples[COMPLEXITY_SIZE_COUNT];
+	pkgconf_cross_personality_t *pers;
+	double c;
+
+	params.seed = 0;
+	decode_params(&params, data, size);
+
+	pers = pkgconf_cross_personality_default();
+
+	for (size_t i = 0; i < COMPLEXITY_SIZE_COUNT; i++)
+	{
+		if (!run_solve(pers, &params, complexity_sizes[i], &samples[i]))
+			goto out;
+	}
+
+	c = (double) samples[0].ops / nlogn(samples[0].n);
+
+	for (size_t i = 1; i < COMPLEXITY_SIZE_COUNT; i++)
+	{
+		double budget = COMPLEXITY_SLACK * c * nlogn(samples[i].n);
+
+		if ((double) samples[i].ops <= budget)
+			continue;
+
+		fprintf(stderr, "complexity-fuzzer: %lu packages (n = %.0f) took %" PRIu64 " operations, over the budget of %.0f\n",
+			complexity_sizes[i], samples[i].n, samples[i].ops, budget);
+
+		for (size_t j = 0; j < COMPLEXITY_COUNTER_COUNT; j++)
+			fprintf(stderr, "  %-20s %12" PRIu64 " (%" PRIu64 " at n = %.0f)\n",
+				pkgconf_stats_counter_name(complexity_counters[j]),
+				samples[i].counters[j], samples[0].counters[j], samples[0].n);
+
+		abort();
+	}
+
+out:
+	pkgconf_cross_personality_deinit(pers);
+	return 0;
+}
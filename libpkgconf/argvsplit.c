@@ -49,39 +49,39 @@ pkgconf_argv_free(char **argv)
 }
 
 /*
- * Walk `src`, breaking it at whitespace which is neither quoted nor escaped.
+ * !doc
+ *
+ * .. c:function:: int pkgconf_argv_tokenize(const char *src, char *dst, bool raw, int *argc)
+ *
+ *    Walks *src*, breaking it at whitespace which is neither quoted nor escaped, and writes the
+ *    arguments to *dst* one after another, each followed by a NUL byte.  This is the tokenizer
+ *    behind :c:func:`pkgconf_argv_split`, for callers which want to walk the arguments without
+ *    an argument vector being allocated for them.
  *
- * When `raw` is set, the quoting and escaping is only read to find those breaks:
- * the quotes and backslashes are copied into the argument along with everything
- * else, leaving it spelled exactly as it was written.  Otherwise they are
- * consumed, as a shell would consume them.
+ *    When *raw* is set, the quoting and escaping is only read to find those breaks: the quotes
+ *    and backslashes are copied into the argument along with everything else, leaving it spelled
+ *    exactly as it was written.  Otherwise they are consumed, as a shell would consume them.
+ *
+ *    *dst* must have room for ``strlen(src) + 1`` bytes.  Writing never gets ahead of reading, so
+ *    it may be the storage *src* points into, to split a string in place.
+ *
+ *    :param char* src: The string to split.
+ *    :param char* dst: Where to write the arguments.
+ *    :param bool raw: Whether to leave the quoting and escaping in the arguments.
+ *    :param int* argc: A pointer to an integer to store the argument count.
+ *    :return: 0 on success, -1 if a quote or escape is left open.
+ *    :rtype: int
  */
-static int
-argv_split(const char *src, int *argc, char ***argv, bool raw)
+int
+pkgconf_argv_tokenize(const char *src, char *dst, bool raw, int *argc)
 {
-	char *buf = calloc(1, strlen(src) + 1);
-	if (buf == NULL)
-		return -1;
-
-	const char *src_iter;
-	char *dst_iter;
+	const char *src_iter = src;
+	char *dst_iter = dst;
+	char *arg = dst;
 	int argc_count = 0;
-	int argv_size = 5;
 	char quote = 0;
 	bool escaped = false;
 
-	src_iter = src;
-	dst_iter = buf;
-
-	*argv = calloc(argv_size, sizeof (void *));
-	if (*argv == NULL)
-	{
-		free(buf);
-		return -1;
-	}
-
-	(*argv)[argc_count] = dst_iter;
-
 	while (*src_iter)
 	{
 		if (escaped)
@@ -122,29 +122,11 @@ argv_split(const char *src, int *argc, char ***argv, bool raw)
 		}
 		else if (isspace((unsigned char)*src_iter))
 		{
-			if ((*argv)[argc_count] != NULL)
-			{
-				argc_count++, dst_iter++;
-
-				if (argc_count == argv_size)
-				{
-					char **new_argv;
-
-					argv_size += 5;
-					new_argv = pkgconf_reallocarray(*argv, argv_size, sizeof(void *));
-					if (new_argv == NULL)
-					{
-						free(*argv);
-						free(buf);
-						*argv = NULL;
-						return -1;
-					}
-
-					*argv = new_argv;
-				}
-
-				(*argv)[argc_count] = dst_iter;
-			}
+			/* every such byte ends an argument, so a run of them leaves empty ones */
+			*dst_iter++ = '\0';
+			argc_count++;
+
+			arg = dst_iter;
 		}
 		else switch(*src_iter)
 		{
@@ -172,16 +154,50 @@ argv_split(const char *src, int *argc, char ***argv, bool raw)
 	}
 
 	if (escaped || quote)
+		return -1;
+
+	*dst_iter = '\0';
+
+	/* the last argument only counts if it is not empty */
+	if (dst_iter > arg)
+		argc_count++;
+
+	*argc = argc_count;
+	return 0;
+}
+
+static int
+argv_split(const char *src, int *argc, char ***argv, bool raw)
+{
+	char *buf = malloc(strlen(src) + 1);
+	char *arg;
+	int argc_count;
+
+	if (buf == NULL)
+		return -1;
+
+	if (pkgconf_argv_tokenize(src, buf, raw, &argc_count) < 0)
 	{
-		free(*argv);
 		free(buf);
 		*argv = NULL;
 		return -1;
 	}
 
-	if (strlen((*argv)[argc_count]))
+	/* argv[0] always owns the arguments, even when there are none */
+	*argv = calloc((size_t) argc_count + 1, sizeof (void *));
+	if (*argv == NULL)
 	{
-		argc_count++;
+		free(buf);
+		return -1;
+	}
+
+	(*argv)[0] = buf;
+
+	arg = buf;
+	for (int i = 0; i < argc_count; i++)
+	{
+		(*argv)[i] = arg;
+		arg += strlen(arg) + 1;
 	}
 
 	*argc = argc_count;
@@ -18,6 +18,14 @@
 #include <libpkgconf/stdinc.h>
 #include <libpkgconf/libpkgconf.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+# endif
+# define HAVE_CHARSET_SSE2
+#endif
+
 /*
  * !doc
  *
@@ -184,6 +192,37 @@ pkgconf_buffer_append_slice(pkgconf_buffer_t *buf, const char *p, size_t n)
 	return true;
 }
 
+/*
+ * !doc
+ *
+ * .. c:function:: char *pkgconf_buffer_extend(pkgconf_buffer_t *buf, size_t n)
+ *
+ *    Grow the buffer by *n* bytes with at most one reallocation, and return a pointer to
+ *    the new bytes for the caller to fill in.  The buffer is NUL-terminated after them.
+ *    Callers which know the exact size of what they are about to append can use this
+ *    instead of appending piece by piece.
+ *
+ *    :param pkgconf_buffer_t *buf: The buffer to grow.
+ *    :param size_t n: Number of bytes to add.
+ *    :return: A pointer to the *n* uninitialized bytes, or :code:`NULL` on allocation failure.
+ */
+char *
+pkgconf_buffer_extend(pkgconf_buffer_t *buf, size_t n)
+{
+	size_t len = pkgconf_buffer_len(buf);
+
+	if (len > SIZE_MAX - n)
+		return NULL;
+
+	if (!buffer_reserve(buf, len + n))
+		return NULL;
+
+	buf->end = buf->base + len + n;
+	*buf->end = '\0';
+
+	return buf->base + len;
+}
+
 /*
  * !doc
  *
@@ -678,6 +717,126 @@ pkgconf_charset_from_spans(pkgconf_charset_t *charset, const pkgconf_span_t *spa
 
 		charset->words[whi] |= mhi;
 	}
+
+	/* record the runs of members, unless there are too many for a block scan to be worth it */
+	for (unsigned int c = 0; c < 256; c++)
+	{
+		if (!pkgconf_charset_contains(charset, (unsigned char) c))
+			continue;
+
+		if (charset->nranges == PKGCONF_CHARSET_MAX_RANGES)
+		{
+			charset->nranges = 0;
+			break;
+		}
+
+		charset->range_lo[charset->nranges] = (unsigned char) c;
+		while (c < 255 && pkgconf_charset_contains(charset, (unsigned char) (c + 1)))
+			c++;
+		charset->range_hi[charset->nranges++] = (unsigned char) c;
+	}
+}
+
+#ifdef HAVE_CHARSET_SSE2
+static inline unsigned int
+lowest_set_bit(unsigned int mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+
+	_BitScanForward(&index, mask);
+	return (unsigned int) index;
+#else
+	return (unsigned int) __builtin_ctz(mask);
+#endif
+}
+
+/*
+ * Test 16 bytes at a time against each range: subtracting the range's low
+ * end maps its members onto 0 .. hi - lo, and an unsigned minimum against
+ * hi - lo leaves exactly those bytes unchanged.  Only whole blocks are
+ * loaded, so nothing past p + n is read; the tail is left to the caller.
+ */
+static size_t
+charset_scan_sse2(const pkgconf_charset_t *charset, const char *p, size_t n)
+{
+	__m128i lo[PKGCONF_CHARSET_MAX_RANGES], width[PKGCONF_CHARSET_MAX_RANGES];
+	size_t i;
+
+	for (unsigned int r = 0; r < charset->nranges; r++)
+	{
+		lo[r] = _mm_set1_epi8((char) charset->range_lo[r]);
+		width[r] = _mm_set1_epi8((char) (charset->range_hi[r] - charset->range_lo[r]));
+	}
+
+	for (i = 0; i + 16 <= n; i += 16)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i *) (const void *) (p + i));
+		__m128i hits = _mm_setzero_si128();
+
+		for (unsigned int r = 0; r < charset->nranges; r++)
+		{
+			__m128i t = _mm_sub_epi8(block, lo[r]);
+
+			hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_min_epu8(t, width[r]), t));
+		}
+
+		unsigned int mask = (unsigned int) _mm_movemask_epi8(hits);
+		if (mask != 0)
+			return i + lowest_set_bit(mask);
+	}
+
+	return i;
+}
+#endif
+
+/*
+ * !doc
+ *
+ * .. c:function:: size_t pkgconf_charset_scan(const pkgconf_charset_t *charset, const char *p, size_t n)
+ *
+ *    Find the first of the *n* bytes at *p* which is a member of *charset*.  Where the
+ *    compiler targets SSE2 and the set was built by :c:func:`pkgconf_charset_from_spans`,
+ *    the bytes after the first block are tested a block at a time; otherwise, one at a
+ *    time against the map.
+ *
+ *    :param pkgconf_charset_t *charset: The set of bytes to look for.
+ *    :param char *p: The bytes to scan, which need not be NUL-terminated.
+ *    :param size_t n: The number of bytes to scan.
+ *    :return: the offset of the first member, or *n* if there is none.
+ */
+size_t
+pkgconf_charset_scan(const pkgconf_charset_t *charset, const char *p, size_t n)
+{
+	size_t i = 0;
+
+#ifdef HAVE_CHARSET_SSE2
+	/*
+	 * Where members are dense, the next one is usually close enough that
+	 * setting up the block scan costs more than it saves, so look through
+	 * the first block a byte at a time.
+	 */
+	if (charset->nranges != 0 && n >= 32)
+	{
+		for (; i < 16; i++)
+		{
+			if (pkgconf_charset_contains(charset, (unsigned char) p[i]))
+				return i;
+		}
+
+		i += charset_scan_sse2(charset, p + i, n - i);
+		if (i + 16 <= n)
+			return i;
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		if (pkgconf_charset_contains(charset, (unsigned char) p[i]))
+			return i;
+	}
+
+	return n;
 }
 
 /*
@@ -698,6 +857,7 @@ bool
 pkgconf_buffer_escape_charset(pkgconf_buffer_t *dest, const pkgconf_buffer_t *src, const pkgconf_charset_t *charset)
 {
 	const char *p = pkgconf_buffer_str(src);
+	const char *end = p + pkgconf_buffer_len(src);
 	const char *run = p;
 
 	if (dest == src ||
@@ -707,22 +867,20 @@ pkgconf_buffer_escape_charset(pkgconf_buffer_t *dest, const pkgconf_buffer_t *sr
 	if (!pkgconf_buffer_len(src))
 		return true;
 
-	for (; *p; p++)
+	/* copy each run up to the next byte needing a backslash in one go; that byte starts the next run */
+	for (;;)
 	{
-		if (!pkgconf_charset_contains(charset, (unsigned char) *p))
-			continue;
+		p += pkgconf_charset_scan(charset, p, (size_t) (end - p));
 
 		if (p > run && !pkgconf_buffer_append_slice(dest, run, (size_t) (p - run)))
 			return false;
 
+		if (p == end)
+			return true;
+
 		if (!pkgconf_buffer_push_byte(dest, '\\'))
 			return false;
 
-		run = p;
+		run = p++;
 	}
-
-	if (p > run)
-		return pkgconf_buffer_append_slice(dest, run, (size_t) (p - run));
-
-	return true;
 }
@@ -176,6 +176,8 @@ pkgconf_bytecode_eval_internal(pkgconf_bytecode_eval_ctx_t *ctx, const pkgconf_b
 		if (!pkgconf_bytecode_read_op(p, remaining, &op, &op_size))
 			return false;
 
+		PKGCONF_STATS_INC(ctx->client, PKGCONF_STATS_BYTECODE_OPS);
+
 		switch (op->tag)
 		{
 		case PKGCONF_BYTECODE_OP_TEXT:
@@ -320,14 +322,38 @@ pkgconf_bytecode_from_buffer(pkgconf_bytecode_t *bc, const pkgconf_buffer_t *buf
 	bc->len = buf->base != NULL ? (size_t)(buf->end - buf->base) : 0;
 }
 
-bool
-pkgconf_bytecode_compile(pkgconf_buffer_t *out, const char *value)
+/*
+ * Append a copy of the first `len` bytes of `out` to `out`.  This is how a
+ * self-reference is spliced: the bytes are the variable's previous bytecode,
+ * which the new bytecode is being built after.
+ */
+static bool
+pkgconf_bytecode_append_prefix(pkgconf_buffer_t *out, size_t len)
 {
-	const char *p, *text_start;
+	char *dst;
 
-	if (out == NULL || value == NULL)
+	if (len == 0)
+		return true;
+
+	dst = pkgconf_buffer_extend(out, len);
+	if (dst == NULL)
 		return false;
 
+	memcpy(dst, out->base, len);
+	return true;
+}
+
+/*
+ * Compile `value`, appending the ops to `out`.  When `key` is not NULL, a
+ * reference to it is not emitted as such, but replaced with the first
+ * `prev_len` bytes of `out`.
+ */
+static bool
+pkgconf_bytecode_compile_internal(pkgconf_buffer_t *out, const char *value, const char *key, size_t prev_len)
+{
+	const char *p, *text_start;
+	size_t klen = key != NULL ? strlen(key) : 0;
+
 	p = value;
 	text_start = value;
 
@@ -395,6 +421,11 @@ pkgconf_bytecode_compile(pkgconf_buffer_t *out, const char *value)
 			if (!pkgconf_bytecode_emit_sysroot(out))
 				return false;
 		}
+		else if (key != NULL && nlen == klen && !memcmp(name, key, klen))
+		{
+			if (!pkgconf_bytecode_append_prefix(out, prev_len))
+				return false;
+		}
 		else
 		{
 			if (!pkgconf_bytecode_emit_var(out, name, nlen))
@@ -414,6 +445,57 @@ pkgconf_bytecode_compile(pkgconf_buffer_t *out, const char *value)
 	return true;
 }
 
+bool
+pkgconf_bytecode_compile(pkgconf_buffer_t *out, const char *value)
+{
+	if (out == NULL || value == NULL)
+		return false;
+
+	return pkgconf_bytecode_compile_internal(out, value, NULL, 0);
+}
+
+/*
+ * Compile `value` into `bcbuf`, replacing what it held.  References to `key`
+ * take the bytecode `bcbuf` held before, which is what ``var=${var}/foo``
+ * means.
+ *
+ * This is done in one pass over `value`, and in `bcbuf` alone: the new
+ * bytecode is built after the old one, so a reference to `key` is a copy from
+ * the front of the same buffer, and it is moved down over the old bytecode
+ * once complete.  On failure, `bcbuf` is left holding the old bytecode.
+ */
+bool
+pkgconf_bytecode_compile_selfref(pkgconf_buffer_t *bcbuf, const char *value, const char *key)
+{
+	size_t prev_len, new_len;
+
+	if (bcbuf == NULL || value == NULL || key == NULL)
+		return false;
+
+	prev_len = pkgconf_buffer_len(bcbuf);
+
+	if (!pkgconf_bytecode_compile_internal(bcbuf, value, key, prev_len))
+	{
+		if (bcbuf->base != NULL)
+		{
+			bcbuf->end = bcbuf->base + prev_len;
+			*bcbuf->end = '\0';
+		}
+
+		return false;
+	}
+
+	if (prev_len == 0)
+		return true;
+
+	new_len = pkgconf_buffer_len(bcbuf) - prev_len;
+	memmove(bcbuf->base, bcbuf->base + prev_len, new_len);
+	bcbuf->end = bcbuf->base + new_len;
+	*bcbuf->end = '\0';
+
+	return true;
+}
+
 bool
 pkgconf_bytecode_eval_str_to_buf(const pkgconf_client_t *client, const pkgconf_list_t *vars, const char *input, bool *saw_sysroot, pkgconf_buffer_t *out)
 {
@@ -92,10 +92,12 @@ pkgconf_cache_lookup(pkgconf_client_t *client, const char *id)
 	if (pkg != NULL)
 	{
 		PKGCONF_TRACE(client, "found: %s @%p", id, pkg);
+		PKGCONF_STATS_INC(client, PKGCONF_STATS_CACHE_HITS);
 		return pkgconf_pkg_ref(client, pkg);
 	}
 
 	PKGCONF_TRACE(client, "miss: %s", id);
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_CACHE_MISSES);
 	return NULL;
 }
 
@@ -138,6 +140,7 @@ pkgconf_cache_add(pkgconf_client_t *client, pkgconf_pkg_t *pkg)
 		return;
 	}
 	cache_index_store(client, &index);
+	PKGCONF_STATS_ADD(client, PKGCONF_STATS_INDEX_SHIFTS, index.shifted);
 
 	PKGCONF_TRACE(client, "added @%p to cache", pkg);
 }
@@ -180,6 +183,7 @@ pkgconf_cache_remove(pkgconf_client_t *client, pkgconf_pkg_t *pkg)
 	 * freeing a package can re-enter pkgconf_cache_remove(). */
 	pkgconf_index_remove(&index, found);
 	cache_index_store(client, &index);
+	PKGCONF_STATS_ADD(client, PKGCONF_STATS_INDEX_SHIFTS, index.shifted);
 
 	if (client->cache_count == 0)
 	{
@@ -204,15 +208,29 @@ pkgconf_cache_remove(pkgconf_client_t *client, pkgconf_pkg_t *pkg)
 void
 pkgconf_cache_free(pkgconf_client_t *client)
 {
-	if (client->cache_table == NULL)
-		return;
+	pkgconf_pkg_t **table = client->cache_table;
+	size_t count = client->cache_count;
 
-	while (client->cache_count > 0)
-		pkgconf_cache_remove(client, client->cache_table[0]);
+	if (table == NULL)
+		return;
 
-	free(client->cache_table);
+	/* Detach the table first, so that packages freed below find nothing to
+	 * remove themselves from.  The entries are then released in table order,
+	 * as the cache always has been: a package freed here still finds the
+	 * packages after it held by the cache, so a long dependency chain is
+	 * freed one package at a time.  Releasing the head of the chain last
+	 * would free the whole chain from a single unref, recursively.
+	 */
 	client->cache_table = NULL;
 	client->cache_count = 0;
 
+	for (size_t i = 0; i < count; i++)
+	{
+		table[i]->flags &= ~PKGCONF_PKG_PROPF_CACHED;
+		pkgconf_pkg_unref(client, table[i]);
+	}
+
+	free(table);
+
 	PKGCONF_TRACE(client, "cleared package cache");
 }
@@ -292,6 +292,7 @@ pkgconf_client_deinit(pkgconf_client_t *client)
 	pkgconf_cache_free(client);
 
 	pkgconf_buffer_finalize(&client->_scratch_buffer);
+	pkgconf_stack_free(&client->_traverse_stack);
 
 	memset(client, '\0', sizeof(*client));
 }
@@ -571,6 +572,235 @@ pkgconf_trace(const pkgconf_client_t *client, const char *filename, size_t linen
 	return ret;
 }
 
+static bool
+trace_event_append_string(pkgconf_buffer_t *buf, const char *str)
+{
+	if (!pkgconf_buffer_push_byte(buf, '"'))
+		return false;
+
+	for (const unsigned char *p = (const unsigned char *) str; *p != '\0'; p++)
+	{
+		bool ok;
+
+		if (*p == '"' || *p == '\\')
+			ok = pkgconf_buffer_push_byte(buf, '\\') && pkgconf_buffer_push_byte(buf, (char) *p);
+		else if (*p < 0x20)
+			ok = pkgconf_buffer_append_fmt(buf, "\\u%04x", *p);
+		else
+			ok = pkgconf_buffer_push_byte(buf, (char) *p);
+
+		if (!ok)
+			return false;
+	}
+
+	return pkgconf_buffer_push_byte(buf, '"');
+}
+
+static void
+trace_event_write(const pkgconf_client_t *client, char type, const char *name, const char *argname, const char *argvalue)
+{
+	pkgconf_client_t *mutable_client = (pkgconf_client_t *) client;
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+	uint64_t ts = pkgconf_stats_now() - client->trace_events_epoch;
+	bool ok;
+
+	/* timestamps are in microseconds, relative to when the trace was started */
+	ok = pkgconf_buffer_append_fmt(&buf, "%s{\"name\":", client->trace_events_count != 0 ? ",\n" : "") &&
+		trace_event_append_string(&buf, name) &&
+		pkgconf_buffer_append_fmt(&buf, ",\"cat\":\"pkgconf\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":1",
+			type, (unsigned long long) (ts / 1000), (unsigned int) (ts % 1000));
+
+	if (ok && argname != NULL && argvalue != NULL)
+		ok = pkgconf_buffer_append(&buf, ",\"args\":{") &&
+			trace_event_append_string(&buf, argname) &&
+			pkgconf_buffer_push_byte(&buf, ':') &&
+			trace_event_append_string(&buf, argvalue) &&
+			pkgconf_buffer_push_byte(&buf, '}');
+
+	if (ok && pkgconf_buffer_push_byte(&buf, '}'))
+	{
+		fwrite(pkgconf_buffer_str(&buf), 1, pkgconf_buffer_len(&buf), client->trace_eventsf);
+		mutable_client->trace_events_count++;
+	}
+
+	pkgconf_buffer_finalize(&buf);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_trace_event_begin(const pkgconf_client_t *client, const char *name, const char *argname, const char *argvalue)
+ *
+ *    Opens a span in the client's trace event file, if one is set.  Spans must be closed with
+ *    ``pkgconf_trace_event_end()`` in the reverse order they were opened.  Callers normally use
+ *    the ``PKGCONF_TRACE_EVENT_BEGIN()`` macro, which skips the call when tracing is disabled.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to trace.
+ *    :param char* name: The name of the span.
+ *    :param char* argname: The name of an argument to attach to the span, or ``NULL``.
+ *    :param char* argvalue: The value of the argument, or ``NULL``.
+ *    :return: nothing
+ */
+void
+pkgconf_trace_event_begin(const pkgconf_client_t *client, const char *name, const char *argname, const char *argvalue)
+{
+	if (client == NULL || client->trace_eventsf == NULL)
+		return;
+
+	trace_event_write(client, 'B', name, argname, argvalue);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_trace_event_end(const pkgconf_client_t *client, const char *name)
+ *
+ *    Closes the span most recently opened with ``pkgconf_trace_event_begin()``.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to trace.
+ *    :param char* name: The name of the span.
+ *    :return: nothing
+ */
+void
+pkgconf_trace_event_end(const pkgconf_client_t *client, const char *name)
+{
+	if (client == NULL || client->trace_eventsf == NULL)
+		return;
+
+	trace_event_write(client, 'E', name, NULL, NULL);
+}
+
+static const char *profile_phase_names[PKGCONF_PROFILE_PHASE_COUNT] = {
+	[PKGCONF_PROFILE_PHASE_SEARCH] = "search",
+	[PKGCONF_PROFILE_PHASE_PARSE] = "parse",
+	[PKGCONF_PROFILE_PHASE_TRAVERSE] = "traverse",
+	[PKGCONF_PROFILE_PHASE_SOLVE] = "solve",
+	[PKGCONF_PROFILE_PHASE_FLATTEN] = "flatten",
+	[PKGCONF_PROFILE_PHASE_COLLECT] = "collect",
+	[PKGCONF_PROFILE_PHASE_RENDER] = "render",
+};
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_profile_event(const pkgconf_client_t *client, pkgconf_profile_event_type_t type, pkgconf_profile_phase_t phase, const pkgconf_pkg_t *pkg)
+ *
+ *    Reports an event to the client-registered profile handler, if any.  Callers normally
+ *    use the ``PKGCONF_PROFILE_BEGIN()`` and ``PKGCONF_PROFILE_END()`` macros, which skip
+ *    the call when no handler is installed.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to report the event to.
+ *    :param pkgconf_profile_event_type_t type: Whether the phase is beginning or ending.
+ *    :param pkgconf_profile_phase_t phase: The phase.
+ *    :param pkgconf_pkg_t* pkg: The package the phase works on, or ``NULL``.
+ *    :return: nothing
+ */
+void
+pkgconf_profile_event(const pkgconf_client_t *client, pkgconf_profile_event_type_t type, pkgconf_profile_phase_t phase, const pkgconf_pkg_t *pkg)
+{
+	pkgconf_profile_event_t event;
+
+	if (client == NULL || client->profile_handler == NULL)
+		return;
+
+	event.type = type;
+	event.phase = phase;
+	event.pkg = pkg;
+	event.timestamp = pkgconf_stats_now();
+
+	client->profile_handler(client, &event, client->profile_handler_data);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: const char *pkgconf_profile_phase_name(pkgconf_profile_phase_t phase)
+ *
+ *    :param pkgconf_profile_phase_t phase: The phase to name.
+ *    :return: A short lowercase name for the phase, or ``NULL`` if it is out of range.
+ *    :rtype: const char *
+ */
+const char *
+pkgconf_profile_phase_name(pkgconf_profile_phase_t phase)
+{
+	if ((unsigned int) phase >= PKGCONF_PROFILE_PHASE_COUNT)
+		return NULL;
+
+	return profile_phase_names[phase];
+}
+
+/* the profile phase reported for each timed phase; PKGCONF_STATS_PHASE_NONE has none */
+static const pkgconf_profile_phase_t stats_profile_phases[PKGCONF_STATS_PHASE_COUNT] = {
+	[PKGCONF_STATS_PHASE_NONE] = PKGCONF_PROFILE_PHASE_COUNT,
+	[PKGCONF_STATS_PHASE_SEARCH] = PKGCONF_PROFILE_PHASE_SEARCH,
+	[PKGCONF_STATS_PHASE_PARSE] = PKGCONF_PROFILE_PHASE_PARSE,
+	[PKGCONF_STATS_PHASE_SOLVE] = PKGCONF_PROFILE_PHASE_SOLVE,
+	[PKGCONF_STATS_PHASE_FLATTEN] = PKGCONF_PROFILE_PHASE_FLATTEN,
+	[PKGCONF_STATS_PHASE_COLLECT] = PKGCONF_PROFILE_PHASE_COLLECT,
+	[PKGCONF_STATS_PHASE_RENDER] = PKGCONF_PROFILE_PHASE_RENDER,
+};
+
+/*
+ * !doc
+ *
+ * .. c:function:: pkgconf_phase_t pkgconf_phase_begin(const pkgconf_client_t *client, pkgconf_stats_phase_t phase, const char *name, const char *argname, const char *argvalue, const pkgconf_pkg_t *pkg)
+ *
+ *    Enters `phase`: it is charged in the client's statistics, opened as a span in the
+ *    client's trace event file and reported to the client's profile handler, as each of
+ *    them is enabled.  The returned phase must be passed to the matching
+ *    ``pkgconf_phase_end()``.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object the phase runs in.
+ *    :param pkgconf_stats_phase_t phase: The phase being entered.
+ *    :param char* name: The name of the trace event span, or ``NULL`` to open none.
+ *    :param char* argname: The name of an argument to attach to the span, or ``NULL``.
+ *    :param char* argvalue: The value of the argument, or ``NULL``.
+ *    :param pkgconf_pkg_t* pkg: The package the phase works on, or ``NULL``.
+ *    :return: The phase that was entered.
+ *    :rtype: pkgconf_phase_t
+ */
+pkgconf_phase_t
+pkgconf_phase_begin(const pkgconf_client_t *client, pkgconf_stats_phase_t phase, const char *name, const char *argname, const char *argvalue, const pkgconf_pkg_t *pkg)
+{
+	pkgconf_phase_t entered = {
+		.phase = phase,
+		.previous = pkgconf_stats_phase_begin(client, phase),
+		.name = name,
+	};
+
+	if (client->profile_handler != NULL && stats_profile_phases[phase] != PKGCONF_PROFILE_PHASE_COUNT)
+		pkgconf_profile_event(client, PKGCONF_PROFILE_EVENT_BEGIN, stats_profile_phases[phase], pkg);
+
+	if (client->trace_eventsf != NULL && name != NULL)
+		pkgconf_trace_event_begin(client, name, argname, argvalue);
+
+	return entered;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_phase_end(const pkgconf_client_t *client, const pkgconf_phase_t *phase, const pkgconf_pkg_t *pkg)
+ *
+ *    Leaves a phase entered with ``pkgconf_phase_begin()``, in the reverse order of entering.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object the phase runs in.
+ *    :param pkgconf_phase_t* phase: The phase returned by ``pkgconf_phase_begin()``.
+ *    :param pkgconf_pkg_t* pkg: The package the phase worked on or produced, or ``NULL``.
+ *    :return: nothing
+ */
+void
+pkgconf_phase_end(const pkgconf_client_t *client, const pkgconf_phase_t *phase, const pkgconf_pkg_t *pkg)
+{
+	if (client->trace_eventsf != NULL && phase->name != NULL)
+		pkgconf_trace_event_end(client, phase->name);
+
+	if (client->profile_handler != NULL && stats_profile_phases[phase->phase] != PKGCONF_PROFILE_PHASE_COUNT)
+		pkgconf_profile_event(client, PKGCONF_PROFILE_EVENT_END, stats_profile_phases[phase->phase], pkg);
+
+	pkgconf_stats_phase_end(client, phase->previous);
+}
+
 /*
  * !doc
  *
@@ -837,8 +1067,102 @@ pkgconf_client_set_trace_handler(pkgconf_client_t *client, pkgconf_error_handler
 	client->trace_handler = trace_handler;
 	client->trace_handler_data = trace_handler_data;
 }
+
+/*
+ * !doc
+ *
+ * .. c:function:: FILE *pkgconf_client_get_trace_events(const pkgconf_client_t *client)
+ *
+ *    Returns the file trace events are written to if one is set, else ``NULL``.
+ *
+ *    :param pkgconf_client_t* client: The client object to get the trace event file from.
+ *    :return: the trace event file or ``NULL``
+ *    :rtype: FILE *
+ */
+FILE *
+pkgconf_client_get_trace_events(const pkgconf_client_t *client)
+{
+	return client->trace_eventsf;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_client_set_trace_events(pkgconf_client_t *client, FILE *trace_eventsf)
+ *
+ *    Sets the file that spans for the phases of a query are written to, in the JSON array
+ *    flavour of the Chrome trace event format understood by ``chrome://tracing`` and Perfetto.
+ *    The opening bracket is written immediately and the closing bracket is written to the
+ *    previous file, if any, when it is replaced, so tracing is finished by setting ``NULL``.
+ *    The caller is responsible for closing the files.
+ *
+ *    :param pkgconf_client_t* client: The client object to modify.
+ *    :param FILE* trace_eventsf: The file pointer for the already open trace event file, or ``NULL``.
+ *    :return: nothing
+ */
+void
+pkgconf_client_set_trace_events(pkgconf_client_t *client, FILE *trace_eventsf)
+{
+	if (client->trace_eventsf != NULL)
+	{
+		fputs("\n]\n", client->trace_eventsf);
+		fflush(client->trace_eventsf);
+	}
+
+	client->trace_eventsf = trace_eventsf;
+	client->trace_events_count = 0;
+
+	if (trace_eventsf != NULL)
+	{
+		client->trace_events_epoch = pkgconf_stats_now();
+		fputs("[\n", trace_eventsf);
+	}
+}
 #endif
 
+/*
+ * !doc
+ *
+ * .. c:function:: pkgconf_profile_handler_func_t pkgconf_client_get_profile_handler(const pkgconf_client_t *client)
+ *
+ *    Returns the profile handler if one is set, else ``NULL``.
+ *
+ *    :param pkgconf_client_t* client: The client object to get the profile handler from.
+ *    :return: a function pointer to the profile handler or ``NULL``
+ */
+pkgconf_profile_handler_func_t
+pkgconf_client_get_profile_handler(const pkgconf_client_t *client)
+{
+	return client->profile_handler;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_client_set_profile_handler(pkgconf_client_t *client, pkgconf_profile_handler_func_t profile_handler, void *profile_handler_data)
+ *
+ *    Sets a profile handler on a client object or uninstalls one if set to ``NULL``.
+ *
+ *    The handler receives a ``pkgconf_profile_event_t`` when the client begins and ends
+ *    searching for a package, parsing a .pc file, traversing a dependency graph, solving and
+ *    flattening a query, collecting fragments and (from the pkgconf CLI) rendering them.
+ *    Events nest, and each carries a timestamp from ``pkgconf_stats_now()`` and the package
+ *    the phase works on: the root of a traversal or collection pass, the world being solved,
+ *    or, on the end event of a search or parse, the package found (which may be ``NULL``).
+ *    When no handler is installed, each event costs a single branch.
+ *
+ *    :param pkgconf_client_t* client: The client object to set the profile handler on.
+ *    :param pkgconf_profile_handler_func_t profile_handler: The profile handler to set.
+ *    :param void* profile_handler_data: Optional data to associate with the profile handler.
+ *    :return: nothing
+ */
+void
+pkgconf_client_set_profile_handler(pkgconf_client_t *client, pkgconf_profile_handler_func_t profile_handler, void *profile_handler_data)
+{
+	client->profile_handler = profile_handler;
+	client->profile_handler_data = profile_handler_data;
+}
+
 /*
  * !doc
  *
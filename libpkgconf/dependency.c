@@ -53,16 +53,136 @@ dependency_to_buf(const pkgconf_dependency_t *dep, pkgconf_buffer_t *buf)
 	return pkgconf_buffer_str(buf);
 }
 
-/* find a colliding dependency that is coloured differently */
+/* FNV-1a over the package name */
+static size_t
+dependency_name_hash(const char *package)
+{
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+	for (const char *p = package; *p != '\0'; p++)
+		hash = (hash ^ (unsigned char) *p) * UINT64_C(0x100000001b3);
+
+	return (size_t) hash;
+}
+
+/* Marks a slot whose dependency has been removed from the list.  Probing continues
+ * past it, so that the entries behind it stay reachable. */
+static pkgconf_dependency_t dependency_cursor_tombstone;
+
+/* The cursor's open-addressed table may hold several dependencies with the same name
+ * (e.g. ``foo > 1, foo < 3``).  New entries only ever take the first empty slot on
+ * their probe sequence and removed ones are replaced by the tombstone, so walking the
+ * sequence visits the same-named dependencies in list order, as the linear scan does. */
+static void
+dependency_cursor_place(pkgconf_dependency_cursor_t *cursor, pkgconf_dependency_t *dep)
+{
+	size_t mask = cursor->alloc - 1;
+	size_t i = dependency_name_hash(dep->package) & mask;
+
+	while (cursor->slots[i] != NULL)
+		i = (i + 1) & mask;
+
+	cursor->slots[i] = dep;
+	cursor->count++;
+}
+
+/* Rebuilds the table from the list, which drops the tombstones. */
+static bool
+dependency_cursor_grow(pkgconf_dependency_cursor_t *cursor)
+{
+	size_t alloc = cursor->alloc != 0 ? cursor->alloc * 2 : 64;
+	pkgconf_dependency_t **slots;
+	const pkgconf_node_t *n;
+
+	while (cursor->list->length * 2 > alloc)
+		alloc *= 2;
+
+	slots = calloc(alloc, sizeof(*slots));
+	if (slots == NULL)
+		return false;
+
+	free(cursor->slots);
+	cursor->slots = slots;
+	cursor->alloc = alloc;
+	cursor->count = 0;
+
+	PKGCONF_FOREACH_LIST_ENTRY(cursor->list->head, n)
+		dependency_cursor_place(cursor, n->data);
+
+	return true;
+}
+
+/* Records `dep`, which has just been appended to the list.  If the table cannot
+ * grow, it is released and lookups fall back to scanning the list. */
+static void
+dependency_cursor_insert(pkgconf_dependency_cursor_t *cursor, pkgconf_dependency_t *dep)
+{
+	/* keep the table at most half full, so probe sequences stay short */
+	if ((cursor->count + 1) * 2 > cursor->alloc)
+	{
+		/* the rebuild picks up `dep` from the list */
+		if (!dependency_cursor_grow(cursor))
+			pkgconf_dependency_cursor_deinit(cursor);
+
+		return;
+	}
+
+	dependency_cursor_place(cursor, dep);
+}
+
+static void
+dependency_cursor_remove(pkgconf_dependency_cursor_t *cursor, const pkgconf_dependency_t *dep)
+{
+	size_t mask = cursor->alloc - 1;
+	size_t i = dependency_name_hash(dep->package) & mask;
+
+	for (; cursor->slots[i] != NULL; i = (i + 1) & mask)
+	{
+		if (cursor->slots[i] == dep)
+		{
+			cursor->slots[i] = &dependency_cursor_tombstone;
+			return;
+		}
+	}
+}
+
+/* find a colliding dependency that is coloured differently: via the cursor's hash
+ * table when one is provided, otherwise a linear scan of the list. */
 static inline pkgconf_dependency_t *
-find_colliding_dependency(const pkgconf_dependency_t *dep, const pkgconf_list_t *list)
+find_colliding_dependency(pkgconf_client_t *client, const pkgconf_dependency_t *dep, const pkgconf_list_t *list, const pkgconf_dependency_cursor_t *cursor)
 {
 	const pkgconf_node_t *n;
 
+	if (cursor != NULL && cursor->alloc != 0)
+	{
+		size_t mask = cursor->alloc - 1;
+		size_t i = dependency_name_hash(dep->package) & mask;
+
+		for (; cursor->slots[i] != NULL; i = (i + 1) & mask)
+		{
+			pkgconf_dependency_t *dep2 = cursor->slots[i];
+
+			if (dep2 == &dependency_cursor_tombstone)
+				continue;
+
+			PKGCONF_STATS_INC(client, PKGCONF_STATS_DEPENDENCY_PROBES);
+
+			if (strcmp(dep->package, dep2->package))
+				continue;
+
+			if (dep->flags != dep2->flags)
+				return dep2;
+		}
+
+		return NULL;
+	}
+
 	PKGCONF_FOREACH_LIST_ENTRY(list->head, n)
 	{
 		pkgconf_dependency_t *dep2 = n->data;
 
+		PKGCONF_STATS_INC(client, PKGCONF_STATS_DEPENDENCY_PROBES);
+
 		if (strcmp(dep->package, dep2->package))
 			continue;
 
@@ -90,10 +210,10 @@ dependency_trace_str(const pkgconf_client_t *client, const pkgconf_dependency_t
 }
 
 static inline pkgconf_dependency_t *
-add_or_replace_dependency_node(pkgconf_client_t *client, pkgconf_dependency_t *dep, pkgconf_list_t *list)
+add_or_replace_dependency_node(pkgconf_client_t *client, pkgconf_dependency_t *dep, pkgconf_list_t *list, pkgconf_dependency_cursor_t *cursor)
 {
 	pkgconf_buffer_t depbuf = PKGCONF_BUFFER_INITIALIZER;
-	pkgconf_dependency_t *dep2 = find_colliding_dependency(dep, list);
+	pkgconf_dependency_t *dep2 = find_colliding_dependency(client, dep, list, cursor);
 	const char *depstr = dependency_trace_str(client, dep, &depbuf);
 
 	/* there is already a node in the graph which describes this dependency */
@@ -120,6 +240,9 @@ add_or_replace_dependency_node(pkgconf_client_t *client, pkgconf_dependency_t *d
 		{
 			PKGCONF_TRACE(client, "dropping dependency [%s]@%p because of collision", depstr2, dep2);
 
+			if (cursor != NULL && cursor->alloc != 0)
+				dependency_cursor_remove(cursor, dep2);
+
 			pkgconf_node_delete(&dep2->iter, list);
 			pkgconf_dependency_unref(dep2->owner, dep2);
 		}
@@ -138,6 +261,9 @@ add_or_replace_dependency_node(pkgconf_client_t *client, pkgconf_dependency_t *d
 	PKGCONF_TRACE(client, "added dependency [%s] to list @%p; flags=%x", depstr, list, dep->flags);
 	pkgconf_node_insert_tail(&dep->iter, pkgconf_dependency_ref(dep->owner, dep), list);
 
+	if (cursor != NULL)
+		dependency_cursor_insert(cursor, dep);
+
 	pkgconf_buffer_finalize(&depbuf);
 
 	/* This dependency is intentionally unowned.
@@ -151,7 +277,7 @@ add_or_replace_dependency_node(pkgconf_client_t *client, pkgconf_dependency_t *d
 }
 
 static inline pkgconf_dependency_t *
-pkgconf_dependency_addraw(pkgconf_client_t *client, pkgconf_list_t *list, const char *package, size_t package_sz, const char *version, size_t version_sz, pkgconf_pkg_comparator_t compare, unsigned int flags)
+pkgconf_dependency_addraw(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_dependency_cursor_t *cursor, const char *package, size_t package_sz, const char *version, size_t version_sz, pkgconf_pkg_comparator_t compare, unsigned int flags)
 {
 	pkgconf_dependency_t *dep;
 
@@ -181,7 +307,7 @@ pkgconf_dependency_addraw(pkgconf_client_t *client, pkgconf_list_t *list, const
 	dep->owner = client;
 	dep->refcount = 0;
 
-	return add_or_replace_dependency_node(client, dep, list);
+	return add_or_replace_dependency_node(client, dep, list, cursor);
 }
 
 /*
@@ -204,7 +330,7 @@ pkgconf_dependency_t *
 pkgconf_dependency_add(pkgconf_client_t *client, pkgconf_list_t *list, const char *package, const char *version, pkgconf_pkg_comparator_t compare, unsigned int flags)
 {
 	pkgconf_dependency_t *dep;
-	dep = pkgconf_dependency_addraw(client, list, package, strlen(package), version,
+	dep = pkgconf_dependency_addraw(client, list, NULL, package, strlen(package), version,
 					version != NULL ? strlen(version) : 0, compare, flags);
 	if (dep == NULL)
 		return NULL;
@@ -250,6 +376,8 @@ pkgconf_dependency_free_one(pkgconf_dependency_t *dep)
 	if (dep->version != NULL)
 		free(dep->version);
 
+	pkgconf_version_free(&dep->parsed_version);
+
 	if (dep->why != NULL)
 		free(dep->why);
 
@@ -328,23 +456,8 @@ pkgconf_dependency_free(pkgconf_list_t *list)
 	pkgconf_list_zero(list);
 }
 
-/*
- * !doc
- *
- * .. c:function:: void pkgconf_dependency_parse_str(pkgconf_list_t *deplist_head, const char *depends)
- *
- *    Parse a dependency declaration into a dependency list.
- *    Commas are counted as whitespace to allow for constructs such as ``@SUBSTVAR@, zlib`` being processed
- *    into ``, zlib``.
- *
- *    :param pkgconf_client_t* client: The client object that owns the package this dependency list belongs to.
- *    :param pkgconf_list_t* deplist_head: The dependency list to populate with dependency nodes.
- *    :param char* depends: The dependency data to parse.
- *    :param uint flags: Any flags to attach to the dependency nodes.
- *    :return: nothing
- */
-void
-pkgconf_dependency_parse_str(pkgconf_client_t *client, pkgconf_list_t *deplist_head, const char *depends, unsigned int flags)
+static void
+dependency_parse_str(pkgconf_client_t *client, pkgconf_list_t *deplist_head, pkgconf_dependency_cursor_t *cursor, const char *depends, unsigned int flags)
 {
 	parse_state_t state = OUTSIDE_MODULE;
 	pkgconf_pkg_comparator_t compare = PKGCONF_CMP_ANY;
@@ -417,7 +530,7 @@ pkgconf_dependency_parse_str(pkgconf_client_t *client, pkgconf_list_t *deplist_h
 
 			if (state == OUTSIDE_MODULE)
 			{
-				pkgconf_dependency_addraw(client, deplist_head, package, package_sz, NULL, 0, compare, flags);
+				pkgconf_dependency_addraw(client, deplist_head, cursor, package, package_sz, NULL, 0, compare, flags);
 
 				compare = PKGCONF_CMP_ANY;
 				package_sz = 0;
@@ -461,7 +574,7 @@ pkgconf_dependency_parse_str(pkgconf_client_t *client, pkgconf_list_t *deplist_h
 				version_sz = ptr - vstart;
 				state = OUTSIDE_MODULE;
 
-				pkgconf_dependency_addraw(client, deplist_head, package, package_sz, version, version_sz, compare, flags);
+				pkgconf_dependency_addraw(client, deplist_head, cursor, package, package_sz, version, version_sz, compare, flags);
 
 				compare = PKGCONF_CMP_ANY;
 				package_sz = 0;
@@ -482,6 +595,27 @@ out:
 	pkgconf_buffer_finalize(&buf);
 }
 
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_dependency_parse_str(pkgconf_list_t *deplist_head, const char *depends)
+ *
+ *    Parse a dependency declaration into a dependency list.
+ *    Commas are counted as whitespace to allow for constructs such as ``@SUBSTVAR@, zlib`` being processed
+ *    into ``, zlib``.
+ *
+ *    :param pkgconf_client_t* client: The client object that owns the package this dependency list belongs to.
+ *    :param pkgconf_list_t* deplist_head: The dependency list to populate with dependency nodes.
+ *    :param char* depends: The dependency data to parse.
+ *    :param uint flags: Any flags to attach to the dependency nodes.
+ *    :return: nothing
+ */
+void
+pkgconf_dependency_parse_str(pkgconf_client_t *client, pkgconf_list_t *deplist_head, const char *depends, unsigned int flags)
+{
+	dependency_parse_str(client, deplist_head, NULL, depends, flags);
+}
+
 /*
  * !doc
  *
@@ -507,6 +641,77 @@ pkgconf_dependency_parse(pkgconf_client_t *client, pkgconf_pkg_t *pkg, pkgconf_l
 	free(kvdepends);
 }
 
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_dependency_cursor_init(pkgconf_dependency_cursor_t *cursor, pkgconf_list_t *list)
+ *
+ *    Initialises a `dependency cursor` bound to a (typically empty) dependency list.  While the
+ *    cursor is in use, dependencies must be added to the list only via ``pkgconf_dependency_parse_cursor()``
+ *    so that the cursor's hash table stays in sync.
+ *
+ *    :param pkgconf_dependency_cursor_t* cursor: The cursor to initialise.
+ *    :param pkgconf_list_t* list: The dependency list.
+ *    :return: nothing
+ */
+void
+pkgconf_dependency_cursor_init(pkgconf_dependency_cursor_t *cursor, pkgconf_list_t *list)
+{
+	cursor->list = list;
+	cursor->slots = NULL;
+	cursor->count = 0;
+	cursor->alloc = 0;
+
+	/* seed the table with anything already present, so collisions with pre-existing
+	 * dependencies are found exactly as the linear scan would find them. */
+	if (list->head != NULL && !dependency_cursor_grow(cursor))
+		pkgconf_dependency_cursor_deinit(cursor);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_dependency_cursor_deinit(pkgconf_dependency_cursor_t *cursor)
+ *
+ *    Releases the hash table held by a `dependency cursor`.  The dependency list and its nodes are
+ *    left untouched.
+ *
+ *    :param pkgconf_dependency_cursor_t* cursor: The cursor to release.
+ *    :return: nothing
+ */
+void
+pkgconf_dependency_cursor_deinit(pkgconf_dependency_cursor_t *cursor)
+{
+	free(cursor->slots);
+	cursor->slots = NULL;
+	cursor->count = 0;
+	cursor->alloc = 0;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_dependency_parse_cursor(pkgconf_client_t *client, pkgconf_pkg_t *pkg, pkgconf_dependency_cursor_t *cursor, const char *depends, unsigned int flags)
+ *
+ *    Like ``pkgconf_dependency_parse()``, but uses the cursor's hash table to find colliding
+ *    dependencies, so that the cost of each addition does not grow with the length of the list.
+ *
+ *    :param pkgconf_client_t* client: The client object that owns the package this dependency list belongs to.
+ *    :param pkgconf_pkg_t* pkg: The package object that owns this dependency list.
+ *    :param pkgconf_dependency_cursor_t* cursor: The cursor bound to the dependency list to populate.
+ *    :param char* depends: The dependency data to parse.
+ *    :param uint flags: Any flags to attach to the dependency nodes.
+ *    :return: nothing
+ */
+void
+pkgconf_dependency_parse_cursor(pkgconf_client_t *client, pkgconf_pkg_t *pkg, pkgconf_dependency_cursor_t *cursor, const char *depends, unsigned int flags)
+{
+	char *kvdepends = pkgconf_bytecode_eval_str(client, &pkg->vars, depends, NULL);
+
+	dependency_parse_str(client, cursor->list, cursor, kvdepends, flags);
+	free(kvdepends);
+}
+
 /*
  * !doc
  *
@@ -212,13 +212,13 @@ pkgconf_fragment_is_groupable(const char *string)
 }
 
 static inline bool
-pkgconf_fragment_is_terminus(const char *parent, const char *string)
+pkgconf_fragment_is_terminus(const pkgconf_fragment_t *parent, const char *string)
 {
 	static const struct pkgconf_fragment_check check_fragments[] = {
 		{"-Wl,--end-group", 15},
 	};
 
-	if (pkgconf_fragment_only_group_one(parent))
+	if (parent->flags & PKGCONF_PKG_FRAGF_GROUP_ONE)
 		return true;
 
 	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(check_fragments); i++)
@@ -240,8 +240,35 @@ pkgconf_fragment_is_special(const char *string)
 	return pkgconf_fragment_is_unmergeable(string);
 }
 
+/*
+ * The PKGCONF_PKG_FRAGF_CLASS_MASK bits for a fragment holding `data`.  Like the
+ * predicates above, these look at the data as it is stored, which for a typed
+ * fragment is what follows the flag.
+ */
+static unsigned int
+fragment_classify(const char *data)
+{
+	unsigned int flags = 0;
+
+	if (data == NULL)
+		return 0;
+
+	if (pkgconf_fragment_is_unmergeable(data))
+		flags |= PKGCONF_PKG_FRAGF_UNMERGEABLE;
+
+	if (pkgconf_fragment_only_group_one(data))
+		flags |= PKGCONF_PKG_FRAGF_GROUP_ONE | PKGCONF_PKG_FRAGF_GROUPABLE;
+	else if (pkgconf_fragment_is_groupable(data))
+		flags |= PKGCONF_PKG_FRAGF_GROUPABLE;
+
+	if (pkgconf_fragment_sysroot_path_offset(data) != 0)
+		flags |= PKGCONF_PKG_FRAGF_SYSROOT_PATH;
+
+	return flags;
+}
+
 static pkgconf_fragment_t *
-fragment_new(char type, const char *data)
+fragment_alloc(char type, const char *data, unsigned int flags)
 {
 	size_t datalen = data != NULL ? strlen(data) : 0;
 	pkgconf_fragment_t *frag = calloc(1, sizeof(*frag) + (data != NULL ? datalen + 1 : 0));
@@ -250,6 +277,7 @@ fragment_new(char type, const char *data)
 		return NULL;
 
 	frag->type = type;
+	frag->flags = flags;
 
 	if (data != NULL)
 	{
@@ -260,6 +288,12 @@ fragment_new(char type, const char *data)
 	return frag;
 }
 
+static pkgconf_fragment_t *
+fragment_new(char type, const char *data)
+{
+	return fragment_alloc(type, data, fragment_classify(data));
+}
+
 /*
  * !doc
  *
@@ -349,7 +383,7 @@ should_inject_sysroot_child(const pkgconf_client_t *client, const pkgconf_fragme
 	if (last->flags & PKGCONF_PKG_FRAGF_TERMINATED)
 		return false;
 
-	if (pkgconf_fragment_sysroot_path_offset(last->data) == 0)
+	if (!(last->flags & PKGCONF_PKG_FRAGF_SYSROOT_PATH))
 		return false;
 
 	return !pkgconf_fragment_under_sysroot(client, string);
@@ -395,13 +429,13 @@ fragment_insert_evaluated(pkgconf_client_t *client, pkgconf_list_t *list, const
 
 		/* only attempt to merge 'special' fragments together */
 		if (!parent->type && parent->data != NULL &&
-			pkgconf_fragment_is_unmergeable(parent->data) &&
+			(parent->flags & PKGCONF_PKG_FRAGF_UNMERGEABLE) &&
 			!(parent->flags & PKGCONF_PKG_FRAGF_TERMINATED))
 		{
-			if (pkgconf_fragment_is_groupable(parent->data))
+			if (parent->flags & PKGCONF_PKG_FRAGF_GROUPABLE)
 				target = &parent->children;
 
-			if (pkgconf_fragment_is_terminus(parent->data, string))
+			if (pkgconf_fragment_is_terminus(parent, string))
 				terminate_parent = parent;
 
 			PKGCONF_TRACE(client, "adding fragment as child to list @%p", target);
@@ -466,87 +500,123 @@ fragment_insert_evaluated(pkgconf_client_t *client, pkgconf_list_t *list, const
 	return true;
 }
 
+static bool fragment_add(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags, pkgconf_buffer_t *evalbuf);
+
 /*
- * Split a string into whitespace-delimited fragments, honouring shell quoting
- * and greedy flags (e.g. "-I /usr/include" -> "-I/usr/include").
- *
- * When `evaluate` is true, `value` is a property as the .pc file spells it and
- * each token is handed to pkgconf_fragment_add to be expanded.  Splitting it
- * only settles where the tokens end, so the quoting is left in place for the
- * pass over the expansion to consume.
+ * Take the `argc` arguments which pkgconf_argv_tokenize() wrote to `args`,
+ * joining greedy flags to the argument they take (e.g. "-I /usr/include" ->
+ * "-I/usr/include").  The join happens in place, by moving the second argument
+ * back over the first one's terminator, so no argument is copied out.
  *
- * When `evaluate` is false, `value` is the expansion of one such token.  This is
- * where the quoting is consumed, once, over text which is otherwise finished,
- * and the tokens are inserted as they stand.  It must not evaluate again, lest
- * an expansion yielding a literal "${...}" (via a "$$" escape) recurse forever.
+ * When `evaluate` is true, the arguments are spelled as the .pc file spells
+ * them, and each is expanded into `evalbuf` and split again there.  Otherwise
+ * they are finished, and are inserted as they stand.
  */
 static bool
-fragment_split(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags, bool evaluate)
+fragment_split_args(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, char *args, int argc, unsigned int flags, bool evaluate, pkgconf_buffer_t *evalbuf)
 {
-	int i, ret, argc;
-	char **argv;
-
-	ret = evaluate
-		? pkgconf_argv_split_raw(value, &argc, &argv)
-		: pkgconf_argv_split(value, &argc, &argv);
-	if (ret < 0)
-	{
-		PKGCONF_TRACE(client, "unable to parse fragment string [%s]", value);
-		return false;
-	}
+	char *arg = args;
 
-	for (i = 0; i < argc; i++)
+	for (int i = 0; i < argc; i++)
 	{
-		const char *token;
-		pkgconf_buffer_t greedybuf = PKGCONF_BUFFER_INITIALIZER;
+		char *token = arg;
 		bool ok;
 
-		if (argv[i] == NULL)
-		{
-			PKGCONF_TRACE(client, "parsed fragment string is inconsistent: argc = %d while argv[%d] == NULL", argc, i);
-			pkgconf_argv_free(argv);
-			return false;
-		}
-
-		token = argv[i];
+		arg += strlen(arg) + 1;
 
-		PKGCONF_TRACE(client, "processing [%s]", argv[i]);
+		PKGCONF_TRACE(client, "processing [%s]", token);
 
-		if (pkgconf_fragment_is_greedy(argv[i]) && i + 1 < argc)
+		if (pkgconf_fragment_is_greedy(token) && i + 1 < argc)
 		{
-			if (!pkgconf_buffer_append(&greedybuf, argv[i]) ||
-				!pkgconf_buffer_append(&greedybuf, argv[i + 1]))
-			{
-				pkgconf_buffer_finalize(&greedybuf);
-				pkgconf_argv_free(argv);
-				return false;
-			}
+			size_t next_len = strlen(arg);
 
-			token = pkgconf_buffer_str(&greedybuf);
+			memmove(token + strlen(token), arg, next_len + 1);
+			arg += next_len + 1;
 
 			/* skip over next arg as we combined them */
 			i++;
 		}
 
 		if (evaluate)
-			ok = pkgconf_fragment_add(client, list, vars, token, flags);
+			ok = fragment_add(client, list, vars, token, flags, evalbuf);
 		else
 			ok = fragment_insert_evaluated(client, list, token, flags);
 
-		pkgconf_buffer_finalize(&greedybuf);
-
 		if (!ok)
-		{
-			pkgconf_argv_free(argv);
 			return false;
-		}
 	}
 
-	pkgconf_argv_free(argv);
-
 	return true;
 }
 
+/*
+ * Split a string into whitespace-delimited fragments, honouring shell quoting
+ * and greedy flags.
+ *
+ * `value` is a property as the .pc file spells it, and each token is expanded
+ * by fragment_add().  Splitting it only settles where the tokens end, so the
+ * quoting is left in place for the pass over the expansion to consume.  The
+ * tokens are written to a single block, and every expansion goes through one
+ * buffer, so a property costs two allocations besides its fragments however
+ * many tokens it has.
+ */
+static bool
+fragment_split(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags)
+{
+	pkgconf_buffer_t evalbuf = PKGCONF_BUFFER_INITIALIZER;
+	char *args;
+	int argc;
+	bool ret;
+
+	args = malloc(strlen(value) + 1);
+	if (args == NULL)
+		return false;
+
+	if (pkgconf_argv_tokenize(value, args, true, &argc) < 0)
+	{
+		PKGCONF_TRACE(client, "unable to parse fragment string [%s]", value);
+		free(args);
+		return false;
+	}
+
+	ret = fragment_split_args(client, list, vars, args, argc, flags, true, &evalbuf);
+
+	pkgconf_buffer_finalize(&evalbuf);
+	free(args);
+
+	return ret;
+}
+
+/*
+ * Expand `value` into `evalbuf` and add the fragments it yields.  The
+ * expansion is split rather than taken whole: the quoting it carries is
+ * consumed there, and a value may in any case expand to several
+ * whitespace-separated fragments.  That split is done in place in `evalbuf`,
+ * and must not evaluate again, lest an expansion yielding a literal "${...}"
+ * (via a "$$" escape) recurse forever.
+ */
+static bool
+fragment_add(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags, pkgconf_buffer_t *evalbuf)
+{
+	int argc;
+
+	pkgconf_buffer_rewind(evalbuf);
+
+	if (!pkgconf_bytecode_eval_str_to_buf(client, vars, value, NULL, evalbuf))
+		return false;
+
+	if (pkgconf_buffer_len(evalbuf) == 0)
+		return true;
+
+	if (pkgconf_argv_tokenize(evalbuf->base, evalbuf->base, false, &argc) < 0)
+	{
+		PKGCONF_TRACE(client, "unable to parse fragment string [%s]", value);
+		return false;
+	}
+
+	return fragment_split_args(client, list, vars, evalbuf->base, argc, flags, false, NULL);
+}
+
 /*
  * !doc
  *
@@ -564,28 +634,7 @@ bool
 pkgconf_fragment_add(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags)
 {
 	pkgconf_buffer_t evalbuf = PKGCONF_BUFFER_INITIALIZER;
-	bool ret;
-
-	if (!pkgconf_bytecode_eval_str_to_buf(client, vars, value, NULL, &evalbuf))
-	{
-		pkgconf_buffer_finalize(&evalbuf);
-		return false;
-	}
-
-	if (pkgconf_buffer_len(&evalbuf) == 0)
-	{
-		pkgconf_buffer_finalize(&evalbuf);
-		return true;
-	}
-
-	/* fragment_split() only reads the expanded string, so hand it the buffer
-	 * contents directly rather than freezing (copying) them out.
-	 *
-	 * The expansion is split rather than taken whole: the quoting it carries is
-	 * consumed there, and a value may in any case expand to several
-	 * whitespace-separated fragments.
-	 */
-	ret = fragment_split(client, list, vars, pkgconf_buffer_str(&evalbuf), flags, false);
+	bool ret = fragment_add(client, list, vars, value, flags, &evalbuf);
 
 	pkgconf_buffer_finalize(&evalbuf);
 	return ret;
@@ -618,36 +667,104 @@ pkgconf_fragment_lookup(pkgconf_list_t *list, const pkgconf_fragment_t *base)
 	return NULL;
 }
 
-/* Order fragments by (type, data).  Used both as the index's sort comparator
- * and, since a fragment is looked up by another fragment, as the lookup key
- * comparator.  NULL data sorts before any non-NULL data of the same type. */
-static int
-fragment_index_cmp(const void *a, const void *b)
+/* Fragments are deduplicated on (type, data), which is what the linear scan in
+ * pkgconf_fragment_lookup() matches on. */
+static bool
+fragment_key_equal(const pkgconf_fragment_t *a, const pkgconf_fragment_t *b)
+{
+	if (a->type != b->type)
+		return false;
+
+	if (a->data == NULL || b->data == NULL)
+		return a->data == b->data;
+
+	return !strcmp(a->data, b->data);
+}
+
+/* FNV-1a over the same key */
+static size_t
+fragment_key_hash(const pkgconf_fragment_t *frag)
 {
-	const pkgconf_fragment_t *fa = a;
-	const pkgconf_fragment_t *fb = b;
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
 
-	if (fa->type != fb->type)
-		return (unsigned char) fa->type < (unsigned char) fb->type ? -1 : 1;
+	hash = (hash ^ (unsigned char) frag->type) * UINT64_C(0x100000001b3);
 
-	if (fa->data == NULL || fb->data == NULL)
+	if (frag->data != NULL)
 	{
-		if (fa->data == fb->data)
-			return 0;
+		for (const char *p = frag->data; *p != '\0'; p++)
+			hash = (hash ^ (unsigned char) *p) * UINT64_C(0x100000001b3);
+	}
+
+	return (size_t) hash;
+}
+
+/* The cursor's open-addressed table holds one fragment per key: the latest one in the
+ * list, which is the one the linear scan would find, as it walks back from the tail.
+ * Returns the slot holding the fragment with `base`'s key, or the empty slot where it
+ * belongs. */
+static pkgconf_fragment_t **
+fragment_cursor_slot(const pkgconf_fragment_cursor_t *cursor, const pkgconf_fragment_t *base)
+{
+	size_t mask = cursor->alloc - 1;
+	size_t i = fragment_key_hash(base) & mask;
 
-		return fa->data == NULL ? -1 : 1;
+	while (cursor->slots[i] != NULL && !fragment_key_equal(cursor->slots[i], base))
+		i = (i + 1) & mask;
+
+	return &cursor->slots[i];
+}
+
+static bool
+fragment_cursor_grow(pkgconf_fragment_cursor_t *cursor)
+{
+	pkgconf_fragment_t **oldslots = cursor->slots;
+	size_t oldalloc = cursor->alloc;
+	size_t alloc = oldalloc != 0 ? oldalloc * 2 : 64;
+	pkgconf_fragment_t **slots = calloc(alloc, sizeof(*slots));
+
+	if (slots == NULL)
+		return false;
+
+	cursor->slots = slots;
+	cursor->alloc = alloc;
+
+	for (size_t i = 0; i < oldalloc; i++)
+	{
+		if (oldslots[i] != NULL)
+			*fragment_cursor_slot(cursor, oldslots[i]) = oldslots[i];
 	}
 
-	return strcmp(fa->data, fb->data);
+	free(oldslots);
+	return true;
+}
+
+/* Records `frag`, which has just been appended to the list, in place of any earlier
+ * fragment with the same key. */
+static bool
+fragment_cursor_insert(pkgconf_fragment_cursor_t *cursor, pkgconf_fragment_t *frag)
+{
+	pkgconf_fragment_t **slot;
+
+	/* keep the table at most half full, so probe sequences stay short */
+	if ((cursor->count + 1) * 2 > cursor->alloc && !fragment_cursor_grow(cursor))
+		return false;
+
+	slot = fragment_cursor_slot(cursor, frag);
+	if (*slot == NULL)
+		cursor->count++;
+
+	*slot = frag;
+
+	return true;
 }
 
-/* Look up an existing fragment matching `base`: via the cursor's sorted index
+/* Look up an existing fragment matching `base`: via the cursor's hash table
  * when one is provided, otherwise a linear scan of the list. */
 static inline pkgconf_fragment_t *
 fragment_lookup(pkgconf_list_t *list, const pkgconf_fragment_cursor_t *cursor, const pkgconf_fragment_t *base)
 {
 	if (cursor != NULL)
-		return pkgconf_index_lookup(&cursor->index, base, fragment_index_cmp);
+		return cursor->alloc != 0 ? *fragment_cursor_slot(cursor, base) : NULL;
 
 	return pkgconf_fragment_lookup(list, base);
 }
@@ -689,7 +806,7 @@ pkgconf_fragment_can_merge(const pkgconf_fragment_t *base, unsigned int flags, b
 	if (base->data == NULL)
 		return false;
 
-	return pkgconf_fragment_is_unmergeable(base->data);
+	return (base->flags & PKGCONF_PKG_FRAGF_UNMERGEABLE) != 0;
 }
 
 static inline pkgconf_fragment_t *
@@ -795,9 +912,13 @@ pkgconf_fragment_copy_node(const pkgconf_client_t *client, pkgconf_list_t *list,
 			old_frag = NULL;
 	}
 	else if (!is_private && !pkgconf_fragment_can_merge_back(base, client->flags, is_private) && (fragment_lookup(list, cursor, base) != NULL))
+	{
+		PKGCONF_STATS_INC(client, PKGCONF_STATS_FRAGMENTS_MERGED);
 		return true;
+	}
 
-	frag = fragment_new(base->type, base->data);
+	/* the copy holds the same data, so it is classified the same way */
+	frag = fragment_alloc(base->type, base->data, base->flags & PKGCONF_PKG_FRAGF_CLASS_MASK);
 	if (frag == NULL)
 		return false;
 
@@ -808,17 +929,20 @@ pkgconf_fragment_copy_node(const pkgconf_client_t *client, pkgconf_list_t *list,
 		return false;
 	}
 
+	pkgconf_node_insert_tail(&frag->iter, frag, list);
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_FRAGMENTS_COPIED);
+
 	if (old_frag != NULL)
 	{
+		/* old_frag was found through the cursor, so it is the recorded fragment for
+		 * this key: the new copy takes its slot before it is freed. */
 		if (cursor != NULL)
-			pkgconf_index_remove(&cursor->index, old_frag);
+			*fragment_cursor_slot(cursor, old_frag) = frag;
 
 		pkgconf_fragment_delete(list, old_frag);
+		PKGCONF_STATS_INC(client, PKGCONF_STATS_FRAGMENTS_MERGED);
 	}
-
-	pkgconf_node_insert_tail(&frag->iter, frag, list);
-
-	if (cursor != NULL && !pkgconf_index_insert(&cursor->index, frag))
+	else if (cursor != NULL && !fragment_cursor_insert(cursor, frag))
 		return false;
 
 	return true;
@@ -851,7 +975,7 @@ pkgconf_fragment_copy(const pkgconf_client_t *client, pkgconf_list_t *list, cons
  *
  *    Initialises a `fragment cursor` bound to a (typically empty) destination list.  While the
  *    cursor is in use, fragments must be added to the list only via ``pkgconf_fragment_copy_cursor()``
- *    so that the cursor's index stays in sync.
+ *    so that the cursor's hash table stays in sync.
  *
  *    :param pkgconf_fragment_cursor_t* cursor: The cursor to initialise.
  *    :param pkgconf_list_t* list: The destination fragment list.
@@ -863,12 +987,14 @@ pkgconf_fragment_cursor_init(pkgconf_fragment_cursor_t *cursor, pkgconf_list_t *
 	pkgconf_node_t *node;
 
 	cursor->list = list;
-	cursor->index = (pkgconf_index_t){ .compare = fragment_index_cmp };
+	cursor->slots = NULL;
+	cursor->count = 0;
+	cursor->alloc = 0;
 
-	/* seed the index with anything already present, so dedup against pre-existing
+	/* seed the table with anything already present, so dedup against pre-existing
 	 * fragments behaves exactly as the linear scan would. */
 	PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
-		(void) pkgconf_index_insert(&cursor->index, node->data);
+		(void) fragment_cursor_insert(cursor, node->data);
 }
 
 /*
@@ -876,7 +1002,7 @@ pkgconf_fragment_cursor_init(pkgconf_fragment_cursor_t *cursor, pkgconf_list_t *
  *
  * .. c:function:: void pkgconf_fragment_cursor_deinit(pkgconf_fragment_cursor_t *cursor)
  *
- *    Releases the index held by a `fragment cursor`.  The destination list and its fragments are
+ *    Releases the hash table held by a `fragment cursor`.  The destination list and its fragments are
  *    not affected.
  *
  *    :param pkgconf_fragment_cursor_t* cursor: The cursor to release.
@@ -885,8 +1011,10 @@ pkgconf_fragment_cursor_init(pkgconf_fragment_cursor_t *cursor, pkgconf_list_t *
 void
 pkgconf_fragment_cursor_deinit(pkgconf_fragment_cursor_t *cursor)
 {
-	free(cursor->index.entries);
-	cursor->index = (pkgconf_index_t){ 0 };
+	free(cursor->slots);
+	cursor->slots = NULL;
+	cursor->count = 0;
+	cursor->alloc = 0;
 }
 
 /*
@@ -894,8 +1022,8 @@ pkgconf_fragment_cursor_deinit(pkgconf_fragment_cursor_t *cursor)
  *
  * .. c:function:: void pkgconf_fragment_copy_cursor(const pkgconf_client_t *client, pkgconf_fragment_cursor_t *cursor, const pkgconf_fragment_t *base, bool is_private)
  *
- *    Like ``pkgconf_fragment_copy()``, but uses the cursor's sorted index for the mergeback lookup,
- *    turning what would be a linear scan of the destination list into a bsearch.
+ *    Like ``pkgconf_fragment_copy()``, but uses the cursor's hash table for the mergeback lookup,
+ *    turning what would be a linear scan of the destination list into a constant-time probe.
  *
  *    :param pkgconf_client_t* client: The pkgconf client being accessed.
  *    :param pkgconf_fragment_cursor_t* cursor: The cursor bound to the destination list.
@@ -1048,56 +1176,34 @@ pkgconf_is_locale_utf8(void)
 #endif
 }
 
-static const pkgconf_span_t quote_spans[] = {
-	{ 0x00, 0x1f },
-	{ (unsigned char)' ', (unsigned char)'#' },
-	{ (unsigned char)'%', (unsigned char)'\'' },
-	{ (unsigned char)'*', (unsigned char)'*' },
-	{ (unsigned char)';', (unsigned char)'<' },
-	{ (unsigned char)'>', (unsigned char)'?' },
-	{ (unsigned char)'[', (unsigned char)']' },
-	{ (unsigned char)'`', (unsigned char)'`' },
-	{ (unsigned char)'{', (unsigned char)'}' },
-	{ 0x7f, 0xff },
-};
+/* the control characters and ' ' .. '#' are adjacent, so they are one range */
+#define QUOTE_RANGES_COMMON(X) \
+	X(0x00, '#') \
+	X('%', '\'') \
+	X('*', '*') \
+	X(';', '<') \
+	X('>', '?') \
+	X('[', ']') \
+	X('`', '`') \
+	X('{', '}')
+
+#define QUOTE_RANGES(X) QUOTE_RANGES_COMMON(X) X(0x7f, 0xff)
 
 /* If the locale is UTF-8 we must not split character over 0x7f because it would add "\" between each bytes.
    So only DEL (0x7f) needs escaping */
-static const pkgconf_span_t quote_spans_utf8[] = {
-	{ 0x00, 0x1f },
-	{ (unsigned char)' ', (unsigned char)'#' },
-	{ (unsigned char)'%', (unsigned char)'\'' },
-	{ (unsigned char)'*', (unsigned char)'*' },
-	{ (unsigned char)';', (unsigned char)'<' },
-	{ (unsigned char)'>', (unsigned char)'?' },
-	{ (unsigned char)'[', (unsigned char)']' },
-	{ (unsigned char)'`', (unsigned char)'`' },
-	{ (unsigned char)'{', (unsigned char)'}' },
-	{ 0x7f, 0x7f },
-};
+#define QUOTE_RANGES_UTF8(X) QUOTE_RANGES_COMMON(X) X(0x7f, 0x7f)
 
 /*
- * The set of bytes needing a backslash is fixed for the life of the process
- * (pkgconf_is_locale_utf8() is itself cached), so resolve the spans into a
- * byte-set once instead of walking them for every byte of every fragment.
+ * The sets of bytes needing a backslash are fixed, so they are built at
+ * compile time instead of walking spans for every byte of every fragment.
  */
+static const pkgconf_charset_t quote_charset = PKGCONF_CHARSET_FROM_RANGES(QUOTE_RANGES);
+static const pkgconf_charset_t quote_charset_utf8 = PKGCONF_CHARSET_FROM_RANGES(QUOTE_RANGES_UTF8);
+
 static const pkgconf_charset_t *
 fragment_quote_charset(void)
 {
-	static pkgconf_charset_t charset;
-	static bool have_charset = false;
-
-	if (!have_charset)
-	{
-		if (pkgconf_is_locale_utf8())
-			pkgconf_charset_from_spans(&charset, quote_spans_utf8, PKGCONF_ARRAY_SIZE(quote_spans_utf8));
-		else
-			pkgconf_charset_from_spans(&charset, quote_spans, PKGCONF_ARRAY_SIZE(quote_spans));
-
-		have_charset = true;
-	}
-
-	return &charset;
+	return pkgconf_is_locale_utf8() ? &quote_charset_utf8 : &quote_charset;
 }
 
 static bool
@@ -1133,8 +1239,100 @@ fragment_render(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment
 	return true;
 }
 
+/* number of bytes fragment_quote() appends: every byte, plus a backslash for each one in the charset */
+static size_t
+fragment_quoted_size(const pkgconf_fragment_t *frag)
+{
+	const pkgconf_charset_t *charset = fragment_quote_charset();
+	const char *p = frag->data;
+	size_t len, size;
+
+	if (p == NULL)
+		return 0;
+
+	for (size = len = strlen(p); len > 0; )
+	{
+		size_t run = pkgconf_charset_scan(charset, p, len);
+
+		if (run == len)
+			break;
+
+		size++;
+		p += run + 1;
+		len -= run + 1;
+	}
+
+	return size;
+}
+
+static char *
+fragment_quote_fill(const pkgconf_fragment_t *frag, char *out)
+{
+	const pkgconf_charset_t *charset = fragment_quote_charset();
+	const char *p = frag->data;
+	size_t len;
+
+	if (p == NULL)
+		return out;
+
+	for (len = strlen(p); len > 0; )
+	{
+		size_t run = pkgconf_charset_scan(charset, p, len);
+
+		memcpy(out, p, run);
+		out += run;
+
+		if (run == len)
+			break;
+
+		*out++ = '\\';
+		*out++ = p[run];
+
+		p += run + 1;
+		len -= run + 1;
+	}
+
+	return out;
+}
+
+static size_t
+fragment_render_size(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag)
+{
+	const pkgconf_node_t *iter;
+	size_t size = (frag->type ? 2 : 0) + fragment_quoted_size(frag);
+
+	PKGCONF_FOREACH_LIST_ENTRY(frag->children.head, iter)
+		size += 1 + fragment_render_size(ctx, iter->data);
+
+	return size;
+}
+
+static char *
+fragment_render_fill(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag, char *out)
+{
+	const pkgconf_node_t *iter;
+
+	if (frag->type)
+	{
+		*out++ = '-';
+		*out++ = frag->type;
+	}
+
+	out = fragment_quote_fill(frag, out);
+
+	PKGCONF_FOREACH_LIST_ENTRY(frag->children.head, iter)
+	{
+		*out++ = ctx->delim;
+		out = fragment_render_fill(ctx, iter->data, out);
+	}
+
+	return out;
+}
+
 static const pkgconf_fragment_render_ops_t default_render_ops = {
-	.render = fragment_render
+	.render = fragment_render,
+	.size = fragment_render_size,
+	.fill = fragment_render_fill,
 };
 
 /*
@@ -1142,7 +1340,9 @@ static const pkgconf_fragment_render_ops_t default_render_ops = {
  *
  * .. c:function:: void pkgconf_fragment_render_buf(const pkgconf_list_t *list, char *buf, size_t buflen, bool escape, const pkgconf_fragment_render_ops_t *ops, char delim)
  *
- *    Renders a `fragment list` into a buffer.
+ *    Renders a `fragment list` into a buffer.  If the ops provide ``size`` and ``fill``, the
+ *    rendered length of the whole list is computed first, so that the buffer is grown once and
+ *    then filled in place; otherwise each fragment is appended by ``render``.
  *
  *    :param pkgconf_list_t* list: The `fragment list` being rendered.
  *    :param pkgconf_buffer_t* buf: The buffer to render the fragment list into.
@@ -1162,6 +1362,31 @@ pkgconf_fragment_render_buf(const pkgconf_list_t *list, pkgconf_buffer_t *buf, b
 
 	ops = ops != NULL ? ops : &default_render_ops;
 
+	if (ops->size != NULL && ops->fill != NULL)
+	{
+		size_t size = 0;
+		char *out, *end;
+
+		PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
+			size += ops->size(&ctx, node->data) + (node->next != NULL);
+
+		if ((out = pkgconf_buffer_extend(buf, size)) == NULL)
+			return false;
+
+		end = out + size;
+
+		PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
+		{
+			out = ops->fill(&ctx, node->data, out);
+
+			if (node->next != NULL)
+				*out++ = ctx.delim;
+		}
+
+		/* a fill which disagrees with its size has either overrun or left garbage behind */
+		return out == end;
+	}
+
 	PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
 	{
 		const pkgconf_fragment_t *frag = node->data;
@@ -1238,5 +1463,5 @@ pkgconf_fragment_free(pkgconf_list_t *list)
 bool
 pkgconf_fragment_parse(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags)
 {
-	return fragment_split(client, list, vars, value, flags, true);
+	return fragment_split(client, list, vars, value, flags);
 }
@@ -0,0 +1,220 @@
+/*
+ * graph.c
+ * frozen dependency graphs
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+
+/*
+ * !doc
+ *
+ * libpkgconf `graph` module
+ * =========================
+ *
+ * Once a dependency graph has been solved, every dependency node carries a
+ * resolved ``match``.  The `graph` module can freeze such a graph into a compact
+ * compressed sparse row form: packages are numbered densely from the root, and the
+ * edges of each package are stored contiguously, in the order of its `Requires`,
+ * `Requires.shared` and `Requires.private` lists.  ``pkgconf_pkg_traverse()`` walks
+ * the frozen form instead of the dependency lists when it is given the root of a
+ * frozen graph.
+ *
+ * A frozen graph is a snapshot: dependency nodes added to a package in the graph
+ * after it was frozen are not seen by traversals of the frozen form.
+ */
+
+static bool
+graph_add_node(pkgconf_client_t *client, pkgconf_graph_t *graph, size_t *alloc, pkgconf_pkg_t *pkg)
+{
+	if (graph->node_count == *alloc)
+	{
+		size_t newalloc = *alloc * 2;
+		pkgconf_pkg_t **nodes;
+		size_t *edge_index;
+
+		nodes = pkgconf_reallocarray(graph->nodes, newalloc, sizeof(*nodes));
+		if (nodes == NULL)
+			return false;
+		graph->nodes = nodes;
+
+		edge_index = pkgconf_reallocarray(graph->edge_index, newalloc + 1, sizeof(*edge_index));
+		if (edge_index == NULL)
+			return false;
+		graph->edge_index = edge_index;
+
+		*alloc = newalloc;
+	}
+
+	/* the root is owned by the caller, every other node is referenced by the graph */
+	if (graph->node_count != 0)
+		pkgconf_pkg_ref(client, pkg);
+
+	pkg->serial = client->serial;
+	pkg->graph_index = graph->node_count;
+	graph->nodes[graph->node_count++] = pkg;
+
+	return true;
+}
+
+static bool
+graph_add_edges(pkgconf_client_t *client, pkgconf_graph_t *graph, size_t *nodes_alloc, size_t *edges_alloc, pkgconf_list_t *deplist, pkgconf_pkg_deplist_t kind)
+{
+	pkgconf_node_t *node;
+
+	PKGCONF_FOREACH_LIST_ENTRY(deplist->head, node)
+	{
+		pkgconf_dependency_t *dep = node->data;
+		pkgconf_graph_edge_t *edge;
+
+		if (*dep->package == '\0')
+			continue;
+
+		/* only solved graphs can be frozen */
+		if (dep->match == NULL)
+		{
+			PKGCONF_TRACE(client, "cannot freeze graph: unmatched dependency %p <%s>", dep, dep->package);
+			return false;
+		}
+
+		if (dep->match->serial != client->serial && !graph_add_node(client, graph, nodes_alloc, dep->match))
+			return false;
+
+		if (graph->edge_count == *edges_alloc)
+		{
+			size_t newalloc = *edges_alloc * 2;
+			pkgconf_graph_edge_t *edges = pkgconf_reallocarray(graph->edges, newalloc, sizeof(*edges));
+
+			if (edges == NULL)
+				return false;
+
+			graph->edges = edges;
+			*edges_alloc = newalloc;
+		}
+
+		edge = &graph->edges[graph->edge_count++];
+		edge->target = dep->match->graph_index;
+		edge->dep = pkgconf_dependency_ref(client, dep);
+		edge->flags = dep->flags;
+		edge->deplist = kind;
+	}
+
+	return true;
+}
+
+static void
+graph_free(pkgconf_client_t *client, pkgconf_graph_t *graph)
+{
+	for (size_t i = 0; i < graph->edge_count; i++)
+	{
+		if (graph->edges[i].dep != NULL)
+			pkgconf_dependency_unref(client, graph->edges[i].dep);
+	}
+
+	for (size_t i = 1; i < graph->node_count; i++)
+		pkgconf_pkg_unref(client, graph->nodes[i]);
+
+	free(graph->edges);
+	free(graph->edge_index);
+	free(graph->nodes);
+	free(graph);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_graph_freeze(pkgconf_client_t *client, pkgconf_pkg_t *root)
+ *
+ *    Freeze the solved dependency graph below `root` into compressed sparse row form,
+ *    replacing any graph previously frozen from `root`.  Every dependency node reachable
+ *    from `root` must have a resolved ``match``, as it has after ``pkgconf_queue_solve()``.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object that owns the graph.
+ *    :param pkgconf_pkg_t* root: The root of the solved dependency graph, usually the world package.
+ *    :return: true if the graph was frozen, false if it is not fully solved or memory ran out.
+ *    :rtype: bool
+ */
+bool
+pkgconf_graph_freeze(pkgconf_client_t *client, pkgconf_pkg_t *root)
+{
+	pkgconf_graph_t *graph;
+	size_t nodes_alloc = 16, edges_alloc = 16;
+
+	pkgconf_graph_free(client, root);
+
+	graph = calloc(1, sizeof(*graph));
+	if (graph == NULL)
+		return false;
+
+	graph->nodes = pkgconf_reallocarray(NULL, nodes_alloc, sizeof(*graph->nodes));
+	graph->edge_index = pkgconf_reallocarray(NULL, nodes_alloc + 1, sizeof(*graph->edge_index));
+	graph->edges = pkgconf_reallocarray(NULL, edges_alloc, sizeof(*graph->edges));
+	if (graph->nodes == NULL || graph->edge_index == NULL || graph->edges == NULL)
+		goto fail;
+
+	/* nodes are numbered breadth first; the serial marks packages already numbered */
+	client->serial++;
+
+	if (!graph_add_node(client, graph, &nodes_alloc, root))
+		goto fail;
+
+	for (size_t i = 0; i < graph->node_count; i++)
+	{
+		pkgconf_pkg_t *pkg = graph->nodes[i];
+
+		graph->edge_index[i] = graph->edge_count;
+
+		if (!graph_add_edges(client, graph, &nodes_alloc, &edges_alloc, &pkg->required, PKGCONF_PKG_DEPLIST_REQUIRES))
+			goto fail;
+
+		if (!graph_add_edges(client, graph, &nodes_alloc, &edges_alloc, &pkg->requires_shared, PKGCONF_PKG_DEPLIST_REQUIRES_SHARED))
+			goto fail;
+
+		if (!graph_add_edges(client, graph, &nodes_alloc, &edges_alloc, &pkg->requires_private, PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE))
+			goto fail;
+	}
+
+	graph->edge_index[graph->node_count] = graph->edge_count;
+	root->graph = graph;
+
+	PKGCONF_TRACE(client, "%s: froze graph, %zu nodes, %zu edges", root->id, graph->node_count, graph->edge_count);
+
+	return true;
+
+fail:
+	graph_free(client, graph);
+	return false;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_graph_free(pkgconf_client_t *client, pkgconf_pkg_t *root)
+ *
+ *    Release the frozen graph of `root`, if it has one.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object that owns the graph.
+ *    :param pkgconf_pkg_t* root: The root the graph was frozen from.
+ *    :return: nothing
+ */
+void
+pkgconf_graph_free(pkgconf_client_t *client, pkgconf_pkg_t *root)
+{
+	if (root->graph == NULL)
+		return;
+
+	graph_free(client, root->graph);
+	root->graph = NULL;
+}
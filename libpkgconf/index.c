@@ -26,7 +26,8 @@
  *
  * The `index` module maintains a sorted array of opaque entry pointers, so that
  * membership tests are a binary search rather than a linear scan.  It is the
- * shared implementation behind the package cache and the fragment dedup cursor.
+ * shared implementation behind the package cache and the solved world's index of
+ * required packages.
  */
 
 /*
@@ -65,7 +66,8 @@ pkgconf_index_lookup(const pkgconf_index_t *index, const void *key, pkgconf_inde
  * .. c:function:: bool pkgconf_index_insert(pkgconf_index_t *index, void *entry)
  *
  *    Inserts `entry` while keeping the index sorted by its `compare` function.
- *    The backing array grows geometrically.
+ *    The backing array grows geometrically.  The number of entries moved to make
+ *    room is added to `shifted`.
  *
  *    :return: true on success, false on allocation failure.
  */
@@ -97,6 +99,7 @@ pkgconf_index_insert(pkgconf_index_t *index, void *entry)
 	}
 
 	memmove(&index->entries[lo + 1], &index->entries[lo], (index->count - lo) * sizeof(void *));
+	index->shifted += index->count - lo;
 	index->entries[lo] = entry;
 	index->count++;
 
@@ -110,7 +113,8 @@ pkgconf_index_insert(pkgconf_index_t *index, void *entry)
  *
  *    Removes `entry` from the index.  The entry is located by its sort key and
  *    then matched by identity across any run of equal-keyed entries, so indexes
- *    that contain duplicate keys remove exactly the requested pointer.
+ *    that contain duplicate keys remove exactly the requested pointer.  The number
+ *    of entries moved to close the gap is added to `shifted`.
  */
 void
 pkgconf_index_remove(pkgconf_index_t *index, void *entry)
@@ -139,6 +143,7 @@ pkgconf_index_remove(pkgconf_index_t *index, void *entry)
 				if (index->entries[i] == entry)
 				{
 					memmove(&index->entries[i], &index->entries[i + 1], (index->count - i - 1) * sizeof(void *));
+					index->shifted += index->count - i - 1;
 					index->count--;
 					return;
 				}
@@ -148,3 +153,86 @@ pkgconf_index_remove(pkgconf_index_t *index, void *entry)
 		}
 	}
 }
+
+/* stable bottom-up merge sort of the index entries, using `scratch` as the merge buffer */
+static void
+pkgconf_index_sort(pkgconf_index_t *index, void **scratch)
+{
+	void **src = index->entries, **dst = scratch;
+
+	for (size_t width = 1; width < index->count; width *= 2)
+	{
+		for (size_t lo = 0; lo < index->count; lo += 2 * width)
+		{
+			size_t mid = lo + width < index->count ? lo + width : index->count;
+			size_t hi = mid + width < index->count ? mid + width : index->count;
+			size_t i = lo, j = mid, k = lo;
+
+			while (i < mid && j < hi)
+				dst[k++] = index->compare(src[j], src[i]) < 0 ? src[j++] : src[i++];
+			while (i < mid)
+				dst[k++] = src[i++];
+			while (j < hi)
+				dst[k++] = src[j++];
+		}
+
+		void **tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if (src != index->entries)
+		memcpy(index->entries, src, index->count * sizeof(void *));
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_index_build(pkgconf_index_t *index, const pkgconf_list_t *list)
+ *
+ *    Replaces the contents of the index with the data pointers of every node in `list`,
+ *    sorted by the index's `compare` function.  Building an index in one pass is
+ *    O(n log n), where inserting the entries one by one would be quadratic.
+ *
+ *    :param pkgconf_index_t* index: The index to fill.  Its `compare` function must be set.
+ *    :param pkgconf_list_t* list: The list whose entries are indexed.
+ *    :return: true on success, false on allocation failure.
+ *    :rtype: bool
+ */
+bool
+pkgconf_index_build(pkgconf_index_t *index, const pkgconf_list_t *list)
+{
+	const pkgconf_node_t *node;
+	void **scratch;
+
+	index->count = 0;
+
+	if (list->length > index->alloc)
+	{
+		void **newentries = pkgconf_reallocarray(index->entries, list->length, sizeof(void *));
+
+		if (newentries == NULL)
+			return false;
+
+		index->entries = newentries;
+		index->alloc = list->length;
+	}
+
+	PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
+		index->entries[index->count++] = node->data;
+
+	if (index->count < 2)
+		return true;
+
+	scratch = calloc(index->count, sizeof(void *));
+	if (scratch == NULL)
+	{
+		index->count = 0;
+		return false;
+	}
+
+	pkgconf_index_sort(index, scratch);
+	free(scratch);
+
+	return true;
+}
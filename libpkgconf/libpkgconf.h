@@ -58,6 +58,7 @@ typedef struct pkgconf_client_ pkgconf_client_t;
 typedef struct pkgconf_cross_personality_ pkgconf_cross_personality_t;
 typedef struct pkgconf_queue_ pkgconf_queue_t;
 typedef struct pkgconf_output_ pkgconf_output_t;
+typedef struct pkgconf_graph_ pkgconf_graph_t;
 typedef struct pkgconf_license_ pkgconf_license_t;
 
 #define PKGCONF_ARRAY_SIZE(x) (sizeof(x) / sizeof(*(x)))
@@ -93,6 +94,45 @@ struct pkgconf_fragment_ {
 
 #define PKGCONF_PKG_FRAGF_TERMINATED		0x1
 
+/*
+ * What a fragment's data says about how it merges.  These are worked out once,
+ * when the fragment is created, so that the merge and mergeback paths test
+ * bits rather than matching the data against lists of prefixes.
+ */
+#define PKGCONF_PKG_FRAGF_UNMERGEABLE		0x2
+#define PKGCONF_PKG_FRAGF_GROUPABLE		0x4
+#define PKGCONF_PKG_FRAGF_GROUP_ONE		0x8
+#define PKGCONF_PKG_FRAGF_SYSROOT_PATH		0x10
+#define PKGCONF_PKG_FRAGF_CLASS_MASK		(PKGCONF_PKG_FRAGF_UNMERGEABLE | PKGCONF_PKG_FRAGF_GROUPABLE | \
+						 PKGCONF_PKG_FRAGF_GROUP_ONE | PKGCONF_PKG_FRAGF_SYSROOT_PATH)
+
+/*
+ * A version string split once into its comparison tokens.  Numeric tokens
+ * short enough to fit are also kept as integers, so that comparing two parsed
+ * versions rarely needs to look at the string again.  The token vector is
+ * terminated by a PKGCONF_VERSION_TOKEN_END token.
+ */
+typedef enum {
+	PKGCONF_VERSION_TOKEN_END = 0,
+	PKGCONF_VERSION_TOKEN_TILDE,
+	PKGCONF_VERSION_TOKEN_NUMERIC,
+	PKGCONF_VERSION_TOKEN_ALPHA
+} pkgconf_version_token_kind_t;
+
+typedef struct pkgconf_version_token_ {
+	pkgconf_version_token_kind_t kind;
+	unsigned int offset;
+	unsigned int len;
+	uint64_t value;
+} pkgconf_version_token_t;
+
+typedef struct pkgconf_version_ {
+	const char *str;
+	pkgconf_version_token_t *tokens;
+} pkgconf_version_t;
+
+#define PKGCONF_VERSION_INITIALIZER	{ NULL, NULL }
+
 struct pkgconf_dependency_ {
 	pkgconf_node_t iter;
 
@@ -108,6 +148,8 @@ struct pkgconf_dependency_ {
 	pkgconf_client_t *owner;
 
 	char *why;
+
+	pkgconf_version_t parsed_version;
 };
 
 struct pkgconf_buffer_ {
@@ -120,6 +162,67 @@ struct pkgconf_bufferset_ {
 	pkgconf_buffer_t buffer;
 };
 
+typedef struct pkgconf_stack_ {
+	unsigned char *base;
+	size_t len;
+	size_t alloc;
+} pkgconf_stack_t;
+
+#define PKGCONF_STACK_INITIALIZER	{ NULL, 0, 0 }
+
+/* performance counters kept on every client, see stats.c */
+typedef enum {
+	PKGCONF_STATS_FILES_OPENED = 0,
+	PKGCONF_STATS_FILES_FAILED,
+	PKGCONF_STATS_BYTES_PARSED,
+	PKGCONF_STATS_CACHE_HITS,
+	PKGCONF_STATS_CACHE_MISSES,
+	PKGCONF_STATS_PROVIDER_SCANS,
+	PKGCONF_STATS_TRAVERSAL_NODES,
+	PKGCONF_STATS_TRAVERSAL_EDGES,
+	PKGCONF_STATS_FRAGMENTS_COPIED,
+	PKGCONF_STATS_FRAGMENTS_MERGED,
+	PKGCONF_STATS_BYTECODE_OPS,
+	PKGCONF_STATS_DEPENDENCY_PROBES,
+	PKGCONF_STATS_INDEX_SHIFTS,
+	PKGCONF_STATS_DIRS_SCANNED,
+	PKGCONF_STATS_PACKAGES_PARSED,
+	PKGCONF_STATS_COUNTER_COUNT
+} pkgconf_stats_counter_t;
+
+/* phases timed by the client; time spent outside any phase is charged to PKGCONF_STATS_PHASE_NONE */
+typedef enum {
+	PKGCONF_STATS_PHASE_NONE = 0,
+	PKGCONF_STATS_PHASE_SEARCH,
+	PKGCONF_STATS_PHASE_PARSE,
+	PKGCONF_STATS_PHASE_SOLVE,
+	PKGCONF_STATS_PHASE_FLATTEN,
+	PKGCONF_STATS_PHASE_COLLECT,
+	PKGCONF_STATS_PHASE_RENDER,
+	PKGCONF_STATS_PHASE_COUNT
+} pkgconf_stats_phase_t;
+
+typedef struct pkgconf_stats_ {
+	uint64_t counters[PKGCONF_STATS_COUNTER_COUNT];
+	uint64_t phase_ns[PKGCONF_STATS_PHASE_COUNT];
+
+	pkgconf_stats_phase_t phase;
+	uint64_t phase_start;
+	bool timing;
+} pkgconf_stats_t;
+
+typedef int (*pkgconf_index_cmp_func_t)(const void *a, const void *b);
+
+typedef struct pkgconf_index_ {
+	void **entries;
+	size_t count;
+	size_t alloc;
+	pkgconf_index_cmp_func_t compare;
+
+	/* entries moved by insertions and removals, drained into PKGCONF_STATS_INDEX_SHIFTS by the owner */
+	size_t shifted;
+} pkgconf_index_t;
+
 #if defined(_MSC_VER) && !defined(__clang__)
 # define PKGCONF_PACKED_STRUCT(name) __pragma(pack(push, 1)) struct name __pragma(pack(pop))
 #else
@@ -206,6 +309,7 @@ struct pkgconf_license_ {
 #define PKGCONF_PKG_PROPF_ANCESTOR		0x20
 #define PKGCONF_PKG_PROPF_VISITED_PRIVATE	0x40
 #define PKGCONF_PKG_PROPF_PRELOADED		0x80
+#define PKGCONF_PKG_PROPF_HEADER_ONLY		0x100
 
 struct pkgconf_pkg_ {
 	int refcount;
@@ -253,6 +357,15 @@ struct pkgconf_pkg_ {
 	uint64_t identifier;
 
 	pkgconf_node_t preload_node;
+
+	unsigned int visited_lanes;
+
+	pkgconf_graph_t *graph;
+	size_t graph_index;
+
+	pkgconf_version_t parsed_version;
+
+	pkgconf_index_t required_index;
 };
 
 typedef bool (*pkgconf_pkg_iteration_func_t)(const pkgconf_pkg_t *pkg, void *data);
@@ -267,6 +380,45 @@ typedef bool (*pkgconf_error_handler_func_t)(const char *msg, const pkgconf_clie
 typedef void (*pkgconf_unveil_handler_func_t)(const pkgconf_client_t *client, const char *path, const char *permissions);
 typedef const char *(*pkgconf_environ_lookup_handler_func_t)(const pkgconf_client_t *client, const char *variable);
 
+/* phases reported to a client's profile handler, see pkgconf_client_set_profile_handler() */
+typedef enum {
+	PKGCONF_PROFILE_PHASE_SEARCH = 0,
+	PKGCONF_PROFILE_PHASE_PARSE,
+	PKGCONF_PROFILE_PHASE_TRAVERSE,
+	PKGCONF_PROFILE_PHASE_SOLVE,
+	PKGCONF_PROFILE_PHASE_FLATTEN,
+	PKGCONF_PROFILE_PHASE_COLLECT,
+	PKGCONF_PROFILE_PHASE_RENDER,
+	PKGCONF_PROFILE_PHASE_COUNT
+} pkgconf_profile_phase_t;
+
+typedef enum {
+	PKGCONF_PROFILE_EVENT_BEGIN = 0,
+	PKGCONF_PROFILE_EVENT_END
+} pkgconf_profile_event_type_t;
+
+typedef struct pkgconf_profile_event_ {
+	pkgconf_profile_event_type_t type;
+	pkgconf_profile_phase_t phase;
+
+	/* the package the phase is working on or produced, if any */
+	const pkgconf_pkg_t *pkg;
+
+	/* nanoseconds on the clock read by pkgconf_stats_now() */
+	uint64_t timestamp;
+} pkgconf_profile_event_t;
+
+typedef void (*pkgconf_profile_handler_func_t)(const pkgconf_client_t *client, const pkgconf_profile_event_t *event, void *data);
+
+/* a phase entered with pkgconf_phase_begin(), to be passed to the matching pkgconf_phase_end() */
+typedef struct pkgconf_phase_ {
+	pkgconf_stats_phase_t phase;
+	pkgconf_stats_phase_t previous;
+
+	/* the name of the trace event span, or NULL for none */
+	const char *name;
+} pkgconf_phase_t;
+
 typedef struct pkgconf_client_options_ {
 	pkgconf_error_handler_func_t error_handler;
 	void *error_handler_data;
@@ -321,6 +473,16 @@ struct pkgconf_client_ {
 	const pkgconf_cross_personality_t *personality;
 
 	pkgconf_buffer_t _scratch_buffer;
+	pkgconf_stack_t _traverse_stack;
+
+	pkgconf_stats_t stats;
+
+	FILE *trace_eventsf;
+	uint64_t trace_events_epoch;
+	size_t trace_events_count;
+
+	pkgconf_profile_handler_func_t profile_handler;
+	void *profile_handler_data;
 };
 
 struct pkgconf_cross_personality_ {
@@ -361,6 +523,7 @@ PKGCONF_API bool pkgconf_bytecode_emit_var(pkgconf_buffer_t *buf, const char *na
 PKGCONF_API bool pkgconf_bytecode_emit_sysroot(pkgconf_buffer_t *buf);
 PKGCONF_API void pkgconf_bytecode_from_buffer(pkgconf_bytecode_t *bc, const pkgconf_buffer_t *buf);
 PKGCONF_API bool pkgconf_bytecode_compile(pkgconf_buffer_t *out, const char *value);
+PKGCONF_API bool pkgconf_bytecode_compile_selfref(pkgconf_buffer_t *bcbuf, const char *value, const char *key);
 PKGCONF_API bool pkgconf_bytecode_eval_str_to_buf(const pkgconf_client_t *client, const pkgconf_list_t *vars, const char *input, bool *saw_sysroot, pkgconf_buffer_t *out);
 PKGCONF_API char *pkgconf_bytecode_eval_str(const pkgconf_client_t *client, const pkgconf_list_t *vars, const char *input, bool *saw_sysroot);
 PKGCONF_API pkgconf_variable_t *pkgconf_bytecode_eval_lookup_var(pkgconf_bytecode_eval_ctx_t *ctx, const char *name, size_t nlen);
@@ -399,6 +562,10 @@ PKGCONF_API pkgconf_error_handler_func_t pkgconf_client_get_error_handler(const
 PKGCONF_API void pkgconf_client_set_error_handler(pkgconf_client_t *client, pkgconf_error_handler_func_t error_handler, void *error_handler_data);
 PKGCONF_API pkgconf_error_handler_func_t pkgconf_client_get_trace_handler(const pkgconf_client_t *client);
 PKGCONF_API void pkgconf_client_set_trace_handler(pkgconf_client_t *client, pkgconf_error_handler_func_t trace_handler, void *trace_handler_data);
+PKGCONF_API FILE *pkgconf_client_get_trace_events(const pkgconf_client_t *client);
+PKGCONF_API pkgconf_profile_handler_func_t pkgconf_client_get_profile_handler(const pkgconf_client_t *client);
+PKGCONF_API void pkgconf_client_set_profile_handler(pkgconf_client_t *client, pkgconf_profile_handler_func_t profile_handler, void *profile_handler_data);
+PKGCONF_API void pkgconf_client_set_trace_events(pkgconf_client_t *client, FILE *trace_eventsf);
 PKGCONF_API pkgconf_unveil_handler_func_t pkgconf_client_get_unveil_handler(const pkgconf_client_t *client);
 PKGCONF_API void pkgconf_client_set_unveil_handler(pkgconf_client_t *client, pkgconf_unveil_handler_func_t unveil_handler);
 PKGCONF_API void pkgconf_client_dir_list_build(pkgconf_client_t *client, const pkgconf_cross_personality_t *personality);
@@ -436,6 +603,8 @@ PKGCONF_API void pkgconf_cross_personality_deinit(pkgconf_cross_personality_t *p
 #define PKGCONF_PKG_PKGF_PKGCONF1_SYSROOT_RULES         0x10000
 #define PKGCONF_PKG_PKGF_REQUIRE_INTERNAL		0x20000
 #define PKGCONF_PKG_PKGF_NO_SYSROOT_INJECTION		0x40000
+#define PKGCONF_PKG_PKGF_EXISTENCE_CHECK		0x80000
+#define PKGCONF_PKG_PKGF_FREEZE_GRAPH			0x100000
 
 #define PKGCONF_PKG_DEPF_INTERNAL		0x1
 #define PKGCONF_PKG_DEPF_PRIVATE		0x2
@@ -448,6 +617,9 @@ PKGCONF_API void pkgconf_cross_personality_deinit(pkgconf_cross_personality_t *p
 #define PKGCONF_PKG_ERRF_PACKAGE_CONFLICT	0x4
 #define PKGCONF_PKG_ERRF_DEPGRAPH_BREAK		0x8
 
+#define PKGCONF_PKG_COLLECTF_NONE		0x0
+#define PKGCONF_PKG_COLLECTF_LINK_SHARED	0x1
+
 #if __GNUC__ >= 5 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 4)
 # define PRINTFLIKE(fmtarg, firstvararg) \
          __attribute__((__format__ (gnu_printf, fmtarg, firstvararg)))
@@ -471,6 +643,22 @@ PKGCONF_API bool pkgconf_error(const pkgconf_client_t *client, const char *forma
 PKGCONF_API bool pkgconf_warn(const pkgconf_client_t *client, const char *format, ...) PRINTFLIKE(2, 3);
 PKGCONF_API bool pkgconf_trace(const pkgconf_client_t *client, const char *filename, size_t lineno, const char *funcname, const char *format, ...) PRINTFLIKE(5, 6);
 PKGCONF_API bool pkgconf_default_error_handler(const char *msg, const pkgconf_client_t *client, void *data);
+PKGCONF_API void pkgconf_trace_event_begin(const pkgconf_client_t *client, const char *name, const char *argname, const char *argvalue);
+PKGCONF_API void pkgconf_trace_event_end(const pkgconf_client_t *client, const char *name);
+PKGCONF_API void pkgconf_profile_event(const pkgconf_client_t *client, pkgconf_profile_event_type_t type, pkgconf_profile_phase_t phase, const pkgconf_pkg_t *pkg);
+PKGCONF_API const char *pkgconf_profile_phase_name(pkgconf_profile_phase_t phase);
+PKGCONF_API pkgconf_phase_t pkgconf_phase_begin(const pkgconf_client_t *client, pkgconf_stats_phase_t phase, const char *name, const char *argname, const char *argvalue, const pkgconf_pkg_t *pkg);
+PKGCONF_API void pkgconf_phase_end(const pkgconf_client_t *client, const pkgconf_phase_t *phase, const pkgconf_pkg_t *pkg);
+
+/* a single predictable branch when no profile handler is installed */
+#define PKGCONF_PROFILE_BEGIN(client, phase, pkg) do { \
+		if ((client)->profile_handler != NULL) \
+			pkgconf_profile_event((client), PKGCONF_PROFILE_EVENT_BEGIN, (phase), (pkg)); \
+	} while (0)
+#define PKGCONF_PROFILE_END(client, phase, pkg) do { \
+		if ((client)->profile_handler != NULL) \
+			pkgconf_profile_event((client), PKGCONF_PROFILE_EVENT_END, (phase), (pkg)); \
+	} while (0)
 
 #ifndef PKGCONF_LITE
 #if defined(__GNUC__) || defined(__INTEL_COMPILER)
@@ -486,8 +674,19 @@ PKGCONF_API bool pkgconf_default_error_handler(const char *msg, const pkgconf_cl
 			pkgconf_trace(pkgconf_trace_client_, __FILE__, __LINE__, __func__, __VA_ARGS__); \
 	} while (0)
 #endif
+
+#define PKGCONF_TRACE_EVENT_BEGIN(client, name, argname, argvalue) do { \
+		if ((client)->trace_eventsf != NULL) \
+			pkgconf_trace_event_begin((client), (name), (argname), (argvalue)); \
+	} while (0)
+#define PKGCONF_TRACE_EVENT_END(client, name) do { \
+		if ((client)->trace_eventsf != NULL) \
+			pkgconf_trace_event_end((client), (name)); \
+	} while (0)
 #else
 #define PKGCONF_TRACE(client, ...)
+#define PKGCONF_TRACE_EVENT_BEGIN(client, name, argname, argvalue)
+#define PKGCONF_TRACE_EVENT_END(client, name)
 #endif
 
 PKGCONF_API pkgconf_pkg_t *pkgconf_pkg_ref(pkgconf_client_t *client, pkgconf_pkg_t *pkg);
@@ -502,15 +701,33 @@ PKGCONF_API const char *pkgconf_pkg_get_comparator(const pkgconf_dependency_t *p
 PKGCONF_API unsigned int pkgconf_pkg_cflags(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *list, int maxdepth);
 PKGCONF_API unsigned int pkgconf_pkg_libs(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *list, int maxdepth);
 PKGCONF_API unsigned int pkgconf_pkg_link_abi(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *list, int maxdepth);
+PKGCONF_API unsigned int pkgconf_pkg_collect(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *cflags, pkgconf_list_t *libs, pkgconf_list_t *link_abi, int maxdepth, unsigned int flags);
 PKGCONF_API pkgconf_pkg_comparator_t pkgconf_pkg_comparator_lookup_by_name(const char *name);
 
 PKGCONF_API int pkgconf_compare_version(const char *a, const char *b);
+PKGCONF_API bool pkgconf_version_parse(pkgconf_version_t *version, const char *str);
+PKGCONF_API void pkgconf_version_free(pkgconf_version_t *version);
+PKGCONF_API int pkgconf_version_compare(const pkgconf_version_t *a, const pkgconf_version_t *b);
 PKGCONF_API pkgconf_pkg_t *pkgconf_scan_all(pkgconf_client_t *client, void *ptr, pkgconf_pkg_iteration_func_t func);
 
+/* A cursor accelerates repeated additions to the same dependency list by maintaining
+ * a hash table of the dependencies it holds, keyed by package name, so that finding a
+ * colliding dependency is a probe rather than a linear scan of the list.
+ */
+typedef struct pkgconf_dependency_cursor_ {
+	pkgconf_list_t *list;
+	pkgconf_dependency_t **slots;
+	size_t count;
+	size_t alloc;
+} pkgconf_dependency_cursor_t;
+
 /* parse.c */
 PKGCONF_API pkgconf_pkg_t *pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *path, unsigned int flags);
 PKGCONF_API void pkgconf_dependency_parse_str(pkgconf_client_t *client, pkgconf_list_t *deplist_head, const char *depends, unsigned int flags);
 PKGCONF_API void pkgconf_dependency_parse(pkgconf_client_t *client, pkgconf_pkg_t *pkg, pkgconf_list_t *deplist_head, const char *depends, unsigned int flags);
+PKGCONF_API void pkgconf_dependency_cursor_init(pkgconf_dependency_cursor_t *cursor, pkgconf_list_t *list);
+PKGCONF_API void pkgconf_dependency_cursor_deinit(pkgconf_dependency_cursor_t *cursor);
+PKGCONF_API void pkgconf_dependency_parse_cursor(pkgconf_client_t *client, pkgconf_pkg_t *pkg, pkgconf_dependency_cursor_t *cursor, const char *depends, unsigned int flags);
 PKGCONF_API void pkgconf_dependency_append(pkgconf_list_t *list, pkgconf_dependency_t *tail);
 PKGCONF_API void pkgconf_dependency_free(pkgconf_list_t *list);
 PKGCONF_API void pkgconf_dependency_free_one(pkgconf_dependency_t *dep);
@@ -522,6 +739,7 @@ PKGCONF_API pkgconf_dependency_t *pkgconf_dependency_copy(pkgconf_client_t *clie
 /* argvsplit.c */
 PKGCONF_API int pkgconf_argv_split(const char *src, int *argc, char ***argv);
 PKGCONF_API int pkgconf_argv_split_raw(const char *src, int *argc, char ***argv);
+PKGCONF_API int pkgconf_argv_tokenize(const char *src, char *dst, bool raw, int *argc);
 PKGCONF_API void pkgconf_argv_free(char **argv);
 
 /* fragment.c */
@@ -532,32 +750,34 @@ typedef struct pkgconf_fragment_render_ctx_ {
 
 typedef struct pkgconf_fragment_render_ops_ {
 	bool (*render)(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag, pkgconf_buffer_t *buf);
+
+	/*
+	 * optional, and only used as a pair: size returns the exact number of bytes render
+	 * would append for frag, and fill writes those bytes at out, returning the end
+	 */
+	size_t (*size)(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag);
+	char *(*fill)(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag, char *out);
 } pkgconf_fragment_render_ops_t;
 
 typedef bool (*pkgconf_fragment_filter_func_t)(const pkgconf_client_t *client, const pkgconf_fragment_t *frag, void *data);
 
 /* index.c */
-typedef int (*pkgconf_index_cmp_func_t)(const void *a, const void *b);
-
-typedef struct pkgconf_index_ {
-	void **entries;
-	size_t count;
-	size_t alloc;
-	pkgconf_index_cmp_func_t compare;
-} pkgconf_index_t;
-
 PKGCONF_API bool pkgconf_index_insert(pkgconf_index_t *index, void *entry);
 PKGCONF_API void pkgconf_index_remove(pkgconf_index_t *index, void *entry);
 PKGCONF_API void *pkgconf_index_lookup(const pkgconf_index_t *index, const void *key, pkgconf_index_cmp_func_t keycmp);
+PKGCONF_API bool pkgconf_index_build(pkgconf_index_t *index, const pkgconf_list_t *list);
 
 /* A cursor accelerates repeated pkgconf_fragment_copy() calls into the same
- * destination list by maintaining a sorted index of the fragments already
- * present, so that the deduplication lookup is a bsearch() rather than a linear
- * scan of the (potentially large) accumulator.
+ * destination list by maintaining a hash table of the fragments already
+ * present, so that the deduplication lookup is a probe rather than a linear
+ * scan of the (potentially large) accumulator.  Unlike a sorted index, adding
+ * a fragment never moves the ones already recorded.
  */
 typedef struct pkgconf_fragment_cursor_ {
 	pkgconf_list_t *list;
-	pkgconf_index_t index;
+	pkgconf_fragment_t **slots;
+	size_t count;
+	size_t alloc;
 } pkgconf_fragment_cursor_t;
 
 PKGCONF_API bool pkgconf_fragment_parse(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_list_t *vars, const char *value, unsigned int flags);
@@ -602,6 +822,7 @@ PKGCONF_API bool pkgconf_queue_solve(pkgconf_client_t *client, pkgconf_list_t *l
 PKGCONF_API void pkgconf_queue_free(pkgconf_list_t *list);
 PKGCONF_API bool pkgconf_queue_apply(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_queue_apply_func_t func, int maxdepth, void *data);
 PKGCONF_API bool pkgconf_queue_validate(pkgconf_client_t *client, pkgconf_list_t *list, int maxdepth);
+PKGCONF_API bool pkgconf_queue_exists(pkgconf_client_t *client, pkgconf_list_t *list, int maxdepth);
 PKGCONF_API void pkgconf_solution_free(pkgconf_client_t *client, pkgconf_pkg_t *world);
 
 /* cache.c */
@@ -648,20 +869,71 @@ static inline bool pkgconf_span_contains(unsigned char c, const pkgconf_span_t *
 /* A set of byte values as a 256-bit map, so that membership is a single test
  * rather than a walk over a span list.  Build one with
  * pkgconf_charset_from_spans() and keep it: the point is to hoist the span
- * walk out of any per-byte loop. */
+ * walk out of any per-byte loop.
+ *
+ * pkgconf_charset_from_spans() also records the set as a short list of
+ * inclusive ranges, which pkgconf_charset_scan() tests a block of bytes at a
+ * time against.  A set which needs more than PKGCONF_CHARSET_MAX_RANGES of
+ * them has nranges == 0 and is scanned through the map. */
+#define PKGCONF_CHARSET_MAX_RANGES	12
+
 typedef struct pkgconf_charset_ {
 	uint64_t words[4];
+
+	unsigned int nranges;
+	unsigned char range_lo[PKGCONF_CHARSET_MAX_RANGES];
+	unsigned char range_hi[PKGCONF_CHARSET_MAX_RANGES];
 } pkgconf_charset_t;
 
+/* the empty set; a set filled in by hand must start from this, so that it has no ranges */
+#define PKGCONF_CHARSET_INITIALIZER	{ { 0, 0, 0, 0 }, 0, { 0 }, { 0 } }
+
+/* the bits of the inclusive byte range lo .. hi which fall within word w of a set */
+#define PKGCONF_CHARSET_RANGE_WORD(lo, hi, w) \
+	((lo) > 64 * (w) + 63 || (hi) < 64 * (w) ? UINT64_C(0) : \
+		(~UINT64_C(0) << ((lo) > 64 * (w) ? (lo) - 64 * (w) : 0)) & \
+		(~UINT64_C(0) >> ((hi) < 64 * (w) + 63 ? 64 * (w) + 63 - (hi) : 0)))
+
+#define PKGCONF_CHARSET_WORD0_(lo, hi)	PKGCONF_CHARSET_RANGE_WORD(lo, hi, 0) |
+#define PKGCONF_CHARSET_WORD1_(lo, hi)	PKGCONF_CHARSET_RANGE_WORD(lo, hi, 1) |
+#define PKGCONF_CHARSET_WORD2_(lo, hi)	PKGCONF_CHARSET_RANGE_WORD(lo, hi, 2) |
+#define PKGCONF_CHARSET_WORD3_(lo, hi)	PKGCONF_CHARSET_RANGE_WORD(lo, hi, 3) |
+#define PKGCONF_CHARSET_COUNT_(lo, hi)	1 +
+#define PKGCONF_CHARSET_LO_(lo, hi)	(lo),
+#define PKGCONF_CHARSET_HI_(lo, hi)	(hi),
+
+/* A set built at compile time, so that a constant set needs no lazy, racy
+ * initialization.  RANGES is a macro which applies its argument to each
+ * inclusive range of the set in turn:
+ *
+ *    #define JSON_ESCAPE_RANGES(X) X(0x00, 0x1f) X('"', '"') X('\\', '\\')
+ *    static const pkgconf_charset_t json_escape = PKGCONF_CHARSET_FROM_RANGES(JSON_ESCAPE_RANGES);
+ *
+ * The ranges are scanned as given, so there must be at least one and no more
+ * than PKGCONF_CHARSET_MAX_RANGES of them. */
+#define PKGCONF_CHARSET_FROM_RANGES(RANGES) { \
+		{ \
+			RANGES(PKGCONF_CHARSET_WORD0_) UINT64_C(0), \
+			RANGES(PKGCONF_CHARSET_WORD1_) UINT64_C(0), \
+			RANGES(PKGCONF_CHARSET_WORD2_) UINT64_C(0), \
+			RANGES(PKGCONF_CHARSET_WORD3_) UINT64_C(0), \
+		}, \
+		RANGES(PKGCONF_CHARSET_COUNT_) 0, \
+		{ RANGES(PKGCONF_CHARSET_LO_) }, \
+		{ RANGES(PKGCONF_CHARSET_HI_) }, \
+	}
+
 static inline bool pkgconf_charset_contains(const pkgconf_charset_t *charset, unsigned char c)
 {
 	return (charset->words[c >> 6] >> (c & 63)) & 1;
 }
 
 PKGCONF_API void pkgconf_charset_from_spans(pkgconf_charset_t *charset, const pkgconf_span_t *spans, size_t nspans);
+PKGCONF_API size_t pkgconf_charset_scan(const pkgconf_charset_t *charset, const char *p, size_t n);
 
 PKGCONF_API bool pkgconf_buffer_append(pkgconf_buffer_t *buffer, const char *text);
 PKGCONF_API bool pkgconf_buffer_append_slice(pkgconf_buffer_t *buf, const char *p, size_t n);
+PKGCONF_API char *pkgconf_buffer_extend(pkgconf_buffer_t *buf, size_t n);
 PKGCONF_API bool pkgconf_buffer_append_fmt(pkgconf_buffer_t *buffer, const char *fmt, ...) PRINTFLIKE(2, 3);
 PKGCONF_API bool pkgconf_buffer_append_vfmt(pkgconf_buffer_t *buffer, const char *fmt, va_list va) PRINTFLIKE(2, 0);
 PKGCONF_API bool pkgconf_buffer_prepend(pkgconf_buffer_t *buffer, const char *text);
@@ -850,6 +1122,58 @@ static inline bool pkgconf_str_eq_slice(const char *s, const char *p, size_t n)
 PKGCONF_API pkgconf_bufferset_t *pkgconf_bufferset_extend(pkgconf_list_t *list, pkgconf_buffer_t *buffer);
 PKGCONF_API void pkgconf_bufferset_free(pkgconf_list_t *list);
 
+/* graph.c */
+typedef enum {
+	PKGCONF_PKG_DEPLIST_REQUIRES = 0,
+	PKGCONF_PKG_DEPLIST_REQUIRES_SHARED,
+	PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE,
+} pkgconf_pkg_deplist_t;
+
+typedef struct pkgconf_graph_edge_ {
+	size_t target;
+	pkgconf_dependency_t *dep;
+	unsigned int flags;
+	pkgconf_pkg_deplist_t deplist;
+} pkgconf_graph_edge_t;
+
+/*
+ * A frozen dependency graph in compressed sparse row form: the edges of node `i`
+ * are edges[edge_index[i]] up to (but not including) edges[edge_index[i + 1]].
+ * Node 0 is the root the graph was frozen from.
+ */
+struct pkgconf_graph_ {
+	pkgconf_pkg_t **nodes;
+	size_t *edge_index;
+	pkgconf_graph_edge_t *edges;
+	size_t node_count;
+	size_t edge_count;
+};
+
+PKGCONF_API bool pkgconf_graph_freeze(pkgconf_client_t *client, pkgconf_pkg_t *root);
+PKGCONF_API void pkgconf_graph_free(pkgconf_client_t *client, pkgconf_pkg_t *root);
+
+/* stack.c */
+PKGCONF_API void *pkgconf_stack_push(pkgconf_stack_t *stack, size_t size);
+PKGCONF_API void *pkgconf_stack_top(const pkgconf_stack_t *stack, size_t size);
+PKGCONF_API void pkgconf_stack_pop(pkgconf_stack_t *stack, size_t size);
+PKGCONF_API void pkgconf_stack_free(pkgconf_stack_t *stack);
+
+/* stats.c */
+
+/* counters are always maintained; the client is written through even where the caller holds it const */
+#define PKGCONF_STATS_ADD(client, counter, n)	(((pkgconf_client_t *) (client))->stats.counters[(counter)] += (uint64_t) (n))
+#define PKGCONF_STATS_INC(client, counter)	PKGCONF_STATS_ADD(client, counter, 1)
+
+PKGCONF_API uint64_t pkgconf_stats_now(void);
+PKGCONF_API void pkgconf_stats_reset(pkgconf_client_t *client);
+PKGCONF_API void pkgconf_stats_set_timing(pkgconf_client_t *client, bool timing);
+PKGCONF_API pkgconf_stats_phase_t pkgconf_stats_phase_begin(const pkgconf_client_t *client, pkgconf_stats_phase_t phase);
+PKGCONF_API void pkgconf_stats_phase_end(const pkgconf_client_t *client, pkgconf_stats_phase_t previous);
+PKGCONF_API const char *pkgconf_stats_counter_name(pkgconf_stats_counter_t counter);
+PKGCONF_API bool pkgconf_stats_counter_lookup(const char *name, pkgconf_stats_counter_t *counter);
+PKGCONF_API const char *pkgconf_stats_phase_name(pkgconf_stats_phase_t phase);
+PKGCONF_API bool pkgconf_stats_render(const pkgconf_client_t *client, pkgconf_buffer_t *buf);
+
 /* fileio.c */
 PKGCONF_API bool pkgconf_fgetline(pkgconf_buffer_t *buffer, FILE *stream);
 
@@ -871,12 +1195,23 @@ typedef enum {
 	PKGCONF_OUTPUT_STDERR,
 } pkgconf_output_stream_t;
 
+/* one piece of a vectored write; the data is not copied and need not be NUL-terminated */
+typedef struct {
+	const char *data;
+	size_t len;
+} pkgconf_output_segment_t;
+
 struct pkgconf_output_ {
 	void *privdata;
 
 	bool (*write)(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer);
+
+	/* optional: outputs without it get the segments joined into a buffer and passed to write */
+	bool (*writev)(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_output_segment_t *segments, size_t count);
 };
 
+PKGCONF_API bool pkgconf_output_writev(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_output_segment_t *segments, size_t count);
+
 PKGCONF_API bool pkgconf_output_putbuf(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer, bool newline);
 PKGCONF_API bool pkgconf_output_puts(pkgconf_output_t *output, pkgconf_output_stream_t stream, const char *str);
 PKGCONF_API bool pkgconf_output_fmt(pkgconf_output_t *output, pkgconf_output_stream_t stream, const char *fmt, ...) PRINTFLIKE(3,4);
@@ -18,20 +18,42 @@
 #include <libpkgconf/stdinc.h>
 #include <libpkgconf/libpkgconf.h>
 
+#ifndef _WIN32
+# include <sys/uio.h>
+#endif
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_output_writev(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_output_segment_t *segments, size_t count)
+ *
+ *    Writes `segments` to `stream` as one write, in order.  Outputs which implement
+ *    ``writev`` receive the segments as they are; for other outputs they are joined
+ *    into a single buffer for ``write``.
+ *
+ *    :param pkgconf_output_t* output: The output to write to.
+ *    :param pkgconf_output_stream_t stream: The stream to write to.
+ *    :param pkgconf_output_segment_t* segments: The segments to write.
+ *    :param size_t count: The number of segments.
+ *    :return: :code:`true` on success, :code:`false` on failure.
+ */
 bool
-pkgconf_output_putbuf(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer, bool newline)
+pkgconf_output_writev(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_output_segment_t *segments, size_t count)
 {
 	bool ret;
 	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
 
-	if (pkgconf_buffer_len(buffer) != 0 &&
-		!pkgconf_buffer_append(&buf, pkgconf_buffer_str(buffer)))
-		return false;
+	if (output->writev != NULL)
+		return output->writev(output, stream, segments, count);
 
-	if (newline && !pkgconf_buffer_push_byte(&buf, '\n'))
+	for (size_t i = 0; i < count; i++)
 	{
-		pkgconf_buffer_finalize(&buf);
-		return false;
+		if (segments[i].len != 0 &&
+			!pkgconf_buffer_append_slice(&buf, segments[i].data, segments[i].len))
+		{
+			pkgconf_buffer_finalize(&buf);
+			return false;
+		}
 	}
 
 	ret = output->write(output, stream, &buf);
@@ -41,22 +63,25 @@ pkgconf_output_putbuf(pkgconf_output_t *output, pkgconf_output_stream_t stream,
 }
 
 bool
-pkgconf_output_puts(pkgconf_output_t *output, pkgconf_output_stream_t stream, const char *str)
+pkgconf_output_putbuf(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer, bool newline)
 {
-	bool ret;
-	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+	const pkgconf_output_segment_t segments[] = {
+		{ pkgconf_buffer_str(buffer), pkgconf_buffer_len(buffer) },
+		{ "\n", 1 },
+	};
 
-	if (!pkgconf_buffer_append(&buf, str) ||
-		!pkgconf_buffer_push_byte(&buf, '\n'))
-	{
-		pkgconf_buffer_finalize(&buf);
-		return false;
-	}
+	return pkgconf_output_writev(output, stream, segments, newline ? 2 : 1);
+}
 
-	ret = output->write(output, stream, &buf);
-	pkgconf_buffer_finalize(&buf);
+bool
+pkgconf_output_puts(pkgconf_output_t *output, pkgconf_output_stream_t stream, const char *str)
+{
+	const pkgconf_output_segment_t segments[] = {
+		{ str, strlen(str) },
+		{ "\n", 1 },
+	};
 
-	return ret;
+	return pkgconf_output_writev(output, stream, segments, 2);
 }
 
 bool
@@ -90,29 +115,124 @@ pkgconf_output_vfmt(pkgconf_output_t *output, pkgconf_output_stream_t stream, co
 	return ret;
 }
 
+/*
+ * Writes this large or larger bypass stdio: stdio is flushed and the segments go
+ * straight to the file descriptor with writev(), so they are never copied.  Smaller
+ * writes are left to stdio's buffering, which turns the many short lines printed by
+ * --digraph, --print-variables and the like into a few large writes.
+ */
+#define PKGCONF_OUTPUT_DIRECT_SIZE	4096
+#define PKGCONF_OUTPUT_IOV_MAX		16
+
+#ifndef _WIN32
 static bool
-pkgconf_output_stdio_write(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer)
+pkgconf_output_fd_writev(int fd, const pkgconf_output_segment_t *segments, size_t count)
+{
+	struct iovec iov[PKGCONF_OUTPUT_IOV_MAX];
+
+	while (count > 0)
+	{
+		size_t n = count < PKGCONF_OUTPUT_IOV_MAX ? count : PKGCONF_OUTPUT_IOV_MAX;
+		struct iovec *cur = iov;
+		size_t left = n;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			iov[i].iov_base = (void *) segments[i].data;
+			iov[i].iov_len = segments[i].len;
+		}
+
+		for (;;)
+		{
+			while (left > 0 && cur->iov_len == 0)
+				cur++, left--;
+
+			if (left == 0)
+				break;
+
+			ssize_t written = writev(fd, cur, (int) left);
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written <= 0)
+				return false;
+
+			/* a short write may stop partway through a segment */
+			while ((size_t) written >= cur->iov_len)
+			{
+				written -= (ssize_t) cur->iov_len;
+				cur++, left--;
+
+				if (left == 0)
+					break;
+			}
+
+			if (left > 0)
+			{
+				cur->iov_base = (char *) cur->iov_base + written;
+				cur->iov_len -= (size_t) written;
+			}
+		}
+
+		segments += n;
+		count -= n;
+	}
+
+	return true;
+}
+#endif
+
+static bool
+pkgconf_output_stdio_writev(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_output_segment_t *segments, size_t count)
 {
 	(void) output;
 
 	FILE *target = stream == PKGCONF_OUTPUT_STDERR ? stderr : stdout;
+	size_t total = 0;
 
-	if (buffer != NULL)
+	/* stderr is unbuffered, so anything still held for stdout has to go first */
+	if (stream == PKGCONF_OUTPUT_STDERR)
+		fflush(stdout);
+
+	for (size_t i = 0; i < count; i++)
+		total += segments[i].len;
+
+#ifndef _WIN32
+	if (total >= PKGCONF_OUTPUT_DIRECT_SIZE)
 	{
-		const char *str = pkgconf_buffer_str(buffer);
-		size_t size = pkgconf_buffer_len(buffer);
+		if (fflush(target) != 0)
+			return false;
+
+		return pkgconf_output_fd_writev(fileno(target), segments, count);
+	}
+#endif
 
-		if (size > 0 && !fwrite(str, size, 1, target))
+	for (size_t i = 0; i < count; i++)
+	{
+		if (segments[i].len > 0 && !fwrite(segments[i].data, segments[i].len, 1, target))
 			return false;
 	}
 
-	fflush(target);
 	return true;
 }
 
+static bool
+pkgconf_output_stdio_write(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer)
+{
+	pkgconf_output_segment_t segment = { NULL, 0 };
+
+	if (buffer != NULL)
+	{
+		segment.data = pkgconf_buffer_str(buffer);
+		segment.len = pkgconf_buffer_len(buffer);
+	}
+
+	return pkgconf_output_stdio_writev(output, stream, &segment, 1);
+}
+
 static pkgconf_output_t pkgconf_default_output = {
 	.privdata = NULL,
 	.write = pkgconf_output_stdio_write,
+	.writev = pkgconf_output_stdio_writev,
 };
 
 pkgconf_output_t *
@@ -176,6 +176,7 @@ valid_triplet(const char *triplet)
 typedef void (*personality_keyword_func_t)(pkgconf_cross_personality_t *p, const char *keyword, const pkgconf_parser_location_t *loc, const ptrdiff_t offset, const char *value);
 typedef struct {
 	const char *keyword;
+	const size_t keyword_len;
 	const personality_keyword_func_t func;
 	const ptrdiff_t offset;
 } personality_keyword_pair_t;
@@ -214,31 +215,58 @@ personality_fragment_func(pkgconf_cross_personality_t *p, const char *keyword, c
 	pkgconf_path_split(value, dest, false);
 }
 
-/* keep in alphabetical order! */
-static const personality_keyword_pair_t personality_keyword_pairs[] = {
-	{"DefaultSearchPaths", personality_fragment_func, offsetof(pkgconf_cross_personality_t, dir_list)},
-	{"SysrootDir", personality_copy_func, offsetof(pkgconf_cross_personality_t, sysroot_dir)},
-	{"SystemIncludePaths", personality_fragment_func, offsetof(pkgconf_cross_personality_t, filter_includedirs)},
-	{"SystemLibraryPaths", personality_fragment_func, offsetof(pkgconf_cross_personality_t, filter_libdirs)},
-	{"Triplet", personality_copy_func, offsetof(pkgconf_cross_personality_t, name)},
-	{"WantDefaultPure", personality_bool_func, offsetof(pkgconf_cross_personality_t, want_default_pure)},
-	{"WantDefaultStatic", personality_bool_func, offsetof(pkgconf_cross_personality_t, want_default_static)},
+/*
+ * A perfect hash over the keywords, as for the .pc keywords in pkg.c: the
+ * seventh and last bytes, folded to lower case, give each keyword a slot of
+ * its own.  Every keyword is at least seven bytes long.
+ */
+#define PERSONALITY_KEYWORD_SLOTS	16
+#define PERSONALITY_KEYWORD_MIN_LEN	7
+
+#define PERSONALITY_KEYWORD_HASH(seventh, last) \
+	((((seventh) | 0x20) + ((last) | 0x20)) & (PERSONALITY_KEYWORD_SLOTS - 1))
+
+#define PERSONALITY_KEYWORD(seventh, last, keyword, func, field) \
+	[PERSONALITY_KEYWORD_HASH(seventh, last)] = \
+		{ keyword, sizeof(keyword) - 1, func, offsetof(pkgconf_cross_personality_t, field) }
+
+/* hash-ordered: each entry is placed in the slot PERSONALITY_KEYWORD_HASH() computes
+ * from the bytes spelled out in it, so the order of the lines below does not matter.
+ * to add a keyword, spell out its seventh and last bytes and rebuild; if the build
+ * reports an overridden initializer, pick other bytes for the hash.
+ */
+static const personality_keyword_pair_t personality_keyword_pairs[PERSONALITY_KEYWORD_SLOTS] = {
+	PERSONALITY_KEYWORD('t', 's', "DefaultSearchPaths", personality_fragment_func, dir_list),
+	PERSONALITY_KEYWORD('t', 'r', "SysrootDir", personality_copy_func, sysroot_dir),
+	PERSONALITY_KEYWORD('I', 's', "SystemIncludePaths", personality_fragment_func, filter_includedirs),
+	PERSONALITY_KEYWORD('L', 's', "SystemLibraryPaths", personality_fragment_func, filter_libdirs),
+	PERSONALITY_KEYWORD('t', 't', "Triplet", personality_copy_func, name),
+	PERSONALITY_KEYWORD('f', 'e', "WantDefaultPure", personality_bool_func, want_default_pure),
+	PERSONALITY_KEYWORD('f', 'c', "WantDefaultStatic", personality_bool_func, want_default_static),
 };
 
-static int
-personality_keyword_pair_cmp(const void *key, const void *ptr)
+static const personality_keyword_pair_t *
+personality_keyword_lookup(const char *keyword)
 {
-	const personality_keyword_pair_t *pair = ptr;
-	return strcasecmp(key, pair->keyword);
+	size_t len = strlen(keyword);
+	const personality_keyword_pair_t *pair;
+
+	if (len < PERSONALITY_KEYWORD_MIN_LEN)
+		return NULL;
+
+	pair = &personality_keyword_pairs[PERSONALITY_KEYWORD_HASH((unsigned char) keyword[6], (unsigned char) keyword[len - 1])];
+
+	if (pair->keyword == NULL || pair->keyword_len != len || strcasecmp(keyword, pair->keyword))
+		return NULL;
+
+	return pair;
 }
 
 static void
 personality_keyword_set(void *data, const pkgconf_parser_location_t *loc, const char *keyword, const char *value)
 {
 	pkgconf_cross_personality_t *p = data;
-	const personality_keyword_pair_t *pair = bsearch(keyword,
-		personality_keyword_pairs, PKGCONF_ARRAY_SIZE(personality_keyword_pairs),
-		sizeof(personality_keyword_pair_t), personality_keyword_pair_cmp);
+	const personality_keyword_pair_t *pair = personality_keyword_lookup(keyword);
 
 	if (pair == NULL || pair->func == NULL)
 		return;
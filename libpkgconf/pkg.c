@@ -32,13 +32,23 @@
 
 #define PKG_CONFIG_EXT ".pc"
 
+/*
+ * A traversal lane is one consumer of a graph walk: a callback together with the
+ * dependency flags it skips.  Several lanes can share a single walk; each lane
+ * visits the packages, in the same order, that a walk of its own would visit.
+ */
+typedef struct {
+	pkgconf_pkg_traverse_func_t func;
+	void *data;
+	unsigned int skip_flags;
+} pkgconf_pkg_traverse_lane_t;
+
 static unsigned int
 pkgconf_pkg_traverse_main(pkgconf_client_t *client,
 	pkgconf_pkg_t *root,
-	pkgconf_pkg_traverse_func_t func,
-	void *data,
+	const pkgconf_pkg_traverse_lane_t *lanes,
+	unsigned int active,
 	int maxdepth,
-	unsigned int skip_flags,
 	unsigned int iter_flags);
 
 static inline bool
@@ -152,16 +162,11 @@ fail:
 typedef void (*pkgconf_pkg_parser_keyword_func_t)(pkgconf_client_t *client, pkgconf_pkg_t *pkg, const char *keyword, const pkgconf_parser_location_t *loc, const ptrdiff_t offset, const char *value);
 typedef struct {
 	const char *keyword;
+	const size_t keyword_len;
 	const pkgconf_pkg_parser_keyword_func_t func;
 	const ptrdiff_t offset;
 } pkgconf_pkg_parser_keyword_pair_t;
 
-static int pkgconf_pkg_parser_keyword_pair_cmp(const void *key, const void *ptr)
-{
-	const pkgconf_pkg_parser_keyword_pair_t *pair = ptr;
-	return strcasecmp(key, pair->keyword);
-}
-
 static void
 pkgconf_pkg_parser_tuple_func(pkgconf_client_t *client, pkgconf_pkg_t *pkg, const char *keyword, const pkgconf_parser_location_t *loc, const ptrdiff_t offset, const char *value)
 {
@@ -342,44 +347,89 @@ pkgconf_pkg_evaluate_license_func(pkgconf_client_t *client, pkgconf_pkg_t *pkg,
 			loc->filename, loc->lineno, keyword);
 }
 
-/* keep this in alphabetical order */
-static const pkgconf_pkg_parser_keyword_pair_t pkgconf_pkg_parser_keyword_funcs[] = {
-	{"CFLAGS", pkgconf_pkg_parser_fragment_func, offsetof(pkgconf_pkg_t, cflags)},
-	{"CFLAGS.private", pkgconf_pkg_parser_fragment_func, offsetof(pkgconf_pkg_t, cflags_private)},
-	{"CFLAGS.shared", pkgconf_pkg_parser_fragment_func, offsetof(pkgconf_pkg_t, cflags_shared)},
-	{"Conflicts", pkgconf_pkg_parser_dependency_func, offsetof(pkgconf_pkg_t, conflicts)},
-	{"Copyright", pkgconf_pkg_parser_bufferset_func, offsetof(pkgconf_pkg_t, copyright)},
-	{"Description", pkgconf_pkg_parser_tuple_func, offsetof(pkgconf_pkg_t, description)},
-	{"LIBS", pkgconf_pkg_parser_fragment_func, offsetof(pkgconf_pkg_t, libs)},
-	{"LIBS.private", pkgconf_pkg_parser_fragment_func, offsetof(pkgconf_pkg_t, libs_private)},
-	{"LIBS.shared", pkgconf_pkg_parser_fragment_func, offsetof(pkgconf_pkg_t, libs_shared)},
-	{"License", pkgconf_pkg_evaluate_license_func, offsetof(pkgconf_pkg_t, license)},
-	{"License.file", pkgconf_pkg_parser_tuple_func, offsetof(pkgconf_pkg_t, license_file)},
-	{"Link.ABI", pkgconf_pkg_parser_link_abi_func, offsetof(pkgconf_pkg_t, link_abi)},
-	{"Maintainer", pkgconf_pkg_parser_tuple_func, offsetof(pkgconf_pkg_t, maintainer)},
-	{"Name", pkgconf_pkg_parser_tuple_func, offsetof(pkgconf_pkg_t, realname)},
-	{"Provides", pkgconf_pkg_parser_dependency_func, offsetof(pkgconf_pkg_t, provides)},
-	{"Requires", pkgconf_pkg_parser_dependency_func, offsetof(pkgconf_pkg_t, required)},
-	{"Requires.internal", pkgconf_pkg_parser_internal_dependency_func, offsetof(pkgconf_pkg_t, requires_private)},
-	{"Requires.private", pkgconf_pkg_parser_private_dependency_func, offsetof(pkgconf_pkg_t, requires_private)},
-	{"Requires.shared", pkgconf_pkg_parser_shared_dependency_func, offsetof(pkgconf_pkg_t, requires_shared)},
-	{"Source", pkgconf_pkg_parser_tuple_func, offsetof(pkgconf_pkg_t, source)},
-	{"URL", pkgconf_pkg_parser_tuple_func, offsetof(pkgconf_pkg_t, url)},
-	{"Version", pkgconf_pkg_parser_version_func, offsetof(pkgconf_pkg_t, version)},
+/*
+ * The keywords are dispatched through a perfect hash: each one has a slot of
+ * its own in a 64-entry table, so a lookup is a hash, a length check and one
+ * comparison.  The hash takes the length and the first, third and last bytes
+ * of the keyword, folded to lower case; every keyword is at least three bytes
+ * long.  The compiler computes each slot from the bytes spelled out in its
+ * entry, which must match the keyword.  A new keyword which collides with an
+ * existing one shows up as an overridden initializer (-Woverride-init), and
+ * then the multipliers in the hash need to change.
+ */
+#define PKG_KEYWORD_SLOTS	64
+#define PKG_KEYWORD_MIN_LEN	3
+
+#define PKG_KEYWORD_HASH(len, first, third, last) \
+	((3 * (len) + 2 * ((first) | 0x20) + ((third) | 0x20) + ((last) | 0x20)) & (PKG_KEYWORD_SLOTS - 1))
+
+#define PKG_KEYWORD(first, third, last, keyword, func, field) \
+	[PKG_KEYWORD_HASH(sizeof(keyword) - 1, first, third, last)] = \
+		{ keyword, sizeof(keyword) - 1, func, offsetof(pkgconf_pkg_t, field) }
+
+/* hash-ordered: each entry is placed in the slot PKG_KEYWORD_HASH() computes from the
+ * bytes spelled out in it, so the order of the lines below does not matter.  to add a
+ * keyword, spell out its first, third and last bytes and rebuild; if the build reports
+ * an overridden initializer, adjust the multipliers in PKG_KEYWORD_HASH().
+ */
+static const pkgconf_pkg_parser_keyword_pair_t pkgconf_pkg_parser_keyword_funcs[PKG_KEYWORD_SLOTS] = {
+	PKG_KEYWORD('C', 'L', 'S', "CFLAGS", pkgconf_pkg_parser_fragment_func, cflags),
+	PKG_KEYWORD('C', 'L', 'e', "CFLAGS.private", pkgconf_pkg_parser_fragment_func, cflags_private),
+	PKG_KEYWORD('C', 'L', 'd', "CFLAGS.shared", pkgconf_pkg_parser_fragment_func, cflags_shared),
+	PKG_KEYWORD('C', 'n', 's', "Conflicts", pkgconf_pkg_parser_dependency_func, conflicts),
+	PKG_KEYWORD('C', 'p', 't', "Copyright", pkgconf_pkg_parser_bufferset_func, copyright),
+	PKG_KEYWORD('D', 's', 'n', "Description", pkgconf_pkg_parser_tuple_func, description),
+	PKG_KEYWORD('L', 'B', 'S', "LIBS", pkgconf_pkg_parser_fragment_func, libs),
+	PKG_KEYWORD('L', 'B', 'e', "LIBS.private", pkgconf_pkg_parser_fragment_func, libs_private),
+	PKG_KEYWORD('L', 'B', 'd', "LIBS.shared", pkgconf_pkg_parser_fragment_func, libs_shared),
+	PKG_KEYWORD('L', 'c', 'e', "License", pkgconf_pkg_evaluate_license_func, license),
+	PKG_KEYWORD('L', 'c', 'e', "License.file", pkgconf_pkg_parser_tuple_func, license_file),
+	PKG_KEYWORD('L', 'n', 'I', "Link.ABI", pkgconf_pkg_parser_link_abi_func, link_abi),
+	PKG_KEYWORD('M', 'i', 'r', "Maintainer", pkgconf_pkg_parser_tuple_func, maintainer),
+	PKG_KEYWORD('N', 'm', 'e', "Name", pkgconf_pkg_parser_tuple_func, realname),
+	PKG_KEYWORD('P', 'o', 's', "Provides", pkgconf_pkg_parser_dependency_func, provides),
+	PKG_KEYWORD('R', 'q', 's', "Requires", pkgconf_pkg_parser_dependency_func, required),
+	PKG_KEYWORD('R', 'q', 'l', "Requires.internal", pkgconf_pkg_parser_internal_dependency_func, requires_private),
+	PKG_KEYWORD('R', 'q', 'e', "Requires.private", pkgconf_pkg_parser_private_dependency_func, requires_private),
+	PKG_KEYWORD('R', 'q', 'd', "Requires.shared", pkgconf_pkg_parser_shared_dependency_func, requires_shared),
+	PKG_KEYWORD('S', 'u', 'e', "Source", pkgconf_pkg_parser_tuple_func, source),
+	PKG_KEYWORD('U', 'L', 'L', "URL", pkgconf_pkg_parser_tuple_func, url),
+	PKG_KEYWORD('V', 'r', 'n', "Version", pkgconf_pkg_parser_version_func, version),
 };
 
+static const pkgconf_pkg_parser_keyword_pair_t *
+pkgconf_pkg_parser_keyword_lookup(const char *keyword)
+{
+	size_t len = strlen(keyword);
+	const pkgconf_pkg_parser_keyword_pair_t *pair;
+
+	if (len < PKG_KEYWORD_MIN_LEN)
+		return NULL;
+
+	pair = &pkgconf_pkg_parser_keyword_funcs[PKG_KEYWORD_HASH(len,
+		(unsigned char) keyword[0], (unsigned char) keyword[2], (unsigned char) keyword[len - 1])];
+
+	if (pair->keyword == NULL || pair->keyword_len != len || strcasecmp(keyword, pair->keyword))
+		return NULL;
+
+	return pair;
+}
+
 static void
 pkgconf_pkg_parser_keyword_set(void *opaque, const pkgconf_parser_location_t *loc, const char *keyword, const char *value)
 {
 	pkgconf_pkg_t *pkg = opaque;
 
-	const pkgconf_pkg_parser_keyword_pair_t *pair = bsearch(keyword,
-		pkgconf_pkg_parser_keyword_funcs, PKGCONF_ARRAY_SIZE(pkgconf_pkg_parser_keyword_funcs),
-		sizeof(pkgconf_pkg_parser_keyword_pair_t), pkgconf_pkg_parser_keyword_pair_cmp);
+	const pkgconf_pkg_parser_keyword_pair_t *pair = pkgconf_pkg_parser_keyword_lookup(keyword);
 
 	if (pair == NULL || pair->func == NULL)
 		return;
 
+	/* an existence check never renders fragments or licenses, so skip evaluating them */
+	if ((pkg->flags & PKGCONF_PKG_PROPF_HEADER_ONLY) &&
+		(pair->func == pkgconf_pkg_parser_fragment_func || pair->func == pkgconf_pkg_evaluate_license_func))
+		return;
+
 	pair->func(pkg->owner, pkg, keyword, loc, pair->offset, value);
 }
 
@@ -692,6 +742,8 @@ pkg_free_object(pkgconf_pkg_t *pkg)
 	if (pkg->version != NULL)
 		free(pkg->version);
 
+	pkgconf_version_free(&pkg->parsed_version);
+
 	if (pkg->description != NULL)
 		free(pkg->description);
 
@@ -725,6 +777,9 @@ pkg_free_lists(pkgconf_pkg_t *pkg)
 	pkgconf_bufferset_free(&pkg->copyright);
 	pkgconf_bufferset_free(&pkg->link_abi);
 
+	free(pkg->required_index.entries);
+	pkg->required_index = (pkgconf_index_t){ 0 };
+
 	pkgconf_dependency_free(&pkg->required);
 	pkgconf_dependency_free(&pkg->requires_private);
 	pkgconf_dependency_free(&pkg->requires_shared);
@@ -742,22 +797,8 @@ pkg_free_lists(pkgconf_pkg_t *pkg)
 	pkgconf_tuple_free(&pkg->vars);
 }
 
-/*
- * !doc
- *
- * .. c:function:: pkgconf_pkg_t *pkgconf_pkg_new_from_path(const pkgconf_client_t *client, const char *filename, unsigned int flags)
- *
- *    Parse a .pc file into a pkgconf_pkg_t object structure.
- *
- *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
- *    :param char* filename: The filename of the package file (including full path).
- *    :param FILE* f: The file object to read from.
- *    :param uint flags: The flags to use when parsing.
- *    :returns: A ``pkgconf_pkg_t`` object which contains the package data.
- *    :rtype: pkgconf_pkg_t *
- */
-pkgconf_pkg_t *
-pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *filename, unsigned int flags)
+static pkgconf_pkg_t *
+pkgconf_pkg_new_from_path_main(pkgconf_client_t *client, const char *filename, unsigned int flags)
 {
 	pkgconf_pkg_t *pkg;
 	char *idptr;
@@ -769,7 +810,12 @@ pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *filename, unsign
 
 	f = fopen(filename, "rb");
 	if (f == NULL)
+	{
+		PKGCONF_STATS_INC(client, PKGCONF_STATS_FILES_FAILED);
 		return NULL;
+	}
+
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_FILES_OPENED);
 
 	pkg = calloc(1, sizeof(pkgconf_pkg_t));
 	if (pkg == NULL)
@@ -781,6 +827,9 @@ pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *filename, unsign
 	pkg->owner = client;
 	pkg->flags = flags;
 
+	if (client->flags & PKGCONF_PKG_PKGF_EXISTENCE_CHECK)
+		pkg->flags |= PKGCONF_PKG_PROPF_HEADER_ONLY;
+
 	pkg->filename = strdup(filename);
 	if (pkg->filename == NULL)
 	{
@@ -835,6 +884,12 @@ pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *filename, unsign
 	}
 
 	pkgconf_parser_parse(f, pkg, pkg_parser_funcs, pkg_warn_func, pkg->filename);
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_PACKAGES_PARSED);
+
+	long parsed = ftell(f);
+	if (parsed > 0)
+		PKGCONF_STATS_ADD(client, PKGCONF_STATS_BYTES_PARSED, parsed);
+
 	fclose(f);
 
 	if (!pkgconf_pkg_validate(client, pkg))
@@ -873,6 +928,33 @@ pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *filename, unsign
 	return pkgconf_pkg_ref(client, pkg);
 }
 
+/*
+ * !doc
+ *
+ * .. c:function:: pkgconf_pkg_t *pkgconf_pkg_new_from_path(const pkgconf_client_t *client, const char *filename, unsigned int flags)
+ *
+ *    Parse a .pc file into a pkgconf_pkg_t object structure.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
+ *    :param char* filename: The filename of the package file (including full path).
+ *    :param FILE* f: The file object to read from.
+ *    :param uint flags: The flags to use when parsing.
+ *    :returns: A ``pkgconf_pkg_t`` object which contains the package data.
+ *    :rtype: pkgconf_pkg_t *
+ */
+pkgconf_pkg_t *
+pkgconf_pkg_new_from_path(pkgconf_client_t *client, const char *filename, unsigned int flags)
+{
+	pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_PARSE, "pkgconf_pkg_new_from_path", "path", filename, NULL);
+	pkgconf_pkg_t *pkg;
+
+	pkg = pkgconf_pkg_new_from_path_main(client, filename, flags);
+
+	pkgconf_phase_end(client, &phase, pkg);
+
+	return pkg;
+}
+
 /*
  * !doc
  *
@@ -895,6 +977,7 @@ pkgconf_pkg_free(pkgconf_client_t *client, pkgconf_pkg_t *pkg)
 
 	pkgconf_cache_remove(client, pkg);
 
+	pkgconf_graph_free(client, pkg);
 	pkg_free_lists(pkg);
 
 	if (pkg->flags & PKGCONF_PKG_PROPF_VIRTUAL)
@@ -1004,7 +1087,9 @@ pkgconf_pkg_scan_dir(pkgconf_client_t *client, const char *path, void *data, pkg
 	if (dir == NULL)
 		return NULL;
 
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_DIRS_SCANNED);
 	PKGCONF_TRACE(client, "scanning dir [%s]", path);
+	PKGCONF_TRACE_EVENT_BEGIN(client, "pkgconf_pkg_scan_dir", "path", path);
 
 	for (dirent = readdir(dir); dirent != NULL; dirent = readdir(dir))
 	{
@@ -1013,8 +1098,8 @@ pkgconf_pkg_scan_dir(pkgconf_client_t *client, const char *path, void *data, pkg
 
 		if (!pkgconf_buffer_join(&filebuf, '/', path, dirent->d_name, NULL))
 		{
-			closedir(dir);
-			return NULL;
+			pkgconf_buffer_finalize(&filebuf);
+			goto out;
 		}
 
 		if (!str_has_suffix(pkgconf_buffer_str(&filebuf), PKG_CONFIG_EXT))
@@ -1062,6 +1147,7 @@ pkgconf_pkg_scan_dir(pkgconf_client_t *client, const char *path, void *data, pkg
 	}
 
 out:
+	PKGCONF_TRACE_EVENT_END(client, "pkgconf_pkg_scan_dir");
 	closedir(dir);
 	return outpkg;
 }
@@ -1116,6 +1202,18 @@ pkgconf_scan_all(pkgconf_client_t *client, void *data, pkgconf_pkg_iteration_fun
 	return NULL;
 }
 
+/*
+ * pkgconf_pkg_is_incomplete(client, pkg)
+ *
+ * packages loaded during an existence check only carry their header fields,
+ * so they must not be handed out once the client wants the full package again.
+ */
+static inline bool
+pkgconf_pkg_is_incomplete(const pkgconf_client_t *client, const pkgconf_pkg_t *pkg)
+{
+	return (pkg->flags & PKGCONF_PKG_PROPF_HEADER_ONLY) && !(client->flags & PKGCONF_PKG_PKGF_EXISTENCE_CHECK);
+}
+
 static pkgconf_pkg_t *
 search_preload_list(pkgconf_client_t *client, const char *name)
 {
@@ -1135,20 +1233,8 @@ search_preload_list(pkgconf_client_t *client, const char *name)
 	return NULL;
 }
 
-/*
- * !doc
- *
- * .. c:function:: pkgconf_pkg_t *pkgconf_pkg_find(pkgconf_client_t *client, const char *name)
- *
- *    Search for a package.
- *
- *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
- *    :param char* name: The name of the package `atom` to use for searching.
- *    :return: A package object reference if the package was found, else ``NULL``.
- *    :rtype: pkgconf_pkg_t *
- */
-pkgconf_pkg_t *
-pkgconf_pkg_find(pkgconf_client_t *client, const char *name)
+static pkgconf_pkg_t *
+pkgconf_pkg_find_main(pkgconf_client_t *client, const char *name)
 {
 	pkgconf_pkg_t *pkg = NULL;
 	pkgconf_node_t *n;
@@ -1179,8 +1265,16 @@ pkgconf_pkg_find(pkgconf_client_t *client, const char *name)
 	{
 		if ((pkg = pkgconf_cache_lookup(client, name)) != NULL)
 		{
-			PKGCONF_TRACE(client, "%s is cached", name);
-			return pkg;
+			if (!pkgconf_pkg_is_incomplete(client, pkg))
+			{
+				PKGCONF_TRACE(client, "%s is cached", name);
+				return pkg;
+			}
+
+			PKGCONF_TRACE(client, "%s is cached, but was loaded for an existence check, reloading", name);
+			pkgconf_cache_remove(client, pkg);
+			pkgconf_pkg_unref(client, pkg);
+			pkg = NULL;
 		}
 	}
 
@@ -1206,7 +1300,50 @@ out:
 	return pkg;
 }
 
-typedef bool (*pkgconf_vercmp_res_func_t)(const char *a, const char *b);
+/*
+ * !doc
+ *
+ * .. c:function:: pkgconf_pkg_t *pkgconf_pkg_find(pkgconf_client_t *client, const char *name)
+ *
+ *    Search for a package.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
+ *    :param char* name: The name of the package `atom` to use for searching.
+ *    :return: A package object reference if the package was found, else ``NULL``.
+ *    :rtype: pkgconf_pkg_t *
+ */
+pkgconf_pkg_t *
+pkgconf_pkg_find(pkgconf_client_t *client, const char *name)
+{
+	pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SEARCH, "pkgconf_pkg_find", "name", name, NULL);
+	pkgconf_pkg_t *pkg;
+
+	pkg = pkgconf_pkg_find_main(client, name);
+
+	pkgconf_phase_end(client, &phase, pkg);
+
+	return pkg;
+}
+
+typedef bool (*pkgconf_vercmp_res_func_t)(const pkgconf_version_t *a, const pkgconf_version_t *b);
+
+/*
+ * the parsed form of a package's or dependency's version, tokenised on first use
+ * and kept next to the string so that later comparisons skip the tokeniser.
+ */
+static inline const pkgconf_version_t *
+pkgconf_pkg_parsed_version(pkgconf_pkg_t *pkg)
+{
+	(void) pkgconf_version_parse(&pkg->parsed_version, pkg->version);
+	return &pkg->parsed_version;
+}
+
+static inline const pkgconf_version_t *
+pkgconf_dependency_parsed_version(pkgconf_dependency_t *dep)
+{
+	(void) pkgconf_version_parse(&dep->parsed_version, dep->version);
+	return &dep->parsed_version;
+}
 
 typedef struct {
 	const char *name;
@@ -1229,37 +1366,37 @@ static int pkgconf_pkg_comparator_pair_namecmp(const void *key, const void *ptr)
 	return strcmp(key, pair->name);
 }
 
-static bool pkgconf_pkg_comparator_lt(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_lt(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
-	return (pkgconf_compare_version(a, b) < 0);
+	return (pkgconf_version_compare(a, b) < 0);
 }
 
-static bool pkgconf_pkg_comparator_gt(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_gt(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
-	return (pkgconf_compare_version(a, b) > 0);
+	return (pkgconf_version_compare(a, b) > 0);
 }
 
-static bool pkgconf_pkg_comparator_lte(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_lte(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
-	return (pkgconf_compare_version(a, b) <= 0);
+	return (pkgconf_version_compare(a, b) <= 0);
 }
 
-static bool pkgconf_pkg_comparator_gte(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_gte(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
-	return (pkgconf_compare_version(a, b) >= 0);
+	return (pkgconf_version_compare(a, b) >= 0);
 }
 
-static bool pkgconf_pkg_comparator_eq(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_eq(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
-	return (pkgconf_compare_version(a, b) == 0);
+	return (pkgconf_version_compare(a, b) == 0);
 }
 
-static bool pkgconf_pkg_comparator_ne(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_ne(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
-	return (pkgconf_compare_version(a, b) != 0);
+	return (pkgconf_version_compare(a, b) != 0);
 }
 
-static bool pkgconf_pkg_comparator_any(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_any(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
 	(void) a;
 	(void) b;
@@ -1267,7 +1404,7 @@ static bool pkgconf_pkg_comparator_any(const char *a, const char *b)
 	return true;
 }
 
-static bool pkgconf_pkg_comparator_none(const char *a, const char *b)
+static bool pkgconf_pkg_comparator_none(const pkgconf_version_t *a, const pkgconf_version_t *b)
 {
 	(void) a;
 	(void) b;
@@ -1446,16 +1583,18 @@ static const pkgconf_pkg_provides_vermatch_rule_t pkgconf_pkg_provides_vermatch_
  * XXX: maybe handle PKGCONF_CMP_ANY in a versioned comparison
  */
 static bool
-pkgconf_pkg_scan_provides_vercmp(const pkgconf_dependency_t *pkgdep, const pkgconf_dependency_t *provider)
+pkgconf_pkg_scan_provides_vercmp(pkgconf_dependency_t *pkgdep, pkgconf_dependency_t *provider)
 {
 	const pkgconf_pkg_provides_vermatch_rule_t *rule = &pkgconf_pkg_provides_vermatch_rules[pkgdep->compare];
+	const pkgconf_version_t *depver = pkgconf_dependency_parsed_version(pkgdep);
+	const pkgconf_version_t *providerver = pkgconf_dependency_parsed_version(provider);
 
 	if (rule->depcmp[provider->compare] != NULL &&
-		!rule->depcmp[provider->compare](provider->version, pkgdep->version))
+		!rule->depcmp[provider->compare](providerver, depver))
 		return false;
 
 	if (rule->rulecmp[provider->compare] != NULL &&
-		!rule->rulecmp[provider->compare](pkgdep->version, provider->version))
+		!rule->rulecmp[provider->compare](depver, providerver))
 		return false;
 
 	return true;
@@ -1470,12 +1609,12 @@ static bool
 pkgconf_pkg_scan_provides_entry(const pkgconf_pkg_t *pkg, void *data)
 {
 	const pkgconf_pkg_scan_providers_ctx_t *ctx = data;
-	const pkgconf_dependency_t *pkgdep = ctx->pkgdep;
+	pkgconf_dependency_t *pkgdep = ctx->pkgdep;
 	pkgconf_node_t *node;
 
 	PKGCONF_FOREACH_LIST_ENTRY(pkg->provides.head, node)
 	{
-		const pkgconf_dependency_t *provider = node->data;
+		pkgconf_dependency_t *provider = node->data;
 		if (!strcmp(provider->package, pkgdep->package))
 			return pkgconf_pkg_scan_provides_vercmp(pkgdep, provider);
 	}
@@ -1492,11 +1631,17 @@ static pkgconf_pkg_t *
 pkgconf_pkg_scan_providers(pkgconf_client_t *client, pkgconf_dependency_t *pkgdep, unsigned int *eflags)
 {
 	pkgconf_pkg_t *pkg;
+	pkgconf_phase_t phase;
 	pkgconf_pkg_scan_providers_ctx_t ctx = {
 		.pkgdep = pkgdep,
 	};
 
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_PROVIDER_SCANS);
+
+	phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SEARCH, NULL, NULL, NULL, NULL);
 	pkg = pkgconf_scan_all(client, &ctx, pkgconf_pkg_scan_provides_entry);
+	pkgconf_phase_end(client, &phase, pkg);
+
 	if (pkg != NULL)
 	{
 		pkgdep->match = pkgconf_pkg_ref(client, pkg);
@@ -1535,8 +1680,14 @@ pkgconf_pkg_verify_dependency(pkgconf_client_t *client, pkgconf_dependency_t *pk
 
 	if (pkgdep->match != NULL)
 	{
-		PKGCONF_TRACE(client, "cached dependency: %s -> %s@%p", pkgdep->package, pkgdep->match->id, pkgdep->match);
-		return pkgconf_pkg_ref(client, pkgdep->match);
+		if (!pkgconf_pkg_is_incomplete(client, pkgdep->match))
+		{
+			PKGCONF_TRACE(client, "cached dependency: %s -> %s@%p", pkgdep->package, pkgdep->match->id, pkgdep->match);
+			return pkgconf_pkg_ref(client, pkgdep->match);
+		}
+
+		pkgconf_pkg_unref(client, pkgdep->match);
+		pkgdep->match = NULL;
 	}
 
 	pkg = pkgconf_pkg_find(client, pkgdep->package);
@@ -1557,7 +1708,7 @@ pkgconf_pkg_verify_dependency(pkgconf_client_t *client, pkgconf_dependency_t *pk
 		if (pkg->id == NULL)
 			pkg->id = strdup(pkgdep->package);
 
-		if (pkgconf_pkg_comparator_impls[pkgdep->compare](pkg->version, pkgdep->version) != true)
+		if (pkgconf_pkg_comparator_impls[pkgdep->compare](pkgconf_pkg_parsed_version(pkg), pkgconf_dependency_parsed_version(pkgdep)) != true)
 		{
 			if (eflags != NULL)
 				*eflags |= PKGCONF_PKG_ERRF_PACKAGE_VER_MISMATCH;
@@ -1640,166 +1791,210 @@ missing_node_is_tolerable(const pkgconf_client_t *client, const pkgconf_dependen
 	return true;
 }
 
+/* returns the subset of `active` lanes which follow a dependency with the given flags */
 static inline unsigned int
-pkgconf_pkg_walk_list(pkgconf_client_t *client,
-	pkgconf_pkg_t *parent,
-	pkgconf_list_t *deplist,
-	pkgconf_pkg_traverse_func_t func,
-	void *data,
-	int depth,
-	unsigned int skip_flags,
-	unsigned int iter_flags)
+pkgconf_pkg_traverse_lanes_following(const pkgconf_pkg_traverse_lane_t *lanes, unsigned int active, unsigned int dep_flags)
 {
-	unsigned int eflags = PKGCONF_PKG_ERRF_OK;
-	pkgconf_node_t *node, *next;
+	unsigned int following = 0;
 
-	parent->flags |= PKGCONF_PKG_PROPF_ANCESTOR;
-
-	PKGCONF_FOREACH_LIST_ENTRY_SAFE(deplist->head, next, node)
+	for (unsigned int i = 0; (active >> i) != 0; i++)
 	{
-		unsigned int eflags_local = PKGCONF_PKG_ERRF_OK;
-		pkgconf_dependency_t *depnode = node->data;
-		pkgconf_pkg_t *pkgdep;
+		unsigned int skip_flags = lanes[i].skip_flags;
 
-		if (*depnode->package == '\0')
+		if (!(active & (1U << i)))
 			continue;
 
-		pkgdep = pkgconf_pkg_verify_dependency(client, depnode, &eflags_local);
-		if (eflags_local != PKGCONF_PKG_ERRF_OK)
-		{
-			if (missing_node_is_tolerable(client, depnode))
-				continue;
-
-			if (!(client->flags & PKGCONF_PKG_PKGF_SKIP_ERRORS))
-				pkgconf_pkg_report_graph_error(client, parent, pkgdep, depnode, eflags_local);
-
-			eflags |= eflags_local;
+		if (skip_flags && (dep_flags & skip_flags) == skip_flags)
 			continue;
-		}
 
-		if((pkgdep->flags & PKGCONF_PKG_PROPF_ANCESTOR) != 0)
-		{
-			/* In this case we have a circular reference.
-			 * We break that by deleting the circular node from the
-			 * the list, so that we dont create a situation where
-			 * memory is leaked due to circular ownership.
-			 * i.e: A owns B owns A
-			 *
-			 * TODO(ariadne): Breaking circular references between Requires and Requires.private
-			 * lists causes problems.  Find a way to refactor the Requires.private list out.
-			 */
-			if (!(depnode->flags & PKGCONF_PKG_DEPF_PRIVATE) &&
-				!(depnode->flags & PKGCONF_PKG_DEPF_SHARED) &&
-				!(parent->flags & PKGCONF_PKG_PROPF_VIRTUAL))
-			{
-				pkgconf_warn(client, "%s: breaking circular reference (%s -> %s -> %s)\n",
-					parent->id, parent->id, pkgdep->id, parent->id);
+		following |= 1U << i;
+	}
 
-				pkgconf_node_delete(node, deplist);
-				pkgconf_dependency_unref(client, depnode);
-			}
+	return following;
+}
 
-			goto next;
-		}
+static int
+pkgconf_pkg_required_keycmp(const void *key, const void *entry)
+{
+	return strcmp((const char *) key, ((const pkgconf_dependency_t *) entry)->package);
+}
 
-		if (skip_flags && (depnode->flags & skip_flags) == skip_flags)
-			goto next;
+/* whether any of root's required entries names the package `package` */
+static bool
+pkgconf_pkg_requires_name(const pkgconf_pkg_t *root, const char *package)
+{
+	const pkgconf_node_t *node;
 
-		pkgconf_audit_log_dependency(client, pkgdep, depnode);
+	if (root->required_index.compare != NULL)
+		return pkgconf_index_lookup(&root->required_index, package, pkgconf_pkg_required_keycmp) != NULL;
 
-		eflags |= pkgconf_pkg_traverse_main(client, pkgdep, func, data, depth - 1, skip_flags, iter_flags);
-next:
-		pkgconf_pkg_unref(client, pkgdep);
-	}
+	PKGCONF_FOREACH_LIST_ENTRY(root->required.head, node)
+	{
+		const pkgconf_dependency_t *depnode = node->data;
 
-	parent->flags &= ~PKGCONF_PKG_PROPF_ANCESTOR;
+		if (!strcmp(depnode->package, package))
+			return true;
+	}
 
-	return eflags;
+	return false;
 }
 
+/*
+ * !doc
+ *
+ * .. c:function:: unsigned int pkgconf_pkg_walk_conflicts_list(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *deplist)
+ *
+ *    Checks each conflict rule in `deplist` against the packages required by `root`.
+ *    A rule is violated when `root` requires a package of the same name and the
+ *    installed version of that package satisfies the rule.  If `root` carries a
+ *    `required_index`, as the world built by ``pkgconf_queue_solve()`` does, each rule
+ *    costs one index lookup rather than a scan of the required list.
+ *
+ *    :param pkgconf_client_t* client: The client object that owns the package.
+ *    :param pkgconf_pkg_t* root: The package whose required list is checked.
+ *    :param pkgconf_list_t* deplist: The conflict rules to check.
+ *    :return: ``PKGCONF_PKG_ERRF_OK`` or ``PKGCONF_PKG_ERRF_PACKAGE_CONFLICT``.
+ *    :rtype: unsigned int
+ */
 unsigned int
 pkgconf_pkg_walk_conflicts_list(pkgconf_client_t *client,
 	pkgconf_pkg_t *root, pkgconf_list_t *deplist)
 {
 	unsigned int eflags;
-	pkgconf_node_t *node, *childnode;
+	pkgconf_node_t *node;
 
 	PKGCONF_FOREACH_LIST_ENTRY(deplist->head, node)
 	{
 		pkgconf_dependency_t *parentnode = node->data;
+		pkgconf_pkg_t *pkgdep;
 
-		if (*parentnode->package == '\0')
+		if (*parentnode->package == '\0' || !pkgconf_pkg_requires_name(root, parentnode->package))
 			continue;
 
-		PKGCONF_FOREACH_LIST_ENTRY(root->required.head, childnode)
+		pkgdep = pkgconf_pkg_verify_dependency(client, parentnode, &eflags);
+		if (eflags == PKGCONF_PKG_ERRF_OK)
 		{
-			pkgconf_pkg_t *pkgdep;
-			pkgconf_dependency_t *depnode = childnode->data;
-
-			if (*depnode->package == '\0' || strcmp(depnode->package, parentnode->package))
-				continue;
+			pkgconf_error(client, "Version '%s' of '%s' conflicts with '%s' due to satisfying conflict rule '%s %s%s%s'.\n",
+				pkgdep->version, pkgdep->id, parentnode->why, parentnode->package, pkgconf_pkg_get_comparator(parentnode),
+				parentnode->version != NULL ? " " : "", parentnode->version != NULL ? parentnode->version : "");
 
-			pkgdep = pkgconf_pkg_verify_dependency(client, parentnode, &eflags);
-			if (eflags == PKGCONF_PKG_ERRF_OK)
+			if (!(client->flags & PKGCONF_PKG_PKGF_SIMPLIFY_ERRORS))
 			{
-				pkgconf_error(client, "Version '%s' of '%s' conflicts with '%s' due to satisfying conflict rule '%s %s%s%s'.\n",
-					pkgdep->version, pkgdep->id, parentnode->why, parentnode->package, pkgconf_pkg_get_comparator(parentnode),
-					parentnode->version != NULL ? " " : "", parentnode->version != NULL ? parentnode->version : "");
-
-				if (!(client->flags & PKGCONF_PKG_PKGF_SIMPLIFY_ERRORS))
-				{
-					pkgconf_error(client, "It may be possible to ignore this conflict and continue, try the\n");
-					pkgconf_error(client, "PKG_CONFIG_IGNORE_CONFLICTS environment variable.\n");
-				}
-
-				pkgconf_pkg_unref(client, pkgdep);
-
-				return PKGCONF_PKG_ERRF_PACKAGE_CONFLICT;
+				pkgconf_error(client, "It may be possible to ignore this conflict and continue, try the\n");
+				pkgconf_error(client, "PKG_CONFIG_IGNORE_CONFLICTS environment variable.\n");
 			}
 
 			pkgconf_pkg_unref(client, pkgdep);
+
+			return PKGCONF_PKG_ERRF_PACKAGE_CONFLICT;
 		}
+
+		pkgconf_pkg_unref(client, pkgdep);
 	}
 
 	return PKGCONF_PKG_ERRF_OK;
 }
 
 /*
- * !doc
- *
- * .. c:function:: unsigned int pkgconf_pkg_traverse_main(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_pkg_traverse_func_t func, void *data, int maxdepth, unsigned int skip_flags)
- *
- *    Walk and resolve the dependency graph up to `maxdepth` levels.
- *
- *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
- *    :param pkgconf_pkg_t* root: The root of the dependency graph.
- *    :param pkgconf_pkg_traverse_func_t func: A traversal function to call for each resolved node in the dependency graph.
- *    :param void* data: An opaque pointer to data to be passed to the traversal function.
- *    :param int maxdepth: The maximum depth to walk the dependency graph for.  -1 means infinite recursion.
- *    :param uint skip_flags: Skip over dependency nodes containing the specified flags.  A setting of 0 skips no dependency nodes.
- *    :return: ``PKGCONF_PKG_ERRF_OK`` on success, else an error code.
- *    :rtype: unsigned int
+ * The traversal keeps its own stack of frames rather than recursing, so that very
+ * deep dependency chains cannot exhaust the C stack.  Each frame is one package
+ * whose dependency lists are being walked, in the order a recursive walk would use:
+ * Requires, then Requires.shared, then Requires.private.  When the root of the walk
+ * has a frozen graph, the frames step through its edge array instead of the lists.
+ */
+typedef struct {
+	pkgconf_pkg_t *pkg;
+	pkgconf_list_t *deplist;
+	pkgconf_node_t *next;
+	pkgconf_graph_t *graph;
+	size_t edge;
+	size_t edge_end;
+	pkgconf_pkg_deplist_t phase;
+	unsigned int active;
+	unsigned int iter_flags;
+	unsigned int eflags;
+	int depth;
+} pkgconf_pkg_walk_frame_t;
+
+#ifndef PKGCONF_LITE
+/* only named in trace output, which lite builds compile out */
+static const char *pkgconf_pkg_deplist_names[] = {
+	[PKGCONF_PKG_DEPLIST_REQUIRES] = "Requires",
+	[PKGCONF_PKG_DEPLIST_REQUIRES_SHARED] = "Requires.shared",
+	[PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE] = "Requires.private",
+};
+#endif
+
+static inline pkgconf_list_t *
+pkgconf_pkg_deplist(pkgconf_pkg_t *pkg, pkgconf_pkg_deplist_t deplist)
+{
+	switch (deplist)
+	{
+	case PKGCONF_PKG_DEPLIST_REQUIRES_SHARED:
+		return &pkg->requires_shared;
+	case PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE:
+		return &pkg->requires_private;
+	case PKGCONF_PKG_DEPLIST_REQUIRES:
+		break;
+	}
+
+	return &pkg->required;
+}
+
+static inline pkgconf_pkg_walk_frame_t *
+pkgconf_pkg_walk_top(pkgconf_client_t *client)
+{
+	return pkgconf_stack_top(&client->_traverse_stack, sizeof(pkgconf_pkg_walk_frame_t));
+}
+
+static inline void
+pkgconf_pkg_walk_set_list(pkgconf_client_t *client, pkgconf_pkg_walk_frame_t *frame, pkgconf_pkg_deplist_t phase)
+{
+	frame->phase = phase;
+	frame->deplist = pkgconf_pkg_deplist(frame->pkg, phase);
+	frame->next = frame->deplist->head;
+
+	PKGCONF_TRACE(client, "%s: walking '%s' list", frame->pkg->id, pkgconf_pkg_deplist_names[phase]);
+}
+
+/*
+ * Visit a package and push a frame for walking its dependencies, either through its
+ * lists or, if graph is not NULL, as node `index` of the frozen graph.  Returns the
+ * error flags of the visit; *pushed says whether a frame was pushed.
  */
 static unsigned int
-pkgconf_pkg_traverse_main(pkgconf_client_t *client,
+pkgconf_pkg_walk_enter(pkgconf_client_t *client,
 	pkgconf_pkg_t *root,
-	pkgconf_pkg_traverse_func_t func,
-	void *data,
+	pkgconf_graph_t *graph,
+	size_t index,
+	const pkgconf_pkg_traverse_lane_t *lanes,
+	unsigned int active,
 	int maxdepth,
-	unsigned int skip_flags,
-	unsigned int iter_flags)
+	unsigned int iter_flags,
+	bool *pushed)
 {
 	unsigned int eflags = PKGCONF_PKG_ERRF_OK;
+	pkgconf_pkg_walk_frame_t *frame;
+
+	*pushed = false;
 
 	if (maxdepth == 0)
 		return eflags;
 
-	/* Short-circuit if we have already visited this node.
+	if (root->serial != client->serial)
+	{
+		root->serial = client->serial;
+		root->visited_lanes = 0;
+	}
+
+	/* Short-circuit if every lane has already visited this node.
 	 */
-	if (root->serial == client->serial)
+	active &= ~root->visited_lanes;
+	if (active == 0)
 		return eflags;
 
-	root->serial = client->serial;
+	root->visited_lanes |= active;
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_TRAVERSAL_NODES);
 
 	if (root->identifier == 0)
 		root->identifier = ++client->identifier;
@@ -1808,8 +2003,11 @@ pkgconf_pkg_traverse_main(pkgconf_client_t *client,
 
 	if ((root->flags & PKGCONF_PKG_PROPF_VIRTUAL) != PKGCONF_PKG_PROPF_VIRTUAL || (client->flags & PKGCONF_PKG_PKGF_SKIP_ROOT_VIRTUAL) != PKGCONF_PKG_PKGF_SKIP_ROOT_VIRTUAL)
 	{
-		if (func != NULL)
-			func(client, root, data, iter_flags);
+		for (unsigned int i = 0; (active >> i) != 0; i++)
+		{
+			if ((active & (1U << i)) && lanes[i].func != NULL)
+				lanes[i].func(client, root, lanes[i].data, iter_flags);
+		}
 	}
 
 	if (!(client->flags & PKGCONF_PKG_PKGF_SKIP_CONFLICTS) && root->conflicts.head != NULL)
@@ -1821,29 +2019,316 @@ pkgconf_pkg_traverse_main(pkgconf_client_t *client,
 			return eflags;
 	}
 
-	PKGCONF_TRACE(client, "%s: walking 'Requires' list", root->id);
-	eflags = pkgconf_pkg_walk_list(client, root, &root->required, func, data, maxdepth, skip_flags, iter_flags);
-	if (eflags != PKGCONF_PKG_ERRF_OK)
-		return eflags;
+	frame = pkgconf_stack_push(&client->_traverse_stack, sizeof(*frame));
+	if (frame == NULL)
+		return PKGCONF_PKG_ERRF_DEPGRAPH_BREAK;
 
-	if (!(client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS))
+	frame->pkg = root;
+	frame->active = active;
+	frame->iter_flags = iter_flags;
+	frame->depth = maxdepth;
+
+	if (graph != NULL)
 	{
-		PKGCONF_TRACE(client, "%s: walking 'Requires.shared' list", root->id);
+		frame->graph = graph;
+		frame->edge = graph->edge_index[index];
+		frame->edge_end = graph->edge_index[index + 1];
+		frame->phase = PKGCONF_PKG_DEPLIST_REQUIRES;
+	}
+	else
+		pkgconf_pkg_walk_set_list(client, frame, PKGCONF_PKG_DEPLIST_REQUIRES);
 
-		eflags = pkgconf_pkg_walk_list(client, root, &root->requires_shared, func, data, maxdepth, skip_flags, iter_flags);
-		if (eflags != PKGCONF_PKG_ERRF_OK)
-			return eflags;
+	root->flags |= PKGCONF_PKG_PROPF_ANCESTOR;
+	*pushed = true;
+
+	return eflags;
+}
+
+/* move the frame on to its next dependency list, returns false once all are walked */
+static inline bool
+pkgconf_pkg_walk_next_list(pkgconf_client_t *client, pkgconf_pkg_walk_frame_t *frame)
+{
+	if (frame->eflags != PKGCONF_PKG_ERRF_OK)
+		return false;
+
+	switch (frame->phase)
+	{
+	case PKGCONF_PKG_DEPLIST_REQUIRES:
+		if (!(client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS))
+		{
+			pkgconf_pkg_walk_set_list(client, frame, PKGCONF_PKG_DEPLIST_REQUIRES_SHARED);
+			return true;
+		}
+		/* fallthrough */
+	case PKGCONF_PKG_DEPLIST_REQUIRES_SHARED:
+		pkgconf_pkg_walk_set_list(client, frame, PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE);
+		return true;
+	case PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE:
+		break;
+	}
+
+	return false;
+}
+
+/*
+ * pop the top frame, returning its error flags and the package it walked; *owned
+ * says whether the walk holds a reference on the package which must be dropped.
+ */
+static inline unsigned int
+pkgconf_pkg_walk_leave(pkgconf_client_t *client, pkgconf_pkg_t **pkg, bool *owned)
+{
+	pkgconf_pkg_walk_frame_t *frame = pkgconf_pkg_walk_top(client);
+	unsigned int eflags = frame->eflags;
+
+	frame->pkg->flags &= ~PKGCONF_PKG_PROPF_ANCESTOR;
+	*pkg = frame->pkg;
+	*owned = frame->graph == NULL;
+
+	pkgconf_stack_pop(&client->_traverse_stack, sizeof(*frame));
+
+	return eflags;
+}
+
+/*
+ * the common tail of walking an edge to a resolved package: break circular
+ * references, then walk into the package for the lanes which follow the edge.
+ * Returns true if a frame was pushed for the package.
+ */
+static bool
+pkgconf_pkg_walk_follow(pkgconf_client_t *client,
+	const pkgconf_pkg_traverse_lane_t *lanes,
+	pkgconf_pkg_t *pkgdep,
+	pkgconf_dependency_t *depnode,
+	size_t index,
+	bool *deleted)
+{
+	pkgconf_pkg_walk_frame_t *frame = pkgconf_pkg_walk_top(client);
+	pkgconf_pkg_t *parent = frame->pkg;
+	unsigned int iter_flags = frame->iter_flags;
+	unsigned int eflags;
+	unsigned int following;
+	bool pushed;
+
+	*deleted = false;
+
+	PKGCONF_STATS_INC(client, PKGCONF_STATS_TRAVERSAL_EDGES);
+
+	if((pkgdep->flags & PKGCONF_PKG_PROPF_ANCESTOR) != 0)
+	{
+		/* In this case we have a circular reference.
+		 * We break that by deleting the circular node from the
+		 * the list, so that we dont create a situation where
+		 * memory is leaked due to circular ownership.
+		 * i.e: A owns B owns A
+		 *
+		 * TODO(ariadne): Breaking circular references between Requires and Requires.private
+		 * lists causes problems.  Find a way to refactor the Requires.private list out.
+		 */
+		if (!(depnode->flags & PKGCONF_PKG_DEPF_PRIVATE) &&
+			!(depnode->flags & PKGCONF_PKG_DEPF_SHARED) &&
+			!(parent->flags & PKGCONF_PKG_PROPF_VIRTUAL))
+		{
+			pkgconf_warn(client, "%s: breaking circular reference (%s -> %s -> %s)\n",
+				parent->id, parent->id, pkgdep->id, parent->id);
+
+			pkgconf_node_delete(&depnode->iter, pkgconf_pkg_deplist(parent, frame->phase));
+			pkgconf_dependency_unref(client, depnode);
+			*deleted = true;
+		}
+
+		return false;
+	}
+
+	following = pkgconf_pkg_traverse_lanes_following(lanes, frame->active, depnode->flags);
+	if (following == 0)
+		return false;
+
+	pkgconf_audit_log_dependency(client, pkgdep, depnode);
+
+	if (frame->phase == PKGCONF_PKG_DEPLIST_REQUIRES_PRIVATE)
+		iter_flags |= PKGCONF_PKG_ITERF_PRIVATE;
+
+	eflags = pkgconf_pkg_walk_enter(client, pkgdep, frame->graph, index, lanes, following, frame->depth - 1, iter_flags, &pushed);
+	if (pushed)
+		return true;
+
+	/* the dependency was not walked into, so the edge is finished here */
+	frame = pkgconf_pkg_walk_top(client);
+	frame->eflags |= eflags;
+
+	return false;
+}
+
+/* walk the next dependency list node of the top frame, possibly pushing a new frame */
+static void
+pkgconf_pkg_walk_list_edge(pkgconf_client_t *client,
+	const pkgconf_pkg_traverse_lane_t *lanes,
+	pkgconf_node_t *node)
+{
+	pkgconf_pkg_walk_frame_t *frame = pkgconf_pkg_walk_top(client);
+	pkgconf_dependency_t *depnode = node->data;
+	unsigned int eflags_local = PKGCONF_PKG_ERRF_OK;
+	pkgconf_pkg_t *pkgdep;
+	bool deleted;
+
+	if (*depnode->package == '\0')
+		return;
+
+	pkgdep = pkgconf_pkg_verify_dependency(client, depnode, &eflags_local);
+	if (eflags_local != PKGCONF_PKG_ERRF_OK)
+	{
+		if (missing_node_is_tolerable(client, depnode))
+			return;
+
+		if (!(client->flags & PKGCONF_PKG_PKGF_SKIP_ERRORS))
+			pkgconf_pkg_report_graph_error(client, frame->pkg, pkgdep, depnode, eflags_local);
+
+		frame = pkgconf_pkg_walk_top(client);
+		frame->eflags |= eflags_local;
+		return;
 	}
 
-	PKGCONF_TRACE(client, "%s: walking 'Requires.private' list", root->id);
+	if (!pkgconf_pkg_walk_follow(client, lanes, pkgdep, depnode, 0, &deleted))
+		pkgconf_pkg_unref(client, pkgdep);
+}
+
+/* walk the next edge of the top frame's frozen graph node, possibly pushing a new frame */
+static void
+pkgconf_pkg_walk_graph_edge(pkgconf_client_t *client,
+	const pkgconf_pkg_traverse_lane_t *lanes,
+	pkgconf_graph_edge_t *edge)
+{
+	pkgconf_pkg_walk_frame_t *frame = pkgconf_pkg_walk_top(client);
+	pkgconf_pkg_t *pkgdep = frame->graph->nodes[edge->target];
+	bool deleted;
+
+	/* the edges of a frozen graph are already resolved, and the graph holds the references */
+	if (pkgconf_pkg_walk_follow(client, lanes, pkgdep, edge->dep, edge->target, &deleted) || !deleted)
+		return;
+
+	pkgconf_dependency_unref(client, edge->dep);
+	edge->dep = NULL;
+}
+
+static unsigned int
+pkgconf_pkg_traverse_main(pkgconf_client_t *client,
+	pkgconf_pkg_t *root,
+	const pkgconf_pkg_traverse_lane_t *lanes,
+	unsigned int active,
+	int maxdepth,
+	unsigned int iter_flags)
+{
+	/* callbacks may start a traversal of their own, so only frames above base are ours */
+	size_t base = client->_traverse_stack.len;
+	unsigned int eflags;
+	bool pushed;
 
-	eflags = pkgconf_pkg_walk_list(client, root, &root->requires_private, func, data, maxdepth, skip_flags, iter_flags | PKGCONF_PKG_ITERF_PRIVATE);
-	if (eflags != PKGCONF_PKG_ERRF_OK)
+	eflags = pkgconf_pkg_walk_enter(client, root, root->graph, 0, lanes, active, maxdepth, iter_flags, &pushed);
+	if (!pushed)
 		return eflags;
 
+	while (client->_traverse_stack.len > base)
+	{
+		pkgconf_pkg_walk_frame_t *frame = pkgconf_pkg_walk_top(client);
+		pkgconf_pkg_t *pkg;
+		bool owned;
+
+		/* an existence check only needs to find one unsatisfiable edge, unless
+		 * the errors are being reported, in which case all of them are wanted.
+		 */
+		if (frame->eflags != PKGCONF_PKG_ERRF_OK &&
+			(client->flags & (PKGCONF_PKG_PKGF_EXISTENCE_CHECK|PKGCONF_PKG_PKGF_SKIP_ERRORS)) ==
+				(PKGCONF_PKG_PKGF_EXISTENCE_CHECK|PKGCONF_PKG_PKGF_SKIP_ERRORS))
+			goto leave;
+
+		if (frame->graph != NULL)
+		{
+			pkgconf_graph_edge_t *edge;
+
+			if (frame->edge == frame->edge_end)
+				goto leave;
+
+			edge = &frame->graph->edges[frame->edge];
+			if (edge->deplist != frame->phase)
+			{
+				/* as with the lists, an error stops the walk before the next list */
+				if (frame->eflags != PKGCONF_PKG_ERRF_OK)
+					goto leave;
+
+				frame->phase = edge->deplist;
+			}
+
+			frame->edge++;
+
+			if (edge->dep == NULL)
+				continue;
+
+			if (edge->deplist == PKGCONF_PKG_DEPLIST_REQUIRES_SHARED && (client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS))
+				continue;
+
+			pkgconf_pkg_walk_graph_edge(client, lanes, edge);
+			continue;
+		}
+
+		if (frame->next != NULL)
+		{
+			pkgconf_node_t *node = frame->next;
+
+			frame->next = node->next;
+
+			pkgconf_pkg_walk_list_edge(client, lanes, node);
+			continue;
+		}
+
+		if (pkgconf_pkg_walk_next_list(client, frame))
+			continue;
+
+leave:
+		eflags = pkgconf_pkg_walk_leave(client, &pkg, &owned);
+		if (client->_traverse_stack.len == base)
+			break;
+
+		/* finish the edge which led to this package in the parent frame */
+		frame = pkgconf_pkg_walk_top(client);
+		frame->eflags |= eflags;
+
+		if (owned)
+			pkgconf_pkg_unref(client, pkg);
+	}
+
 	return eflags;
 }
 
+/* the dependency flags a walk skips for the given client flags */
+static inline unsigned int
+pkgconf_pkg_traverse_skip_flags(unsigned int client_flags, unsigned int skip_flags)
+{
+	if ((client_flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) == 0)
+		skip_flags |= PKGCONF_PKG_DEPF_PRIVATE;
+
+	if (client_flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS)
+		// Skip shared deps in static mode
+		skip_flags |= PKGCONF_PKG_DEPF_SHARED;
+
+	return skip_flags;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: unsigned int pkgconf_pkg_traverse(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_pkg_traverse_func_t func, void *data, int maxdepth, unsigned int skip_flags)
+ *
+ *    Walk and resolve the dependency graph up to `maxdepth` levels.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
+ *    :param pkgconf_pkg_t* root: The root of the dependency graph.
+ *    :param pkgconf_pkg_traverse_func_t func: A traversal function to call for each resolved node in the dependency graph.
+ *    :param void* data: An opaque pointer to data to be passed to the traversal function.
+ *    :param int maxdepth: The maximum depth to walk the dependency graph for.  -1 means infinite recursion.
+ *    :param uint skip_flags: Skip over dependency nodes containing the specified flags.  A setting of 0 skips no dependency nodes.
+ *    :return: ``PKGCONF_PKG_ERRF_OK`` on success, else an error code.
+ *    :rtype: unsigned int
+ */
 unsigned int
 pkgconf_pkg_traverse(pkgconf_client_t *client,
 	pkgconf_pkg_t *root,
@@ -1852,24 +2337,46 @@ pkgconf_pkg_traverse(pkgconf_client_t *client,
 	int maxdepth,
 	unsigned int skip_flags)
 {
-	client->serial++;
+	const pkgconf_pkg_traverse_lane_t lane = {
+		.func = func,
+		.data = data,
+		.skip_flags = pkgconf_pkg_traverse_skip_flags(client->flags, skip_flags),
+	};
+	unsigned int eflags;
 
-	if ((client->flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) == 0)
-	{
-		skip_flags |= PKGCONF_PKG_DEPF_PRIVATE;
-	}
+	client->serial++;
 
-	if (client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS)
-		// Skip shared deps in static mode
-		skip_flags |= PKGCONF_PKG_DEPF_SHARED;
+	PKGCONF_PROFILE_BEGIN(client, PKGCONF_PROFILE_PHASE_TRAVERSE, root);
+	eflags = pkgconf_pkg_traverse_main(client, root, &lane, 0x1, maxdepth, PKGCONF_PKG_ITERF_NONE);
+	PKGCONF_PROFILE_END(client, PKGCONF_PROFILE_PHASE_TRAVERSE, root);
 
-	return pkgconf_pkg_traverse_main(client, root, func, data, maxdepth, skip_flags, PKGCONF_PKG_ITERF_NONE);
+	return eflags;
 }
 
+/*
+ * the public CFLAGS of every package come first, followed by the private (static) or
+ * shared CFLAGS of every package.  both halves are gathered during a single walk.
+ */
+typedef struct {
+	pkgconf_fragment_cursor_t cursor;
+	pkgconf_list_t extra;
+} pkgconf_pkg_cflags_ctx_t;
+
+typedef struct {
+	pkgconf_fragment_cursor_t cursor;
+	bool search_private;
+} pkgconf_pkg_libs_ctx_t;
+
+typedef struct {
+	pkgconf_list_t *list;
+	bool search_private;
+} pkgconf_pkg_link_abi_ctx_t;
+
 static void
 pkgconf_pkg_cflags_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
 {
-	pkgconf_fragment_cursor_t *cursor = data;
+	pkgconf_pkg_cflags_ctx_t *ctx = data;
+	const pkgconf_list_t *extra = (client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS) ? &pkg->cflags_private : &pkg->cflags_shared;
 	pkgconf_node_t *node;
 
 	(void) iter_flags;
@@ -1877,38 +2384,44 @@ pkgconf_pkg_cflags_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *d
 	PKGCONF_FOREACH_LIST_ENTRY(pkg->cflags.head, node)
 	{
 		pkgconf_fragment_t *frag = node->data;
-		pkgconf_fragment_copy_cursor(client, cursor, frag, false);
+		pkgconf_fragment_copy_cursor(client, &ctx->cursor, frag, false);
 	}
-}
-
-static void
-pkgconf_pkg_cflags_private_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
-{
-	pkgconf_fragment_cursor_t *cursor = data;
-	pkgconf_node_t *node;
-
-	(void) iter_flags;
 
-	PKGCONF_FOREACH_LIST_ENTRY(pkg->cflags_private.head, node)
+	/* private fragments are never merged back, so they can be kept apart and appended later */
+	PKGCONF_FOREACH_LIST_ENTRY(extra->head, node)
 	{
 		pkgconf_fragment_t *frag = node->data;
-		pkgconf_fragment_copy_cursor(client, cursor, frag, true);
+		pkgconf_fragment_copy(client, &ctx->extra, frag, true);
 	}
 }
 
-static void
-pkgconf_pkg_cflags_shared_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
+static inline unsigned int
+pkgconf_pkg_cflags_skip_flags(const pkgconf_client_t *client)
 {
-	pkgconf_fragment_cursor_t *cursor = data;
-	pkgconf_node_t *node;
+	return (client->flags & PKGCONF_PKG_PKGF_DONT_FILTER_INTERNAL_CFLAGS) == 0 ? PKGCONF_PKG_DEPF_INTERNAL : 0;
+}
 
-	(void) iter_flags;
+static inline void
+pkgconf_pkg_cflags_ctx_init(pkgconf_pkg_cflags_ctx_t *ctx, pkgconf_list_t *frags)
+{
+	pkgconf_fragment_cursor_init(&ctx->cursor, frags);
+	pkgconf_list_zero(&ctx->extra);
+}
 
-	PKGCONF_FOREACH_LIST_ENTRY(pkg->cflags_shared.head, node)
+static inline void
+pkgconf_pkg_cflags_ctx_finish(pkgconf_pkg_cflags_ctx_t *ctx, pkgconf_list_t *frags, pkgconf_list_t *list, unsigned int eflag)
+{
+	pkgconf_fragment_cursor_deinit(&ctx->cursor);
+
+	if (eflag != PKGCONF_PKG_ERRF_OK)
 	{
-		pkgconf_fragment_t *frag = node->data;
-		pkgconf_fragment_copy_cursor(client, cursor, frag, true);
+		pkgconf_fragment_free(&ctx->extra);
+		pkgconf_fragment_free(frags);
+		return;
 	}
+
+	pkgconf_list_splice(frags, &ctx->extra);
+	pkgconf_list_splice(list, frags);
 }
 
 /*
@@ -1929,35 +2442,16 @@ unsigned int
 pkgconf_pkg_cflags(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *list, int maxdepth)
 {
 	unsigned int eflag;
-	unsigned int skip_flags = (client->flags & PKGCONF_PKG_PKGF_DONT_FILTER_INTERNAL_CFLAGS) == 0 ? PKGCONF_PKG_DEPF_INTERNAL : 0;
 	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
-	pkgconf_fragment_cursor_t cursor;
+	pkgconf_pkg_cflags_ctx_t ctx;
 
-	pkgconf_fragment_cursor_init(&cursor, &frags);
+	pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_COLLECT, "pkgconf_pkg_cflags", "package", root->id, root);
 
-	eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_cflags_collect, &cursor, maxdepth, skip_flags);
+	pkgconf_pkg_cflags_ctx_init(&ctx, &frags);
+	eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_cflags_collect, &ctx, maxdepth, pkgconf_pkg_cflags_skip_flags(client));
+	pkgconf_pkg_cflags_ctx_finish(&ctx, &frags, list, eflag);
 
-	if (eflag == PKGCONF_PKG_ERRF_OK)
-	{
-		if (client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS)
-		{
-			eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_cflags_private_collect, &cursor, maxdepth, skip_flags);
-		}
-		else
-		{
-			eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_cflags_shared_collect, &cursor, maxdepth, skip_flags);
-		}
-	}
-
-	pkgconf_fragment_cursor_deinit(&cursor);
-
-	if (eflag != PKGCONF_PKG_ERRF_OK)
-	{
-		pkgconf_fragment_free(&frags);
-		return eflag;
-	}
-
-	pkgconf_list_splice(list, &frags);
+	pkgconf_phase_end(client, &phase, root);
 
 	return eflag;
 }
@@ -1965,16 +2459,16 @@ pkgconf_pkg_cflags(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t
 static void
 pkgconf_pkg_libs_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
 {
-	pkgconf_fragment_cursor_t *cursor = data;
+	pkgconf_pkg_libs_ctx_t *ctx = data;
 	pkgconf_node_t *node;
 
-	if (!(client->flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) && pkg->flags & PKGCONF_PKG_PROPF_VISITED_PRIVATE)
+	if (!ctx->search_private && pkg->flags & PKGCONF_PKG_PROPF_VISITED_PRIVATE)
 		return;
 
 	PKGCONF_FOREACH_LIST_ENTRY(pkg->libs.head, node)
 	{
 		pkgconf_fragment_t *frag = node->data;
-		pkgconf_fragment_copy_cursor(client, cursor, frag, (iter_flags & PKGCONF_PKG_ITERF_PRIVATE) != 0);
+		pkgconf_fragment_copy_cursor(client, &ctx->cursor, frag, (iter_flags & PKGCONF_PKG_ITERF_PRIVATE) != 0);
 	}
 
 	if (client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS)
@@ -1982,7 +2476,7 @@ pkgconf_pkg_libs_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *dat
 		PKGCONF_FOREACH_LIST_ENTRY(pkg->libs_private.head, node)
 		{
 			pkgconf_fragment_t *frag = node->data;
-			pkgconf_fragment_copy_cursor(client, cursor, frag, true);
+			pkgconf_fragment_copy_cursor(client, &ctx->cursor, frag, true);
 		}
 	}
 	else
@@ -1990,7 +2484,7 @@ pkgconf_pkg_libs_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *dat
 		PKGCONF_FOREACH_LIST_ENTRY(pkg->libs_shared.head, node)
 		{
 			pkgconf_fragment_t *frag = node->data;
-			pkgconf_fragment_copy_cursor(client, cursor, frag, true);
+			pkgconf_fragment_copy_cursor(client, &ctx->cursor, frag, true);
 		}
 	}
 }
@@ -2013,11 +2507,17 @@ unsigned int
 pkgconf_pkg_libs(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *list, int maxdepth)
 {
 	unsigned int eflag;
-	pkgconf_fragment_cursor_t cursor;
+	pkgconf_pkg_libs_ctx_t ctx = {
+		.search_private = (client->flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) != 0,
+	};
+
+	pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_COLLECT, "pkgconf_pkg_libs", "package", root->id, root);
 
-	pkgconf_fragment_cursor_init(&cursor, list);
-	eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_libs_collect, &cursor, maxdepth, 0);
-	pkgconf_fragment_cursor_deinit(&cursor);
+	pkgconf_fragment_cursor_init(&ctx.cursor, list);
+	eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_libs_collect, &ctx, maxdepth, 0);
+	pkgconf_fragment_cursor_deinit(&ctx.cursor);
+
+	pkgconf_phase_end(client, &phase, root);
 
 	if (eflag != PKGCONF_PKG_ERRF_OK)
 	{
@@ -2031,12 +2531,14 @@ pkgconf_pkg_libs(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *
 static void
 pkgconf_pkg_link_abi_collect(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
 {
-	pkgconf_list_t *list = data;
+	pkgconf_pkg_link_abi_ctx_t *ctx = data;
+	pkgconf_list_t *list = ctx->list;
 	pkgconf_node_t *node;
 
+	(void) client;
 	(void) iter_flags;
 
-	if (!(client->flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) && pkg->flags & PKGCONF_PKG_PROPF_VISITED_PRIVATE)
+	if (!ctx->search_private && pkg->flags & PKGCONF_PKG_PROPF_VISITED_PRIVATE)
 		return;
 
 	PKGCONF_FOREACH_LIST_ENTRY(pkg->link_abi.head, node)
@@ -2086,8 +2588,16 @@ unsigned int
 pkgconf_pkg_link_abi(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *list, int maxdepth)
 {
 	unsigned int eflag;
+	pkgconf_pkg_link_abi_ctx_t ctx = {
+		.list = list,
+		.search_private = (client->flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) != 0,
+	};
 
-	eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_link_abi_collect, list, maxdepth, 0);
+	pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_COLLECT, "pkgconf_pkg_link_abi", "package", root->id, root);
+
+	eflag = pkgconf_pkg_traverse(client, root, pkgconf_pkg_link_abi_collect, &ctx, maxdepth, 0);
+
+	pkgconf_phase_end(client, &phase, root);
 
 	if (eflag != PKGCONF_PKG_ERRF_OK)
 	{
@@ -2097,3 +2607,102 @@ pkgconf_pkg_link_abi(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list
 
 	return eflag;
 }
+
+/*
+ * !doc
+ *
+ * .. c:function:: unsigned int pkgconf_pkg_collect(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *cflags, pkgconf_list_t *libs, pkgconf_list_t *link_abi, int maxdepth, unsigned int flags)
+ *
+ *    Walks a dependency graph once and collects any combination of ``CFLAGS`` fragments, ``LIBS``
+ *    fragments and ``Link.ABI`` tags.  Each output is identical to what ``pkgconf_pkg_cflags()``,
+ *    ``pkgconf_pkg_libs()`` and ``pkgconf_pkg_link_abi()`` would produce, even when their walks
+ *    would follow different dependency edges.
+ *
+ *    If the ``PKGCONF_PKG_COLLECTF_LINK_SHARED`` flag is set, ``LIBS`` and ``Link.ABI`` are collected
+ *    as for a shared link, as if ``PKGCONF_PKG_PKGF_SEARCH_PRIVATE`` were unset on the client.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
+ *    :param pkgconf_pkg_t* root: The root of the dependency graph.
+ *    :param pkgconf_list_t* cflags: The fragment list to add ``CFLAGS`` fragments to, or ``NULL``.
+ *    :param pkgconf_list_t* libs: The fragment list to add ``LIBS`` fragments to, or ``NULL``.
+ *    :param pkgconf_list_t* link_abi: The bufferset list to add ``Link.ABI`` tags to, or ``NULL``.
+ *    :param int maxdepth: The maximum allowed depth for dependency resolution.  -1 means infinite recursion.
+ *    :param uint flags: A bitfield of ``PKGCONF_PKG_COLLECTF_*`` flags.
+ *    :return: ``PKGCONF_PKG_ERRF_OK`` if successful, otherwise an error code.
+ *    :rtype: unsigned int
+ */
+unsigned int
+pkgconf_pkg_collect(pkgconf_client_t *client, pkgconf_pkg_t *root, pkgconf_list_t *cflags, pkgconf_list_t *libs, pkgconf_list_t *link_abi, int maxdepth, unsigned int flags)
+{
+	unsigned int eflag;
+	unsigned int link_client_flags = client->flags;
+	unsigned int nlanes = 0;
+	pkgconf_pkg_traverse_lane_t lanes[3];
+	pkgconf_list_t cflags_frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_cflags_ctx_t cflags_ctx;
+	pkgconf_pkg_libs_ctx_t libs_ctx;
+	pkgconf_pkg_link_abi_ctx_t link_abi_ctx;
+
+	if (flags & PKGCONF_PKG_COLLECTF_LINK_SHARED)
+		link_client_flags &= ~PKGCONF_PKG_PKGF_SEARCH_PRIVATE;
+
+	if (cflags != NULL)
+	{
+		pkgconf_pkg_cflags_ctx_init(&cflags_ctx, &cflags_frags);
+		lanes[nlanes++] = (pkgconf_pkg_traverse_lane_t) {
+			.func = pkgconf_pkg_cflags_collect,
+			.data = &cflags_ctx,
+			.skip_flags = pkgconf_pkg_traverse_skip_flags(client->flags, pkgconf_pkg_cflags_skip_flags(client)),
+		};
+	}
+
+	if (libs != NULL)
+	{
+		libs_ctx.search_private = (link_client_flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) != 0;
+		pkgconf_fragment_cursor_init(&libs_ctx.cursor, libs);
+		lanes[nlanes++] = (pkgconf_pkg_traverse_lane_t) {
+			.func = pkgconf_pkg_libs_collect,
+			.data = &libs_ctx,
+			.skip_flags = pkgconf_pkg_traverse_skip_flags(link_client_flags, 0),
+		};
+	}
+
+	if (link_abi != NULL)
+	{
+		link_abi_ctx.list = link_abi;
+		link_abi_ctx.search_private = (link_client_flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE) != 0;
+		lanes[nlanes++] = (pkgconf_pkg_traverse_lane_t) {
+			.func = pkgconf_pkg_link_abi_collect,
+			.data = &link_abi_ctx,
+			.skip_flags = pkgconf_pkg_traverse_skip_flags(link_client_flags, 0),
+		};
+	}
+
+	if (nlanes == 0)
+		return PKGCONF_PKG_ERRF_OK;
+
+	pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_COLLECT, "pkgconf_pkg_collect", "package", root->id, root);
+
+	client->serial++;
+	PKGCONF_PROFILE_BEGIN(client, PKGCONF_PROFILE_PHASE_TRAVERSE, root);
+	eflag = pkgconf_pkg_traverse_main(client, root, lanes, (1U << nlanes) - 1, maxdepth, PKGCONF_PKG_ITERF_NONE);
+	PKGCONF_PROFILE_END(client, PKGCONF_PROFILE_PHASE_TRAVERSE, root);
+
+	pkgconf_phase_end(client, &phase, root);
+
+	if (cflags != NULL)
+		pkgconf_pkg_cflags_ctx_finish(&cflags_ctx, &cflags_frags, cflags, eflag);
+
+	if (libs != NULL)
+	{
+		pkgconf_fragment_cursor_deinit(&libs_ctx.cursor);
+
+		if (eflag != PKGCONF_PKG_ERRF_OK)
+			pkgconf_fragment_free(libs);
+	}
+
+	if (link_abi != NULL && eflag != PKGCONF_PKG_ERRF_OK)
+		pkgconf_bufferset_free(link_abi);
+
+	return eflag;
+}
@@ -116,16 +116,23 @@ pkgconf_queue_push(pkgconf_list_t *list, const char *package)
 bool
 pkgconf_queue_compile(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_list_t *list)
 {
+	pkgconf_dependency_cursor_t cursor;
 	pkgconf_node_t *iter;
 
+	/* every query lands in world->required, so look collisions up by name rather
+	 * than scanning all the queries added so far */
+	pkgconf_dependency_cursor_init(&cursor, &world->required);
+
 	PKGCONF_FOREACH_LIST_ENTRY(list->head, iter)
 	{
 		pkgconf_queue_t *pkgq;
 
 		pkgq = iter->data;
-		pkgconf_dependency_parse(client, world, &world->required, pkgq->package, PKGCONF_PKG_DEPF_QUERY);
+		pkgconf_dependency_parse_cursor(client, world, &cursor, pkgq->package, PKGCONF_PKG_DEPF_QUERY);
 	}
 
+	pkgconf_dependency_cursor_deinit(&cursor);
+
 	return (world->required.head != NULL);
 }
 
@@ -176,103 +183,212 @@ pkgconf_queue_mark_public(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *da
 	}
 }
 
+/*
+ * Dependencies are collected with an explicit stack of frames rather than by
+ * recursion.  Each frame walks the lists of one package from tail to head, in the
+ * order Requires.shared, Requires.private, Requires.
+ */
+typedef enum {
+	PKGCONF_QUEUE_COLLECT_SHARED = 0,
+	PKGCONF_QUEUE_COLLECT_PRIVATE,
+	PKGCONF_QUEUE_COLLECT_PUBLIC,
+} pkgconf_queue_collect_phase_t;
+
+typedef struct {
+	pkgconf_pkg_t *pkg;
+	pkgconf_node_t *node;
+	pkgconf_queue_collect_phase_t phase;
+	unsigned int iter_flags;
+	unsigned int eflags;
+	int depth;
+} pkgconf_queue_collect_frame_t;
+
+static inline pkgconf_queue_collect_frame_t *
+pkgconf_queue_collect_top(pkgconf_client_t *client)
+{
+	return pkgconf_stack_top(&client->_traverse_stack, sizeof(pkgconf_queue_collect_frame_t));
+}
+
+static inline void
+pkgconf_queue_collect_set_list(pkgconf_client_t *client, pkgconf_queue_collect_frame_t *frame, pkgconf_queue_collect_phase_t phase)
+{
+	frame->phase = phase;
+
+	switch (phase)
+	{
+	case PKGCONF_QUEUE_COLLECT_SHARED:
+		PKGCONF_TRACE(client, "%s: collecting shared dependencies, level %d", frame->pkg->id, frame->depth);
+		frame->node = frame->pkg->requires_shared.tail;
+		break;
+	case PKGCONF_QUEUE_COLLECT_PRIVATE:
+		PKGCONF_TRACE(client, "%s: collecting private dependencies, level %d", frame->pkg->id, frame->depth);
+		frame->node = frame->pkg->requires_private.tail;
+		break;
+	case PKGCONF_QUEUE_COLLECT_PUBLIC:
+		PKGCONF_TRACE(client, "%s: collecting public dependencies, level %d", frame->pkg->id, frame->depth);
+		frame->node = frame->pkg->required.tail;
+		break;
+	}
+}
+
+/* push a frame for collecting the dependencies of a package, if it needs walking */
 static unsigned int
-pkgconf_queue_collect_dependencies_main(pkgconf_client_t *client,
+pkgconf_queue_collect_enter(pkgconf_client_t *client,
 	pkgconf_pkg_t *root,
-	void *data,
 	int maxdepth,
-	unsigned int iter_flags);
-
-static inline unsigned int
-pkgconf_queue_collect_dependencies_walk(pkgconf_client_t *client,
-	pkgconf_list_t *deplist,
-	void *data,
-	int depth,
-	unsigned int iter_flags)
+	unsigned int iter_flags,
+	bool *pushed)
 {
-	unsigned int eflags = PKGCONF_PKG_ERRF_OK;
-	pkgconf_node_t *node;
-	pkgconf_pkg_t *world = data;
+	pkgconf_queue_collect_frame_t *frame;
 
-	PKGCONF_FOREACH_LIST_ENTRY_REVERSE(deplist->tail, node)
-	{
-		pkgconf_dependency_t *dep = node->data;
-		pkgconf_dependency_t *flattened_dep;
-		pkgconf_pkg_t *pkg = dep->match;
+	*pushed = false;
 
-		if (*dep->package == '\0')
-			continue;
+	if (maxdepth == 0)
+		return PKGCONF_PKG_ERRF_OK;
 
-		if (pkg == NULL)
-		{
-			PKGCONF_TRACE(client, "WTF: unmatched dependency %p <%s>", dep, dep->package);
-			continue;
-		}
+	/* Short-circuit if we have already visited this node.
+	 */
+	if (root->serial == client->serial)
+		return PKGCONF_PKG_ERRF_OK;
 
-		if (pkg->serial == client->serial)
-			continue;
+	root->serial = client->serial;
 
-		if (iter_flags & PKGCONF_PKG_ITERF_PRIVATE)
-			pkg->flags |= PKGCONF_PKG_PROPF_VISITED_PRIVATE;
-		else
-			pkg->flags &= ~PKGCONF_PKG_PROPF_VISITED_PRIVATE;
+	frame = pkgconf_stack_push(&client->_traverse_stack, sizeof(*frame));
+	if (frame == NULL)
+		return PKGCONF_PKG_ERRF_DEPGRAPH_BREAK;
 
-		eflags |= pkgconf_queue_collect_dependencies_main(client, pkg, data, depth - 1, iter_flags);
+	frame->pkg = root;
+	frame->iter_flags = iter_flags;
+	frame->depth = maxdepth;
 
-		flattened_dep = pkgconf_dependency_copy(client, dep);
-		if (flattened_dep == NULL)
-		{
-			eflags |= PKGCONF_PKG_ERRF_DEPGRAPH_BREAK;
-			continue;
-		}
+	if (!(client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS))
+		pkgconf_queue_collect_set_list(client, frame, PKGCONF_QUEUE_COLLECT_SHARED);
+	else
+		pkgconf_queue_collect_set_list(client, frame, PKGCONF_QUEUE_COLLECT_PRIVATE);
+
+	*pushed = true;
+
+	return PKGCONF_PKG_ERRF_OK;
+}
 
-		pkgconf_node_insert(&flattened_dep->iter, flattened_dep, &world->required);
+/* move the frame on to its next dependency list, returns false once all are walked */
+static inline bool
+pkgconf_queue_collect_next_list(pkgconf_client_t *client, pkgconf_queue_collect_frame_t *frame)
+{
+	if (frame->eflags != PKGCONF_PKG_ERRF_OK)
+		return false;
+
+	switch (frame->phase)
+	{
+	case PKGCONF_QUEUE_COLLECT_SHARED:
+		pkgconf_queue_collect_set_list(client, frame, PKGCONF_QUEUE_COLLECT_PRIVATE);
+		return true;
+	case PKGCONF_QUEUE_COLLECT_PRIVATE:
+		pkgconf_queue_collect_set_list(client, frame, PKGCONF_QUEUE_COLLECT_PUBLIC);
+		return true;
+	case PKGCONF_QUEUE_COLLECT_PUBLIC:
+		break;
 	}
 
-	return eflags;
+	PKGCONF_TRACE(client, "%s: finished, %s", frame->pkg->id, (frame->pkg->flags & PKGCONF_PKG_PROPF_VISITED_PRIVATE) ? "private" : "public");
+
+	return false;
+}
+
+/* add the dependency at the frame's cursor to the world and step to the previous one */
+static inline void
+pkgconf_queue_collect_finish_edge(pkgconf_client_t *client, pkgconf_queue_collect_frame_t *frame, pkgconf_pkg_t *world)
+{
+	pkgconf_dependency_t *flattened_dep = pkgconf_dependency_copy(client, frame->node->data);
+
+	frame->node = frame->node->prev;
+
+	if (flattened_dep == NULL)
+	{
+		frame->eflags |= PKGCONF_PKG_ERRF_DEPGRAPH_BREAK;
+		return;
+	}
+
+	pkgconf_node_insert(&flattened_dep->iter, flattened_dep, &world->required);
 }
 
 static unsigned int
 pkgconf_queue_collect_dependencies_main(pkgconf_client_t *client,
 	pkgconf_pkg_t *root,
-	void *data,
+	pkgconf_pkg_t *world,
 	int maxdepth,
 	unsigned int iter_flags)
 {
-	unsigned int eflags = PKGCONF_PKG_ERRF_OK;
+	size_t base = client->_traverse_stack.len;
+	unsigned int eflags;
+	bool pushed;
 
-	if (maxdepth == 0)
+	eflags = pkgconf_queue_collect_enter(client, root, maxdepth, iter_flags, &pushed);
+	if (!pushed)
 		return eflags;
 
-	/* Short-circuit if we have already visited this node.
-	 */
-	if (root->serial == client->serial)
-		return eflags;
+	while (client->_traverse_stack.len > base)
+	{
+		pkgconf_queue_collect_frame_t *frame = pkgconf_queue_collect_top(client);
+		pkgconf_dependency_t *dep;
+		pkgconf_pkg_t *pkg;
+		unsigned int child_flags;
 
-	root->serial = client->serial;
+		if (frame->node == NULL)
+		{
+			if (pkgconf_queue_collect_next_list(client, frame))
+				continue;
 
-	if (!(client->flags & PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS))
-	{
-		PKGCONF_TRACE(client, "%s: collecting shared dependencies, level %d", root->id, maxdepth);
+			eflags = frame->eflags;
+			pkgconf_stack_pop(&client->_traverse_stack, sizeof(*frame));
+			if (client->_traverse_stack.len == base)
+				break;
 
-		eflags = pkgconf_queue_collect_dependencies_walk(client, &root->requires_shared, data, maxdepth, iter_flags);
-		if (eflags != PKGCONF_PKG_ERRF_OK)
-			return eflags;
-	}
+			/* finish the edge which led to this package in the parent frame */
+			frame = pkgconf_queue_collect_top(client);
+			frame->eflags |= eflags;
+			pkgconf_queue_collect_finish_edge(client, frame, world);
+			continue;
+		}
 
-	PKGCONF_TRACE(client, "%s: collecting private dependencies, level %d", root->id, maxdepth);
+		dep = frame->node->data;
+		pkg = dep->match;
 
-	eflags = pkgconf_queue_collect_dependencies_walk(client, &root->requires_private, data, maxdepth, iter_flags | PKGCONF_PKG_ITERF_PRIVATE);
-	if (eflags != PKGCONF_PKG_ERRF_OK)
-		return eflags;
+		if (*dep->package == '\0')
+		{
+			frame->node = frame->node->prev;
+			continue;
+		}
+
+		if (pkg == NULL)
+		{
+			PKGCONF_TRACE(client, "WTF: unmatched dependency %p <%s>", dep, dep->package);
+			frame->node = frame->node->prev;
+			continue;
+		}
+
+		if (pkg->serial == client->serial)
+		{
+			frame->node = frame->node->prev;
+			continue;
+		}
 
-	PKGCONF_TRACE(client, "%s: collecting public dependencies, level %d", root->id, maxdepth);
+		child_flags = frame->iter_flags;
+		if (frame->phase == PKGCONF_QUEUE_COLLECT_PRIVATE)
+			child_flags |= PKGCONF_PKG_ITERF_PRIVATE;
 
-	eflags = pkgconf_queue_collect_dependencies_walk(client, &root->required, data, maxdepth, iter_flags);
-	if (eflags != PKGCONF_PKG_ERRF_OK)
-		return eflags;
+		if (child_flags & PKGCONF_PKG_ITERF_PRIVATE)
+			pkg->flags |= PKGCONF_PKG_PROPF_VISITED_PRIVATE;
+		else
+			pkg->flags &= ~PKGCONF_PKG_PROPF_VISITED_PRIVATE;
 
-	PKGCONF_TRACE(client, "%s: finished, %s", root->id, (root->flags & PKGCONF_PKG_PROPF_VISITED_PRIVATE) ? "private" : "public");
+		eflags = pkgconf_queue_collect_enter(client, pkg, frame->depth - 1, child_flags, &pushed);
+		if (pushed)
+			continue;
+
+		frame->eflags |= eflags;
+		pkgconf_queue_collect_finish_edge(client, frame, world);
+	}
 
 	return eflags;
 }
@@ -280,11 +396,11 @@ pkgconf_queue_collect_dependencies_main(pkgconf_client_t *client,
 static inline unsigned int
 pkgconf_queue_collect_dependencies(pkgconf_client_t *client,
 	pkgconf_pkg_t *root,
-	void *data,
+	pkgconf_pkg_t *world,
 	int maxdepth)
 {
 	++client->serial;
-	return pkgconf_queue_collect_dependencies_main(client, root, data, maxdepth, PKGCONF_PKG_ITERF_NONE);
+	return pkgconf_queue_collect_dependencies_main(client, root, world, maxdepth, PKGCONF_PKG_ITERF_NONE);
 }
 
 static inline unsigned int
@@ -338,10 +454,29 @@ pkgconf_queue_collect_conflicts(pkgconf_client_t *client,
 	return eflags;
 }
 
+static int
+pkgconf_queue_required_cmp(const void *a, const void *b)
+{
+	return strcmp(((const pkgconf_dependency_t *) a)->package, ((const pkgconf_dependency_t *) b)->package);
+}
+
+/*
+ * Index the flattened world's required packages by name, so that checking a
+ * conflict rule against them is a single lookup instead of a scan of the list.
+ */
+static inline bool
+pkgconf_queue_index_required(pkgconf_pkg_t *world)
+{
+	world->required_index.compare = pkgconf_queue_required_cmp;
+
+	return pkgconf_index_build(&world->required_index, &world->required);
+}
+
 static inline unsigned int
 pkgconf_queue_verify(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_list_t *list, int maxdepth)
 {
 	unsigned int result;
+	pkgconf_phase_t phase;
 	const unsigned int saved_flags = client->flags;
 	pkgconf_pkg_t initial_world = {
 		.id = "user:request",
@@ -356,7 +491,9 @@ pkgconf_queue_verify(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_lis
 	}
 
 	PKGCONF_TRACE(client, "solving");
+	phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SOLVE, "pkgconf_queue_verify: solve", NULL, NULL, world);
 	result = pkgconf_pkg_traverse(client, &initial_world, NULL, NULL, maxdepth, 0);
+	pkgconf_phase_end(client, &phase, world);
 	if (result != PKGCONF_PKG_ERRF_OK)
 	{
 		pkgconf_solution_free(client, &initial_world);
@@ -364,19 +501,18 @@ pkgconf_queue_verify(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_lis
 	}
 
 	PKGCONF_TRACE(client, "flattening");
+	phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_FLATTEN, "pkgconf_queue_verify: flatten", NULL, NULL, world);
 	result = pkgconf_queue_collect_dependencies(client, &initial_world, world, maxdepth);
+	if (result == PKGCONF_PKG_ERRF_OK)
+		result = pkgconf_queue_collect_conflicts(client, world, world, maxdepth);
+	pkgconf_phase_end(client, &phase, world);
 	if (result != PKGCONF_PKG_ERRF_OK)
 	{
 		pkgconf_solution_free(client, &initial_world);
 		return result;
 	}
 
-	result = pkgconf_queue_collect_conflicts(client, world, world, maxdepth);
-	if (result != PKGCONF_PKG_ERRF_OK)
-	{
-		pkgconf_solution_free(client, &initial_world);
-		return result;
-	}
+	phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SOLVE, "pkgconf_queue_verify: check", NULL, NULL, world);
 
 	if (client->flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE)
 	{
@@ -386,28 +522,89 @@ pkgconf_queue_verify(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_lis
 		result = pkgconf_pkg_traverse(client, &initial_world, pkgconf_queue_mark_public, &world->required, maxdepth, 0);
 		client->flags = saved_flags;
 		if (result != PKGCONF_PKG_ERRF_OK)
-		{
-			pkgconf_solution_free(client, &initial_world);
-			return result;
-		}
+			goto out;
 	}
 
 	if (!(client->flags & PKGCONF_PKG_PKGF_SKIP_CONFLICTS))
 	{
 		PKGCONF_TRACE(client, "checking for conflicts");
 
-		result = pkgconf_pkg_walk_conflicts_list(client, world, &world->conflicts);
-		if (result != PKGCONF_PKG_ERRF_OK)
+		if (world->conflicts.head != NULL && !pkgconf_queue_index_required(world))
 		{
-			pkgconf_solution_free(client, &initial_world);
-			return result;
+			result = PKGCONF_PKG_ERRF_DEPGRAPH_BREAK;
+			goto out;
 		}
+
+		result = pkgconf_pkg_walk_conflicts_list(client, world, &world->conflicts);
 	}
 
+out:
+	pkgconf_phase_end(client, &phase, world);
+
 	/* free the initial solution */
 	pkgconf_solution_free(client, &initial_world);
 
-	return PKGCONF_PKG_ERRF_OK;
+	return result;
+}
+
+static void
+pkgconf_queue_note_conflicts(pkgconf_client_t *client, pkgconf_pkg_t *pkg, void *data, unsigned int iter_flags)
+{
+	bool *has_conflicts = data;
+
+	(void) client;
+	(void) iter_flags;
+
+	if (pkg->conflicts.head != NULL)
+		*has_conflicts = true;
+}
+
+static unsigned int
+pkgconf_queue_verify_exists(pkgconf_client_t *client, pkgconf_list_t *list, int maxdepth)
+{
+	unsigned int result;
+	pkgconf_phase_t phase;
+	bool has_conflicts = false;
+	const unsigned int saved_flags = client->flags;
+	pkgconf_pkg_t initial_world = {
+		.id = "user:request",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+
+	if (!pkgconf_queue_compile(client, &initial_world, list))
+	{
+		pkgconf_solution_free(client, &initial_world);
+		return PKGCONF_PKG_ERRF_DEPGRAPH_BREAK;
+	}
+
+	client->flags |= PKGCONF_PKG_PKGF_EXISTENCE_CHECK;
+
+	PKGCONF_TRACE(client, "checking existence");
+	phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SOLVE, "pkgconf_queue_verify_exists", NULL, NULL, NULL);
+	result = pkgconf_pkg_traverse(client, &initial_world, pkgconf_queue_note_conflicts, &has_conflicts, maxdepth, 0);
+	pkgconf_phase_end(client, &phase, NULL);
+
+	/* Conflicts rules are matched against the flattened world, so only pay for
+	 * flattening when some package in the graph actually declares them.
+	 */
+	if (result == PKGCONF_PKG_ERRF_OK && has_conflicts && !(client->flags & PKGCONF_PKG_PKGF_SKIP_CONFLICTS))
+	{
+		pkgconf_pkg_t world = {
+			.id = "virtual:world",
+			.realname = "virtual world package",
+			.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+		};
+
+		PKGCONF_TRACE(client, "graph declares conflicts, flattening");
+		result = pkgconf_queue_verify(client, &world, list, maxdepth);
+		pkgconf_pkg_free(client, &world);
+	}
+
+	client->flags = saved_flags;
+	pkgconf_solution_free(client, &initial_world);
+
+	return result;
 }
 
 /*
@@ -424,10 +621,11 @@ pkgconf_queue_verify(pkgconf_client_t *client, pkgconf_pkg_t *world, pkgconf_lis
 void
 pkgconf_solution_free(pkgconf_client_t *client, pkgconf_pkg_t *world)
 {
-	(void) client;
-
 	if (world->flags & PKGCONF_PKG_PROPF_VIRTUAL)
 	{
+		pkgconf_graph_free(client, world);
+		free(world->required_index.entries);
+		world->required_index = (pkgconf_index_t){ 0 };
 		pkgconf_dependency_free(&world->required);
 		pkgconf_dependency_free(&world->requires_private);
 		pkgconf_dependency_free(&world->conflicts);
@@ -440,6 +638,9 @@ pkgconf_solution_free(pkgconf_client_t *client, pkgconf_pkg_t *world)
  * .. c:function:: bool pkgconf_queue_solve(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_pkg_t *world, int maxdepth)
  *
  *    Solves and flattens the dependency graph for the supplied dependency list.
+ *    If the client has the ``PKGCONF_PKG_PKGF_FREEZE_GRAPH`` flag set, the solved graph is
+ *    also frozen with ``pkgconf_graph_freeze()``, so later traversals of `world` walk the
+ *    frozen form.
  *
  *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
  *    :param pkgconf_list_t* list: The list of dependency requests to consider.
@@ -461,7 +662,18 @@ pkgconf_queue_solve(pkgconf_client_t *client, pkgconf_list_t *list, pkgconf_pkg_
 	unsigned int ret = pkgconf_queue_verify(client, world, list, maxdepth);
 	client->flags = flags;
 
-	return ret == PKGCONF_PKG_ERRF_OK;
+	if (ret != PKGCONF_PKG_ERRF_OK)
+		return false;
+
+	/* a graph which cannot be frozen is still walked through its lists */
+	if (client->flags & PKGCONF_PKG_PKGF_FREEZE_GRAPH)
+	{
+		pkgconf_phase_t phase = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_FLATTEN, "pkgconf_graph_freeze", NULL, NULL, world);
+		(void) pkgconf_graph_freeze(client, world);
+		pkgconf_phase_end(client, &phase, world);
+	}
+
+	return true;
 }
 
 /*
@@ -526,21 +738,45 @@ cleanup:
 bool
 pkgconf_queue_validate(pkgconf_client_t *client, pkgconf_list_t *list, int maxdepth)
 {
-	bool retval = true;
-	pkgconf_pkg_t world = {
-		.id = "virtual:world",
-		.realname = "virtual world package",
-		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
-	};
+	/* if maxdepth is one, then we will not traverse deeper than our virtual package. */
+	if (!maxdepth)
+		maxdepth = -1;
+
+	return pkgconf_queue_verify_exists(client, list, maxdepth) == PKGCONF_PKG_ERRF_OK;
+}
 
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_queue_exists(pkgconf_client_t *client, pkgconf_list_t *list, int maxdepth)
+ *
+ *    Check whether the full dependency graph of a dependency resolution queue, including private
+ *    dependencies, can be solved.  This is the check behind ``--exists``: the graph is walked
+ *    without being flattened, and packages are loaded without evaluating their fragment and
+ *    license fields.  If the client has ``PKGCONF_PKG_PKGF_SKIP_ERRORS`` set, the walk also
+ *    stops at the first unsatisfiable edge; otherwise every missing dependency is reported.
+ *
+ *    Packages loaded this way are transparently reloaded when the client is later used for
+ *    a full solve.
+ *
+ *    :param pkgconf_client_t* client: The pkgconf client object to use for dependency resolution.
+ *    :param pkgconf_list_t* list: The list of dependency requests to consider.
+ *    :param int maxdepth: The maximum allowed depth for the dependency resolver.  A depth of -1 means unlimited.
+ *    :returns: true if every requested package and its dependencies could be found, otherwise false.
+ *    :rtype: bool
+ */
+bool
+pkgconf_queue_exists(pkgconf_client_t *client, pkgconf_list_t *list, int maxdepth)
+{
 	/* if maxdepth is one, then we will not traverse deeper than our virtual package. */
 	if (!maxdepth)
 		maxdepth = -1;
 
-	if (pkgconf_queue_verify(client, &world, list, maxdepth) != PKGCONF_PKG_ERRF_OK)
-		retval = false;
+	unsigned int flags = client->flags;
+	client->flags |= PKGCONF_PKG_PKGF_SEARCH_PRIVATE;
 
-	pkgconf_pkg_free(client, &world);
+	unsigned int ret = pkgconf_queue_verify_exists(client, list, maxdepth);
+	client->flags = flags;
 
-	return retval;
+	return ret == PKGCONF_PKG_ERRF_OK;
 }
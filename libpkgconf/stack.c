@@ -0,0 +1,142 @@
+/*
+ * stack.c
+ * reusable work stacks for iterative graph traversal
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+
+/*
+ * !doc
+ *
+ * libpkgconf `stack` module
+ * =========================
+ *
+ * The libpkgconf `stack` module implements a growable stack of frames, which the
+ * dependency graph walkers use in place of the C call stack.  A stack may hold
+ * frames of different types, as long as every frame is popped with the size it
+ * was pushed with.  Pushing a frame may move the stack in memory, so pointers to
+ * frames must be refetched with ``pkgconf_stack_top()`` after a push.
+ */
+
+#define PKGCONF_STACK_ALIGN	16
+#define PKGCONF_STACK_MIN_ALLOC	1024
+
+static inline size_t
+pkgconf_stack_frame_size(size_t size)
+{
+	return (size + PKGCONF_STACK_ALIGN - 1) & ~((size_t) PKGCONF_STACK_ALIGN - 1);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void *pkgconf_stack_push(pkgconf_stack_t *stack, size_t size)
+ *
+ *    Push a zero-filled frame of `size` bytes onto the stack, growing it if needed.
+ *
+ *    :param pkgconf_stack_t* stack: The stack to push onto.
+ *    :param size_t size: The size of the frame.
+ *    :return: A pointer to the new frame, or ``NULL`` if the stack could not be grown.
+ *    :rtype: void *
+ */
+void *
+pkgconf_stack_push(pkgconf_stack_t *stack, size_t size)
+{
+	size_t framesize = pkgconf_stack_frame_size(size);
+	void *frame;
+
+	if (stack->alloc - stack->len < framesize)
+	{
+		size_t newalloc = stack->alloc ? stack->alloc : PKGCONF_STACK_MIN_ALLOC;
+		unsigned char *newbase;
+
+		while (newalloc - stack->len < framesize)
+		{
+			if (newalloc > SIZE_MAX / 2)
+				return NULL;
+
+			newalloc *= 2;
+		}
+
+		newbase = realloc(stack->base, newalloc);
+		if (newbase == NULL)
+			return NULL;
+
+		stack->base = newbase;
+		stack->alloc = newalloc;
+	}
+
+	frame = stack->base + stack->len;
+	stack->len += framesize;
+
+	memset(frame, '\0', framesize);
+	return frame;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void *pkgconf_stack_top(const pkgconf_stack_t *stack, size_t size)
+ *
+ *    Return the frame on top of the stack, which must have been pushed with `size`.
+ *
+ *    :param pkgconf_stack_t* stack: The stack to inspect.
+ *    :param size_t size: The size of the frame.
+ *    :return: A pointer to the top frame.
+ *    :rtype: void *
+ */
+void *
+pkgconf_stack_top(const pkgconf_stack_t *stack, size_t size)
+{
+	return stack->base + stack->len - pkgconf_stack_frame_size(size);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_stack_pop(pkgconf_stack_t *stack, size_t size)
+ *
+ *    Pop the frame on top of the stack, which must have been pushed with `size`.
+ *    The memory backing the stack is kept for reuse.
+ *
+ *    :param pkgconf_stack_t* stack: The stack to pop from.
+ *    :param size_t size: The size of the frame.
+ *    :return: nothing
+ */
+void
+pkgconf_stack_pop(pkgconf_stack_t *stack, size_t size)
+{
+	stack->len -= pkgconf_stack_frame_size(size);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_stack_free(pkgconf_stack_t *stack)
+ *
+ *    Release the memory backing the stack.
+ *
+ *    :param pkgconf_stack_t* stack: The stack to release.
+ *    :return: nothing
+ */
+void
+pkgconf_stack_free(pkgconf_stack_t *stack)
+{
+	free(stack->base);
+
+	stack->base = NULL;
+	stack->len = stack->alloc = 0;
+}
@@ -0,0 +1,325 @@
+/*
+ * stats.c
+ * performance counters and phase timers
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+
+#ifndef _WIN32
+# include <time.h>
+#endif
+
+/*
+ * !doc
+ *
+ * libpkgconf `stats` module
+ * =========================
+ *
+ * Every client keeps a set of counters (files opened, cache hits, traversal nodes and
+ * so on), which are bumped with the ``PKGCONF_STATS_INC()`` and ``PKGCONF_STATS_ADD()``
+ * macros.  They cost a single add, so they are always maintained.
+ *
+ * The client can also time the phases of a query (search, parse, solve, flatten,
+ * collect and render).  Phases nest: entering a phase pauses the enclosing one, so each
+ * phase is charged only for its own time and the phase totals add up to the time spent
+ * with timing enabled.  Timing reads a monotonic clock on every phase change, so it is
+ * off until ``pkgconf_stats_set_timing()`` turns it on.
+ */
+
+static const char *pkgconf_stats_counter_names[PKGCONF_STATS_COUNTER_COUNT] = {
+	[PKGCONF_STATS_FILES_OPENED] = "files_opened",
+	[PKGCONF_STATS_FILES_FAILED] = "files_failed",
+	[PKGCONF_STATS_BYTES_PARSED] = "bytes_parsed",
+	[PKGCONF_STATS_CACHE_HITS] = "cache_hits",
+	[PKGCONF_STATS_CACHE_MISSES] = "cache_misses",
+	[PKGCONF_STATS_PROVIDER_SCANS] = "provider_scans",
+	[PKGCONF_STATS_TRAVERSAL_NODES] = "traversal_nodes",
+	[PKGCONF_STATS_TRAVERSAL_EDGES] = "traversal_edges",
+	[PKGCONF_STATS_FRAGMENTS_COPIED] = "fragments_copied",
+	[PKGCONF_STATS_FRAGMENTS_MERGED] = "fragments_merged",
+	[PKGCONF_STATS_BYTECODE_OPS] = "bytecode_ops",
+	[PKGCONF_STATS_DEPENDENCY_PROBES] = "dependency_probes",
+	[PKGCONF_STATS_INDEX_SHIFTS] = "index_shifts",
+	[PKGCONF_STATS_DIRS_SCANNED] = "dirs_scanned",
+	[PKGCONF_STATS_PACKAGES_PARSED] = "packages_parsed",
+};
+
+static const char *pkgconf_stats_phase_names[PKGCONF_STATS_PHASE_COUNT] = {
+	[PKGCONF_STATS_PHASE_NONE] = "other",
+	[PKGCONF_STATS_PHASE_SEARCH] = "search",
+	[PKGCONF_STATS_PHASE_PARSE] = "parse",
+	[PKGCONF_STATS_PHASE_SOLVE] = "solve",
+	[PKGCONF_STATS_PHASE_FLATTEN] = "flatten",
+	[PKGCONF_STATS_PHASE_COLLECT] = "collect",
+	[PKGCONF_STATS_PHASE_RENDER] = "render",
+};
+
+/*
+ * !doc
+ *
+ * .. c:function:: uint64_t pkgconf_stats_now(void)
+ *
+ *    Reads the monotonic clock the phase timers are based on.
+ *
+ *    :return: The current time in nanoseconds, relative to an unspecified starting point.
+ *    :rtype: uint64_t
+ */
+uint64_t
+pkgconf_stats_now(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+
+	QueryPerformanceCounter(&now);
+
+	return (uint64_t) (now.QuadPart / freq.QuadPart) * 1000000000u +
+		(uint64_t) (now.QuadPart % freq.QuadPart) * 1000000000u / (uint64_t) freq.QuadPart;
+#else
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+		return 0;
+
+	return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+/* charge the time since the last phase change to the current phase */
+static void
+pkgconf_stats_charge(pkgconf_stats_t *stats)
+{
+	uint64_t now = pkgconf_stats_now();
+
+	stats->phase_ns[stats->phase] += now - stats->phase_start;
+	stats->phase_start = now;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_stats_reset(pkgconf_client_t *client)
+ *
+ *    Zeroes the client's counters and phase timers.  Whether timing is enabled is
+ *    left unchanged.
+ *
+ *    :param pkgconf_client_t* client: The client whose statistics to reset.
+ *    :return: nothing
+ */
+void
+pkgconf_stats_reset(pkgconf_client_t *client)
+{
+	bool timing = client->stats.timing;
+
+	memset(&client->stats, 0, sizeof(client->stats));
+	pkgconf_stats_set_timing(client, timing);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_stats_set_timing(pkgconf_client_t *client, bool timing)
+ *
+ *    Enables or disables the phase timers.  Counters are maintained either way.
+ *
+ *    :param pkgconf_client_t* client: The client to configure.
+ *    :param bool timing: Whether phase changes should be timed.
+ *    :return: nothing
+ */
+void
+pkgconf_stats_set_timing(pkgconf_client_t *client, bool timing)
+{
+	pkgconf_stats_t *stats = &client->stats;
+
+	if (stats->timing && !timing)
+		pkgconf_stats_charge(stats);
+	else if (timing)
+		stats->phase_start = pkgconf_stats_now();
+
+	stats->timing = timing;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: pkgconf_stats_phase_t pkgconf_stats_phase_begin(const pkgconf_client_t *client, pkgconf_stats_phase_t phase)
+ *
+ *    Enters `phase`, pausing the phase the client was in.  The returned phase must be
+ *    passed to the matching ``pkgconf_stats_phase_end()``.
+ *
+ *    :param pkgconf_client_t* client: The client being timed.
+ *    :param pkgconf_stats_phase_t phase: The phase being entered.
+ *    :return: The phase the client was in before.
+ *    :rtype: pkgconf_stats_phase_t
+ */
+pkgconf_stats_phase_t
+pkgconf_stats_phase_begin(const pkgconf_client_t *client, pkgconf_stats_phase_t phase)
+{
+	pkgconf_stats_t *stats = &((pkgconf_client_t *) client)->stats;
+	pkgconf_stats_phase_t previous = stats->phase;
+
+	if (stats->timing && phase != previous)
+		pkgconf_stats_charge(stats);
+
+	stats->phase = phase;
+
+	return previous;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_stats_phase_end(const pkgconf_client_t *client, pkgconf_stats_phase_t previous)
+ *
+ *    Leaves the current phase and resumes `previous`, as returned by the matching
+ *    ``pkgconf_stats_phase_begin()``.
+ *
+ *    :param pkgconf_client_t* client: The client being timed.
+ *    :param pkgconf_stats_phase_t previous: The phase to resume.
+ *    :return: nothing
+ */
+void
+pkgconf_stats_phase_end(const pkgconf_client_t *client, pkgconf_stats_phase_t previous)
+{
+	pkgconf_stats_t *stats = &((pkgconf_client_t *) client)->stats;
+
+	if (stats->timing && stats->phase != previous)
+		pkgconf_stats_charge(stats);
+
+	stats->phase = previous;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: const char *pkgconf_stats_counter_name(pkgconf_stats_counter_t counter)
+ *
+ *    :param pkgconf_stats_counter_t counter: The counter to name.
+ *    :return: The name the counter is rendered under, or ``NULL`` if it is out of range.
+ *    :rtype: const char *
+ */
+const char *
+pkgconf_stats_counter_name(pkgconf_stats_counter_t counter)
+{
+	if ((unsigned int) counter >= PKGCONF_STATS_COUNTER_COUNT)
+		return NULL;
+
+	return pkgconf_stats_counter_names[counter];
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_stats_counter_lookup(const char *name, pkgconf_stats_counter_t *counter)
+ *
+ *    Finds the counter rendered under `name`, the inverse of ``pkgconf_stats_counter_name()``.
+ *
+ *    :param char* name: The name of the counter, such as ``files_opened``.
+ *    :param pkgconf_stats_counter_t* counter: Set to the counter if one is found.
+ *    :return: true if `name` names a counter, else false.
+ *    :rtype: bool
+ */
+bool
+pkgconf_stats_counter_lookup(const char *name, pkgconf_stats_counter_t *counter)
+{
+	for (size_t i = 0; i < PKGCONF_STATS_COUNTER_COUNT; i++)
+	{
+		if (!strcmp(name, pkgconf_stats_counter_names[i]))
+		{
+			*counter = (pkgconf_stats_counter_t) i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: const char *pkgconf_stats_phase_name(pkgconf_stats_phase_t phase)
+ *
+ *    :param pkgconf_stats_phase_t phase: The phase to name.
+ *    :return: The name the phase is rendered under, or ``NULL`` if it is out of range.
+ *    :rtype: const char *
+ */
+const char *
+pkgconf_stats_phase_name(pkgconf_stats_phase_t phase)
+{
+	if ((unsigned int) phase >= PKGCONF_STATS_PHASE_COUNT)
+		return NULL;
+
+	return pkgconf_stats_phase_names[phase];
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_stats_render(const pkgconf_client_t *client, pkgconf_buffer_t *buf)
+ *
+ *    Renders the client's counters and phase timers as a single-line JSON object of the form
+ *    ``{"counters":{"files_opened":3,...},"phases_ns":{"search":1200,...}}``.  The phase
+ *    timers are only present if timing is enabled.
+ *
+ *    :param pkgconf_client_t* client: The client whose statistics to render.
+ *    :param pkgconf_buffer_t* buf: The buffer to append the JSON object to.
+ *    :return: true on success, false on allocation failure.
+ *    :rtype: bool
+ */
+bool
+pkgconf_stats_render(const pkgconf_client_t *client, pkgconf_buffer_t *buf)
+{
+	const pkgconf_stats_t *stats = &client->stats;
+
+	if (!pkgconf_buffer_append(buf, "{\"counters\":{"))
+		return false;
+
+	for (size_t i = 0; i < PKGCONF_STATS_COUNTER_COUNT; i++)
+	{
+		if (!pkgconf_buffer_append_fmt(buf, "%s\"%s\":%llu", i != 0 ? "," : "",
+			pkgconf_stats_counter_names[i], (unsigned long long) stats->counters[i]))
+			return false;
+	}
+
+	if (!pkgconf_buffer_push_byte(buf, '}'))
+		return false;
+
+	if (stats->timing)
+	{
+		/* include the time spent so far in the phase the client is in now */
+		uint64_t running = pkgconf_stats_now() - stats->phase_start;
+
+		if (!pkgconf_buffer_append(buf, ",\"phases_ns\":{"))
+			return false;
+
+		for (size_t i = 0; i < PKGCONF_STATS_PHASE_COUNT; i++)
+		{
+			uint64_t ns = stats->phase_ns[i] + (i == (size_t) stats->phase ? running : 0);
+
+			if (!pkgconf_buffer_append_fmt(buf, "%s\"%s\":%llu", i != 0 ? "," : "",
+				pkgconf_stats_phase_names[i], (unsigned long long) ns))
+				return false;
+		}
+
+		if (!pkgconf_buffer_push_byte(buf, '}'))
+			return false;
+	}
+
+	return pkgconf_buffer_push_byte(buf, '}');
+}
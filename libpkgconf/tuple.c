@@ -130,23 +130,25 @@ out:
 	free(workbuf);
 }
 
+/*
+ * Strip the quotes from a value which starts with one, unescaping the quote
+ * character where it is escaped.  Dequoting only ever drops bytes, so the
+ * result fits in a copy of the same length.
+ */
 static char *
 dequote(const char *value)
 {
-	char *buf = calloc(1, (strlen(value) + 1) * 2);
+	char *buf = malloc(strlen(value) + 1);
 	char *bptr = buf;
 	const char *i;
-	char quote = 0;
+	char quote = *value;
 
 	if (buf == NULL)
 		return NULL;
 
-	if (*value == '\'' || *value == '"')
-		quote = *value;
-
 	for (i = value; *i != '\0'; i++)
 	{
-		if (*i == '\\' && quote && *(i + 1) == quote)
+		if (*i == '\\' && *(i + 1) == quote)
 		{
 			i++;
 			*bptr++ = *i;
@@ -155,6 +157,8 @@ dequote(const char *value)
 			*bptr++ = *i;
 	}
 
+	*bptr = '\0';
+
 	return buf;
 }
 
@@ -176,89 +180,54 @@ dequote(const char *value)
 pkgconf_tuple_t *
 pkgconf_tuple_add(const pkgconf_client_t *client, pkgconf_list_t *list, const char *key, const char *value, bool parse, unsigned int flags)
 {
-	char *dequote_value;
-	pkgconf_buffer_t rhs_bcbuf = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_variable_t *v;
+	char *dequote_value = NULL;
+	bool ok;
 
 	(void) client;
 
 	if (list == NULL || key == NULL || value == NULL)
 		return NULL;
 
-	dequote_value = dequote(value);
-	if (dequote_value == NULL)
-		return NULL;
+	/* only a quoted value needs rewriting before it is compiled */
+	if (*value == '\'' || *value == '"')
+	{
+		dequote_value = dequote(value);
+		if (dequote_value == NULL)
+			return NULL;
 
-	pkgconf_variable_t *v = pkgconf_variable_get_or_create(list, key);
+		value = dequote_value;
+	}
+
+	v = pkgconf_variable_get_or_create(list, key);
 	if (v == NULL)
 	{
 		free(dequote_value);
 		return NULL;
 	}
 
-	if (!parse)
-	{
-		if (!pkgconf_bytecode_emit_text(&rhs_bcbuf, dequote_value, strlen(dequote_value)))
-		{
-			pkgconf_buffer_finalize(&rhs_bcbuf);
-			free(dequote_value);
-			return NULL;
-		}
-
-		free(dequote_value);
-	}
+	/* the value is compiled straight into the variable's own bytecode buffer,
+	 * with var=${var}/foo self-references spliced in as it goes */
+	if (parse)
+		ok = pkgconf_bytecode_compile_selfref(&v->bcbuf, value, key);
 	else
 	{
-		if (!pkgconf_bytecode_compile(&rhs_bcbuf, dequote_value))
-		{
-			pkgconf_buffer_finalize(&rhs_bcbuf);
-			free(dequote_value);
-			return NULL;
-		}
+		pkgconf_buffer_rewind(&v->bcbuf);
 
-		free(dequote_value);
+		ok = pkgconf_bytecode_emit_text(&v->bcbuf, value, strlen(value));
+		if (!ok)
+			pkgconf_buffer_rewind(&v->bcbuf);
 	}
 
-	/* ugh, we are doing var=${var}/foo stuff */
-	if (parse && pkgconf_bytecode_references_var(&rhs_bcbuf, key))
-	{
-		pkgconf_buffer_t old_bcbuf = PKGCONF_BUFFER_INITIALIZER;
-		pkgconf_buffer_t new_bcbuf = PKGCONF_BUFFER_INITIALIZER;
-
-		/* preserve the old bytecode */
-		if (!pkgconf_buffer_copy(&v->bcbuf, &old_bcbuf))
-		{
-			pkgconf_buffer_finalize(&old_bcbuf);
-			pkgconf_buffer_finalize(&rhs_bcbuf);
-			return NULL;
-		}
-
-		/* splice the selfrefs, using the old bytecode instead of ${var} */
-		if (!pkgconf_bytecode_rewrite_selfrefs(&new_bcbuf, &rhs_bcbuf, key, &old_bcbuf))
-		{
-			pkgconf_buffer_finalize(&old_bcbuf);
-			pkgconf_buffer_finalize(&new_bcbuf);
-			pkgconf_buffer_finalize(&rhs_bcbuf);
-
-			return NULL;
-		}
+	free(dequote_value);
 
-		/* copy the spliced bytecode back to &rhs_bcbuf, replacing its contents */
-		if (!pkgconf_buffer_copy(&new_bcbuf, &rhs_bcbuf))
-		{
-			pkgconf_buffer_finalize(&old_bcbuf);
-			pkgconf_buffer_finalize(&new_bcbuf);
-			pkgconf_buffer_finalize(&rhs_bcbuf);
-			return NULL;
-		}
+	/* the buffer may have moved, even if compiling it failed */
+	pkgconf_bytecode_from_buffer(&v->bc, &v->bcbuf);
 
-		pkgconf_buffer_finalize(&old_bcbuf);
-		pkgconf_buffer_finalize(&new_bcbuf);
-	}
+	if (!ok)
+		return NULL;
 
-	pkgconf_buffer_finalize(&v->bcbuf);
-	v->bcbuf = rhs_bcbuf;
 	v->flags = flags;
-	pkgconf_bytecode_from_buffer(&v->bc, &v->bcbuf);
 
 	return (pkgconf_tuple_t *) v;
 }
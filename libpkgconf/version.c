@@ -19,18 +19,11 @@
 #include <libpkgconf/stdinc.h>
 #include <libpkgconf/libpkgconf.h>
 
-typedef enum {
-	PKGCONF_VERSION_TOKEN_END = 0,
-	PKGCONF_VERSION_TOKEN_TILDE,
-	PKGCONF_VERSION_TOKEN_NUMERIC,
-	PKGCONF_VERSION_TOKEN_ALPHA
-} pkgconf_version_token_kind_t;
-
 typedef struct {
 	pkgconf_version_token_kind_t kind;
 	const char *start;
 	const char *end;
-} pkgconf_version_token_t;
+} pkgconf_version_span_t;
 
 typedef struct {
 	const char *cur;
@@ -51,10 +44,10 @@ pkgconf_version_skip_separators(const char *s)
 	return s;
 }
 
-static pkgconf_version_token_t
+static pkgconf_version_span_t
 pkgconf_version_next_token(pkgconf_version_iter_t *it)
 {
-	pkgconf_version_token_t tok;
+	pkgconf_version_span_t tok;
 	const char *s = pkgconf_version_skip_separators(it->cur);
 
 	tok.start = s;
@@ -98,7 +91,7 @@ pkgconf_version_next_token(pkgconf_version_iter_t *it)
 }
 
 static int
-pkgconf_version_compare_numeric(const pkgconf_version_token_t *a, const pkgconf_version_token_t *b)
+pkgconf_version_compare_numeric(const pkgconf_version_span_t *a, const pkgconf_version_span_t *b)
 {
 	const char *ap = a->start;
 	const char *bp = b->start;
@@ -132,7 +125,7 @@ pkgconf_version_compare_numeric(const pkgconf_version_token_t *a, const pkgconf_
 }
 
 static int
-pkgconf_version_compare_alpha(const pkgconf_version_token_t *a, const pkgconf_version_token_t *b)
+pkgconf_version_compare_alpha(const pkgconf_version_span_t *a, const pkgconf_version_span_t *b)
 {
 	size_t alen = (size_t)(a->end - a->start);
 	size_t blen = (size_t)(b->end - b->start);
@@ -154,7 +147,7 @@ pkgconf_version_compare_alpha(const pkgconf_version_token_t *a, const pkgconf_ve
 }
 
 static int
-pkgconf_version_compare_token(const pkgconf_version_token_t *a, const pkgconf_version_token_t *b)
+pkgconf_version_compare_token(const pkgconf_version_span_t *a, const pkgconf_version_span_t *b)
 {
 	if (a->kind == PKGCONF_VERSION_TOKEN_TILDE || b->kind == PKGCONF_VERSION_TOKEN_TILDE)
 	{
@@ -222,8 +215,8 @@ pkgconf_compare_version(const char *a, const char *b)
 
 	for (;;)
 	{
-		pkgconf_version_token_t ta = pkgconf_version_next_token(&ia);
-		pkgconf_version_token_t tb = pkgconf_version_next_token(&ib);
+		pkgconf_version_span_t ta = pkgconf_version_next_token(&ia);
+		pkgconf_version_span_t tb = pkgconf_version_next_token(&ib);
 		int ret = pkgconf_version_compare_token(&ta, &tb);
 
 		if (ret != 0)
@@ -236,3 +229,232 @@ pkgconf_compare_version(const char *a, const char *b)
 		}
 	}
 }
+
+/* numeric tokens with at most this many significant digits are also stored as integers */
+#define PKGCONF_VERSION_NUMERIC_DIGITS	19
+
+/*
+ * !doc
+ *
+ * .. c:function:: bool pkgconf_version_parse(pkgconf_version_t *version, const char *str)
+ *
+ *    Split a version string into the tokens used for comparison, so that it can be compared
+ *    repeatedly with ``pkgconf_version_compare()`` without being tokenised again.  The string
+ *    must outlive the parsed version.  If `version` already holds the tokens of `str`, it is
+ *    left as it is, so a ``pkgconf_version_t`` can serve as a cache next to the string it parses.
+ *
+ *    :param pkgconf_version_t* version: The parsed version to fill in.
+ *    :param char* str: The version string to parse, or ``NULL``.
+ *    :return: true if the tokens are available, false if `str` is ``NULL`` or memory ran out.
+ *    :rtype: bool
+ */
+bool
+pkgconf_version_parse(pkgconf_version_t *version, const char *str)
+{
+	pkgconf_version_iter_t it;
+	pkgconf_version_token_t *tokens;
+	size_t count = 0, i = 0;
+
+	if (version->str == str && version->tokens != NULL)
+		return true;
+
+	pkgconf_version_free(version);
+	version->str = str;
+
+	if (str == NULL)
+		return false;
+
+	/* a version has at most one token per byte, plus the end marker */
+	it.cur = str;
+	for (;;)
+	{
+		pkgconf_version_span_t span = pkgconf_version_next_token(&it);
+
+		count++;
+		if (span.kind == PKGCONF_VERSION_TOKEN_END)
+			break;
+	}
+
+	tokens = pkgconf_reallocarray(NULL, count, sizeof(*tokens));
+	if (tokens == NULL)
+		return false;
+
+	it.cur = str;
+	for (;;)
+	{
+		pkgconf_version_span_t span = pkgconf_version_next_token(&it);
+		pkgconf_version_token_t *tok = &tokens[i++];
+
+		tok->kind = span.kind;
+		tok->value = 0;
+
+		if (span.kind == PKGCONF_VERSION_TOKEN_NUMERIC)
+		{
+			while (span.start < span.end && *span.start == '0')
+				span.start++;
+
+			if (span.end - span.start <= PKGCONF_VERSION_NUMERIC_DIGITS)
+			{
+				for (const char *p = span.start; p < span.end; p++)
+					tok->value = tok->value * 10 + (uint64_t) (*p - '0');
+			}
+		}
+
+		tok->offset = (unsigned int) (span.start - str);
+		tok->len = (unsigned int) (span.end - span.start);
+
+		if (span.kind == PKGCONF_VERSION_TOKEN_END)
+			break;
+	}
+
+	version->tokens = tokens;
+
+	return true;
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: void pkgconf_version_free(pkgconf_version_t *version)
+ *
+ *    Release the tokens of a parsed version.  The version string itself is not freed.
+ *
+ *    :param pkgconf_version_t* version: The parsed version to release.
+ *    :return: nothing
+ */
+void
+pkgconf_version_free(pkgconf_version_t *version)
+{
+	free(version->tokens);
+
+	version->tokens = NULL;
+	version->str = NULL;
+}
+
+static int
+pkgconf_version_compare_parsed_numeric(const pkgconf_version_t *a, const pkgconf_version_token_t *ta,
+	const pkgconf_version_t *b, const pkgconf_version_token_t *tb)
+{
+	int ret;
+
+	if (ta->len != tb->len)
+		return ta->len > tb->len ? 1 : -1;
+
+	if (ta->len <= PKGCONF_VERSION_NUMERIC_DIGITS)
+	{
+		if (ta->value == tb->value)
+			return 0;
+
+		return ta->value > tb->value ? 1 : -1;
+	}
+
+	ret = strncmp(a->str + ta->offset, b->str + tb->offset, ta->len);
+	if (ret < 0)
+		return -1;
+	if (ret > 0)
+		return 1;
+
+	return 0;
+}
+
+static int
+pkgconf_version_compare_parsed_alpha(const pkgconf_version_t *a, const pkgconf_version_token_t *ta,
+	const pkgconf_version_t *b, const pkgconf_version_token_t *tb)
+{
+	size_t len = ta->len < tb->len ? ta->len : tb->len;
+	int ret;
+
+	ret = strncmp(a->str + ta->offset, b->str + tb->offset, len);
+	if (ret < 0)
+		return -1;
+	if (ret > 0)
+		return 1;
+
+	if (ta->len < tb->len)
+		return -1;
+	if (ta->len > tb->len)
+		return 1;
+
+	return 0;
+}
+
+/* the same ordering as pkgconf_version_compare_token(), over parsed tokens */
+static int
+pkgconf_version_compare_parsed_token(const pkgconf_version_t *a, const pkgconf_version_token_t *ta,
+	const pkgconf_version_t *b, const pkgconf_version_token_t *tb)
+{
+	if (ta->kind == PKGCONF_VERSION_TOKEN_TILDE || tb->kind == PKGCONF_VERSION_TOKEN_TILDE)
+	{
+		if (ta->kind != PKGCONF_VERSION_TOKEN_TILDE)
+			return 1;
+		if (tb->kind != PKGCONF_VERSION_TOKEN_TILDE)
+			return -1;
+
+		return 0;
+	}
+
+	if (ta->kind == PKGCONF_VERSION_TOKEN_END || tb->kind == PKGCONF_VERSION_TOKEN_END)
+	{
+		if (ta->kind == PKGCONF_VERSION_TOKEN_END && tb->kind == PKGCONF_VERSION_TOKEN_END)
+			return 0;
+		if (ta->kind == PKGCONF_VERSION_TOKEN_END)
+			return -1;
+
+		return 1;
+	}
+
+	if (ta->kind == PKGCONF_VERSION_TOKEN_NUMERIC)
+	{
+		if (tb->kind != PKGCONF_VERSION_TOKEN_NUMERIC)
+			return 1;
+
+		return pkgconf_version_compare_parsed_numeric(a, ta, b, tb);
+	}
+
+	if (tb->kind != PKGCONF_VERSION_TOKEN_ALPHA)
+		return -1;
+
+	return pkgconf_version_compare_parsed_alpha(a, ta, b, tb);
+}
+
+/*
+ * !doc
+ *
+ * .. c:function:: int pkgconf_version_compare(const pkgconf_version_t *a, const pkgconf_version_t *b)
+ *
+ *    Compare two parsed versions, with the same result as ``pkgconf_compare_version()`` on the
+ *    strings they were parsed from.  A version whose tokens are unavailable is compared as a string.
+ *
+ *    :param pkgconf_version_t* a: The first version to compare in the pair.
+ *    :param pkgconf_version_t* b: The second version to compare in the pair.
+ *    :return: -1 if the first version is less than, 0 if both versions are equal, 1 if the second version is less than.
+ *    :rtype: int
+ */
+int
+pkgconf_version_compare(const pkgconf_version_t *a, const pkgconf_version_t *b)
+{
+	if (a->str == NULL)
+		return -1;
+	if (b->str == NULL)
+		return 1;
+
+	if (a->tokens == NULL || b->tokens == NULL)
+		return pkgconf_compare_version(a->str, b->str);
+
+	if (!strcasecmp(a->str, b->str))
+		return 0;
+
+	for (size_t i = 0;; i++)
+	{
+		const pkgconf_version_token_t *ta = &a->tokens[i];
+		const pkgconf_version_token_t *tb = &b->tokens[i];
+		int ret = pkgconf_version_compare_parsed_token(a, ta, b, tb);
+
+		if (ret != 0)
+			return ret;
+
+		/* equal tokens are of the same kind, so either both vectors end here or neither does */
+		if (ta->kind == PKGCONF_VERSION_TOKEN_END)
+			return 0;
+	}
+}
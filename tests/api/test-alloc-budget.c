@@ -0,0 +1,205 @@
+/*
+ * test-alloc-budget.c
+ * Allocation-count regression tests.  Representative queries run against a
+ * generated 50-package universe while fuzzer/alloc-inject counts the
+ * allocations libpkgconf makes, and each count is checked against a stored
+ * budget.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include "test-api.h"
+#include "alloc-inject.h"
+#include <tests/universe.h>
+
+/*
+ * The budgets are the measured values of a 64-bit build plus some headroom;
+ * byte counts are lower on 32-bit builds, where pointers are smaller.  When a
+ * change reduces the allocations a query makes, lower its budget to match, so
+ * that the reduction is kept.  A query that comes in well under its budget
+ * says so on stderr.
+ */
+typedef struct {
+	const char *name;
+	unsigned long count;
+	size_t bytes;
+} alloc_budget_t;
+
+static const alloc_budget_t budget_cflags = { "cflags", 3740, 396000 };
+static const alloc_budget_t budget_libs_static = { "libs-static", 3800, 400000 };
+static const alloc_budget_t budget_list_all = { "list-all", 3410, 407000 };
+
+#define FIXTURE_PACKAGES	50
+
+static char fixture_dir[] = "/tmp/pkgconf-alloc-budget-XXXXXX";
+
+static void
+setup_fixtures(void)
+{
+	universe_params_t params = UNIVERSE_PARAMS_DEFAULT;
+	universe_stats_t stats;
+
+	params.packages = FIXTURE_PACKAGES;
+	params.private_percent = 50;
+	params.spine = true;
+
+	TEST_ASSERT_NONNULL(mkdtemp(fixture_dir));
+	TEST_ASSERT_TRUE(universe_generate(&params, fixture_dir, &stats));
+}
+
+static void
+teardown_fixtures(void)
+{
+	char name[64];
+	char path[PKGCONF_ITEM_SIZE];
+
+	for (unsigned long i = 0; i < FIXTURE_PACKAGES; i++)
+	{
+		universe_package_name(name, sizeof name, i);
+		snprintf(path, sizeof path, "%s/%s.pc", fixture_dir, name);
+		remove(path);
+	}
+
+	rmdir(fixture_dir);
+}
+
+static pkgconf_client_t *
+fixture_client(unsigned int flags)
+{
+	pkgconf_client_t *client = test_client_new();
+
+	pkgconf_path_free(&client->dir_list);
+	pkgconf_path_add(fixture_dir, &client->dir_list, false);
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_NO_UNINSTALLED | flags);
+
+	return client;
+}
+
+static void
+check_budget(const alloc_budget_t *budget, unsigned long count, size_t bytes)
+{
+	fprintf(stderr, " [%s: %lu allocations, %zu bytes]", budget->name, count, bytes);
+
+	TEST_ASSERT_LE(count, budget->count);
+	TEST_ASSERT_LE(bytes, budget->bytes);
+
+	if (count < budget->count * 9 / 10 || bytes < budget->bytes * 9 / 10)
+		fprintf(stderr, " [%s: well under budget, consider lowering it]", budget->name);
+}
+
+/* What --cflags and --libs do: solve the query, collect the fragments and render them. */
+static void
+run_query(const alloc_budget_t *budget, unsigned int flags, bool libs)
+{
+	pkgconf_client_t *client = fixture_client(flags);
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t out = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+	char root[64];
+	unsigned long count;
+	size_t bytes;
+
+	if (flags & PKGCONF_PKG_PKGF_SEARCH_PRIVATE)
+		world.flags |= PKGCONF_PKG_PROPF_STATIC;
+
+	universe_package_name(root, sizeof root, 0);
+
+	alloc_inject_count_begin();
+
+	pkgconf_queue_push(&queue, root);
+	TEST_ASSERT_TRUE(pkgconf_queue_solve(client, &queue, &world, -1));
+
+	if (libs)
+		TEST_ASSERT_EQ(pkgconf_pkg_libs(client, &world, &frags, -1), PKGCONF_PKG_ERRF_OK);
+	else
+		TEST_ASSERT_EQ(pkgconf_pkg_cflags(client, &world, &frags, -1), PKGCONF_PKG_ERRF_OK);
+
+	pkgconf_fragment_render_buf(&frags, &out, true, NULL, ' ');
+	TEST_ASSERT_GT(pkgconf_buffer_len(&out), 0);
+
+	pkgconf_buffer_finalize(&out);
+	pkgconf_fragment_free(&frags);
+	pkgconf_solution_free(client, &world);
+	pkgconf_queue_free(&queue);
+
+	alloc_inject_count_end(&count, &bytes);
+
+	pkgconf_client_free(client);
+
+	check_budget(budget, count, bytes);
+}
+
+static void
+test_alloc_budget_cflags(void)
+{
+	run_query(&budget_cflags, 0, false);
+}
+
+static void
+test_alloc_budget_libs_static(void)
+{
+	run_query(&budget_libs_static, PKGCONF_PKG_PKGF_SEARCH_PRIVATE | PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS, true);
+}
+
+static bool
+list_entry(const pkgconf_pkg_t *pkg, void *data)
+{
+	pkgconf_buffer_t *out = data;
+
+	pkgconf_buffer_append_fmt(out, "%-30s %s - %s\n", pkg->id, pkg->realname, pkg->description);
+	return false;
+}
+
+/* What --list-all does: parse every package on the search path. */
+static void
+test_alloc_budget_list_all(void)
+{
+	pkgconf_client_t *client = fixture_client(0);
+	pkgconf_buffer_t out = PKGCONF_BUFFER_INITIALIZER;
+	unsigned long count;
+	size_t bytes;
+
+	alloc_inject_count_begin();
+
+	TEST_ASSERT_NULL(pkgconf_scan_all(client, &out, list_entry));
+	TEST_ASSERT_GT(pkgconf_buffer_len(&out), 0);
+	pkgconf_buffer_finalize(&out);
+
+	alloc_inject_count_end(&count, &bytes);
+
+	pkgconf_client_free(client);
+
+	check_budget(&budget_list_all, count, bytes);
+}
+
+int
+main(int argc, char *argv[])
+{
+	(void) argc;
+	const char *basename = pkgconf_path_find_basename(argv[0]);
+
+	setup_fixtures();
+
+	TEST_RUN(basename, test_alloc_budget_cflags);
+	TEST_RUN(basename, test_alloc_budget_libs_static);
+	TEST_RUN(basename, test_alloc_budget_list_all);
+
+	teardown_fixtures();
+
+	return EXIT_SUCCESS;
+}
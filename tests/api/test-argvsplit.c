@@ -0,0 +1,147 @@
+/*
+ * test-argvsplit.c
+ * Tests for the libpkgconf argvsplit module.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include "test-api.h"
+
+/* the arguments written by pkgconf_argv_tokenize(), joined by '|' */
+static void
+join_args(pkgconf_buffer_t *out, const char *args, int argc)
+{
+	pkgconf_buffer_reset(out);
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (i > 0)
+			pkgconf_buffer_push_byte(out, '|');
+
+		pkgconf_buffer_append(out, args);
+		args += strlen(args) + 1;
+	}
+}
+
+static void
+test_argv_split_quoting(void)
+{
+	int argc;
+	char **argv;
+
+	TEST_ASSERT_EQ(pkgconf_argv_split("-I'/opt/my include' \"-DX=\\\"y\\\"\" a\\ b", &argc, &argv), 0);
+	TEST_ASSERT_EQ(argc, 3);
+	TEST_ASSERT_STRCMP_EQ(argv[0], "-I/opt/my include");
+	TEST_ASSERT_STRCMP_EQ(argv[1], "-DX=\"y\"");
+	TEST_ASSERT_STRCMP_EQ(argv[2], "a b");
+	TEST_ASSERT_NULL(argv[3]);
+	pkgconf_argv_free(argv);
+
+	TEST_ASSERT_EQ(pkgconf_argv_split_raw("-I'/opt/my include' a\\ b", &argc, &argv), 0);
+	TEST_ASSERT_EQ(argc, 2);
+	TEST_ASSERT_STRCMP_EQ(argv[0], "-I'/opt/my include'");
+	TEST_ASSERT_STRCMP_EQ(argv[1], "a\\ b");
+	pkgconf_argv_free(argv);
+
+	/* an open quote or a trailing escape is an error */
+	TEST_ASSERT_EQ(pkgconf_argv_split("-I'/opt", &argc, &argv), -1);
+	TEST_ASSERT_NULL(argv);
+	TEST_ASSERT_EQ(pkgconf_argv_split("-I\\", &argc, &argv), -1);
+	TEST_ASSERT_NULL(argv);
+}
+
+/*
+ * Every unquoted whitespace byte ends an argument, so runs of whitespace leave
+ * empty arguments behind, while an empty last argument is dropped.  Callers
+ * rely on this, e.g. a greedy flag followed by two spaces takes an empty path.
+ */
+static void
+test_argv_split_empty_arguments(void)
+{
+	static const struct {
+		const char *src;
+		int argc;
+		const char *joined;
+	} cases[] = {
+		{ "", 0, "" },
+		{ " ", 1, "" },
+		{ "a ", 1, "a" },
+		{ " a", 2, "|a" },
+		{ "a  b", 3, "a||b" },
+		{ "''", 0, "" },
+		{ "a '' b", 3, "a||b" },
+	};
+	pkgconf_buffer_t joined = PKGCONF_BUFFER_INITIALIZER;
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(cases); i++)
+	{
+		int argc;
+		char **argv;
+		char buf[16];
+
+		TEST_ASSERT_EQ(pkgconf_argv_split(cases[i].src, &argc, &argv), 0);
+		TEST_ASSERT_EQ(argc, cases[i].argc);
+		TEST_ASSERT_NONNULL(argv[0]);
+		pkgconf_argv_free(argv);
+
+		TEST_ASSERT_EQ(pkgconf_argv_tokenize(cases[i].src, buf, false, &argc), 0);
+		TEST_ASSERT_EQ(argc, cases[i].argc);
+		join_args(&joined, buf, argc);
+		TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str_or_empty(&joined), cases[i].joined);
+	}
+
+	pkgconf_buffer_finalize(&joined);
+}
+
+/* tokenizing in place gives the same arguments as tokenizing into a copy */
+static void
+test_argv_tokenize_in_place(void)
+{
+	static const char src[] = "-framework  Foo \"-DA=\\\"b c\\\"\" '-I/x y' -lz\\ z";
+	char copy[sizeof src];
+	char in_place[sizeof src];
+	pkgconf_buffer_t expected = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_buffer_t actual = PKGCONF_BUFFER_INITIALIZER;
+	int argc_copy, argc_in_place;
+
+	for (int raw = 0; raw < 2; raw++)
+	{
+		memcpy(in_place, src, sizeof src);
+
+		TEST_ASSERT_EQ(pkgconf_argv_tokenize(src, copy, raw, &argc_copy), 0);
+		TEST_ASSERT_EQ(pkgconf_argv_tokenize(in_place, in_place, raw, &argc_in_place), 0);
+		TEST_ASSERT_EQ(argc_copy, argc_in_place);
+
+		join_args(&expected, copy, argc_copy);
+		join_args(&actual, in_place, argc_in_place);
+		TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&actual), pkgconf_buffer_str(&expected));
+	}
+
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&actual), "-framework||Foo|\"-DA=\\\"b c\\\"\"|'-I/x y'|-lz\\ z");
+
+	pkgconf_buffer_finalize(&expected);
+	pkgconf_buffer_finalize(&actual);
+}
+
+int
+main(int argc, char *argv[])
+{
+	(void) argc;
+	const char *basename = pkgconf_path_find_basename(argv[0]);
+
+	TEST_RUN(basename, test_argv_split_quoting);
+	TEST_RUN(basename, test_argv_split_empty_arguments);
+	TEST_RUN(basename, test_argv_tokenize_in_place);
+
+	return EXIT_SUCCESS;
+}
@@ -64,6 +64,33 @@ test_buffer_append_slice(void)
 	pkgconf_buffer_finalize(&buf);
 }
 
+static void
+test_buffer_extend(void)
+{
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+	char *p;
+
+	TEST_ASSERT_TRUE(pkgconf_buffer_append(&buf, "abc"));
+
+	p = pkgconf_buffer_extend(&buf, 5000);
+	TEST_ASSERT_NONNULL(p);
+	TEST_ASSERT_TRUE(p == pkgconf_buffer_str(&buf) + 3);
+	TEST_ASSERT_EQ(pkgconf_buffer_len(&buf), 5003);
+	TEST_ASSERT_EQ(pkgconf_buffer_str(&buf)[5003], '\0');
+
+	memset(p, 'x', 5000);
+	TEST_ASSERT_EQ(pkgconf_buffer_lastc(&buf), 'x');
+	TEST_ASSERT_TRUE(!strncmp(pkgconf_buffer_str(&buf), "abcxx", 5));
+
+	TEST_ASSERT_NONNULL(pkgconf_buffer_extend(&buf, 0));
+	TEST_ASSERT_EQ(pkgconf_buffer_len(&buf), 5003);
+
+	TEST_ASSERT_NULL(pkgconf_buffer_extend(&buf, SIZE_MAX));
+	TEST_ASSERT_EQ(pkgconf_buffer_len(&buf), 5003);
+
+	pkgconf_buffer_finalize(&buf);
+}
+
 static void
 test_buffer_append_fmt(void)
 {
@@ -455,6 +482,137 @@ test_charset_matches_spans(void)
 	}
 }
 
+/* the first member of charset among the n bytes at p, one byte at a time */
+static size_t
+naive_scan(const pkgconf_charset_t *charset, const char *p, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		if (pkgconf_charset_contains(charset, (unsigned char) p[i]))
+			return i;
+	}
+
+	return n;
+}
+
+/*
+ * pkgconf_charset_scan() may test a block of bytes at a time, so check it
+ * against a byte-at-a-time scan with a single member at every offset of
+ * lengths on either side of a block, for every byte value.  The byte just
+ * past the end is always a member, which the scan must not see.
+ */
+static void
+test_charset_scan(void)
+{
+	static const pkgconf_span_t quote_spans[] = {
+		{ 0x00, 0x1f }, { ' ', '#' }, { '%', '\'' }, { '*', '*' }, { ';', '<' },
+		{ '>', '?' }, { '[', ']' }, { '`', '`' }, { '{', '}' }, { 0x7f, 0xff },
+	};
+	static const pkgconf_span_t json_spans[] = {
+		{ 0x00, 0x1f }, { '"', '"' }, { '\\', '\\' },
+	};
+	static const pkgconf_span_t top[] = { { 0xfe, 0xff } };
+	pkgconf_charset_t charsets[5];
+	char buf[50];
+
+	/* 0x00 .. 0x1f and ' ' .. '#' are adjacent, so they make one range */
+	pkgconf_charset_from_spans(&charsets[0], quote_spans, PKGCONF_ARRAY_SIZE(quote_spans));
+	TEST_ASSERT_EQ(charsets[0].nranges, 9);
+
+	pkgconf_charset_from_spans(&charsets[1], json_spans, PKGCONF_ARRAY_SIZE(json_spans));
+	TEST_ASSERT_EQ(charsets[1].nranges, 3);
+
+	pkgconf_charset_from_spans(&charsets[2], top, PKGCONF_ARRAY_SIZE(top));
+	TEST_ASSERT_EQ(charsets[2].nranges, 1);
+
+	/* every other byte: far too many ranges, so only the map is used */
+	charsets[3] = (pkgconf_charset_t) PKGCONF_CHARSET_INITIALIZER;
+	for (size_t w = 0; w < 4; w++)
+		charsets[3].words[w] = UINT64_C(0x5555555555555555);
+
+	pkgconf_charset_from_spans(&charsets[4], quote_spans, 0);
+	TEST_ASSERT_EQ(charsets[4].nranges, 0);
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(charsets); i++)
+	{
+		const pkgconf_charset_t *charset = &charsets[i];
+		unsigned char member = 0, other = 0;
+
+		for (unsigned int c = 0; c <= 0xff; c++)
+		{
+			if (pkgconf_charset_contains(charset, (unsigned char) c))
+				member = (unsigned char) c;
+			else
+				other = (unsigned char) c;
+		}
+
+		for (size_t n = 0; n < sizeof(buf) - 1; n++)
+		{
+			memset(buf, other, n);
+			buf[n] = (char) member;
+
+			TEST_ASSERT_EQ(pkgconf_charset_scan(charset, buf, n), naive_scan(charset, buf, n));
+
+			for (size_t at = 0; at < n; at++)
+			{
+				for (unsigned int c = 0; c <= 0xff; c++)
+				{
+					buf[at] = (char) c;
+					TEST_ASSERT_EQ(pkgconf_charset_scan(charset, buf, n), naive_scan(charset, buf, n));
+				}
+
+				buf[at] = (char) other;
+			}
+		}
+	}
+}
+
+#define TEST_WORD_RANGES(X) X(0x3f, 0x40) X(0x7f, 0x80) X(0xbf, 0xc1) X(0xff, 0xff)
+#define TEST_JSON_RANGES(X) X(0x00, 0x1f) X('"', '"') X('\\', '\\')
+#define TEST_ALL_RANGES(X) X(0x00, 0xff)
+
+/* a set built at compile time has the members and ranges pkgconf_charset_from_spans() gives it */
+static void
+test_charset_from_ranges(void)
+{
+	static const pkgconf_charset_t built[] = {
+		PKGCONF_CHARSET_FROM_RANGES(TEST_WORD_RANGES),
+		PKGCONF_CHARSET_FROM_RANGES(TEST_JSON_RANGES),
+		PKGCONF_CHARSET_FROM_RANGES(TEST_ALL_RANGES),
+	};
+	static const pkgconf_span_t word_spans[] = {
+		{ 0x3f, 0x40 }, { 0x7f, 0x80 }, { 0xbf, 0xc1 }, { 0xff, 0xff },
+	};
+	static const pkgconf_span_t json_spans[] = {
+		{ 0x00, 0x1f }, { '"', '"' }, { '\\', '\\' },
+	};
+	static const pkgconf_span_t all_spans[] = { { 0x00, 0xff } };
+	const struct {
+		const pkgconf_span_t *spans;
+		size_t nspans;
+	} cases[] = {
+		{ word_spans, PKGCONF_ARRAY_SIZE(word_spans) },
+		{ json_spans, PKGCONF_ARRAY_SIZE(json_spans) },
+		{ all_spans, PKGCONF_ARRAY_SIZE(all_spans) },
+	};
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(cases); i++)
+	{
+		pkgconf_charset_t charset;
+
+		pkgconf_charset_from_spans(&charset, cases[i].spans, cases[i].nspans);
+
+		TEST_ASSERT_EQ(memcmp(built[i].words, charset.words, sizeof(charset.words)), 0);
+		TEST_ASSERT_EQ(built[i].nranges, cases[i].nspans);
+
+		for (unsigned int r = 0; r < built[i].nranges; r++)
+		{
+			TEST_ASSERT_EQ(built[i].range_lo[r], cases[i].spans[r].lo);
+			TEST_ASSERT_EQ(built[i].range_hi[r], cases[i].spans[r].hi);
+		}
+	}
+}
+
 static void
 test_str_eq_slice(void)
 {
@@ -531,6 +689,7 @@ main(int argc, const char **argv)
 	TEST_RUN(basename, test_buffer_empty);
 	TEST_RUN(basename, test_buffer_append);
 	TEST_RUN(basename, test_buffer_append_slice);
+	TEST_RUN(basename, test_buffer_extend);
 	TEST_RUN(basename, test_buffer_append_fmt);
 	TEST_RUN(basename, test_buffer_prepend);
 	TEST_RUN(basename, test_buffer_push_byte);
@@ -548,6 +707,8 @@ main(int argc, const char **argv)
 	TEST_RUN(basename, test_buffer_escape);
 	TEST_RUN(basename, test_buffer_escape_charset);
 	TEST_RUN(basename, test_charset_matches_spans);
+	TEST_RUN(basename, test_charset_scan);
+	TEST_RUN(basename, test_charset_from_ranges);
 	TEST_RUN(basename, test_charset_word_boundaries);
 	TEST_RUN(basename, test_str_eq_slice);
 	TEST_RUN(basename, test_span_contains);
@@ -466,6 +466,52 @@ test_rewrite_selfrefs_no_match(void)
 	pkgconf_client_free(client);
 }
 
+/* compiling with the splice gives the same bytecode as compiling and rewriting */
+static void
+test_compile_selfref_matches_rewrite(void)
+{
+	static const char *values[] = {
+		"${foo} new",
+		"${foo}${foo}/${bar}${foo}",
+		"no reference",
+		"",
+		"$${foo} ${foo",
+		"${pc_sysrootdir}${foo}",
+	};
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(values); i++)
+	{
+		for (int has_prev = 0; has_prev < 2; has_prev++)
+		{
+			pkgconf_buffer_t prev = PKGCONF_BUFFER_INITIALIZER;
+			pkgconf_buffer_t rhs = PKGCONF_BUFFER_INITIALIZER;
+			pkgconf_buffer_t expected = PKGCONF_BUFFER_INITIALIZER;
+			pkgconf_buffer_t actual = PKGCONF_BUFFER_INITIALIZER;
+
+			if (has_prev)
+			{
+				TEST_ASSERT_TRUE(pkgconf_bytecode_compile(&prev, "old ${other} "));
+				TEST_ASSERT_TRUE(pkgconf_bytecode_compile(&actual, "old ${other} "));
+			}
+
+			TEST_ASSERT_TRUE(pkgconf_bytecode_compile(&rhs, values[i]));
+			TEST_ASSERT_TRUE(pkgconf_bytecode_rewrite_selfrefs(&expected, &rhs, "foo", &prev));
+			TEST_ASSERT_TRUE(pkgconf_bytecode_compile_selfref(&actual, values[i], "foo"));
+
+			TEST_ASSERT_EQ(pkgconf_buffer_len(&actual), pkgconf_buffer_len(&expected));
+			if (pkgconf_buffer_len(&expected) != 0)
+				TEST_ASSERT_TRUE(!memcmp(actual.base, expected.base, pkgconf_buffer_len(&expected)));
+
+			pkgconf_buffer_finalize(&actual);
+			pkgconf_buffer_finalize(&expected);
+			pkgconf_buffer_finalize(&rhs);
+			pkgconf_buffer_finalize(&prev);
+		}
+	}
+
+	TEST_ASSERT_FALSE(pkgconf_bytecode_compile_selfref(NULL, "x", "foo"));
+}
+
 static void
 test_eval_plain_text(void)
 {
@@ -687,6 +733,7 @@ main(int argc, char *argv[])
 
 	TEST_RUN(basename, test_rewrite_selfrefs);
 	TEST_RUN(basename, test_rewrite_selfrefs_no_match);
+	TEST_RUN(basename, test_compile_selfref_matches_rewrite);
 
 	TEST_RUN(basename, test_compile_eval_roundtrip);
 	TEST_RUN(basename, test_compile_produces_nonempty_buffer);
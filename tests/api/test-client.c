@@ -171,6 +171,46 @@ test_client_trace_handler_fires(void)
 
 	pkgconf_client_free(client);
 }
+
+static void
+test_client_trace_events(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	FILE *f = tmpfile();
+	char buf[1024];
+	size_t n;
+
+	TEST_ASSERT_NONNULL(f);
+
+	/* without a file set, events are dropped */
+	PKGCONF_TRACE_EVENT_BEGIN(client, "dropped", NULL, NULL);
+	PKGCONF_TRACE_EVENT_END(client, "dropped");
+
+	pkgconf_client_set_trace_events(client, f);
+	TEST_ASSERT_EQ(pkgconf_client_get_trace_events(client), f);
+
+	PKGCONF_TRACE_EVENT_BEGIN(client, "outer", "path", "C:\\pc\\\"foo\".pc");
+	PKGCONF_TRACE_EVENT_BEGIN(client, "inner", NULL, NULL);
+	PKGCONF_TRACE_EVENT_END(client, "inner");
+	PKGCONF_TRACE_EVENT_END(client, "outer");
+
+	pkgconf_client_set_trace_events(client, NULL);
+	TEST_ASSERT_NULL(pkgconf_client_get_trace_events(client));
+
+	rewind(f);
+	n = fread(buf, 1, sizeof(buf) - 1, f);
+	buf[n] = '\0';
+
+	TEST_ASSERT_TRUE(!strncmp(buf, "[\n{\"name\":\"outer\",\"cat\":\"pkgconf\",\"ph\":\"B\",\"ts\":", 47));
+	TEST_ASSERT_STRSTR(buf, "\"args\":{\"path\":\"C:\\\\pc\\\\\\\"foo\\\".pc\"}}");
+	TEST_ASSERT_STRSTR(buf, "},\n{\"name\":\"inner\",\"cat\":\"pkgconf\",\"ph\":\"B\"");
+	TEST_ASSERT_STRSTR(buf, "{\"name\":\"outer\",\"cat\":\"pkgconf\",\"ph\":\"E\"");
+	TEST_ASSERT_NULL(strstr(buf, "dropped"));
+	TEST_ASSERT_EQ(strcmp(buf + n - 4, "}\n]\n"), 0);
+
+	fclose(f);
+	pkgconf_client_free(client);
+}
 #endif
 
 static void
@@ -340,6 +380,7 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_client_warn_handler_fires);
 #ifndef PKGCONF_LITE
 	TEST_RUN(basename, test_client_trace_handler_fires);
+	TEST_RUN(basename, test_client_trace_events);
 #endif
 	TEST_RUN(basename, test_client_unveil_handler_installation);
 
@@ -366,6 +366,44 @@ test_dependency_collision_drops_flagged_existing(void)
 	pkgconf_client_free(client);
 }
 
+static void
+test_dependency_cursor_collisions(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_pkg_t world = { .id = "virtual:world" };
+	pkgconf_list_t deps = PKGCONF_LIST_INITIALIZER;
+	pkgconf_dependency_cursor_t cursor;
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+
+	/* the cursor is seeded with what the list already holds */
+	pkgconf_dependency_parse_str(client, &deps, "foo", PKGCONF_PKG_DEPF_INTERNAL);
+	pkgconf_dependency_cursor_init(&cursor, &deps);
+
+	/* the unflagged foo > 1 replaces the seeded foo, and foo < 3 is kept beside it */
+	pkgconf_dependency_parse_cursor(client, &world, &cursor, "bar, foo > 1, foo < 3", 0);
+	TEST_ASSERT_EQ(dependency_count(&deps), 3);
+	TEST_ASSERT_STRCMP_EQ(dependency_at(&deps, 1)->version, "1");
+	TEST_ASSERT_EQ(dependency_at(&deps, 1)->flags, 0);
+
+	/* enough names to grow the table past its initial size */
+	for (size_t i = 0; i < 200; i++)
+	{
+		pkgconf_buffer_reset(&buf);
+		TEST_ASSERT_TRUE(pkgconf_buffer_append_fmt(&buf, "p%zu", i));
+		pkgconf_dependency_parse_cursor(client, &world, &cursor, pkgconf_buffer_str(&buf), 0);
+	}
+	TEST_ASSERT_EQ(dependency_count(&deps), 203);
+
+	/* flagged newcomers still collide with the unflagged nodes after the rebuild */
+	pkgconf_dependency_parse_cursor(client, &world, &cursor, "p150 foo", PKGCONF_PKG_DEPF_INTERNAL);
+	TEST_ASSERT_EQ(dependency_count(&deps), 203);
+
+	pkgconf_dependency_cursor_deinit(&cursor);
+	pkgconf_buffer_finalize(&buf);
+	pkgconf_dependency_free(&deps);
+	pkgconf_client_free(client);
+}
+
 static void
 test_version_equal(void)
 {
@@ -529,6 +567,7 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_dependency_add_multiple);
 	TEST_RUN(basename, test_dependency_collision_drops_flagged_newcomer);
 	TEST_RUN(basename, test_dependency_collision_drops_flagged_existing);
+	TEST_RUN(basename, test_dependency_cursor_collisions);
 
 	TEST_RUN(basename, test_version_equal);
 	TEST_RUN(basename, test_version_simple_numeric);
@@ -245,6 +245,57 @@ test_fragment_render_empty(void)
 	free(rendered);
 }
 
+static void
+test_fragment_render_escapes_and_children(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t vars = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+
+	pkgconf_fragment_parse(client, &frags, &vars, "-I\"/opt/my include\" -framework Cocoa -lfoo", 0);
+
+	/* the rendered list is sized up front, and must land after what the buffer holds */
+	pkgconf_buffer_append(&buf, "cc");
+	TEST_ASSERT_TRUE(pkgconf_fragment_render_buf(&frags, &buf, true, NULL, '\n'));
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&buf), "cc-I/opt/my\\ include\n-framework\nCocoa\n-lfoo");
+
+	pkgconf_buffer_finalize(&buf);
+	pkgconf_fragment_free(&frags);
+	pkgconf_variable_list_free(&vars);
+	pkgconf_client_free(client);
+}
+
+static bool
+render_type_only(const pkgconf_fragment_render_ctx_t *ctx, const pkgconf_fragment_t *frag, pkgconf_buffer_t *buf)
+{
+	(void) ctx;
+
+	return pkgconf_buffer_push_byte(buf, frag->type ? frag->type : '?');
+}
+
+static void
+test_fragment_render_ops_without_size(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t vars = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+	const pkgconf_fragment_render_ops_t ops = {
+		.render = render_type_only,
+	};
+
+	pkgconf_fragment_parse(client, &frags, &vars, "-L/usr/lib -lfoo -pthread", 0);
+
+	TEST_ASSERT_TRUE(pkgconf_fragment_render_buf(&frags, &buf, true, &ops, ','));
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&buf), "L,l,?");
+
+	pkgconf_buffer_finalize(&buf);
+	pkgconf_fragment_free(&frags);
+	pkgconf_variable_list_free(&vars);
+	pkgconf_client_free(client);
+}
+
 // Filter predicate: keep only -I (include) fragments.
 static bool
 filter_only_includes(const pkgconf_client_t *client, const pkgconf_fragment_t *frag, void *data)
@@ -483,6 +534,93 @@ test_fragment_has_system_dir_libs(void)
 	pkgconf_client_free(client);
 }
 
+/*
+ * The merge classification is worked out when a fragment is created, from the
+ * data it stores, and a copy carries it over rather than working it out again.
+ */
+static void
+test_fragment_classified_on_creation(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t copy = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t vars = PKGCONF_LIST_INITIALIZER;
+	pkgconf_fragment_cursor_t cursor;
+	const pkgconf_node_t *iter;
+
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_DONT_MERGE_SPECIAL_FRAGMENTS);
+	TEST_ASSERT_TRUE(pkgconf_fragment_parse(client, &frags, &vars,
+		"-lfoo -pthread -isystem /opt/include -Wl,--start-group -framework", 0));
+	TEST_ASSERT_EQ(fragment_count(&frags), 6);
+
+	/* a typed fragment stores its data without the flag */
+	TEST_ASSERT_EQ(fragment_at(&frags, 0)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK, PKGCONF_PKG_FRAGF_UNMERGEABLE);
+	TEST_ASSERT_EQ(fragment_at(&frags, 1)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK, PKGCONF_PKG_FRAGF_UNMERGEABLE);
+	TEST_ASSERT_EQ(fragment_at(&frags, 2)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK,
+		PKGCONF_PKG_FRAGF_UNMERGEABLE | PKGCONF_PKG_FRAGF_GROUPABLE | PKGCONF_PKG_FRAGF_GROUP_ONE | PKGCONF_PKG_FRAGF_SYSROOT_PATH);
+	TEST_ASSERT_EQ(fragment_at(&frags, 3)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK, PKGCONF_PKG_FRAGF_UNMERGEABLE);
+	TEST_ASSERT_EQ(fragment_at(&frags, 4)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK,
+		PKGCONF_PKG_FRAGF_UNMERGEABLE | PKGCONF_PKG_FRAGF_GROUPABLE);
+	TEST_ASSERT_EQ(fragment_at(&frags, 5)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK,
+		PKGCONF_PKG_FRAGF_UNMERGEABLE | PKGCONF_PKG_FRAGF_GROUPABLE | PKGCONF_PKG_FRAGF_GROUP_ONE);
+
+	pkgconf_fragment_cursor_init(&cursor, &copy);
+	PKGCONF_FOREACH_LIST_ENTRY(frags.head, iter)
+		pkgconf_fragment_copy_cursor(client, &cursor, iter->data, false);
+	pkgconf_fragment_cursor_deinit(&cursor);
+
+	TEST_ASSERT_EQ(fragment_count(&copy), 6);
+	for (size_t i = 0; i < 6; i++)
+		TEST_ASSERT_EQ(fragment_at(&copy, i)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK,
+			fragment_at(&frags, i)->flags & PKGCONF_PKG_FRAGF_CLASS_MASK);
+
+	pkgconf_fragment_free(&copy);
+	pkgconf_fragment_free(&frags);
+	pkgconf_variable_list_free(&vars);
+	pkgconf_client_free(client);
+}
+
+/* special fragments take the following ones as children, as their class says */
+static void
+test_fragment_special_children(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t vars = PKGCONF_LIST_INITIALIZER;
+	const pkgconf_fragment_t *frag;
+
+	TEST_ASSERT_TRUE(pkgconf_fragment_parse(client, &frags, &vars,
+		"-framework Foo -framework Bar -Wl,--start-group -la -lb -Wl,--end-group -lc", 0));
+	TEST_ASSERT_EQ(fragment_count(&frags), 4);
+
+	/* -framework takes exactly one child */
+	frag = fragment_at(&frags, 0);
+	TEST_ASSERT_STRCMP_EQ(frag->data, "-framework");
+	TEST_ASSERT_EQ(fragment_count(&frag->children), 1);
+	TEST_ASSERT_TRUE((frag->flags & PKGCONF_PKG_FRAGF_TERMINATED) != 0);
+
+	frag = fragment_at(&frags, 1);
+	TEST_ASSERT_STRCMP_EQ(frag->data, "-framework");
+	TEST_ASSERT_EQ(fragment_count(&frag->children), 1);
+
+	/* a group runs until its end */
+	frag = fragment_at(&frags, 2);
+	TEST_ASSERT_STRCMP_EQ(frag->data, "-Wl,--start-group");
+	TEST_ASSERT_EQ(fragment_count(&frag->children), 3);
+
+	frag = fragment_at(&frags, 3);
+	TEST_ASSERT_EQ(frag->type, 'l');
+	TEST_ASSERT_STRCMP_EQ(frag->data, "c");
+
+	char *rendered = render_to_string(&frags);
+	TEST_ASSERT_STRCMP_EQ(rendered, "-framework Foo -framework Bar -Wl,--start-group -la -lb -Wl,--end-group -lc");
+	free(rendered);
+
+	pkgconf_fragment_free(&frags);
+	pkgconf_variable_list_free(&vars);
+	pkgconf_client_free(client);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -496,6 +634,8 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_fragment_render_empty);
 	TEST_RUN(basename, test_fragment_render_cflags);
 	TEST_RUN(basename, test_fragment_render_libs);
+	TEST_RUN(basename, test_fragment_render_escapes_and_children);
+	TEST_RUN(basename, test_fragment_render_ops_without_size);
 	TEST_RUN(basename, test_fragment_filter_only_includes);
 	TEST_RUN(basename, test_fragment_filter_only_libnames);
 	TEST_RUN(basename, test_fragment_filter_keeps_nothing);
@@ -503,6 +643,8 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_fragment_splice_list);
 	TEST_RUN(basename, test_fragment_has_system_dir_matches);
 	TEST_RUN(basename, test_fragment_has_system_dir_libs);
+	TEST_RUN(basename, test_fragment_classified_on_creation);
+	TEST_RUN(basename, test_fragment_special_children);
 
 	return EXIT_SUCCESS; 
 }
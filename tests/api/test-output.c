@@ -0,0 +1,189 @@
+/*
+ * test-output.c
+ * Tests for the libpkgconf output API.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include "test-api.h"
+
+/* an output which records what it is given */
+typedef struct {
+	pkgconf_output_t output;
+
+	pkgconf_buffer_t written;
+	size_t calls;
+	size_t last_count;
+	const char *last_data;
+} recording_output_t;
+
+static bool
+recording_write(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_buffer_t *buffer)
+{
+	recording_output_t *rec = (recording_output_t *) output;
+
+	(void) stream;
+
+	rec->calls++;
+	rec->last_count = 1;
+	rec->last_data = pkgconf_buffer_str(buffer);
+
+	return pkgconf_buffer_len(buffer) == 0 ||
+		pkgconf_buffer_append_slice(&rec->written, pkgconf_buffer_str(buffer), pkgconf_buffer_len(buffer));
+}
+
+static bool
+recording_writev(pkgconf_output_t *output, pkgconf_output_stream_t stream, const pkgconf_output_segment_t *segments, size_t count)
+{
+	recording_output_t *rec = (recording_output_t *) output;
+
+	(void) stream;
+
+	rec->calls++;
+	rec->last_count = count;
+	rec->last_data = count > 0 ? segments[0].data : NULL;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (segments[i].len != 0 &&
+			!pkgconf_buffer_append_slice(&rec->written, segments[i].data, segments[i].len))
+			return false;
+	}
+
+	return true;
+}
+
+static void
+test_output_putbuf_is_vectored(void)
+{
+	recording_output_t rec = {
+		.output.write = recording_write,
+		.output.writev = recording_writev,
+	};
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+
+	pkgconf_buffer_append(&buf, "-L/usr/lib -lfoo");
+
+	/* the payload is handed over as it is, with the newline as a second segment */
+	TEST_ASSERT_TRUE(pkgconf_output_putbuf(&rec.output, PKGCONF_OUTPUT_STDOUT, &buf, true));
+	TEST_ASSERT_EQ(rec.calls, 1);
+	TEST_ASSERT_EQ(rec.last_count, 2);
+	TEST_ASSERT_TRUE(rec.last_data == pkgconf_buffer_str(&buf));
+
+	TEST_ASSERT_TRUE(pkgconf_output_putbuf(&rec.output, PKGCONF_OUTPUT_STDOUT, &buf, false));
+	TEST_ASSERT_EQ(rec.last_count, 1);
+
+	TEST_ASSERT_TRUE(pkgconf_output_puts(&rec.output, PKGCONF_OUTPUT_STDOUT, "}"));
+	TEST_ASSERT_EQ(rec.last_count, 2);
+
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&rec.written), "-L/usr/lib -lfoo\n-L/usr/lib -lfoo}\n");
+
+	pkgconf_buffer_finalize(&buf);
+	pkgconf_buffer_finalize(&rec.written);
+}
+
+static void
+test_output_writev_falls_back_to_write(void)
+{
+	recording_output_t rec = {
+		.output.write = recording_write,
+	};
+	const pkgconf_output_segment_t segments[] = {
+		{ "abc", 3 },
+		{ NULL, 0 },
+		{ "defgh", 2 },
+	};
+
+	TEST_ASSERT_TRUE(pkgconf_output_writev(&rec.output, PKGCONF_OUTPUT_STDOUT, segments, PKGCONF_ARRAY_SIZE(segments)));
+	TEST_ASSERT_EQ(rec.calls, 1);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&rec.written), "abcde");
+
+	TEST_ASSERT_TRUE(pkgconf_output_puts(&rec.output, PKGCONF_OUTPUT_STDOUT, "x"));
+	TEST_ASSERT_EQ(rec.calls, 2);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&rec.written), "abcdex\n");
+
+	pkgconf_buffer_finalize(&rec.written);
+}
+
+#ifndef _WIN32
+/*
+ * Small writes to the default output are buffered by stdio and large ones go
+ * straight to the file descriptor, so check that a mix of the two still comes
+ * out in order.
+ */
+static void
+test_output_default_keeps_order(void)
+{
+	pkgconf_output_t *output = pkgconf_output_default();
+	pkgconf_buffer_t large = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_buffer_t expected = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_buffer_t actual = PKGCONF_BUFFER_INITIALIZER;
+	char path[] = "/tmp/pkgconf-test-output-XXXXXX";
+	char chunk[4096];
+	int fd, saved;
+	ssize_t n;
+
+	for (size_t i = 0; i < 3000; i++)
+		pkgconf_buffer_append_fmt(&large, "-lx%zu ", i);
+
+	pkgconf_buffer_append(&expected, "first\n");
+	pkgconf_buffer_append(&expected, pkgconf_buffer_str(&large));
+	pkgconf_buffer_append(&expected, "\nsecond 2\nthird\n");
+
+	fd = mkstemp(path);
+	TEST_ASSERT_TRUE(fd >= 0);
+
+	fflush(stdout);
+	saved = dup(STDOUT_FILENO);
+	TEST_ASSERT_TRUE(saved >= 0);
+	TEST_ASSERT_TRUE(dup2(fd, STDOUT_FILENO) >= 0);
+
+	TEST_ASSERT_TRUE(pkgconf_output_puts(output, PKGCONF_OUTPUT_STDOUT, "first"));
+	TEST_ASSERT_TRUE(pkgconf_output_putbuf(output, PKGCONF_OUTPUT_STDOUT, &large, true));
+	TEST_ASSERT_TRUE(pkgconf_output_fmt(output, PKGCONF_OUTPUT_STDOUT, "second %d\n", 2));
+	TEST_ASSERT_TRUE(pkgconf_output_puts(output, PKGCONF_OUTPUT_STDOUT, "third"));
+
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+
+	lseek(fd, 0, SEEK_SET);
+	while ((n = read(fd, chunk, sizeof chunk)) > 0)
+		pkgconf_buffer_append_slice(&actual, chunk, (size_t) n);
+
+	close(fd);
+	unlink(path);
+
+	TEST_ASSERT_EQ(pkgconf_buffer_len(&actual), pkgconf_buffer_len(&expected));
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str(&actual), pkgconf_buffer_str(&expected));
+
+	pkgconf_buffer_finalize(&large);
+	pkgconf_buffer_finalize(&expected);
+	pkgconf_buffer_finalize(&actual);
+}
+#endif
+
+int
+main(int argc, char *argv[])
+{
+	(void) argc;
+	const char *basename = pkgconf_path_find_basename(argv[0]);
+
+	TEST_RUN(basename, test_output_putbuf_is_vectored);
+	TEST_RUN(basename, test_output_writev_falls_back_to_write);
+#ifndef _WIN32
+	TEST_RUN(basename, test_output_default_keeps_order);
+#endif
+
+	return EXIT_SUCCESS;
+}
@@ -91,6 +91,43 @@ test_personality_find_direct_path(void)
 	unlink(path);
 }
 
+// Keywords match in any case; ones which are a byte off are ignored
+static void
+test_personality_find_keyword_case(void)
+{
+	char path[] = "test-personality-XXXXXX";
+	int fd = mkstemp(path);
+	TEST_ASSERT_TRUE(fd >= 0);
+
+	FILE *f = fdopen(fd, "w");
+	TEST_ASSERT_NONNULL(f);
+
+	fprintf(f,
+		"TRIPLET: x86_64-linux-musl\n"
+		"Triplets: wrong\n"
+		"sysrootdir: /opt/sysroot\n"
+		"SysrootDi: /wrong\n"
+		"systemincludepaths: /opt/sysroot/usr/include\n"
+		"SystemIncludePath: /wrong\n"
+		"wantdefaultstatic: true\n"
+		"WantDefaultPurE: yes\n"
+		"WantDefaultStatik: false\n");
+	fclose(f);
+
+	pkgconf_cross_personality_t *p = pkgconf_cross_personality_find(path);
+	TEST_ASSERT_NONNULL(p);
+	TEST_ASSERT_STRCMP_EQ(p->name, "x86_64-linux-musl");
+	TEST_ASSERT_NONNULL(p->sysroot_dir);
+	TEST_ASSERT_STRCMP_EQ(p->sysroot_dir, "/opt/sysroot");
+	TEST_ASSERT_NONNULL(p->filter_includedirs.head);
+	TEST_ASSERT_NULL(p->filter_includedirs.head->next);
+	TEST_ASSERT_TRUE(p->want_default_static);
+	TEST_ASSERT_TRUE(p->want_default_pure);
+
+	pkgconf_cross_personality_deinit(p);
+	unlink(path);
+}
+
 #if !defined(_WIN32) && !defined(__HAIKU__)
 
 static void
@@ -177,6 +214,7 @@ main(int argc, char *argv[])
 #ifndef PKGCONF_LITE
 	TEST_RUN(basename, test_personality_find_invalid_triplet);
 	TEST_RUN(basename, test_personality_find_direct_path);
+	TEST_RUN(basename, test_personality_find_keyword_case);
 #if !defined(_WIN32) && !defined(__HAIKU__)
 	TEST_RUN(basename, test_personality_find_via_xdg);
 #endif
@@ -0,0 +1,161 @@
+/*
+ * test-pkg.c
+ * Tests for parsing .pc files into pkgconf_pkg_t.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include "test-api.h"
+
+static pkgconf_pkg_t *
+load_pc(pkgconf_client_t *client, const char *path, const char *contents)
+{
+	FILE *f = fopen(path, "wb");
+	TEST_ASSERT_NONNULL(f);
+	fputs(contents, f);
+	fclose(f);
+
+	pkgconf_pkg_t *pkg = pkgconf_pkg_new_from_path(client, path, 0);
+	remove(path);
+
+	return pkg;
+}
+
+static size_t
+list_length(const pkgconf_list_t *list)
+{
+	size_t n = 0;
+	const pkgconf_node_t *node;
+
+	PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
+		n++;
+
+	return n;
+}
+
+static const char *
+first_buffer(const pkgconf_list_t *bufferset)
+{
+	const pkgconf_bufferset_t *set = bufferset->head->data;
+
+	return pkgconf_buffer_str(&set->buffer);
+}
+
+/* every keyword, in a case other than its usual one, lands in its own field */
+static void
+test_pkg_keywords_case_insensitive(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_pkg_t *pkg = load_pc(client, "test-pkg-keywords.pc",
+		"name: keywords\n"
+		"DESCRIPTION: every keyword\n"
+		"vErSiOn: 1.2.3\n"
+		"url: https://example.org/\n"
+		"MAINTAINER: someone\n"
+		"source: https://example.org/src\n"
+		"license: MIT\n"
+		"LICENSE.FILE: COPYING\n"
+		"copyright: 2026 someone\n"
+		"link.abi: GNU\n"
+		"cflags: -DA\n"
+		"cflags.PRIVATE: -DB\n"
+		"Cflags.Shared: -DC\n"
+		"libs: -la\n"
+		"Libs.Private: -lb\n"
+		"libs.shared: -lc\n"
+		"requires: foo\n"
+		"REQUIRES.PRIVATE: bar\n"
+		"requires.internal: baz\n"
+		"Requires.Shared: quux\n"
+		"conflicts: old\n"
+		"PROVIDES: other\n");
+
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_STRCMP_EQ(pkg->realname, "keywords");
+	TEST_ASSERT_STRCMP_EQ(pkg->description, "every keyword");
+	TEST_ASSERT_STRCMP_EQ(pkg->version, "1.2.3");
+	TEST_ASSERT_STRCMP_EQ(pkg->url, "https://example.org/");
+	TEST_ASSERT_STRCMP_EQ(pkg->maintainer, "someone");
+	TEST_ASSERT_STRCMP_EQ(pkg->source, "https://example.org/src");
+	TEST_ASSERT_STRCMP_EQ(pkg->license_file, "COPYING");
+	TEST_ASSERT_EQ(list_length(&pkg->license), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->copyright), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->link_abi), 1);
+	TEST_ASSERT_STRCMP_EQ(first_buffer(&pkg->link_abi), "gnu");
+	TEST_ASSERT_EQ(list_length(&pkg->cflags), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->cflags_private), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->cflags_shared), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->libs), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->libs_private), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->libs_shared), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->required), 1);
+	/* Requires.private and Requires.internal share a list */
+	TEST_ASSERT_EQ(list_length(&pkg->requires_private), 2);
+	TEST_ASSERT_EQ(list_length(&pkg->requires_shared), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->conflicts), 1);
+	/* a package always provides itself */
+	TEST_ASSERT_EQ(list_length(&pkg->provides), 2);
+
+	pkgconf_pkg_unref(client, pkg);
+	pkgconf_client_free(client);
+}
+
+/* keywords which are a byte off, too short, or unknown are ignored */
+static void
+test_pkg_keywords_near_misses(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_pkg_t *pkg = load_pc(client, "test-pkg-near-misses.pc",
+		"Name: near-misses\n"
+		"Names: wrong\n"
+		"Nam: wrong\n"
+		"Description: near misses\n"
+		"Version: 1\n"
+		"Versions: 2\n"
+		"UR: wrong\n"
+		"URLs: wrong\n"
+		"Cflag: -DWRONG\n"
+		"CFLAGS.privatE: -DRIGHT\n"
+		"CFLAGS.privat: -DWRONG\n"
+		"Requires.privates: wrong\n"
+		"Requires.sharee: wrong\n"
+		"Link.AB: wrong\n"
+		"XFLAGS: -DWRONG\n");
+
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_STRCMP_EQ(pkg->realname, "near-misses");
+	TEST_ASSERT_STRCMP_EQ(pkg->version, "1");
+	TEST_ASSERT_NULL(pkg->url);
+	TEST_ASSERT_EQ(list_length(&pkg->cflags), 0);
+	TEST_ASSERT_EQ(list_length(&pkg->cflags_private), 1);
+	TEST_ASSERT_EQ(list_length(&pkg->requires_private), 0);
+	TEST_ASSERT_EQ(list_length(&pkg->requires_shared), 0);
+	/* without a Link.ABI field, the package gets the default */
+	TEST_ASSERT_EQ(list_length(&pkg->link_abi), 1);
+	TEST_ASSERT_STRCMP_EQ(first_buffer(&pkg->link_abi), "c");
+
+	pkgconf_pkg_unref(client, pkg);
+	pkgconf_client_free(client);
+}
+
+int
+main(int argc, char *argv[])
+{
+	(void) argc;
+	const char *basename = pkgconf_path_find_basename(argv[0]);
+
+	TEST_RUN(basename, test_pkg_keywords_case_insensitive);
+	TEST_RUN(basename, test_pkg_keywords_near_misses);
+
+	return EXIT_SUCCESS;
+}
@@ -43,6 +43,23 @@ setup_fixtures(void)
 		"Name: qdirect\nDescription: direct\nVersion: 1.0\n"
 		"Cflags: -I/direct/include\n"
 		"Libs: -L/direct/lib -ldirect\n");
+	write_pc("qprivmissing.pc",
+		"Name: qprivmissing\nDescription: private dep missing\nVersion: 1.0\n"
+		"Requires.private: does-not-exist\n");
+	write_pc("qconflict.pc",
+		"Name: qconflict\nDescription: conflicts with qbar\nVersion: 1.0\n"
+		"Conflicts: qbar <= 3.0\n");
+	write_pc("qcpub.pc",
+		"Name: qcpub\nDescription: public dep\nVersion: 1.0\n"
+		"Cflags: -I/cpub/include\nLibs: -L/cpub/lib -lcpub\nLink.ABI: c++\n");
+	write_pc("qcpriv.pc",
+		"Name: qcpriv\nDescription: private dep\nVersion: 1.0\n"
+		"Cflags: -I/cpriv/include\nLibs: -lcpriv\nLink.ABI: rust\n");
+	write_pc("qcollect.pc",
+		"Name: qcollect\nDescription: collect\nVersion: 1.0\n"
+		"Requires: qcpub\nRequires.private: qcpriv\n"
+		"Cflags: -I/collect/include\nCflags.shared: -DCOLLECT_SHARED\n"
+		"Libs: -lcollect\nLibs.private: -lm\n");
 }
 
 static void
@@ -51,6 +68,11 @@ teardown_fixtures(void)
 	remove(FIXTURE_DIR "/qfoo.pc");
 	remove(FIXTURE_DIR "/qbar.pc");
 	remove(FIXTURE_DIR "/qdirect.pc");
+	remove(FIXTURE_DIR "/qprivmissing.pc");
+	remove(FIXTURE_DIR "/qconflict.pc");
+	remove(FIXTURE_DIR "/qcpub.pc");
+	remove(FIXTURE_DIR "/qcpriv.pc");
+	remove(FIXTURE_DIR "/qcollect.pc");
 	rmdir(FIXTURE_DIR);
 }
 
@@ -171,6 +193,91 @@ test_queue_validate_empty(void)
 	pkgconf_client_free(client);
 }
 
+static void
+test_queue_exists_success(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+
+	pkgconf_queue_push(&queue, "qfoo");
+	pkgconf_queue_push(&queue, "qdirect >= 1.0");
+	TEST_ASSERT_TRUE(pkgconf_queue_exists(client, &queue, -1));
+
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_queue_exists_missing_package(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+
+	pkgconf_queue_push(&queue, "does-not-exist");
+	pkgconf_queue_push(&queue, "qfoo");
+	TEST_ASSERT_FALSE(pkgconf_queue_exists(client, &queue, -1));
+
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_queue_exists_private_dependency(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+
+	pkgconf_queue_push(&queue, "qprivmissing");
+	TEST_ASSERT_FALSE(pkgconf_queue_exists(client, &queue, -1));
+
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_queue_exists_conflicts(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+
+	pkgconf_queue_push(&queue, "qconflict");
+	TEST_ASSERT_TRUE(pkgconf_queue_exists(client, &queue, -1));
+
+	pkgconf_queue_push(&queue, "qbar");
+	TEST_ASSERT_FALSE(pkgconf_queue_exists(client, &queue, -1));
+
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_SKIP_CONFLICTS);
+	TEST_ASSERT_TRUE(pkgconf_queue_exists(client, &queue, -1));
+
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_queue_exists_then_full_load(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t cflags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t *pkg;
+
+	pkgconf_queue_push(&queue, "qdirect");
+	TEST_ASSERT_TRUE(pkgconf_queue_exists(client, &queue, -1));
+
+	/* the existence check skipped the fragment fields, so they must be reloaded */
+	pkg = pkgconf_pkg_find(client, "qdirect");
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_FALSE(pkg->flags & PKGCONF_PKG_PROPF_HEADER_ONLY);
+
+	TEST_ASSERT_EQ(pkgconf_pkg_cflags(client, pkg, &cflags, -1), PKGCONF_PKG_ERRF_OK);
+	TEST_ASSERT_GT(fragment_count(&cflags), 0);
+
+	pkgconf_fragment_free(&cflags);
+	pkgconf_pkg_unref(client, pkg);
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
 struct apply_state {
 	int calls;
 	size_t deps;
@@ -266,6 +373,240 @@ test_direct_pkg_helpers_traverse_each_call(void)
 	pkgconf_client_free(client);
 }
 
+static void
+render_list(const pkgconf_list_t *list, pkgconf_buffer_t *buf)
+{
+	pkgconf_buffer_reset(buf);
+	TEST_ASSERT_TRUE(pkgconf_fragment_render_buf(list, buf, true, NULL, ' '));
+}
+
+static void
+render_bufferset(const pkgconf_list_t *list, pkgconf_buffer_t *buf)
+{
+	const pkgconf_node_t *iter;
+
+	pkgconf_buffer_reset(buf);
+
+	PKGCONF_FOREACH_LIST_ENTRY(list->head, iter)
+	{
+		const pkgconf_bufferset_t *set = iter->data;
+
+		TEST_ASSERT_TRUE(pkgconf_buffer_append(buf, pkgconf_buffer_str_or_empty(&set->buffer)));
+		TEST_ASSERT_TRUE(pkgconf_buffer_push_byte(buf, ' '));
+	}
+}
+
+static void
+check_collect_matches_helpers(unsigned int client_flags, unsigned int collect_flags)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_pkg_t *pkg;
+	pkgconf_list_t cflags = PKGCONF_LIST_INITIALIZER, libs = PKGCONF_LIST_INITIALIZER, link_abi = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t one_cflags = PKGCONF_LIST_INITIALIZER, one_libs = PKGCONF_LIST_INITIALIZER, one_link_abi = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t expected = PKGCONF_BUFFER_INITIALIZER, got = PKGCONF_BUFFER_INITIALIZER;
+	unsigned int link_client_flags = client_flags;
+	uint64_t serial;
+
+	if (collect_flags & PKGCONF_PKG_COLLECTF_LINK_SHARED)
+		link_client_flags &= ~PKGCONF_PKG_PKGF_SEARCH_PRIVATE;
+
+	pkg = pkgconf_pkg_find(client, "qcollect");
+	TEST_ASSERT_NONNULL(pkg);
+
+	pkgconf_client_set_flags(client, client_flags);
+	TEST_ASSERT_EQ(pkgconf_pkg_cflags(client, pkg, &cflags, -1), PKGCONF_PKG_ERRF_OK);
+	pkgconf_client_set_flags(client, link_client_flags);
+	TEST_ASSERT_EQ(pkgconf_pkg_libs(client, pkg, &libs, -1), PKGCONF_PKG_ERRF_OK);
+	TEST_ASSERT_EQ(pkgconf_pkg_link_abi(client, pkg, &link_abi, -1), PKGCONF_PKG_ERRF_OK);
+
+	pkgconf_client_set_flags(client, client_flags);
+	serial = client->serial;
+	TEST_ASSERT_EQ(pkgconf_pkg_collect(client, pkg, &one_cflags, &one_libs, &one_link_abi, -1, collect_flags), PKGCONF_PKG_ERRF_OK);
+	TEST_ASSERT_EQ(client->serial, serial + 1);
+
+	render_list(&cflags, &expected);
+	render_list(&one_cflags, &got);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str_or_empty(&got), pkgconf_buffer_str_or_empty(&expected));
+
+	render_list(&libs, &expected);
+	render_list(&one_libs, &got);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str_or_empty(&got), pkgconf_buffer_str_or_empty(&expected));
+
+	render_bufferset(&link_abi, &expected);
+	render_bufferset(&one_link_abi, &got);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str_or_empty(&got), pkgconf_buffer_str_or_empty(&expected));
+
+	pkgconf_buffer_finalize(&expected);
+	pkgconf_buffer_finalize(&got);
+	pkgconf_fragment_free(&cflags);
+	pkgconf_fragment_free(&libs);
+	pkgconf_bufferset_free(&link_abi);
+	pkgconf_fragment_free(&one_cflags);
+	pkgconf_fragment_free(&one_libs);
+	pkgconf_bufferset_free(&one_link_abi);
+	pkgconf_pkg_unref(client, pkg);
+	pkgconf_client_free(client);
+}
+
+static void
+test_pkg_collect_shared(void)
+{
+	check_collect_matches_helpers(PKGCONF_PKG_PKGF_SEARCH_PRIVATE, PKGCONF_PKG_COLLECTF_LINK_SHARED);
+}
+
+static void
+test_pkg_collect_static(void)
+{
+	check_collect_matches_helpers(PKGCONF_PKG_PKGF_SEARCH_PRIVATE | PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS, PKGCONF_PKG_COLLECTF_NONE);
+}
+
+static void
+test_pkg_collect_nothing(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_pkg_t *pkg = pkgconf_pkg_find(client, "qcollect");
+	uint64_t serial = client->serial;
+
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_EQ(pkgconf_pkg_collect(client, pkg, NULL, NULL, NULL, -1, PKGCONF_PKG_COLLECTF_NONE), PKGCONF_PKG_ERRF_OK);
+	TEST_ASSERT_EQ(client->serial, serial);
+
+	pkgconf_pkg_unref(client, pkg);
+	pkgconf_client_free(client);
+}
+
+static void
+test_graph_freeze_after_solve(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_FREEZE_GRAPH);
+	pkgconf_queue_push(&queue, "qfoo");
+	TEST_ASSERT_TRUE(pkgconf_queue_solve(client, &queue, &world, -1));
+
+	/* world -> qfoo, world -> qbar (flattened) and qfoo -> qbar */
+	TEST_ASSERT_NONNULL(world.graph);
+	TEST_ASSERT_EQ(world.graph->node_count, 3);
+	TEST_ASSERT_EQ(world.graph->edge_count, 3);
+	TEST_ASSERT_TRUE(world.graph->nodes[0] == &world);
+	TEST_ASSERT_EQ(world.graph->edge_index[0], 0);
+	TEST_ASSERT_EQ(world.graph->edge_index[world.graph->node_count], world.graph->edge_count);
+
+	pkgconf_solution_free(client, &world);
+	TEST_ASSERT_NULL(world.graph);
+
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_queue_solve_conflicts_index(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t conflicting = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+
+	/* qconflict's rule is checked against the indexed world, and nothing matches */
+	pkgconf_queue_push(&queue, "qconflict");
+	pkgconf_queue_push(&queue, "qdirect");
+	pkgconf_queue_push(&queue, "qcollect");
+	TEST_ASSERT_TRUE(pkgconf_queue_solve(client, &queue, &world, -1));
+
+	TEST_ASSERT_EQ(world.required_index.count, required_count(&world));
+	for (size_t i = 1; i < world.required_index.count; i++)
+	{
+		const pkgconf_dependency_t *prev = world.required_index.entries[i - 1];
+		const pkgconf_dependency_t *dep = world.required_index.entries[i];
+
+		TEST_ASSERT_LE(strcmp(prev->package, dep->package), 0);
+	}
+
+	pkgconf_solution_free(client, &world);
+	TEST_ASSERT_NULL(world.required_index.entries);
+	pkgconf_queue_free(&queue);
+
+	/* qfoo pulls in qbar 2.0, which satisfies qconflict's rule */
+	pkgconf_queue_push(&conflicting, "qconflict");
+	pkgconf_queue_push(&conflicting, "qfoo");
+	TEST_ASSERT_FALSE(pkgconf_queue_solve(client, &conflicting, &world, -1));
+	pkgconf_solution_free(client, &world);
+
+	pkgconf_queue_free(&conflicting);
+	pkgconf_client_free(client);
+}
+
+static void
+test_graph_freeze_unsolved(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_pkg_t *pkg = pkgconf_pkg_find(client, "qfoo");
+
+	TEST_ASSERT_NONNULL(pkg);
+
+	/* qfoo's dependency on qbar has not been resolved yet */
+	TEST_ASSERT_FALSE(pkgconf_graph_freeze(client, pkg));
+	TEST_ASSERT_NULL(pkg->graph);
+
+	pkgconf_pkg_unref(client, pkg);
+	pkgconf_client_free(client);
+}
+
+static void
+test_graph_frozen_walk_matches_lists(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+	pkgconf_list_t cflags = PKGCONF_LIST_INITIALIZER, libs = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t frozen_cflags = PKGCONF_LIST_INITIALIZER, frozen_libs = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t expected = PKGCONF_BUFFER_INITIALIZER, got = PKGCONF_BUFFER_INITIALIZER;
+
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_FREEZE_GRAPH | PKGCONF_PKG_PKGF_SEARCH_PRIVATE);
+	pkgconf_queue_push(&queue, "qcollect");
+	TEST_ASSERT_TRUE(pkgconf_queue_solve(client, &queue, &world, -1));
+	TEST_ASSERT_NONNULL(world.graph);
+
+	TEST_ASSERT_EQ(pkgconf_pkg_collect(client, &world, &frozen_cflags, &frozen_libs, NULL, -1, PKGCONF_PKG_COLLECTF_LINK_SHARED), PKGCONF_PKG_ERRF_OK);
+
+	pkgconf_graph_free(client, &world);
+	TEST_ASSERT_EQ(pkgconf_pkg_collect(client, &world, &cflags, &libs, NULL, -1, PKGCONF_PKG_COLLECTF_LINK_SHARED), PKGCONF_PKG_ERRF_OK);
+
+	TEST_ASSERT_GT(fragment_count(&cflags), 0);
+	render_list(&cflags, &expected);
+	render_list(&frozen_cflags, &got);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str_or_empty(&got), pkgconf_buffer_str_or_empty(&expected));
+
+	TEST_ASSERT_GT(fragment_count(&libs), 0);
+	render_list(&libs, &expected);
+	render_list(&frozen_libs, &got);
+	TEST_ASSERT_STRCMP_EQ(pkgconf_buffer_str_or_empty(&got), pkgconf_buffer_str_or_empty(&expected));
+
+	pkgconf_buffer_finalize(&expected);
+	pkgconf_buffer_finalize(&got);
+	pkgconf_fragment_free(&cflags);
+	pkgconf_fragment_free(&libs);
+	pkgconf_fragment_free(&frozen_cflags);
+	pkgconf_fragment_free(&frozen_libs);
+	pkgconf_solution_free(client, &world);
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -279,10 +620,22 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_queue_validate_missing_package);
 	TEST_RUN(basename, test_queue_validate_unsatisfiable_version);
 	TEST_RUN(basename, test_queue_validate_empty);
+	TEST_RUN(basename, test_queue_exists_success);
+	TEST_RUN(basename, test_queue_exists_missing_package);
+	TEST_RUN(basename, test_queue_exists_private_dependency);
+	TEST_RUN(basename, test_queue_exists_conflicts);
+	TEST_RUN(basename, test_queue_exists_then_full_load);
+	TEST_RUN(basename, test_queue_solve_conflicts_index);
 	TEST_RUN(basename, test_queue_apply_success);
 	TEST_RUN(basename, test_queue_apply_callback_failure);
 	TEST_RUN(basename, test_queue_apply_missing_package);
 	TEST_RUN(basename, test_direct_pkg_helpers_traverse_each_call);
+	TEST_RUN(basename, test_pkg_collect_shared);
+	TEST_RUN(basename, test_pkg_collect_static);
+	TEST_RUN(basename, test_pkg_collect_nothing);
+	TEST_RUN(basename, test_graph_freeze_after_solve);
+	TEST_RUN(basename, test_graph_freeze_unsolved);
+	TEST_RUN(basename, test_graph_frozen_walk_matches_lists);
 
 	teardown_fixtures();
 
@@ -1,6 +1,6 @@
 /*
  * test-serialize.c
- * Tests for spdxtool's JSON serialization value model.
+ * Tests for spdxtool's JSON serialization value model and SPDX document.
  *
  * SPDX-License-Identifier: pkgconf
  *
@@ -19,6 +19,7 @@
 #include <libpkgconf/libpkgconf.h>
 #include "test-api.h"
 #include "serialize.h"
+#include "core.h"
 
 // Render a value to a freshly-allocated C string (caller frees)
 static char *
@@ -116,6 +117,21 @@ test_serialize_escape_sequences(void)
 	spdxtool_serialize_value_free(v);
 }
 
+// Escapes on either side of a 16-byte block boundary, and a clean tail after the last one
+static void
+test_serialize_escape_long_string(void)
+{
+	spdxtool_serialize_value_t *v = spdxtool_serialize_value_string(
+		"0123456789abcde\"0123456789abcdef\n0123456789abcd\x1f\\0123456789abcdefghijklmnop");
+	char *s = render(v);
+
+	TEST_ASSERT_STRCMP_EQ(s,
+		"\"0123456789abcde\\\"0123456789abcdef\\n0123456789abcd\\u001f\\\\0123456789abcdefghijklmnop\"");
+
+	free(s);
+	spdxtool_serialize_value_free(v);
+}
+
 // Mixed-type object exercises the int/bool/null add helpers
 static void
 test_serialize_object_mixed_types(void)
@@ -198,6 +214,173 @@ test_serialize_null_guards(void)
 	spdxtool_serialize_array_free(NULL);
 }
 
+// Read back what a writer wrote to a temporary file (caller frees)
+static char *
+read_back(FILE *f)
+{
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+	char chunk[4096];
+	size_t n;
+
+	rewind(f);
+	while ((n = fread(chunk, 1, sizeof chunk, f)) > 0)
+		TEST_ASSERT_TRUE(pkgconf_buffer_append_slice(&buf, chunk, n));
+
+	char *s = strdup(pkgconf_buffer_str_or_empty(&buf));
+	pkgconf_buffer_finalize(&buf);
+	return s;
+}
+
+// Streaming a document gives the same text as rendering its value tree
+static void
+test_serialize_writer_matches_tree(void)
+{
+	char *large = malloc(SPDXTOOL_SERIALIZE_WRITER_FLUSH_SIZE + 1);
+	TEST_ASSERT_NONNULL(large);
+	memset(large, 'x', SPDXTOOL_SERIALIZE_WRITER_FLUSH_SIZE);
+	large[SPDXTOOL_SERIALIZE_WRITER_FLUSH_SIZE] = '\0';
+
+	spdxtool_serialize_object_list_t *element = spdxtool_serialize_object_list_new();
+	spdxtool_serialize_array_t *to = spdxtool_serialize_array_new();
+	TEST_ASSERT_NONNULL(element);
+	TEST_ASSERT_NONNULL(to);
+	TEST_ASSERT_NONNULL(spdxtool_serialize_array_add_string(to, "b"));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_array_add_int(to, 2));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_string(element, "type", "Relationship"));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_array(element, "to", to));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_object(element, "empty", spdxtool_serialize_object_list_new()));
+
+	// the tree: { "@context": ..., "@graph": [ element, { "id": ..., "list": [], "large": ... } ] }
+	spdxtool_serialize_object_list_t *second = spdxtool_serialize_object_list_new();
+	spdxtool_serialize_array_t *graph = spdxtool_serialize_array_new();
+	spdxtool_serialize_object_list_t *root = spdxtool_serialize_object_list_new();
+	TEST_ASSERT_NONNULL(second);
+	TEST_ASSERT_NONNULL(graph);
+	TEST_ASSERT_NONNULL(root);
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_string(second, "id", "\"quoted\"\n"));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_array(second, "list", spdxtool_serialize_array_new()));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_string(second, "large", large));
+	spdxtool_serialize_value_t *element_value = spdxtool_serialize_array_add_object(graph, element);
+	TEST_ASSERT_NONNULL(element_value);
+	TEST_ASSERT_NONNULL(spdxtool_serialize_array_add_object(graph, second));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_string(root, "@context", "https://example.org/context"));
+	TEST_ASSERT_NONNULL(spdxtool_serialize_object_add_array(root, "@graph", graph));
+
+	char *expected = render_object(root);
+
+	FILE *f = tmpfile();
+	TEST_ASSERT_NONNULL(f);
+
+	spdxtool_serialize_writer_t writer;
+	spdxtool_serialize_writer_init(&writer, f);
+
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_begin_object(&writer, NULL));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_add_string(&writer, "@context", "https://example.org/context"));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_begin_array(&writer, "@graph"));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_add_value(&writer, NULL, element_value));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_begin_object(&writer, NULL));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_add_string(&writer, "id", "\"quoted\"\n"));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_begin_array(&writer, "list"));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_end_array(&writer));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_add_take(&writer, "large", spdxtool_serialize_value_string(large)));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_end_object(&writer));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_end_array(&writer));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_end_object(&writer));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_finish(&writer));
+
+	// a top-level value is followed by a newline
+	char *actual = read_back(f);
+	TEST_ASSERT_EQ(strlen(actual), strlen(expected) + 1);
+	TEST_ASSERT_EQ(actual[strlen(expected)], '\n');
+	actual[strlen(expected)] = '\0';
+	TEST_ASSERT_STRCMP_EQ(actual, expected);
+
+	fclose(f);
+	free(actual);
+	free(expected);
+	free(large);
+	spdxtool_serialize_object_list_free(root);
+}
+
+// An unbalanced document is not written out, and is reported as a failure
+static void
+test_serialize_writer_unbalanced(void)
+{
+	FILE *f = tmpfile();
+	TEST_ASSERT_NONNULL(f);
+
+	spdxtool_serialize_writer_t writer;
+	spdxtool_serialize_writer_init(&writer, f);
+
+	TEST_ASSERT_FALSE(spdxtool_serialize_writer_end_array(&writer));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_begin_object(&writer, NULL));
+	TEST_ASSERT_TRUE(spdxtool_serialize_writer_add_string(&writer, "k", "v"));
+	TEST_ASSERT_FALSE(spdxtool_serialize_writer_add_take(&writer, "k", NULL));
+	TEST_ASSERT_FALSE(spdxtool_serialize_writer_finish(&writer));
+
+	char *actual = read_back(f);
+	TEST_ASSERT_STRCMP_EQ(actual, "");
+
+	fclose(f);
+	free(actual);
+}
+
+static size_t
+list_length(const pkgconf_list_t *list)
+{
+	size_t n = 0;
+	const pkgconf_node_t *node;
+
+	PKGCONF_FOREACH_LIST_ENTRY(list->head, node)
+		n++;
+
+	return n;
+}
+
+// Licenses and maintainers are registered once each, in the order first seen
+static void
+test_spdx_document_dedup(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	spdxtool_util_set_uri_root(client, "https://example.com/test");
+	spdxtool_util_set_uri_separator_colon(client, false);
+
+	spdxtool_core_spdx_document_t *spdx = spdxtool_core_spdx_document_new(client, "docid", "_:c1", "agentid");
+	TEST_ASSERT_NONNULL(spdx);
+
+	// enough distinct keys to grow the indexes a few times
+	for (int round = 0; round < 2; round++)
+	{
+		for (int i = 0; i < 300; i++)
+		{
+			char license[32], maintainer[32];
+
+			snprintf(license, sizeof license, "LicenseRef-%d", i);
+			snprintf(maintainer, sizeof maintainer, "Maintainer %d", i % 100);
+
+			TEST_ASSERT_TRUE(spdxtool_core_spdx_document_add_license(client, spdx, license));
+			TEST_ASSERT_NONNULL(spdxtool_core_spdx_document_add_maintainer(client, spdx, maintainer));
+		}
+	}
+
+	TEST_ASSERT_EQ(list_length(&spdx->licenses), 300);
+	TEST_ASSERT_EQ(list_length(&spdx->maintainers), 100);
+	TEST_ASSERT_EQ(list_length(&spdx->element), 400);
+
+	TEST_ASSERT_TRUE(spdxtool_core_spdx_document_is_license(client, spdx, "LicenseRef-299"));
+	TEST_ASSERT_FALSE(spdxtool_core_spdx_document_is_license(client, spdx, "LicenseRef-300"));
+
+	const spdxtool_simplelicensing_license_expression_t *first = spdx->licenses.head->data;
+	TEST_ASSERT_STRCMP_EQ(first->license_expression, "LicenseRef-0");
+
+	// a maintainer seen again gives back the spdxId it was first registered with
+	const spdxtool_core_agent_t *maintainer = spdx->maintainers.tail->data;
+	TEST_ASSERT_TRUE(spdxtool_core_spdx_document_add_maintainer(client, spdx, "Maintainer 99") == maintainer->spdx_id);
+
+	spdxtool_core_spdx_document_free(spdx);
+	pkgconf_client_free(client);
+}
+
 int
 main(int argc, const char **argv)
 {
@@ -209,10 +392,14 @@ main(int argc, const char **argv)
 	TEST_RUN(basename, test_serialize_value_bool);
 	TEST_RUN(basename, test_serialize_value_null);
 	TEST_RUN(basename, test_serialize_escape_sequences);
+	TEST_RUN(basename, test_serialize_escape_long_string);
 	TEST_RUN(basename, test_serialize_object_mixed_types);
 	TEST_RUN(basename, test_serialize_object_key_escaping);
 	TEST_RUN(basename, test_serialize_array_mixed_types);
 	TEST_RUN(basename, test_serialize_null_guards);
+	TEST_RUN(basename, test_serialize_writer_matches_tree);
+	TEST_RUN(basename, test_serialize_writer_unbalanced);
+	TEST_RUN(basename, test_spdx_document_dedup);
 
 	return EXIT_SUCCESS;
 }
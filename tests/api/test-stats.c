@@ -0,0 +1,393 @@
+/*
+ * test-stats.c
+ * Tests for the libpkgconf performance counters and phase timers.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include "test-api.h"
+
+#define FIXTURE_DIR "test-stats-pcdir"
+
+static void
+setup_fixtures(void)
+{
+	FILE *f;
+
+	mkdir(FIXTURE_DIR, 0755);
+
+	f = fopen(FIXTURE_DIR "/sbar.pc", "wb");
+	TEST_ASSERT_NONNULL(f);
+	fputs("Name: sbar\nDescription: bar\nVersion: 2.0\nLibs: -lsbar\n", f);
+	fclose(f);
+
+	f = fopen(FIXTURE_DIR "/sfoo.pc", "wb");
+	TEST_ASSERT_NONNULL(f);
+	fputs("prefix=/s\nName: sfoo\nDescription: foo\nVersion: 1.0\nRequires: sbar\nLibs: -L${prefix}/lib -lsfoo\n", f);
+	fclose(f);
+}
+
+static void
+teardown_fixtures(void)
+{
+	remove(FIXTURE_DIR "/sbar.pc");
+	remove(FIXTURE_DIR "/sfoo.pc");
+	rmdir(FIXTURE_DIR);
+}
+
+static pkgconf_client_t *
+fixture_client(void)
+{
+	pkgconf_client_t *client = test_client_new();
+
+	pkgconf_path_free(&client->dir_list);
+	pkgconf_path_add(FIXTURE_DIR, &client->dir_list, false);
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_NO_UNINSTALLED);
+
+	return client;
+}
+
+static uint64_t
+counter(const pkgconf_client_t *client, pkgconf_stats_counter_t c)
+{
+	return client->stats.counters[c];
+}
+
+static void
+test_stats_find_counts_files_and_cache(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_pkg_t *pkg;
+
+	pkg = pkgconf_pkg_find(client, "sfoo");
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_FILES_OPENED), 1);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_FILES_FAILED), 0);
+	TEST_ASSERT_GT(counter(client, PKGCONF_STATS_BYTES_PARSED), 0);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_PACKAGES_PARSED), 1);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_DIRS_SCANNED), 0);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_CACHE_HITS), 0);
+	pkgconf_pkg_unref(client, pkg);
+
+	/* the second lookup is served from the cache */
+	pkg = pkgconf_pkg_find(client, "sfoo");
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_FILES_OPENED), 1);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_CACHE_HITS), 1);
+	pkgconf_pkg_unref(client, pkg);
+
+	TEST_ASSERT_NULL(pkgconf_pkg_find(client, "does-not-exist"));
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_FILES_FAILED), 1);
+
+	pkgconf_client_free(client);
+}
+
+static void
+test_stats_solve_counts_traversal_and_fragments(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t libs = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+
+	pkgconf_queue_push(&queue, "sfoo");
+	TEST_ASSERT_TRUE(pkgconf_queue_solve(client, &queue, &world, -1));
+	TEST_ASSERT_GT(counter(client, PKGCONF_STATS_TRAVERSAL_NODES), 0);
+	TEST_ASSERT_GT(counter(client, PKGCONF_STATS_TRAVERSAL_EDGES), 0);
+
+	TEST_ASSERT_EQ(pkgconf_pkg_libs(client, &world, &libs, -1), PKGCONF_PKG_ERRF_OK);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_FRAGMENTS_COPIED), 3);
+	TEST_ASSERT_GT(counter(client, PKGCONF_STATS_BYTECODE_OPS), 0);
+
+	pkgconf_stats_reset(client);
+	for (size_t i = 0; i < PKGCONF_STATS_COUNTER_COUNT; i++)
+		TEST_ASSERT_EQ(client->stats.counters[i], 0);
+
+	pkgconf_fragment_free(&libs);
+	pkgconf_solution_free(client, &world);
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_stats_counts_probes_and_shifts(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t deps = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t *pkg;
+
+	/* each dependency is checked for a collision against the ones before it */
+	pkgconf_dependency_parse_str(client, &deps, "a, b, c", 0);
+	TEST_ASSERT_EQ(deps.length, 3);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_DEPENDENCY_PROBES), 3);
+	pkgconf_dependency_free(&deps);
+
+	/* sbar sorts before sfoo, so caching it moves sfoo along */
+	pkg = pkgconf_pkg_find(client, "sfoo");
+	TEST_ASSERT_NONNULL(pkg);
+	pkgconf_pkg_unref(client, pkg);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_INDEX_SHIFTS), 0);
+
+	pkg = pkgconf_pkg_find(client, "sbar");
+	TEST_ASSERT_NONNULL(pkg);
+	pkgconf_pkg_unref(client, pkg);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_INDEX_SHIFTS), 1);
+
+	/* the cache is drained from the end, which moves nothing */
+	pkgconf_cache_free(client);
+	TEST_ASSERT_EQ(client->cache_count, 0);
+	TEST_ASSERT_EQ(counter(client, PKGCONF_STATS_INDEX_SHIFTS), 1);
+
+	pkgconf_client_free(client);
+}
+
+static void
+test_stats_phases_nest(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_stats_phase_t outer, inner;
+
+	/* phases are tracked, but not timed, until timing is enabled */
+	outer = pkgconf_stats_phase_begin(client, PKGCONF_STATS_PHASE_SEARCH);
+	TEST_ASSERT_EQ(outer, PKGCONF_STATS_PHASE_NONE);
+	pkgconf_stats_phase_end(client, outer);
+	TEST_ASSERT_EQ(client->stats.phase_ns[PKGCONF_STATS_PHASE_SEARCH], 0);
+
+	pkgconf_stats_set_timing(client, true);
+
+	outer = pkgconf_stats_phase_begin(client, PKGCONF_STATS_PHASE_SEARCH);
+	inner = pkgconf_stats_phase_begin(client, PKGCONF_STATS_PHASE_PARSE);
+	TEST_ASSERT_EQ(inner, PKGCONF_STATS_PHASE_SEARCH);
+	TEST_ASSERT_EQ(client->stats.phase, PKGCONF_STATS_PHASE_PARSE);
+
+	pkgconf_stats_phase_end(client, inner);
+	TEST_ASSERT_EQ(client->stats.phase, PKGCONF_STATS_PHASE_SEARCH);
+
+	pkgconf_stats_phase_end(client, outer);
+	TEST_ASSERT_EQ(client->stats.phase, PKGCONF_STATS_PHASE_NONE);
+
+	pkgconf_client_free(client);
+}
+
+typedef struct {
+	pkgconf_profile_event_t events[64];
+	size_t count;
+	size_t depth;
+	size_t max_depth;
+} profile_log_t;
+
+static void
+profile_handler(const pkgconf_client_t *client, const pkgconf_profile_event_t *event, void *data)
+{
+	profile_log_t *log = data;
+
+	(void) client;
+
+	if (event->type == PKGCONF_PROFILE_EVENT_BEGIN)
+	{
+		if (++log->depth > log->max_depth)
+			log->max_depth = log->depth;
+	}
+	else
+	{
+		TEST_ASSERT_GT(log->depth, 0);
+		log->depth--;
+	}
+
+	if (log->count < sizeof(log->events) / sizeof(log->events[0]))
+		log->events[log->count++] = *event;
+}
+
+static bool
+profile_log_has(const profile_log_t *log, pkgconf_profile_event_type_t type, pkgconf_profile_phase_t phase)
+{
+	for (size_t i = 0; i < log->count; i++)
+	{
+		if (log->events[i].type == type && log->events[i].phase == phase)
+			return true;
+	}
+
+	return false;
+}
+
+static void
+test_stats_profile_handler(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+	profile_log_t log = { .count = 0 };
+	pkgconf_pkg_t *pkg;
+
+	pkgconf_client_set_profile_handler(client, profile_handler, &log);
+	TEST_ASSERT_EQ(pkgconf_client_get_profile_handler(client), profile_handler);
+
+	/* a lookup which parses a file: search { parse { } } */
+	pkg = pkgconf_pkg_find(client, "sbar");
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_EQ(log.count, 4);
+	TEST_ASSERT_EQ(log.events[0].type, PKGCONF_PROFILE_EVENT_BEGIN);
+	TEST_ASSERT_EQ(log.events[0].phase, PKGCONF_PROFILE_PHASE_SEARCH);
+	TEST_ASSERT_EQ(log.events[1].phase, PKGCONF_PROFILE_PHASE_PARSE);
+	TEST_ASSERT_EQ(log.events[2].type, PKGCONF_PROFILE_EVENT_END);
+	TEST_ASSERT_EQ(log.events[2].phase, PKGCONF_PROFILE_PHASE_PARSE);
+	TEST_ASSERT_EQ(log.events[2].pkg, pkg);
+	TEST_ASSERT_EQ(log.events[3].type, PKGCONF_PROFILE_EVENT_END);
+	TEST_ASSERT_EQ(log.events[3].phase, PKGCONF_PROFILE_PHASE_SEARCH);
+	TEST_ASSERT_EQ(log.events[3].pkg, pkg);
+	pkgconf_pkg_unref(client, pkg);
+
+	for (size_t i = 1; i < log.count; i++)
+		TEST_ASSERT_GE(log.events[i].timestamp, log.events[i - 1].timestamp);
+
+	log.count = 0;
+	log.max_depth = 0;
+
+	pkgconf_queue_push(&queue, "sfoo");
+	TEST_ASSERT_TRUE(pkgconf_queue_solve(client, &queue, &world, -1));
+	TEST_ASSERT_EQ(log.depth, 0);
+	TEST_ASSERT_GE(log.max_depth, 3);
+	TEST_ASSERT_TRUE(profile_log_has(&log, PKGCONF_PROFILE_EVENT_BEGIN, PKGCONF_PROFILE_PHASE_SOLVE));
+	TEST_ASSERT_TRUE(profile_log_has(&log, PKGCONF_PROFILE_EVENT_BEGIN, PKGCONF_PROFILE_PHASE_TRAVERSE));
+	TEST_ASSERT_TRUE(profile_log_has(&log, PKGCONF_PROFILE_EVENT_END, PKGCONF_PROFILE_PHASE_FLATTEN));
+	TEST_ASSERT_EQ(log.events[0].pkg, &world);
+
+	/* once uninstalled, nothing is reported */
+	pkgconf_client_set_profile_handler(client, NULL, NULL);
+	log.count = 0;
+
+	pkg = pkgconf_pkg_find(client, "sbar");
+	TEST_ASSERT_NONNULL(pkg);
+	TEST_ASSERT_EQ(log.count, 0);
+	pkgconf_pkg_unref(client, pkg);
+
+	TEST_ASSERT_STRCMP_EQ(pkgconf_profile_phase_name(PKGCONF_PROFILE_PHASE_TRAVERSE), "traverse");
+	TEST_ASSERT_NULL(pkgconf_profile_phase_name(PKGCONF_PROFILE_PHASE_COUNT));
+
+	pkgconf_solution_free(client, &world);
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+}
+
+static void
+test_stats_phase_hook(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	profile_log_t log = { .count = 0 };
+	pkgconf_phase_t outer, inner;
+	FILE *f = tmpfile();
+	char buf[1024];
+	size_t n;
+
+	TEST_ASSERT_NONNULL(f);
+
+	pkgconf_client_set_profile_handler(client, profile_handler, &log);
+	pkgconf_client_set_trace_events(client, f);
+
+	/* one hook reaches the statistics, the trace event file and the profile handler */
+	outer = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SOLVE, "outer", "name", "sfoo", NULL);
+	inner = pkgconf_phase_begin(client, PKGCONF_STATS_PHASE_SEARCH, NULL, NULL, NULL, NULL);
+	TEST_ASSERT_EQ(inner.previous, PKGCONF_STATS_PHASE_SOLVE);
+	TEST_ASSERT_EQ(client->stats.phase, PKGCONF_STATS_PHASE_SEARCH);
+	pkgconf_phase_end(client, &inner, NULL);
+	pkgconf_phase_end(client, &outer, NULL);
+	TEST_ASSERT_EQ(client->stats.phase, PKGCONF_STATS_PHASE_NONE);
+
+	TEST_ASSERT_EQ(log.count, 4);
+	TEST_ASSERT_EQ(log.depth, 0);
+	TEST_ASSERT_EQ(log.events[0].phase, PKGCONF_PROFILE_PHASE_SOLVE);
+	TEST_ASSERT_EQ(log.events[1].phase, PKGCONF_PROFILE_PHASE_SEARCH);
+	TEST_ASSERT_EQ(log.events[3].type, PKGCONF_PROFILE_EVENT_END);
+	TEST_ASSERT_EQ(log.events[3].phase, PKGCONF_PROFILE_PHASE_SOLVE);
+
+	pkgconf_client_set_trace_events(client, NULL);
+	pkgconf_client_set_profile_handler(client, NULL, NULL);
+
+	/* a phase without a name opens no span */
+	rewind(f);
+	n = fread(buf, 1, sizeof(buf) - 1, f);
+	buf[n] = '\0';
+
+	TEST_ASSERT_STRSTR(buf, "{\"name\":\"outer\",\"cat\":\"pkgconf\",\"ph\":\"B\"");
+	TEST_ASSERT_STRSTR(buf, "\"args\":{\"name\":\"sfoo\"}}");
+	TEST_ASSERT_STRSTR(buf, "{\"name\":\"outer\",\"cat\":\"pkgconf\",\"ph\":\"E\"");
+	TEST_ASSERT_NULL(strstr(strstr(buf, "\"ph\":\"B\"") + 1, "\"ph\":\"B\""));
+
+	fclose(f);
+	pkgconf_client_free(client);
+}
+
+static void
+test_stats_render(void)
+{
+	pkgconf_client_t *client = fixture_client();
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_stats_counter_t c;
+	pkgconf_pkg_t *pkg;
+
+	pkg = pkgconf_pkg_find(client, "sbar");
+	TEST_ASSERT_NONNULL(pkg);
+	pkgconf_pkg_unref(client, pkg);
+
+	TEST_ASSERT_TRUE(pkgconf_stats_render(client, &buf));
+	TEST_ASSERT_TRUE(!strncmp(pkgconf_buffer_str(&buf), "{\"counters\":{\"files_opened\":1,", 30));
+	TEST_ASSERT_NULL(strstr(pkgconf_buffer_str(&buf), "phases_ns"));
+	TEST_ASSERT_EQ(pkgconf_buffer_str(&buf)[pkgconf_buffer_len(&buf) - 1], '}');
+
+	pkgconf_buffer_reset(&buf);
+	pkgconf_stats_set_timing(client, true);
+
+	TEST_ASSERT_TRUE(pkgconf_stats_render(client, &buf));
+	TEST_ASSERT_NONNULL(strstr(pkgconf_buffer_str(&buf), ",\"phases_ns\":{\"other\":"));
+	TEST_ASSERT_NONNULL(strstr(pkgconf_buffer_str(&buf), "\"render\":"));
+
+	TEST_ASSERT_STRCMP_EQ(pkgconf_stats_counter_name(PKGCONF_STATS_BYTECODE_OPS), "bytecode_ops");
+	TEST_ASSERT_NULL(pkgconf_stats_counter_name(PKGCONF_STATS_COUNTER_COUNT));
+	TEST_ASSERT_TRUE(pkgconf_stats_counter_lookup("dirs_scanned", &c));
+	TEST_ASSERT_EQ(c, PKGCONF_STATS_DIRS_SCANNED);
+	TEST_ASSERT_FALSE(pkgconf_stats_counter_lookup("no_such_counter", &c));
+	TEST_ASSERT_STRCMP_EQ(pkgconf_stats_phase_name(PKGCONF_STATS_PHASE_FLATTEN), "flatten");
+	TEST_ASSERT_NULL(pkgconf_stats_phase_name(PKGCONF_STATS_PHASE_COUNT));
+
+	pkgconf_buffer_finalize(&buf);
+	pkgconf_client_free(client);
+}
+
+int
+main(int argc, char *argv[])
+{
+	(void) argc;
+	const char *basename = pkgconf_path_find_basename(argv[0]);
+
+	setup_fixtures();
+
+	TEST_RUN(basename, test_stats_find_counts_files_and_cache);
+	TEST_RUN(basename, test_stats_solve_counts_traversal_and_fragments);
+	TEST_RUN(basename, test_stats_counts_probes_and_shifts);
+	TEST_RUN(basename, test_stats_phases_nest);
+	TEST_RUN(basename, test_stats_render);
+	TEST_RUN(basename, test_stats_profile_handler);
+	TEST_RUN(basename, test_stats_phase_hook);
+
+	teardown_fixtures();
+
+	return EXIT_SUCCESS;
+}
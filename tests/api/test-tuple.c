@@ -234,6 +234,49 @@ test_tuple_escaped_quote(void)
 	pkgconf_client_free(client);
 }
 
+/* var=${var}... appends to the previous definition, however often it is done */
+static void
+test_tuple_self_reference_appends(void)
+{
+	pkgconf_client_t *client = test_client_new();
+	pkgconf_list_t tuples = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t expected = PKGCONF_BUFFER_INITIALIZER;
+
+	TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "prefix", "/usr", true, 0));
+	TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "cflags", "-I${prefix}/include", true, 0));
+	pkgconf_buffer_append(&expected, "-I/usr/include");
+
+	for (int i = 0; i < 50; i++)
+	{
+		TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "cflags", "${cflags} -DX", true, 0));
+		pkgconf_buffer_append(&expected, " -DX");
+	}
+
+	TEST_ASSERT_STRCMP_EQ(pkgconf_tuple_find(client, &tuples, "cflags"), pkgconf_buffer_str(&expected));
+
+	/* a later definition of a referenced variable still applies */
+	TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "prefix", "/opt", true, 0));
+	pkgconf_buffer_reset(&expected);
+	pkgconf_buffer_append(&expected, "-I/opt/include");
+	for (int i = 0; i < 50; i++)
+		pkgconf_buffer_append(&expected, " -DX");
+
+	TEST_ASSERT_STRCMP_EQ(pkgconf_tuple_find(client, &tuples, "cflags"), pkgconf_buffer_str(&expected));
+
+	/* both sides of the reference, and a quoted value */
+	TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "path", "b", true, 0));
+	TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "path", "\"a:${path}:c\"", true, 0));
+	TEST_ASSERT_STRCMP_EQ(pkgconf_tuple_find(client, &tuples, "path"), "a:b:c");
+
+	/* a reference to a variable not defined before is empty */
+	TEST_ASSERT_NONNULL(pkgconf_tuple_add(client, &tuples, "fresh", "${fresh}x", true, 0));
+	TEST_ASSERT_STRCMP_EQ(pkgconf_tuple_find(client, &tuples, "fresh"), "x");
+
+	pkgconf_buffer_finalize(&expected);
+	pkgconf_tuple_free(&tuples);
+	pkgconf_client_free(client);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -253,6 +296,7 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_tuple_define_variable_end_to_end);
 	TEST_RUN(basename, test_tuple_define_variable_overrides_local);
 	TEST_RUN(basename, test_tuple_escaped_quote);
+	TEST_RUN(basename, test_tuple_self_reference_appends);
 
 	return EXIT_SUCCESS;
 }
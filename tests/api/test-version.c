@@ -17,18 +17,35 @@
 
 #include "test-api.h"
 
+/* compares a and b both as strings and as parsed versions, which must agree */
+static int
+cmp_both(const char *a, const char *b)
+{
+	pkgconf_version_t va = PKGCONF_VERSION_INITIALIZER, vb = PKGCONF_VERSION_INITIALIZER;
+	int ret = pkgconf_compare_version(a, b);
+
+	TEST_ASSERT_EQ(pkgconf_version_parse(&va, a), a != NULL);
+	TEST_ASSERT_EQ(pkgconf_version_parse(&vb, b), b != NULL);
+	TEST_ASSERT_EQ(pkgconf_version_compare(&va, &vb), ret);
+
+	pkgconf_version_free(&va);
+	pkgconf_version_free(&vb);
+
+	return ret;
+}
+
 static void
 cmp_lt(const char *a, const char *b)
 {
-	TEST_ASSERT_EQ(pkgconf_compare_version(a, b), -1);
-	TEST_ASSERT_EQ(pkgconf_compare_version(b, a), 1);
+	TEST_ASSERT_EQ(cmp_both(a, b), -1);
+	TEST_ASSERT_EQ(cmp_both(b, a), 1);
 }
 
 static void
 cmp_eq(const char *a, const char *b)
 {
-	TEST_ASSERT_EQ(pkgconf_compare_version(a, b), 0);
-	TEST_ASSERT_EQ(pkgconf_compare_version(b, a), 0);
+	TEST_ASSERT_EQ(cmp_both(a, b), 0);
+	TEST_ASSERT_EQ(cmp_both(b, a), 0);
 }
 
 static void
@@ -113,6 +130,44 @@ test_version_real_world(void)
 	cmp_lt("1.0.0~rc1", "1.0.0");
 }
 
+static void
+test_version_long_numeric(void)
+{
+	cmp_lt("1.9999999999999999999", "1.10000000000000000000");
+	cmp_lt("1.12345678901234567890", "1.12345678901234567891");
+	cmp_eq("1.000012345678901234567890", "1.12345678901234567890");
+	cmp_lt("20260101000000000000", "20260101000000000001");
+}
+
+static void
+test_version_parse_cache(void)
+{
+	const char *str = "1.2.3~rc1";
+	pkgconf_version_t v = PKGCONF_VERSION_INITIALIZER;
+	const pkgconf_version_token_t *tokens;
+
+	TEST_ASSERT_TRUE(pkgconf_version_parse(&v, str));
+	tokens = v.tokens;
+
+	/* 1 . 2 . 3 ~ rc 1 <end> */
+	TEST_ASSERT_EQ(tokens[0].kind, PKGCONF_VERSION_TOKEN_NUMERIC);
+	TEST_ASSERT_EQ(tokens[0].value, 1);
+	TEST_ASSERT_EQ(tokens[3].kind, PKGCONF_VERSION_TOKEN_TILDE);
+	TEST_ASSERT_EQ(tokens[4].kind, PKGCONF_VERSION_TOKEN_ALPHA);
+	TEST_ASSERT_EQ(tokens[4].len, 2);
+	TEST_ASSERT_EQ(tokens[6].kind, PKGCONF_VERSION_TOKEN_END);
+
+	/* parsing the same string again reuses the tokens */
+	TEST_ASSERT_TRUE(pkgconf_version_parse(&v, str));
+	TEST_ASSERT_TRUE(v.tokens == tokens);
+
+	/* parsing NULL drops them */
+	TEST_ASSERT_FALSE(pkgconf_version_parse(&v, NULL));
+	TEST_ASSERT_NULL(v.tokens);
+
+	pkgconf_version_free(&v);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -128,6 +183,8 @@ main(int argc, char *argv[])
 	TEST_RUN(basename, test_version_tilde);
 	TEST_RUN(basename, test_version_alpha_numeric);
 	TEST_RUN(basename, test_version_real_world);
+	TEST_RUN(basename, test_version_long_numeric);
+	TEST_RUN(basename, test_version_parse_cache);
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,159 @@
+/*
+ * bench-deep-chain.c
+ * Benchmark dependency solving and flag collection over a very deep chain.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+#include <libpkgconf/path.h>
+#include <tests/win-shim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_DEPTH	100000
+#define CHAIN_DIR	"bench-deep-chain-pcdir"
+
+/*
+ * Package chain-N requires chain-(N+1).  The names are zero-padded so that the
+ * packages are loaded, and thus added to the cache, in sorted order.
+ */
+static bool
+write_chain(unsigned long depth)
+{
+	char path[512];
+
+	mkdir(CHAIN_DIR, 0755);
+
+	for (unsigned long i = 0; i < depth; i++)
+	{
+		FILE *f;
+
+		snprintf(path, sizeof path, "%s/chain-%08lu.pc", CHAIN_DIR, i);
+		f = fopen(path, "wb");
+		if (f == NULL)
+			return false;
+
+		fprintf(f, "Name: chain-%08lu\nDescription: link %lu of the chain\nVersion: 1.0\n", i, i);
+		fprintf(f, "Cflags: -DCHAIN_%lu\nLibs: -lchain%lu\n", i, i);
+		if (i + 1 < depth)
+			fprintf(f, "Requires: chain-%08lu >= 1.0\n", i + 1);
+
+		fclose(f);
+	}
+
+	return true;
+}
+
+static void
+remove_chain(unsigned long depth)
+{
+	char path[512];
+
+	for (unsigned long i = 0; i < depth; i++)
+	{
+		snprintf(path, sizeof path, "%s/chain-%08lu.pc", CHAIN_DIR, i);
+		remove(path);
+	}
+
+	rmdir(CHAIN_DIR);
+}
+
+static double
+elapsed_ms(clock_t start)
+{
+	return (double) (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static size_t
+list_length(const pkgconf_list_t *list)
+{
+	size_t n = 0;
+	const pkgconf_node_t *iter;
+
+	PKGCONF_FOREACH_LIST_ENTRY(list->head, iter)
+		n++;
+
+	return n;
+}
+
+static bool
+collect_apply(pkgconf_client_t *client, pkgconf_pkg_t *world, void *data, int maxdepth)
+{
+	pkgconf_list_t *libs = data;
+	pkgconf_list_t cflags = PKGCONF_LIST_INITIALIZER;
+	unsigned int eflags;
+
+	eflags = pkgconf_pkg_collect(client, world, &cflags, libs, NULL, maxdepth, PKGCONF_PKG_COLLECTF_LINK_SHARED);
+	pkgconf_fragment_free(&cflags);
+
+	return eflags == PKGCONF_PKG_ERRF_OK;
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned long depth = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_DEPTH;
+	pkgconf_client_t *client;
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t libs = PKGCONF_LIST_INITIALIZER;
+	clock_t start;
+	bool ok;
+	int ret = EXIT_FAILURE;
+
+	if (depth == 0)
+	{
+		fprintf(stderr, "usage: %s [depth]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	start = clock();
+	if (!write_chain(depth))
+	{
+		fprintf(stderr, "failed to write the %lu package chain\n", depth);
+		goto out;
+	}
+	printf("generate: %lu packages, %.1f ms\n", depth, elapsed_ms(start));
+
+	client = pkgconf_client_new(NULL, NULL, pkgconf_cross_personality_default(), NULL, NULL);
+	pkgconf_path_free(&client->dir_list);
+	pkgconf_path_add(CHAIN_DIR, &client->dir_list, false);
+	pkgconf_client_set_flags(client, PKGCONF_PKG_PKGF_SEARCH_PRIVATE);
+
+	pkgconf_queue_push(&queue, "chain-00000000");
+
+	start = clock();
+	ok = pkgconf_queue_validate(client, &queue, -1);
+	printf("validate: %s, %.1f ms\n", ok ? "ok" : "FAILED", elapsed_ms(start));
+	if (!ok)
+		goto free_client;
+
+	start = clock();
+	ok = pkgconf_queue_apply(client, &queue, collect_apply, -1, &libs);
+	printf("solve+collect: %zu libs, %.1f ms\n", list_length(&libs), elapsed_ms(start));
+	if (!ok || list_length(&libs) != depth)
+		goto free_client;
+
+	ret = EXIT_SUCCESS;
+
+free_client:
+	pkgconf_fragment_free(&libs);
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+out:
+	remove_chain(depth);
+	return ret;
+}
@@ -0,0 +1,625 @@
+/*
+ * bench-kernels.c
+ * Microbenchmarks for the string kernels every query runs: version comparison,
+ * variable definition and bytecode, fragment parsing and mergeback, argv
+ * splitting, dependency parsing, shell escaping, and spdxtool's JSON string
+ * escaping.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "serialize.h"
+
+#ifdef BENCH_ALLOC_INJECT
+# include "alloc-inject.h"
+#endif
+
+/*
+ * Each kernel runs over a realistic input set, taken from the shapes found in
+ * real .pc files, and an adversarial one built to hit its slow paths.  Kernels
+ * whose cost grows with the length of their input also run over a large set
+ * of long but otherwise ordinary values.  One
+ * operation is one call on the next value of the set.  The operation count is
+ * doubled until a measurement takes at least the minimum time, and the result
+ * is printed as one JSON object per line.
+ *
+ * Allocations per operation are counted over a separate, untimed batch when
+ * the benchmark is linked with fuzzer/alloc-inject (BENCH_ALLOC_INJECT), and
+ * reported as null otherwise.
+ */
+
+#define DEFAULT_MIN_MS	100
+#define ALLOC_ROUNDS	64
+#define ADVERSARIAL_MAX	6
+
+typedef struct {
+	pkgconf_client_t *client;
+	pkgconf_list_t vars;
+	pkgconf_charset_t charset;
+	pkgconf_buffer_t out;
+
+	/* bytecode for the eval kernel, compiled from the input set when it is prepared */
+	pkgconf_buffer_t *compiled;
+	size_t ncompiled;
+
+	/* fragment lists for the copy kernel, parsed from the input set */
+	pkgconf_list_t *parsed;
+	size_t nparsed;
+} bench_ctx_t;
+
+typedef struct {
+	const char *name;
+	const char **values;
+	size_t count;
+} bench_input_t;
+
+typedef struct {
+	const char *name;
+	bool (*prepare)(bench_ctx_t *ctx, const bench_input_t *input);
+	bool (*run)(bench_ctx_t *ctx, const bench_input_t *input, size_t i);
+	void (*finish)(bench_ctx_t *ctx);
+	const bench_input_t *realistic;
+	bench_input_t *adversarial;
+	bench_input_t *large;
+} bench_kernel_t;
+
+/*
+ * ===========
+ * input sets
+ * ===========
+ */
+
+static const char *versions_realistic[] = {
+	"1.2.3", "1.2.4", "2.74.1", "2.74.1", "3.0.13-rc1", "3.0.13",
+	"1.2.3~beta2", "1.2.3", "20230125", "20230125.1", "0.9.8zh", "1.1.1w",
+};
+
+static const char *values_realistic[] = {
+	"${prefix}/lib",
+	"${libdir}/pkgconfig",
+	"-I${includedir}/glib-2.0 -I${libdir}/glib-2.0/include",
+	"/usr/lib/x86_64-linux-gnu",
+	"${pc_sysrootdir}${prefix}/share/${name}",
+};
+
+static const char *fragments_realistic[] = {
+	"-I/usr/include/glib-2.0 -I/usr/lib/x86_64-linux-gnu/glib-2.0/include -pthread",
+	"-L/usr/lib -lgobject-2.0 -lglib-2.0 -lintl",
+	"-Wl,--as-needed -framework CoreFoundation -lm",
+	"-DG_LOG_DOMAIN=\\\"GLib\\\" -I'/opt/My Program/include'",
+};
+
+static const char *dependencies_realistic[] = {
+	"glib-2.0 >= 2.50, gobject-2.0 >= 2.50, zlib",
+	"libssl >= 1.1 libcrypto",
+	"gtk+-3.0 >= 3.22 pango >= 1.40 cairo",
+	"x11, xext, xrender >= 0.9",
+};
+
+static const char *escapes_realistic[] = {
+	"/usr/include/glib-2.0",
+	"/opt/My Program/include",
+	"-DNAME=\"value\"",
+	"/usr/lib/x86_64-linux-gnu",
+};
+
+static const bench_input_t version_realistic = { "realistic", versions_realistic, PKGCONF_ARRAY_SIZE(versions_realistic) };
+static const bench_input_t value_realistic = { "realistic", values_realistic, PKGCONF_ARRAY_SIZE(values_realistic) };
+static const bench_input_t fragment_realistic = { "realistic", fragments_realistic, PKGCONF_ARRAY_SIZE(fragments_realistic) };
+static const bench_input_t dependency_realistic = { "realistic", dependencies_realistic, PKGCONF_ARRAY_SIZE(dependencies_realistic) };
+static const bench_input_t escape_realistic = { "realistic", escapes_realistic, PKGCONF_ARRAY_SIZE(escapes_realistic) };
+
+static const char *json_strings_realistic[] = {
+	"pkg:pkgconf/glib-2.0@2.74.1",
+	"LGPL-2.1-or-later",
+	"The \"GLib\" utility library\nfor C programs",
+	"https://spdx.org/licenses/MIT",
+	"SPDXRef-Package-glib-2.0",
+};
+
+static const bench_input_t json_string_realistic = { "realistic", json_strings_realistic, PKGCONF_ARRAY_SIZE(json_strings_realistic) };
+
+/* the adversarial and large sets are generated at startup, since their values are long */
+static const char *version_adversarial_values[ADVERSARIAL_MAX];
+static const char *value_adversarial_values[ADVERSARIAL_MAX];
+static const char *fragment_adversarial_values[ADVERSARIAL_MAX];
+static const char *dependency_adversarial_values[ADVERSARIAL_MAX];
+static const char *escape_adversarial_values[ADVERSARIAL_MAX];
+static const char *json_string_adversarial_values[ADVERSARIAL_MAX];
+static const char *escape_large_values[ADVERSARIAL_MAX];
+static const char *json_string_large_values[ADVERSARIAL_MAX];
+
+static bench_input_t version_adversarial = { "adversarial", version_adversarial_values, 0 };
+static bench_input_t value_adversarial = { "adversarial", value_adversarial_values, 0 };
+static bench_input_t fragment_adversarial = { "adversarial", fragment_adversarial_values, 0 };
+static bench_input_t dependency_adversarial = { "adversarial", dependency_adversarial_values, 0 };
+static bench_input_t escape_adversarial = { "adversarial", escape_adversarial_values, 0 };
+static bench_input_t json_string_adversarial = { "adversarial", json_string_adversarial_values, 0 };
+static bench_input_t escape_large = { "large", escape_large_values, 0 };
+static bench_input_t json_string_large = { "large", json_string_large_values, 0 };
+
+/* `prefix`, then `count` copies of `unit` with each '#' replaced by the copy's number, then `suffix` */
+static const char *
+repeat(const char *prefix, const char *unit, unsigned int count, const char *suffix)
+{
+	pkgconf_buffer_t buf = PKGCONF_BUFFER_INITIALIZER;
+
+	pkgconf_buffer_append(&buf, prefix);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		for (const char *p = unit; *p != '\0'; p++)
+		{
+			if (*p == '#')
+				pkgconf_buffer_append_fmt(&buf, "%u", i);
+			else
+				pkgconf_buffer_push_byte(&buf, *p);
+		}
+	}
+	pkgconf_buffer_append(&buf, suffix);
+
+	return pkgconf_buffer_freeze(&buf);
+}
+
+static void
+add_value(bench_input_t *input, const char *value)
+{
+	if (value != NULL && input->count < ADVERSARIAL_MAX)
+		input->values[input->count++] = value;
+}
+
+static void
+build_adversarial(void)
+{
+	/* long runs of segments which only differ at the end */
+	add_value(&version_adversarial, repeat("1", ".#", 500, ".0"));
+	add_value(&version_adversarial, repeat("1", ".#", 500, ".1"));
+	/* digit strings far beyond any integer type */
+	add_value(&version_adversarial, repeat("1.", "#", 300, ""));
+	add_value(&version_adversarial, repeat("1.", "#", 300, "1"));
+	/* nothing but separators and pre-release markers */
+	add_value(&version_adversarial, repeat("1", "..~-+", 200, "a"));
+	add_value(&version_adversarial, repeat("1", "..~-+", 200, "b"));
+
+	/* many references, a reference chain, and text which only looks like references */
+	add_value(&value_adversarial, repeat("", "${prefix}/#", 500, ""));
+	add_value(&value_adversarial, repeat("", "${v31}/end", 1, ""));
+	add_value(&value_adversarial, repeat("", "$$#{$", 500, ""));
+	add_value(&value_adversarial, repeat("", "${unset#}", 200, ""));
+	add_value(&value_adversarial, repeat("", "${", 200, ""));
+
+	add_value(&fragment_adversarial, repeat("", "-lfoo# ", 1000, ""));
+	add_value(&fragment_adversarial, repeat("", "'-I/a b #' \"-DX=\\\"#\\\"\" ", 200, ""));
+	add_value(&fragment_adversarial, repeat("", "-I ", 500, "-L"));
+	add_value(&fragment_adversarial, repeat("", "-Wl,-rpath,/opt/lib# -framework F# ", 300, ""));
+
+	/* many dependencies, half of them colliding on the same name */
+	add_value(&dependency_adversarial, repeat("", "pkg# >= 1.0, ", 500, ""));
+	add_value(&dependency_adversarial, repeat("", "dup >= 1.#, ", 500, "dup"));
+	add_value(&dependency_adversarial, repeat("", "a#,,,, ", 300, ""));
+
+	/* every byte escaped, and none */
+	add_value(&escape_adversarial, repeat("", "\"$ '`;&|<>", 400, ""));
+	add_value(&escape_adversarial, repeat("", "abcdefghijklmnopqrstuvwxyz", 160, ""));
+	add_value(&escape_adversarial, repeat("", "/opt/path with spaces/# ", 200, ""));
+
+	/* every byte a control character, and a quote or backslash every other byte */
+	add_value(&json_string_adversarial, repeat("", "\x01\x02\x1f\n\t", 800, ""));
+	add_value(&json_string_adversarial, repeat("", "a\"b\\", 1000, ""));
+}
+
+/* long values which are otherwise like the realistic ones */
+static void
+build_large(void)
+{
+	/* include paths from deep prefixes, with nothing or almost nothing to escape */
+	add_value(&escape_large, repeat("/opt/toolchains/x86_64-linux-gnu", "/sysroot/usr/include/component-#", 60, "/include"));
+	add_value(&escape_large, repeat("-I/nix/store/", "0123456789abcdefghijklmnopqrstuv-dependency-#/include/", 40, ""));
+	add_value(&escape_large, repeat("/Users/Shared/Build Products", "/Framework#.framework/Headers", 80, ""));
+
+	/* license texts and descriptions as they end up in an SBOM */
+	add_value(&json_string_large, repeat("", "Permission is hereby granted, free of charge, to any person obtaining a copy of this software (#).\n", 120, ""));
+	add_value(&json_string_large, repeat("", "pkg:pkgconf/library-#@1.0.# ", 400, ""));
+	add_value(&json_string_large, repeat("", "The \"component #\" is distributed under the terms of C:\\licenses\\#.txt\n", 150, ""));
+}
+
+static void
+free_generated(void)
+{
+	bench_input_t *inputs[] = {
+		&version_adversarial, &value_adversarial, &fragment_adversarial,
+		&dependency_adversarial, &escape_adversarial, &json_string_adversarial,
+		&escape_large, &json_string_large,
+	};
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(inputs); i++)
+	{
+		for (size_t j = 0; j < inputs[i]->count; j++)
+			free((char *) inputs[i]->values[j]);
+	}
+}
+
+/*
+ * ========
+ * kernels
+ * ========
+ */
+
+static bool
+run_compare_version(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	(void) ctx;
+
+	/* compare neighbours; the result only matters in that it is not optimised away */
+	return pkgconf_compare_version(input->values[i % input->count], input->values[(i + 1) % input->count]) <= 1;
+}
+
+static bool
+run_bytecode_compile(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	pkgconf_buffer_rewind(&ctx->out);
+	return pkgconf_bytecode_compile(&ctx->out, input->values[i % input->count]);
+}
+
+#define TUPLE_APPENDS	16
+
+/* what a generated .pc file does: define a variable, then keep appending to it */
+static bool
+run_tuple_append(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	pkgconf_list_t vars = PKGCONF_LIST_INITIALIZER;
+	const char *value = input->values[i % input->count];
+	bool ok = pkgconf_tuple_add(ctx->client, &vars, "flags", value, true, 0) != NULL;
+
+	pkgconf_buffer_rewind(&ctx->out);
+	ok = ok && pkgconf_buffer_append(&ctx->out, "${flags} ") && pkgconf_buffer_append(&ctx->out, value);
+
+	for (size_t j = 0; ok && j < TUPLE_APPENDS; j++)
+		ok = pkgconf_tuple_add(ctx->client, &vars, "flags", pkgconf_buffer_str(&ctx->out), true, 0) != NULL;
+
+	pkgconf_tuple_free(&vars);
+	return ok;
+}
+
+static bool
+prepare_bytecode_eval(bench_ctx_t *ctx, const bench_input_t *input)
+{
+	ctx->compiled = calloc(input->count, sizeof(*ctx->compiled));
+	if (ctx->compiled == NULL)
+		return false;
+
+	ctx->ncompiled = input->count;
+	for (size_t i = 0; i < input->count; i++)
+	{
+		if (!pkgconf_bytecode_compile(&ctx->compiled[i], input->values[i]))
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+run_bytecode_eval(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	pkgconf_bytecode_t bc;
+	bool saw_sysroot = false;
+
+	pkgconf_bytecode_from_buffer(&bc, &ctx->compiled[i % input->count]);
+	pkgconf_buffer_rewind(&ctx->out);
+
+	return pkgconf_bytecode_eval(ctx->client, &ctx->vars, &bc, &ctx->out, &saw_sysroot);
+}
+
+static void
+finish_bytecode_eval(bench_ctx_t *ctx)
+{
+	for (size_t i = 0; i < ctx->ncompiled; i++)
+		pkgconf_buffer_finalize(&ctx->compiled[i]);
+
+	free(ctx->compiled);
+	ctx->compiled = NULL;
+	ctx->ncompiled = 0;
+}
+
+static bool
+run_fragment_parse(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	bool ok = pkgconf_fragment_parse(ctx->client, &frags, &ctx->vars, input->values[i % input->count], 0);
+
+	pkgconf_fragment_free(&frags);
+	return ok;
+}
+
+static bool
+prepare_fragment_copy(bench_ctx_t *ctx, const bench_input_t *input)
+{
+	ctx->parsed = calloc(input->count, sizeof(*ctx->parsed));
+	if (ctx->parsed == NULL)
+		return false;
+
+	ctx->nparsed = input->count;
+	for (size_t i = 0; i < input->count; i++)
+	{
+		if (!pkgconf_fragment_parse(ctx->client, &ctx->parsed[i], &ctx->vars, input->values[i], 0))
+			return false;
+	}
+
+	return true;
+}
+
+/* what collecting a package's fragments does: copy each through a mergeback cursor */
+static bool
+run_fragment_copy(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	pkgconf_list_t frags = PKGCONF_LIST_INITIALIZER;
+	pkgconf_fragment_cursor_t cursor;
+	pkgconf_node_t *node;
+
+	(void) input;
+
+	pkgconf_fragment_cursor_init(&cursor, &frags);
+	PKGCONF_FOREACH_LIST_ENTRY(ctx->parsed[i % ctx->nparsed].head, node)
+		pkgconf_fragment_copy_cursor(ctx->client, &cursor, node->data, false);
+	pkgconf_fragment_cursor_deinit(&cursor);
+
+	pkgconf_fragment_free(&frags);
+	return true;
+}
+
+static void
+finish_fragment_copy(bench_ctx_t *ctx)
+{
+	for (size_t i = 0; i < ctx->nparsed; i++)
+		pkgconf_fragment_free(&ctx->parsed[i]);
+
+	free(ctx->parsed);
+	ctx->parsed = NULL;
+	ctx->nparsed = 0;
+}
+
+static bool
+run_argv_split(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	int argc;
+	char **argv;
+
+	(void) ctx;
+
+	if (pkgconf_argv_split(input->values[i % input->count], &argc, &argv) != 0)
+		return false;
+
+	pkgconf_argv_free(argv);
+	return true;
+}
+
+static bool
+run_dependency_parse(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	pkgconf_list_t deps = PKGCONF_LIST_INITIALIZER;
+
+	pkgconf_dependency_parse_str(ctx->client, &deps, input->values[i % input->count], 0);
+	pkgconf_dependency_free(&deps);
+
+	return true;
+}
+
+static bool
+run_escape_charset(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	const char *value = input->values[i % input->count];
+	pkgconf_buffer_t src = {
+		.base = (char *) value,
+		.end = (char *) value + strlen(value),
+	};
+
+	pkgconf_buffer_rewind(&ctx->out);
+	return pkgconf_buffer_escape_charset(&ctx->out, &src, &ctx->charset);
+}
+
+static bool
+run_serialize_string(bench_ctx_t *ctx, const bench_input_t *input, size_t i)
+{
+	spdxtool_serialize_value_t value = {
+		.type = SPDXTOOL_SERIALIZE_TYPE_STRING,
+		.value.s = (char *) input->values[i % input->count],
+	};
+
+	pkgconf_buffer_rewind(&ctx->out);
+	return spdxtool_serialize_value_to_buf(&ctx->out, &value, 0);
+}
+
+static const bench_kernel_t kernels[] = {
+	{ "compare_version", NULL, run_compare_version, NULL, &version_realistic, &version_adversarial, NULL },
+	{ "bytecode_compile", NULL, run_bytecode_compile, NULL, &value_realistic, &value_adversarial, NULL },
+	{ "tuple_append", NULL, run_tuple_append, NULL, &value_realistic, &value_adversarial, NULL },
+	{ "bytecode_eval", prepare_bytecode_eval, run_bytecode_eval, finish_bytecode_eval, &value_realistic, &value_adversarial, NULL },
+	{ "fragment_parse", NULL, run_fragment_parse, NULL, &fragment_realistic, &fragment_adversarial, NULL },
+	{ "fragment_copy", prepare_fragment_copy, run_fragment_copy, finish_fragment_copy, &fragment_realistic, &fragment_adversarial, NULL },
+	{ "argv_split", NULL, run_argv_split, NULL, &fragment_realistic, &fragment_adversarial, NULL },
+	{ "dependency_parse_str", NULL, run_dependency_parse, NULL, &dependency_realistic, &dependency_adversarial, NULL },
+	{ "buffer_escape_charset", NULL, run_escape_charset, NULL, &escape_realistic, &escape_adversarial, &escape_large },
+	{ "serialize_string", NULL, run_serialize_string, NULL, &json_string_realistic, &json_string_adversarial, &json_string_large },
+};
+
+/*
+ * =======
+ * driver
+ * =======
+ */
+
+/* the shell metacharacters the fragment renderer escapes */
+static const pkgconf_span_t shell_spans[] = {
+	{ 0x00, 0x1f },
+	{ (unsigned char)' ', (unsigned char)'#' },
+	{ (unsigned char)'%', (unsigned char)'\'' },
+	{ (unsigned char)'*', (unsigned char)'*' },
+	{ (unsigned char)';', (unsigned char)'<' },
+	{ (unsigned char)'>', (unsigned char)'?' },
+	{ (unsigned char)'[', (unsigned char)']' },
+	{ (unsigned char)'`', (unsigned char)'`' },
+	{ (unsigned char)'{', (unsigned char)'}' },
+	{ 0x7f, 0xff },
+};
+
+static bool
+setup_ctx(bench_ctx_t *ctx)
+{
+	static const char *realistic_vars[][2] = {
+		{ "prefix", "/usr" },
+		{ "exec_prefix", "${prefix}" },
+		{ "libdir", "${exec_prefix}/lib" },
+		{ "includedir", "${prefix}/include" },
+		{ "name", "glib-2.0" },
+	};
+	char key[16], value[32];
+
+	memset(ctx, 0, sizeof(*ctx));
+
+	ctx->client = pkgconf_client_new(NULL, NULL, pkgconf_cross_personality_default(), NULL, NULL);
+	if (ctx->client == NULL)
+		return false;
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(realistic_vars); i++)
+		pkgconf_tuple_add(ctx->client, &ctx->vars, realistic_vars[i][0], realistic_vars[i][1], true, 0);
+
+	/* v0 .. v31, each defined in terms of the previous one */
+	pkgconf_tuple_add(ctx->client, &ctx->vars, "v0", "/opt", true, 0);
+	for (unsigned int i = 1; i < 32; i++)
+	{
+		snprintf(key, sizeof key, "v%u", i);
+		snprintf(value, sizeof value, "${v%u}/%u", i - 1, i);
+		pkgconf_tuple_add(ctx->client, &ctx->vars, key, value, true, 0);
+	}
+
+	pkgconf_charset_from_spans(&ctx->charset, shell_spans, PKGCONF_ARRAY_SIZE(shell_spans));
+
+	return true;
+}
+
+static void
+teardown_ctx(bench_ctx_t *ctx)
+{
+	pkgconf_buffer_finalize(&ctx->out);
+	pkgconf_tuple_free(&ctx->vars);
+	pkgconf_client_free(ctx->client);
+}
+
+static bool
+run_batch(const bench_kernel_t *kernel, bench_ctx_t *ctx, const bench_input_t *input, size_t ops)
+{
+	for (size_t i = 0; i < ops; i++)
+	{
+		if (!kernel->run(ctx, input, i))
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+measure(const bench_kernel_t *kernel, bench_ctx_t *ctx, const bench_input_t *input, uint64_t min_ns)
+{
+	uint64_t start, elapsed = 0;
+	size_t ops = 1;
+	bool ok = false;
+
+	if (kernel->prepare != NULL && !kernel->prepare(ctx, input))
+		goto out;
+
+	/* warm up, and check the kernel accepts every value */
+	if (!run_batch(kernel, ctx, input, input->count))
+		goto out;
+
+	for (;;)
+	{
+		start = pkgconf_stats_now();
+		if (!run_batch(kernel, ctx, input, ops))
+			goto out;
+		elapsed = pkgconf_stats_now() - start;
+
+		if (elapsed >= min_ns)
+			break;
+
+		ops *= 2;
+	}
+
+	printf("{\"kernel\":\"%s\",\"input\":\"%s\",\"ops\":%zu,\"ns_per_op\":%.1f,",
+		kernel->name, input->name, ops, (double) elapsed / (double) ops);
+
+#ifdef BENCH_ALLOC_INJECT
+	unsigned long count;
+	size_t bytes;
+
+	alloc_inject_count_begin();
+	ok = run_batch(kernel, ctx, input, ALLOC_ROUNDS);
+	alloc_inject_count_end(&count, &bytes);
+
+	printf("\"allocs_per_op\":%.2f,\"bytes_per_op\":%.1f}\n",
+		(double) count / ALLOC_ROUNDS, (double) bytes / ALLOC_ROUNDS);
+#else
+	ok = true;
+	printf("\"allocs_per_op\":null,\"bytes_per_op\":null}\n");
+#endif
+
+out:
+	if (kernel->finish != NULL)
+		kernel->finish(ctx);
+
+	if (!ok)
+		fprintf(stderr, "%s: failed on the %s inputs\n", kernel->name, input->name);
+
+	return ok;
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned long min_ms = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MIN_MS;
+	const char *only = argc > 2 ? argv[2] : NULL;
+	bench_ctx_t ctx;
+	int ret = EXIT_SUCCESS;
+
+	if (min_ms == 0)
+	{
+		fprintf(stderr, "usage: %s [min-ms [kernel]]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (!setup_ctx(&ctx))
+		return EXIT_FAILURE;
+
+	build_adversarial();
+	build_large();
+
+	for (size_t i = 0; i < PKGCONF_ARRAY_SIZE(kernels); i++)
+	{
+		if (only != NULL && strcmp(only, kernels[i].name))
+			continue;
+
+		if (!measure(&kernels[i], &ctx, kernels[i].realistic, min_ms * 1000000) ||
+			!measure(&kernels[i], &ctx, kernels[i].adversarial, min_ms * 1000000) ||
+			(kernels[i].large != NULL && !measure(&kernels[i], &ctx, kernels[i].large, min_ms * 1000000)))
+			ret = EXIT_FAILURE;
+	}
+
+	free_generated();
+	teardown_ctx(&ctx);
+
+	return ret;
+}
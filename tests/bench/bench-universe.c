@@ -0,0 +1,458 @@
+/*
+ * bench-universe.c
+ * Benchmark solving, flag collection, listing and provider lookup over
+ * synthetic package universes of various shapes.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+#include <libpkgconf/path.h>
+#include <tests/win-shim.h>
+#include <tests/universe.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Each result is printed as a single-line JSON object, so that the output of
+ * `meson test --benchmark` can be collected by scripts:
+ *
+ *   {"shape":"flat","step":"solve","packages":10000,"count":10000,"ms":41.2}
+ *
+ * The client's performance counters for the whole run are printed last.
+ */
+
+typedef struct {
+	const char *name;
+	unsigned long default_size;
+
+	/* writes the universe into dir, returns the number of packages written */
+	unsigned long (*generate)(const char *dir, unsigned long size);
+
+	/* pushes the packages to query onto the queue */
+	void (*query)(pkgconf_list_t *queue, unsigned long size);
+
+	unsigned int client_flags;
+} bench_shape_t;
+
+#define UNIVERSE_DIR	"bench-universe-pcdir"
+
+static FILE *
+open_pc(const char *dir, const char *name)
+{
+	char path[512];
+
+	snprintf(path, sizeof path, "%s/%s.pc", dir, name);
+	return fopen(path, "wb");
+}
+
+static void
+remove_universe(const char *dir)
+{
+	DIR *d = opendir(dir);
+	struct dirent *dirent;
+	char path[512];
+
+	if (d == NULL)
+		return;
+
+	while ((dirent = readdir(d)) != NULL)
+	{
+		if (dirent->d_name[0] == '.')
+			continue;
+
+		snprintf(path, sizeof path, "%s/%s", dir, dirent->d_name);
+		remove(path);
+	}
+
+	closedir(d);
+	rmdir(dir);
+}
+
+/*
+ * flat: `size` independent packages, all of which are queried at once.
+ */
+static unsigned long
+generate_flat(const char *dir, unsigned long size)
+{
+	char name[64];
+
+	for (unsigned long i = 0; i < size; i++)
+	{
+		FILE *f;
+
+		snprintf(name, sizeof name, "flat-%06lu", i);
+		if ((f = open_pc(dir, name)) == NULL)
+			return 0;
+
+		fprintf(f, "prefix=/usr\nlibdir=${prefix}/lib\nincludedir=${prefix}/include/%s\n\n", name);
+		fprintf(f, "Name: %s\nDescription: flat package %lu\nVersion: 1.%lu\n", name, i, i % 100);
+		fprintf(f, "Cflags: -I${includedir} -DFLAT_%lu\nLibs: -L${libdir} -lflat%lu\n", i, i);
+		fclose(f);
+	}
+
+	return size;
+}
+
+static void
+query_flat(pkgconf_list_t *queue, unsigned long size)
+{
+	char name[64];
+
+	for (unsigned long i = 0; i < size; i++)
+	{
+		snprintf(name, sizeof name, "flat-%06lu", i);
+		pkgconf_queue_push(queue, name);
+	}
+}
+
+/*
+ * diamond: `size` layers of DIAMOND_WIDTH packages, where every package
+ * requires every package of the next layer, so the graph repeatedly fans out
+ * and back in.  Only the single package at the top is queried.
+ */
+#define DIAMOND_WIDTH	32
+
+static unsigned long
+generate_diamond(const char *dir, unsigned long size)
+{
+	char name[64];
+	FILE *f;
+
+	if ((f = open_pc(dir, "diamond-top")) == NULL)
+		return 0;
+
+	fprintf(f, "Name: diamond-top\nDescription: top of the diamonds\nVersion: 1.0\nRequires:");
+	for (unsigned long w = 0; w < DIAMOND_WIDTH; w++)
+		fprintf(f, " diamond-0-%lu", w);
+	fprintf(f, "\n");
+	fclose(f);
+
+	for (unsigned long layer = 0; layer < size; layer++)
+	{
+		for (unsigned long w = 0; w < DIAMOND_WIDTH; w++)
+		{
+			snprintf(name, sizeof name, "diamond-%lu-%lu", layer, w);
+			if ((f = open_pc(dir, name)) == NULL)
+				return 0;
+
+			fprintf(f, "Name: %s\nDescription: diamond node\nVersion: 1.0\n", name);
+			fprintf(f, "Cflags: -I/usr/include/%s\nLibs: -l%s\n", name, name);
+			if (layer + 1 < size)
+			{
+				fprintf(f, "Requires:");
+				for (unsigned long next = 0; next < DIAMOND_WIDTH; next++)
+					fprintf(f, " diamond-%lu-%lu >= 1.0", layer + 1, next);
+				fprintf(f, "\n");
+			}
+
+			fclose(f);
+		}
+	}
+
+	return size * DIAMOND_WIDTH + 1;
+}
+
+static void
+query_diamond(pkgconf_list_t *queue, unsigned long size)
+{
+	(void) size;
+
+	pkgconf_queue_push(queue, "diamond-top");
+}
+
+/*
+ * provides: `size` packages which each provide PROVIDES_ALIASES virtual
+ * names.  Every queried name is an alias, so each one is only found by
+ * falling back to a scan of the providers.
+ */
+#define PROVIDES_ALIASES	4
+#define PROVIDES_QUERIES	32
+
+static unsigned long
+generate_provides(const char *dir, unsigned long size)
+{
+	char name[64];
+
+	for (unsigned long i = 0; i < size; i++)
+	{
+		FILE *f;
+
+		snprintf(name, sizeof name, "impl-%06lu", i);
+		if ((f = open_pc(dir, name)) == NULL)
+			return 0;
+
+		fprintf(f, "Name: %s\nDescription: provider %lu\nVersion: 2.%lu\nProvides:", name, i, i % 10);
+		for (unsigned long a = 0; a < PROVIDES_ALIASES; a++)
+			fprintf(f, "%s virt-%06lu-%lu = 2.%lu", a ? "," : "", i, a, i % 10);
+		fprintf(f, "\nLibs: -limpl%lu\n", i);
+		fclose(f);
+	}
+
+	return size;
+}
+
+static void
+query_provides(pkgconf_list_t *queue, unsigned long size)
+{
+	char name[64];
+
+	/* spread the queries over the universe, so later ones scan further */
+	for (unsigned long q = 0; q < PROVIDES_QUERIES && q < size; q++)
+	{
+		snprintf(name, sizeof name, "virt-%06lu-%lu >= 2.0", (size - 1) * q / PROVIDES_QUERIES, q % PROVIDES_ALIASES);
+		pkgconf_queue_push(queue, name);
+	}
+}
+
+/*
+ * static: `size` packages in a line, each privately requiring the next two
+ * and carrying a long Libs.private, queried for a static link line.
+ */
+#define STATIC_PRIVATE_LIBS	16
+
+static unsigned long
+generate_static(const char *dir, unsigned long size)
+{
+	char name[64];
+
+	for (unsigned long i = 0; i < size; i++)
+	{
+		FILE *f;
+
+		snprintf(name, sizeof name, "static-%06lu", i);
+		if ((f = open_pc(dir, name)) == NULL)
+			return 0;
+
+		fprintf(f, "libdir=/opt/static/%lu/lib\n\n", i);
+		fprintf(f, "Name: %s\nDescription: static package %lu\nVersion: 1.0\n", name, i);
+		fprintf(f, "Libs: -L${libdir} -lstatic%lu\nLibs.private:", i);
+		for (unsigned long l = 0; l < STATIC_PRIVATE_LIBS; l++)
+			fprintf(f, " -lpriv%lu", (i + l) % (size + STATIC_PRIVATE_LIBS));
+		fprintf(f, " -pthread -lm\n");
+
+		if (i + 1 < size)
+		{
+			fprintf(f, "Requires.private: static-%06lu", i + 1);
+			if (i + 2 < size)
+				fprintf(f, ", static-%06lu", i + 2);
+			fprintf(f, "\n");
+		}
+
+		fclose(f);
+	}
+
+	return size;
+}
+
+static void
+query_static(pkgconf_list_t *queue, unsigned long size)
+{
+	(void) size;
+
+	pkgconf_queue_push(queue, "static-000000");
+}
+
+/*
+ * random: `size` packages from the universe generator with its default shape
+ * and a fixed seed, cycles included, queried from the root.
+ */
+static unsigned long
+generate_random(const char *dir, unsigned long size)
+{
+	universe_params_t params = UNIVERSE_PARAMS_DEFAULT;
+	universe_stats_t stats;
+
+	params.packages = size;
+	params.cycles = size / 100;
+
+	return universe_generate(&params, dir, &stats) ? stats.packages : 0;
+}
+
+static void
+query_random(pkgconf_list_t *queue, unsigned long size)
+{
+	char name[64];
+
+	(void) size;
+
+	universe_package_name(name, sizeof name, 0);
+	pkgconf_queue_push(queue, name);
+}
+
+static const bench_shape_t shapes[] = {
+	{ "flat", 10000, generate_flat, query_flat, 0 },
+	{ "diamond", 64, generate_diamond, query_diamond, 0 },
+	{ "provides", 2000, generate_provides, query_provides, 0 },
+	{ "static", 2000, generate_static, query_static, PKGCONF_PKG_PKGF_SEARCH_PRIVATE | PKGCONF_PKG_PKGF_MERGE_PRIVATE_FRAGMENTS },
+	{ "random", 5000, generate_random, query_random, PKGCONF_PKG_PKGF_SEARCH_PRIVATE },
+};
+
+static double
+elapsed_ms(clock_t start)
+{
+	return (double) (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static void
+report(const bench_shape_t *shape, const char *step, unsigned long packages, size_t count, clock_t start)
+{
+	printf("{\"shape\":\"%s\",\"step\":\"%s\",\"packages\":%lu,\"count\":%zu,\"ms\":%.1f}\n",
+		shape->name, step, packages, count, elapsed_ms(start));
+}
+
+static size_t
+list_length(const pkgconf_list_t *list)
+{
+	size_t n = 0;
+	const pkgconf_node_t *iter;
+
+	PKGCONF_FOREACH_LIST_ENTRY(list->head, iter)
+		n++;
+
+	return n;
+}
+
+static bool
+count_entry(const pkgconf_pkg_t *pkg, void *data)
+{
+	size_t *count = data;
+
+	(void) pkg;
+	(*count)++;
+
+	return false;
+}
+
+static pkgconf_client_t *
+universe_client(const bench_shape_t *shape)
+{
+	pkgconf_client_t *client = pkgconf_client_new(NULL, NULL, pkgconf_cross_personality_default(), NULL, NULL);
+
+	pkgconf_path_free(&client->dir_list);
+	pkgconf_path_add(UNIVERSE_DIR, &client->dir_list, false);
+	pkgconf_client_set_flags(client, shape->client_flags);
+
+	return client;
+}
+
+static bool
+run_shape(const bench_shape_t *shape, unsigned long size)
+{
+	pkgconf_client_t *client;
+	pkgconf_list_t queue = PKGCONF_LIST_INITIALIZER;
+	pkgconf_list_t libs = PKGCONF_LIST_INITIALIZER;
+	pkgconf_buffer_t statsbuf = PKGCONF_BUFFER_INITIALIZER;
+	pkgconf_pkg_t world = {
+		.id = "virtual:world",
+		.realname = "virtual world package",
+		.flags = PKGCONF_PKG_PROPF_STATIC | PKGCONF_PKG_PROPF_VIRTUAL,
+	};
+	unsigned long packages;
+	size_t count = 0;
+	clock_t start;
+	bool ok = false;
+
+	remove_universe(UNIVERSE_DIR);
+	mkdir(UNIVERSE_DIR, 0755);
+
+	start = clock();
+	packages = shape->generate(UNIVERSE_DIR, size);
+	if (packages == 0)
+	{
+		fprintf(stderr, "%s: failed to write the universe\n", shape->name);
+		goto out;
+	}
+	report(shape, "generate", packages, packages, start);
+
+	/* a fresh client, so that listing does not benefit from the solver's cache */
+	client = universe_client(shape);
+	start = clock();
+	pkgconf_scan_all(client, &count, count_entry);
+	report(shape, "list-all", packages, count, start);
+	pkgconf_client_free(client);
+
+	if (count != packages)
+	{
+		fprintf(stderr, "%s: listed %zu of %lu packages\n", shape->name, count, packages);
+		goto out;
+	}
+
+	client = universe_client(shape);
+	shape->query(&queue, size);
+
+	start = clock();
+	if (!pkgconf_queue_solve(client, &queue, &world, -1))
+	{
+		fprintf(stderr, "%s: failed to solve\n", shape->name);
+		goto free_client;
+	}
+	report(shape, "solve", packages, list_length(&world.required), start);
+
+	start = clock();
+	if (pkgconf_pkg_libs(client, &world, &libs, -1) != PKGCONF_PKG_ERRF_OK)
+	{
+		fprintf(stderr, "%s: failed to collect libs\n", shape->name);
+		goto free_client;
+	}
+	report(shape, "libs", packages, list_length(&libs), start);
+
+	if (pkgconf_stats_render(client, &statsbuf))
+		printf("{\"shape\":\"%s\",\"stats\":%s}\n", shape->name, pkgconf_buffer_str(&statsbuf));
+
+	ok = true;
+
+free_client:
+	pkgconf_buffer_finalize(&statsbuf);
+	pkgconf_fragment_free(&libs);
+	pkgconf_solution_free(client, &world);
+	pkgconf_queue_free(&queue);
+	pkgconf_client_free(client);
+out:
+	remove_universe(UNIVERSE_DIR);
+	return ok;
+}
+
+int
+main(int argc, char *argv[])
+{
+	const bench_shape_t *shape = NULL;
+	unsigned long size;
+
+	if (argc > 1)
+	{
+		for (size_t i = 0; i < sizeof shapes / sizeof *shapes; i++)
+		{
+			if (!strcmp(argv[1], shapes[i].name))
+				shape = &shapes[i];
+		}
+	}
+
+	if (shape == NULL)
+	{
+		fprintf(stderr, "usage: %s flat|diamond|provides|static|random [size]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	size = argc > 2 ? strtoul(argv[2], NULL, 10) : shape->default_size;
+	if (size == 0)
+	{
+		fprintf(stderr, "usage: %s flat|diamond|provides|static|random [size]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	return run_shape(shape, size) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+/*
+ * bench-version.c
+ * Benchmark string and pre-tokenised version comparison.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <libpkgconf/libpkgconf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ROUNDS	200000
+
+/* a mix of the version shapes found in real .pc files */
+static const char *versions[] = {
+	"1.0",
+	"1.0.0",
+	"2.74.1",
+	"2.74.0",
+	"3.0.13",
+	"3.0.13-rc1",
+	"1.2.3~beta2",
+	"1.2.3",
+	"20230125",
+	"20230125.1",
+	"0.9.8zh",
+	"1.1.1w",
+	"6.4.0-git-a1b2c3d",
+	"6.4.0",
+	"1.12345678901234567890",
+	"1.12345678901234567891",
+};
+
+#define N_VERSIONS	(sizeof versions / sizeof *versions)
+
+static double
+elapsed_ms(clock_t start)
+{
+	return (double) (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned long rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_ROUNDS;
+	pkgconf_version_t parsed[N_VERSIONS];
+	long string_sum = 0, parsed_sum = 0;
+	clock_t start;
+	int ret = EXIT_FAILURE;
+
+	if (rounds == 0)
+	{
+		fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < N_VERSIONS; i++)
+		parsed[i] = (pkgconf_version_t) PKGCONF_VERSION_INITIALIZER;
+
+	start = clock();
+	for (size_t i = 0; i < N_VERSIONS; i++)
+	{
+		if (!pkgconf_version_parse(&parsed[i], versions[i]))
+		{
+			fprintf(stderr, "failed to parse %s\n", versions[i]);
+			goto out;
+		}
+	}
+	printf("parse: %zu versions, %.3f ms\n", N_VERSIONS, elapsed_ms(start));
+
+	start = clock();
+	for (unsigned long r = 0; r < rounds; r++)
+		for (size_t i = 0; i < N_VERSIONS; i++)
+			for (size_t j = 0; j < N_VERSIONS; j++)
+				string_sum += pkgconf_compare_version(versions[i], versions[j]);
+	printf("string: %lu comparisons, %.1f ms\n", rounds * N_VERSIONS * N_VERSIONS, elapsed_ms(start));
+
+	start = clock();
+	for (unsigned long r = 0; r < rounds; r++)
+		for (size_t i = 0; i < N_VERSIONS; i++)
+			for (size_t j = 0; j < N_VERSIONS; j++)
+				parsed_sum += pkgconf_version_compare(&parsed[i], &parsed[j]);
+	printf("parsed: %lu comparisons, %.1f ms\n", rounds * N_VERSIONS * N_VERSIONS, elapsed_ms(start));
+
+	/* both paths must order the versions the same way */
+	if (string_sum != parsed_sum)
+	{
+		fprintf(stderr, "string and parsed comparisons disagree\n");
+		goto out;
+	}
+
+	ret = EXIT_SUCCESS;
+
+out:
+	for (size_t i = 0; i < N_VERSIONS; i++)
+		pkgconf_version_free(&parsed[i]);
+
+	return ret;
+}
@@ -83,6 +83,7 @@ typedef struct test_case_
 	bool require_utf8_locale;
 
 	pkgconf_list_t define_variables;
+	pkgconf_list_t max_counters;
 
 	int verbosity;
 
@@ -396,6 +397,7 @@ static const pkgconf_test_flag_pair_t test_flag_pairs[] =
 	{"simulate",			PKG_SIMULATE},
 	{"solution",			PKG_SOLUTION},
 	{"static",			PKG_STATIC},
+	{"stats",			PKG_STATS},
 	{"uninstalled",			PKG_UNINSTALLED},
 	{"validate",			PKG_VALIDATE},
 };
@@ -525,6 +527,7 @@ static const pkgconf_test_keyword_pair_t test_keyword_pairs[] =
 	{"FragmentFilter",	test_keyword_set_buffer,		offsetof(pkgconf_test_case_t, fragment_filter)},
 	{"MatchStderr",		test_keyword_set_match_strategy,	offsetof(pkgconf_test_case_t, match_stderr)},
 	{"MatchStdout",		test_keyword_set_match_strategy,	offsetof(pkgconf_test_case_t, match_stdout)},
+	{"MaxCounter",		test_keyword_extend_bufferset,		offsetof(pkgconf_test_case_t, max_counters)},
 	{"MaxVersion",		test_keyword_set_buffer,		offsetof(pkgconf_test_case_t, max_version)},
 	{"PackageSearchPath",	test_keyword_set_path_list,		offsetof(pkgconf_test_case_t, search_path)},
 	{"Query",		test_keyword_set_buffer,		offsetof(pkgconf_test_case_t, query)},
@@ -960,6 +963,73 @@ split_pair(const char *entry, char **left_out, char **right_out)
 	return true;
 }
 
+/*
+ * parse_counter_limit: a limit is a plain decimal number.  strtoull() alone
+ * would also take a sign, leading blanks, trailing junk or an empty string,
+ * and saturate on overflow, any of which would quietly change the limit.
+ */
+static bool
+parse_counter_limit(const char *limit, unsigned long long *out)
+{
+	char *end;
+
+	if (!isdigit((unsigned char) *limit))
+		return false;
+
+	errno = 0;
+	*out = strtoull(limit, &end, 10);
+
+	return *end == '\0' && errno != ERANGE;
+}
+
+/*
+ * check_max_counters: each MaxCounter entry is "counter limit", naming one of
+ * the client's stats counters (see pkgconf_stats_counter_name()) and the most
+ * the query may bump it by.
+ */
+static bool
+check_max_counters(const pkgconf_test_case_t *testcase, const pkgconf_stats_t *stats)
+{
+	bool passed = true;
+	pkgconf_node_t *iter;
+
+	PKGCONF_FOREACH_LIST_ENTRY(testcase->max_counters.head, iter)
+	{
+		pkgconf_bufferset_t *set = iter->data;
+		pkgconf_stats_counter_t counter;
+		unsigned long long max;
+		char *name = NULL, *limit = NULL;
+
+		if (!split_pair(pkgconf_buffer_str(&set->buffer), &name, &limit) ||
+			limit == NULL || !parse_counter_limit(limit, &max))
+		{
+			fprintf(stderr, "MaxCounter: malformed entry (expected 'counter limit'): %s\n",
+				pkgconf_buffer_str_or_empty(&set->buffer));
+			passed = false;
+			free(name);
+			free(limit);
+			continue;
+		}
+
+		if (!pkgconf_stats_counter_lookup(name, &counter))
+		{
+			fprintf(stderr, "MaxCounter: unknown counter '%s'\n", name);
+			passed = false;
+		}
+		else if (stats->counters[counter] > max)
+		{
+			fprintf(stderr, "counter %s is %llu, over its limit of %s\n",
+				name, (unsigned long long) stats->counters[counter], limit);
+			passed = false;
+		}
+
+		free(name);
+		free(limit);
+	}
+
+	return passed;
+}
+
 /*
  * run_setup: execute mkdirs, copies, and symlinks in order.
  * Must be called after chdir() into the tmp_dir.
@@ -1163,6 +1233,12 @@ annotate_result(const pkgconf_test_case_t *testcase, int ret, const pkgconf_test
 		fprintf(stderr, "define-variable: [%s]\n", pkgconf_buffer_str_or_empty(&set->buffer));
 	}
 
+	PKGCONF_FOREACH_LIST_ENTRY(testcase->max_counters.head, iter)
+	{
+		pkgconf_bufferset_t *set = iter->data;
+		fprintf(stderr, "max-counter: [%s]\n", pkgconf_buffer_str_or_empty(&set->buffer));
+	}
+
 	fprintf(stderr,
 		"want-env-prefix: [%s]\n"
 		"fragment-filter: [%s]\n"
@@ -1236,11 +1312,19 @@ run_test_case(const pkgconf_test_case_t *testcase)
 	}
 
 	pkgconf_test_output_t *out = (pkgconf_test_output_t *) test_output();
+	pkgconf_stats_t stats = {0};
 	int ret;
 
 	if (pkgconf_buffer_len(&testcase->tool))
 	{
 		ret = run_tool(testcase, &out->o_stdout, &out->o_stderr);
+
+		// the counters live in the tool's process, out of our reach
+		if (testcase->max_counters.head != NULL)
+		{
+			fprintf(stderr, "MaxCounter: not supported with Tool\n");
+			passed = false;
+		}
 	}
 	else
 	{
@@ -1255,6 +1339,7 @@ run_test_case(const pkgconf_test_case_t *testcase)
 			.cli_state.required_exact_module_version = pkgconf_buffer_str(&testcase->exact_version),
 			.cli_state.required_max_module_version = pkgconf_buffer_str(&testcase->max_version),
 			.cli_state.verbosity = testcase->verbosity,
+			.cli_state.stats_out = &stats,
 			.testcase = testcase,
 		};
 
@@ -1367,6 +1452,9 @@ run_test_case(const pkgconf_test_case_t *testcase)
 			passed = false;
 	}
 
+	if (!check_max_counters(testcase, &stats))
+		passed = false;
+
 	if (ret != testcase->exitcode)
 	{
 		fprintf(stderr, "exitcode %d does not match expected %d\n", ret, testcase->exitcode);
@@ -1395,6 +1483,7 @@ static void
 free_test_case(pkgconf_test_case_t *testcase)
 {
 	pkgconf_bufferset_free(&testcase->define_variables);
+	pkgconf_bufferset_free(&testcase->max_counters);
 	pkgconf_bufferset_free(&testcase->expected_stderr);
 	pkgconf_bufferset_free(&testcase->expected_stdout);
 	pkgconf_bufferset_free(&testcase->mkdirs);
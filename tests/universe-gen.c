@@ -0,0 +1,157 @@
+/*
+ * universe-gen.c
+ * Write a reproducible synthetic .pc universe into a directory.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <tests/win-shim.h>
+#include <tests/universe.h>
+#include <cli/getopt_long.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void
+usage(void)
+{
+	fprintf(stderr, "usage: universe-gen [options] <output-dir>\n\n");
+	fprintf(stderr, "  --seed=N                  seed for the generator (default 1)\n");
+	fprintf(stderr, "  --packages=N              number of packages (default 1000)\n");
+	fprintf(stderr, "  --degree=N                mean number of dependencies per package (default 3)\n");
+	fprintf(stderr, "  --degree-dist=DIST        fixed, uniform or geometric (default geometric)\n");
+	fprintf(stderr, "  --private=PERCENT         share of dependencies in Requires.private (default 25)\n");
+	fprintf(stderr, "  --shared=PERCENT          share of dependencies in Requires.shared (default 0)\n");
+	fprintf(stderr, "  --variable-depth=N        variables chained before libdir/includedir (default 2)\n");
+	fprintf(stderr, "  --cflags=N                Cflags fragments per package (default 2)\n");
+	fprintf(stderr, "  --libs=N                  Libs fragments per package (default 2)\n");
+	fprintf(stderr, "  --provides=N              Provides aliases per package (default 0)\n");
+	fprintf(stderr, "  --cycles=N                dependency cycles to introduce (default 0)\n");
+	fprintf(stderr, "  --spine                   make every package require its successor\n");
+	exit(EXIT_FAILURE);
+}
+
+static unsigned long
+parse_number(const char *arg, const char *option)
+{
+	char *end;
+	unsigned long value = strtoul(arg, &end, 10);
+
+	if (*arg == '\0' || *end != '\0')
+	{
+		fprintf(stderr, "universe-gen: invalid value for --%s: %s\n", option, arg);
+		exit(EXIT_FAILURE);
+	}
+
+	return value;
+}
+
+int
+main(int argc, char *argv[])
+{
+	universe_params_t params = UNIVERSE_PARAMS_DEFAULT;
+	universe_stats_t stats;
+	const char *dir;
+	int ret;
+
+	struct pkg_option options[] =
+	{
+		{"seed",		required_argument,	NULL,	1},
+		{"packages",		required_argument,	NULL,	2},
+		{"degree",		required_argument,	NULL,	3},
+		{"degree-dist",		required_argument,	NULL,	4},
+		{"private",		required_argument,	NULL,	5},
+		{"variable-depth",	required_argument,	NULL,	6},
+		{"cflags",		required_argument,	NULL,	7},
+		{"libs",		required_argument,	NULL,	8},
+		{"provides",		required_argument,	NULL,	9},
+		{"cycles",		required_argument,	NULL,	10},
+		{"spine",		no_argument,		NULL,	11},
+		{"shared",		required_argument,	NULL,	12},
+		{NULL,			0,			NULL,	0},
+	};
+
+	while ((ret = pkg_getopt_long_only(argc, argv, "", options, NULL)) != -1)
+	{
+		switch (ret)
+		{
+		case 1:
+			params.seed = parse_number(pkg_optarg, "seed");
+			break;
+		case 2:
+			params.packages = parse_number(pkg_optarg, "packages");
+			break;
+		case 3:
+			params.degree = parse_number(pkg_optarg, "degree");
+			break;
+		case 4:
+			if (!strcmp(pkg_optarg, "fixed"))
+				params.degree_dist = UNIVERSE_DEGREE_FIXED;
+			else if (!strcmp(pkg_optarg, "uniform"))
+				params.degree_dist = UNIVERSE_DEGREE_UNIFORM;
+			else if (!strcmp(pkg_optarg, "geometric"))
+				params.degree_dist = UNIVERSE_DEGREE_GEOMETRIC;
+			else
+				usage();
+			break;
+		case 5:
+			params.private_percent = (unsigned int) parse_number(pkg_optarg, "private");
+			if (params.private_percent > 100)
+				usage();
+			break;
+		case 6:
+			params.variable_depth = (unsigned int) parse_number(pkg_optarg, "variable-depth");
+			break;
+		case 7:
+			params.cflags = (unsigned int) parse_number(pkg_optarg, "cflags");
+			break;
+		case 8:
+			params.libs = (unsigned int) parse_number(pkg_optarg, "libs");
+			break;
+		case 9:
+			params.provides = (unsigned int) parse_number(pkg_optarg, "provides");
+			break;
+		case 10:
+			params.cycles = parse_number(pkg_optarg, "cycles");
+			break;
+		case 11:
+			params.spine = true;
+			break;
+		case 12:
+			params.shared_percent = (unsigned int) parse_number(pkg_optarg, "shared");
+			if (params.shared_percent > 100)
+				usage();
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (argv[pkg_optind] == NULL || params.private_percent + params.shared_percent > 100)
+		usage();
+
+	dir = argv[pkg_optind];
+	mkdir(dir, 0755);
+
+	if (!universe_generate(&params, dir, &stats))
+	{
+		fprintf(stderr, "universe-gen: failed to write the universe to %s: %s\n", dir, strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	printf("{\"packages\":%lu,\"requires\":%lu,\"requires_shared\":%lu,\"requires_private\":%lu,\"cycles\":%lu,\"provides\":%lu}\n",
+		stats.packages, stats.requires, stats.requires_shared, stats.requires_private, stats.cycles, stats.provides);
+
+	return EXIT_SUCCESS;
+}
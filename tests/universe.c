@@ -0,0 +1,324 @@
+/*
+ * universe.c
+ * Reproducible synthetic .pc universes for benchmarks and fuzzing.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#include <libpkgconf/stdinc.h>
+#include <tests/win-shim.h>
+#include <tests/universe.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The universe is a function of the parameters alone: the generator uses its
+ * own PRNG (splitmix64) rather than rand(), so a seed produces the same files
+ * on every platform.
+ */
+
+/* which Requires field an edge is written to */
+typedef enum {
+	UNIVERSE_EDGE_REQUIRES = 0,
+	UNIVERSE_EDGE_SHARED,
+	UNIVERSE_EDGE_PRIVATE,
+} universe_edge_kind_t;
+
+typedef struct {
+	unsigned long from;
+	unsigned long to;
+	universe_edge_kind_t kind;
+} universe_edge_t;
+
+typedef struct {
+	universe_edge_t *edges;
+	size_t count;
+	size_t capacity;
+} universe_edges_t;
+
+static uint64_t
+universe_next(uint64_t *state)
+{
+	uint64_t z = (*state += UINT64_C(0x9e3779b97f4a7c15));
+
+	z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+	return z ^ (z >> 31);
+}
+
+/* uniform over [0, bound) */
+static unsigned long
+universe_below(uint64_t *state, unsigned long bound)
+{
+	return bound != 0 ? (unsigned long) (universe_next(state) % bound) : 0;
+}
+
+/* uniform over [0, 1) */
+static double
+universe_unit(uint64_t *state)
+{
+	return (double) (universe_next(state) >> 11) / (double) (UINT64_C(1) << 53);
+}
+
+static unsigned long
+universe_degree(const universe_params_t *params, uint64_t *state)
+{
+	unsigned long degree = 0;
+
+	switch (params->degree_dist)
+	{
+	case UNIVERSE_DEGREE_FIXED:
+		return params->degree;
+	case UNIVERSE_DEGREE_UNIFORM:
+		return universe_below(state, 2 * params->degree + 1);
+	case UNIVERSE_DEGREE_GEOMETRIC:
+		/* each further dependency with probability degree / (degree + 1) */
+		while (degree < params->packages &&
+			universe_unit(state) * (double) (params->degree + 1) < (double) params->degree)
+			degree++;
+		return degree;
+	}
+
+	return params->degree;
+}
+
+static bool
+universe_edges_push(universe_edges_t *edges, unsigned long from, unsigned long to, universe_edge_kind_t kind)
+{
+	if (edges->count == edges->capacity)
+	{
+		size_t capacity = edges->capacity ? edges->capacity * 2 : 256;
+		universe_edge_t *grown = realloc(edges->edges, capacity * sizeof(*grown));
+
+		if (grown == NULL)
+			return false;
+
+		edges->edges = grown;
+		edges->capacity = capacity;
+	}
+
+	edges->edges[edges->count++] = (universe_edge_t) {
+		.from = from,
+		.to = to,
+		.kind = kind,
+	};
+
+	return true;
+}
+
+void
+universe_package_name(char *buf, size_t len, unsigned long index)
+{
+	snprintf(buf, len, "u%06lu", index);
+}
+
+static void
+universe_write_requires(FILE *f, const char *field, const universe_edge_t *edges, size_t count, universe_edge_kind_t kind)
+{
+	char name[64];
+	bool first = true;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (edges[i].kind != kind)
+			continue;
+
+		universe_package_name(name, sizeof name, edges[i].to);
+		fprintf(f, "%s %s", first ? field : ",", name);
+
+		/* constrain every other dependency, so both paths of the solver are exercised */
+		if ((edges[i].from + edges[i].to) % 2 == 0)
+			fprintf(f, " >= 1.0");
+
+		first = false;
+	}
+
+	if (!first)
+		fprintf(f, "\n");
+}
+
+static bool
+universe_write_package(const universe_params_t *params, const char *dir, unsigned long index,
+	const universe_edge_t *edges, size_t count)
+{
+	char name[64];
+	char path[512];
+	FILE *f;
+	bool has_private = false;
+
+	universe_package_name(name, sizeof name, index);
+	snprintf(path, sizeof path, "%s/%s.pc", dir, name);
+
+	f = fopen(path, "wb");
+	if (f == NULL)
+		return false;
+
+	fprintf(f, "v0=/opt/%s\n", name);
+	for (unsigned int v = 1; v < params->variable_depth; v++)
+		fprintf(f, "v%u=${v%u}/%u\n", v, v - 1, v);
+	if (params->variable_depth != 0)
+		fprintf(f, "libdir=${v%u}/lib\nincludedir=${v%u}/include\n\n",
+			params->variable_depth - 1, params->variable_depth - 1);
+	else
+		fprintf(f, "libdir=/usr/lib\nincludedir=/usr/include\n\n");
+
+	fprintf(f, "Name: %s\nDescription: synthetic package %lu\nVersion: 1.%lu\n", name, index, index % 10);
+
+	if (params->cflags != 0)
+	{
+		fprintf(f, "Cflags: -I${includedir}");
+		for (unsigned int c = 1; c < params->cflags; c++)
+			fprintf(f, " -D%s_%u", name, c);
+		fprintf(f, "\n");
+	}
+
+	if (params->libs != 0)
+	{
+		fprintf(f, "Libs: -L${libdir}");
+		for (unsigned int l = 1; l < params->libs; l++)
+			fprintf(f, " -l%s_%u", name, l);
+		fprintf(f, "\n");
+	}
+
+	for (size_t i = 0; i < count; i++)
+		has_private |= edges[i].kind == UNIVERSE_EDGE_PRIVATE;
+	if (has_private)
+		fprintf(f, "Libs.private: -lm -pthread\n");
+
+	if (params->provides != 0)
+	{
+		for (unsigned int p = 0; p < params->provides; p++)
+			fprintf(f, "%s %s-alias%u = 1.%lu", p != 0 ? "," : "Provides:", name, p, index % 10);
+		fprintf(f, "\n");
+	}
+
+	universe_write_requires(f, "Requires:", edges, count, UNIVERSE_EDGE_REQUIRES);
+	universe_write_requires(f, "Requires.shared:", edges, count, UNIVERSE_EDGE_SHARED);
+	universe_write_requires(f, "Requires.private:", edges, count, UNIVERSE_EDGE_PRIVATE);
+
+	return fclose(f) == 0;
+}
+
+static int
+universe_edge_cmp(const void *a, const void *b)
+{
+	const universe_edge_t *ea = a, *eb = b;
+
+	if (ea->from != eb->from)
+		return ea->from < eb->from ? -1 : 1;
+
+	if (ea->to != eb->to)
+		return ea->to < eb->to ? -1 : 1;
+
+	return (int) ea->kind - (int) eb->kind;
+}
+
+/*
+ * Writes params->packages files named u000000.pc, u000001.pc, ... into dir,
+ * which must already exist.  Package 0 is the natural root to query.
+ */
+bool
+universe_generate(const universe_params_t *params, const char *dir, universe_stats_t *stats)
+{
+	universe_edges_t edges = { NULL, 0, 0 };
+	uint64_t state = params->seed;
+	size_t first;
+	bool ok = false;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (unsigned long i = 0; i < params->packages; i++)
+	{
+		unsigned long later = params->packages - i - 1;
+		unsigned long degree = universe_degree(params, &state);
+
+		if (degree > later)
+			degree = later;
+
+		first = edges.count;
+		if (params->spine && later != 0)
+		{
+			if (!universe_edges_push(&edges, i, i + 1, UNIVERSE_EDGE_REQUIRES))
+				goto out;
+
+			stats->requires++;
+		}
+
+		for (unsigned long d = 0; d < degree; d++)
+		{
+			unsigned long to = i + 1 + universe_below(&state, later);
+			unsigned long share = universe_below(&state, 100);
+			universe_edge_kind_t kind = UNIVERSE_EDGE_REQUIRES;
+			bool duplicate = false;
+
+			/* one draw picks the field, so a universe without shared edges is unchanged */
+			if (share < params->private_percent)
+				kind = UNIVERSE_EDGE_PRIVATE;
+			else if (share < params->private_percent + params->shared_percent)
+				kind = UNIVERSE_EDGE_SHARED;
+
+			for (size_t e = first; e < edges.count; e++)
+				duplicate |= edges.edges[e].to == to;
+			if (duplicate)
+				continue;
+
+			if (!universe_edges_push(&edges, i, to, kind))
+				goto out;
+
+			if (kind == UNIVERSE_EDGE_PRIVATE)
+				stats->requires_private++;
+			else if (kind == UNIVERSE_EDGE_SHARED)
+				stats->requires_shared++;
+			else
+				stats->requires++;
+		}
+	}
+
+	/* close a cycle by pointing the target of an existing edge back at its source */
+	for (unsigned long c = 0; c < params->cycles && edges.count != 0; c++)
+	{
+		const universe_edge_t *edge = &edges.edges[universe_below(&state, edges.count)];
+
+		if (!universe_edges_push(&edges, edge->to, edge->from, UNIVERSE_EDGE_REQUIRES))
+			goto out;
+
+		stats->cycles++;
+	}
+
+	/* group the back edges with their package; the full ordering keeps the output independent of the qsort() used */
+	qsort(edges.edges, edges.count, sizeof(*edges.edges), universe_edge_cmp);
+
+	first = 0;
+	for (unsigned long i = 0; i < params->packages; i++)
+	{
+		size_t last = first;
+
+		while (last < edges.count && edges.edges[last].from == i)
+			last++;
+
+		if (!universe_write_package(params, dir, i, edges.edges + first, last - first))
+			goto out;
+
+		first = last;
+	}
+
+	stats->packages = params->packages;
+	stats->provides = params->packages * params->provides;
+	ok = true;
+
+out:
+	free(edges.edges);
+	return ok;
+}
@@ -0,0 +1,90 @@
+/*
+ * universe.h
+ * Reproducible synthetic .pc universes for benchmarks and fuzzing.
+ *
+ * SPDX-License-Identifier: pkgconf
+ *
+ * Copyright (c) 2026 pkgconf authors (see AUTHORS).
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * This software is provided 'as is' and without any warranty, express or
+ * implied.  In no event shall the authors be liable for any damages arising
+ * from the use of this software.
+ */
+
+#ifndef TESTS_UNIVERSE_H
+#define TESTS_UNIVERSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+	UNIVERSE_DEGREE_FIXED = 0,	/* every package has exactly `degree` dependencies */
+	UNIVERSE_DEGREE_UNIFORM,	/* uniform over [0, 2 * degree] */
+	UNIVERSE_DEGREE_GEOMETRIC,	/* geometric with mean `degree`: most packages have few, some have many */
+} universe_degree_dist_t;
+
+typedef struct {
+	uint64_t seed;
+
+	unsigned long packages;
+
+	/* dependencies only point at packages with a higher index, so the graph is acyclic ... */
+	unsigned long degree;
+	universe_degree_dist_t degree_dist;
+
+	/* ... unless cycles are requested, each of which adds one edge back to a lower index */
+	unsigned long cycles;
+
+	/* every package also requires its successor, so package 0 reaches the whole universe */
+	bool spine;
+
+	/* percentage of dependencies which go to Requires.private instead of Requires */
+	unsigned int private_percent;
+
+	/* percentage of dependencies which go to Requires.shared; private_percent + shared_percent <= 100 */
+	unsigned int shared_percent;
+
+	/* number of variables chained through ${} before libdir and includedir */
+	unsigned int variable_depth;
+
+	/* number of Cflags and Libs fragments per package */
+	unsigned int cflags;
+	unsigned int libs;
+
+	/* number of Provides aliases per package */
+	unsigned int provides;
+} universe_params_t;
+
+typedef struct {
+	unsigned long packages;
+	unsigned long requires;
+	unsigned long requires_shared;
+	unsigned long requires_private;
+	unsigned long cycles;
+	unsigned long provides;
+} universe_stats_t;
+
+#define UNIVERSE_PARAMS_DEFAULT { \
+		.seed = 1, \
+		.packages = 1000, \
+		.degree = 3, \
+		.degree_dist = UNIVERSE_DEGREE_GEOMETRIC, \
+		.cycles = 0, \
+		.spine = false, \
+		.private_percent = 25, \
+		.shared_percent = 0, \
+		.variable_depth = 2, \
+		.cflags = 2, \
+		.libs = 2, \
+		.provides = 0, \
+	}
+
+extern void universe_package_name(char *buf, size_t len, unsigned long index);
+extern bool universe_generate(const universe_params_t *params, const char *dir, universe_stats_t *stats);
+
+#endif